@@ -4,6 +4,7 @@ import lib.OpenGLItem 1.0
 import "src/QML_Files/Buttons"
 
 import Cpp.Painter 1.0
+import Cpp.Theme 1.0
 
 
 HusWindow {
@@ -11,10 +12,22 @@ HusWindow {
     height: 480
     visible: true
     title: qsTr("Hello World")
-    CppPainter {
-        id: painter;
+    // 应用侧的强类型主题跟随 HusTheme 切换明暗, 只有值变化的令牌会通知绑定
+    Binding {
+        target: AppTheme;
+        property: "dark";
+        value: HusTheme.isDark;
+    }
+    // 场景图版本: 图元直接变成几何节点, 不再整窗光栅化上传; 接口与 CppPainter 相同
+    // 较重的子树都异步创建, 第一帧只有窗口和按钮, 其余由 FrameIncubationController 按帧孵化
+    Loader {
+        id: painterLoader;
         z:-1;
         anchors.fill: parent;
+        asynchronous: true;
+        sourceComponent: Component {
+            CppSGPainter {}
+        }
     }
 
     Rectangle{
@@ -28,6 +41,8 @@ HusWindow {
             text: "HuskarUI";
 
             onClicked: () => {
+                const painter = painterLoader.item;
+                if ( !painter ) return;
                 painter.randomPaint();
                 painter.outputString("haah");
 
@@ -35,17 +50,22 @@ HusWindow {
         }
 
 
-        Rectangle {
-            color: "transparent";
-            border.width: 2;
-            border.color: "red";
+        Loader {
             width: 100; height: 100;
             anchors.top: mainButton.bottom;
             anchors.margins: 10;
             anchors.horizontalCenter: mainButton.horizontalCenter;
-            OpenGLItem {
-                visible: true;
-                anchors.fill: parent;
+            asynchronous: true;
+            sourceComponent: Component {
+                Rectangle {
+                    color: "transparent";
+                    border.width: 2;
+                    border.color: "red";
+                    OpenGLItem {
+                        visible: true;
+                        anchors.fill: parent;
+                    }
+                }
             }
         }
     }
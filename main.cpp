@@ -1,12 +1,19 @@
 #include<QGuiApplication>
 #include <QDebug> // 添加调试输出支持
 #include <QQmlApplicationEngine>
+#include <QQmlComponent>
 #include <QQuickWindow>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
 
 // #include <HuskarUI/husapp.h>
 #include "HuskarUI/include/husapp.h"
 #include "iostream"
 #include "src/OpenGL/opengl_item.hpp"
+#include "src/CPP/frame_incubation_controller.hpp"
+#include "src/CPP/startup_profiler.hpp"
+#include "trace.hpp"
+#include <cstring>
 
 // 测试各种设计模式
 #include "src/CPP/FactoryTest.hpp"
@@ -23,7 +30,37 @@
 
 
 int main(int argc, char *argv[]) {
+  StartupProfiler::start();
+  // 内核校验和基准不在界面程序里, 见 src/benchmarks
+  // --startup-once: 第一个完整帧后输出各阶段时间点并退出, 由 benchmarks startup
+  // 调用
+  const bool exitAfterFirstFrame =
+      argc > 1 && std::strcmp(argv[1], "--startup-once") == 0;
+  // --trace <文件>: 记录 GUI / 渲染 / 工作线程的时间线, 退出时写成 Chrome trace
+  // JSON, 用 chrome://tracing 或 ui.perfetto.dev 打开
+  const char *tracePath = nullptr;
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (std::strcmp(argv[i], "--trace") == 0)
+      tracePath = argv[i + 1];
+  }
+  if (tracePath) {
+    TRACE_THREAD_NAME("GUI thread");
+    Trace::start();
+  }
+
+  // 着色器是 GLSL 330 core / 300 es, 渲染器用 std140 uniform 块 (GL 3.1 / ES
+  // 3.0 起才有); 不指定时 macOS 给 2.1 上下文. 要在创建窗口之前设置
+  QSurfaceFormat surfaceFormat = QSurfaceFormat::defaultFormat();
+  if (QOpenGLContext::openGLModuleType() == QOpenGLContext::LibGLES) {
+    surfaceFormat.setVersion(3, 0);
+  } else {
+    surfaceFormat.setVersion(3, 3);
+    surfaceFormat.setProfile(QSurfaceFormat::CoreProfile);
+  }
+  QSurfaceFormat::setDefaultFormat(surfaceFormat);
+
   QGuiApplication app(argc, argv);
+  StartupProfiler::mark(StartupPhase::kApplication);
   // 自动创建的QQuickWindow类
   QQuickWindow::setGraphicsApi(QSGRendererInterface::OpenGL);
   QQuickWindow::setDefaultAlphaBuffer(true);
@@ -32,6 +69,7 @@ int main(int argc, char *argv[]) {
   qmlRegisterType<OpenGLItem>("lib.OpenGLItem", 1, 0, "OpenGLItem");
   QQmlApplicationEngine engine;
   HusApp::initialize(&engine);
+  StartupProfiler::mark(StartupPhase::kHuskarInit);
 
   // 获取应用程序目录，用于定位 HuskarUI 插件
   QString appDir = QCoreApplication::
@@ -47,13 +85,60 @@ int main(int argc, char *argv[]) {
 
   // 调试输出：查看所有 Import Path
   qDebug() << "QML Import Paths:" << engine.importPathList();
+  StartupProfiler::mark(StartupPhase::kImportPaths);
 
   QObject::connect(
       &engine, &QQmlApplicationEngine::objectCreationFailed, &app,
       []() { QCoreApplication::exit(-1); }, Qt::QueuedConnection);
 
+  // 先单独编译 Main 及其依赖的类型, 把类型加载和对象创建分开计时;
+  // 编译结果留在引擎的类型缓存里, loadFromModule 直接复用
+  // Main.qml 里 asynchronous 的 Loader 由它按帧切片孵化, 必须在创建对象之前装上
+  FrameIncubationController incubator;
+  engine.setIncubationController(&incubator);
+
+  QQmlComponent mainType(&engine);
+  mainType.loadFromModule("QMLSQLite", "Main");
+  StartupProfiler::mark(StartupPhase::kTypeLoading);
+
   // 加载主 QML 文件（必须在 addImportPath 之后）
   engine.loadFromModule("QMLSQLite", "Main");
+  StartupProfiler::mark(StartupPhase::kComponentCreation);
+
+  QQuickWindow *mainWindow = engine.rootObjects().isEmpty()
+                                 ? nullptr
+                                 : qobject_cast<QQuickWindow *>(
+                                       engine.rootObjects().first());
+  incubator.attachTo(mainWindow);
+  if (tracePath && mainWindow) {
+    // 场景图同步期间 GUI 线程被阻塞, 这段区间就是两边互相等待的时间;
+    // 信号都在渲染线程发出
+    QObject::connect(
+        mainWindow, &QQuickWindow::beforeSynchronizing, mainWindow,
+        []() { TRACE_BEGIN("Scene graph sync"); }, Qt::DirectConnection);
+    QObject::connect(
+        mainWindow, &QQuickWindow::afterSynchronizing, mainWindow,
+        []() { TRACE_END("Scene graph sync"); }, Qt::DirectConnection);
+    QObject::connect(
+        mainWindow, &QQuickWindow::frameSwapped, mainWindow,
+        []() { TRACE_INSTANT("Frame swapped"); }, Qt::DirectConnection);
+  }
+  // 异步 Loader 在第一帧之后才孵化, 启动时间量到 OpenGLItem 和背景画布都画出来的那一帧
+  if (incubator.incubatingObjectCount() == 0) {
+    StartupProfiler::mark(StartupPhase::kDeferredContent);
+  } else {
+    QObject::connect(&incubator, &FrameIncubationController::drained, &app,
+                     []() { StartupProfiler::mark(StartupPhase::kDeferredContent); });
+  }
+  StartupProfiler::finishOnFirstCompleteFrame(
+      mainWindow,
+      {StartupPhase::kDeferredContent, StartupPhase::kFirstOpenGLRender},
+      [exitAfterFirstFrame]() {
+        if (exitAfterFirstFrame) {
+          StartupProfiler::printMachineReadable();
+          QCoreApplication::exit(0);
+        }
+      });
 
   // 设计模式测试
   // useStrategyTest();
@@ -65,5 +150,11 @@ int main(int argc, char *argv[]) {
 
   TemplateTest();
 
-  return app.exec();
+  const int exitCode = app.exec();
+  if (tracePath) {
+    Trace::stop();
+    if (Trace::writeJson(tracePath))
+      qDebug() << "Trace written to" << tracePath;
+  }
+  return exitCode;
 }
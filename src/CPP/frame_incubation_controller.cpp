@@ -0,0 +1,68 @@
+#include "frame_incubation_controller.hpp"
+
+#include <QDebug>
+#include <QQuickWindow>
+#include <QScreen>
+
+FrameIncubationController::FrameIncubationController( QObject* parent )
+    : QObject( parent )
+{
+    connect( &m_fallback, &QTimer::timeout, this, &FrameIncubationController::incubateSlice );
+}
+
+void FrameIncubationController::attachTo( QQuickWindow* window ) {
+    m_window = window;
+    m_sinceAttach.start();
+    if ( !window ) {
+        // 没有窗口就没有帧, 直接用定时器推进
+        m_firstFrameShown = true;
+        m_fallback.start( 16 );
+        return;
+    }
+
+    const qreal refreshRate = window->screen() ? window->screen()->refreshRate() : 60.0;
+    const int frameMs = qMax( 1, int( 1000.0 / ( refreshRate > 0 ? refreshRate : 60.0 ) ) );
+    setBudgetMs( frameMs / 3 );
+    m_fallback.setInterval( frameMs );
+
+    // frameSwapped 在渲染线程发出, 排队回到 GUI 线程再孵化
+    connect( window, &QQuickWindow::frameSwapped, this, &FrameIncubationController::onFrameSwapped, Qt::QueuedConnection );
+    QTimer::singleShot( kFirstFrameDeadlineMs, this, [this]() {
+        if ( m_firstFrameShown ) return;
+        qDebug() << "First frame missed the" << kFirstFrameDeadlineMs << "ms deadline, incubating on a timer";
+        m_firstFrameShown = true;
+        if ( incubatingObjectCount() > 0 ) m_fallback.start();
+    } );
+}
+
+void FrameIncubationController::incubatingObjectCountChanged( int count ) {
+    if ( count == 0 ) {
+        m_fallback.stop();
+        emit drained();
+        return;
+    }
+    if ( !m_firstFrameShown ) return;
+    // 有新的孵化任务时让窗口出一帧, 由 frameSwapped 接着推进
+    if ( m_window && m_window->isVisible() && !m_fallback.isActive() ) {
+        m_window->update();
+    } else if ( !m_fallback.isActive() ) {
+        m_fallback.start();
+    }
+}
+
+void FrameIncubationController::onFrameSwapped() {
+    if ( !m_firstFrameShown ) {
+        m_firstFrameShown = true;
+        if ( m_sinceAttach.elapsed() > kFirstFrameDeadlineMs ) {
+            qDebug() << "First frame took" << m_sinceAttach.elapsed() << "ms, deadline is" << kFirstFrameDeadlineMs << "ms";
+        }
+    }
+    // 定时器已经接手时不重复孵化
+    if ( m_fallback.isActive() ) return;
+    incubateSlice();
+    if ( incubatingObjectCount() > 0 && m_window ) m_window->update();
+}
+
+void FrameIncubationController::incubateSlice() {
+    if ( incubatingObjectCount() > 0 ) incubateFor( m_budgetMs );
+}
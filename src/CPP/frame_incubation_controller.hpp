@@ -0,0 +1,45 @@
+// 单一职责: 按帧切片的 QML 孵化控制器, asynchronous 的 Loader 等异步创建都由它推进
+// 第一帧交换之前不孵化, 让首帧只包含同步创建的部分; 之后每帧交换后在 GUI 线程孵化至多 budget 毫秒,
+// 还有对象没孵化完就请求下一帧, 直到全部完成
+// 截止时间内窗口没有交出第一帧 (比如窗口被隐藏) 时改用定时器推进, 异步部分不会一直卡住
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QQmlIncubationController>
+#include <QTimer>
+
+class QQuickWindow;
+
+class FrameIncubationController : public QObject, public QQmlIncubationController {
+    Q_OBJECT
+public:
+    static constexpr int kFirstFrameDeadlineMs = 500;
+
+    explicit FrameIncubationController( QObject* parent = nullptr );
+
+    // 根窗口创建后调用; 之前已经排队的孵化任务等第一帧之后开始
+    void attachTo( QQuickWindow* window );
+
+    // 每帧孵化时间, 默认取屏幕刷新间隔的三分之一
+    int budgetMs() const { return m_budgetMs; }
+    void setBudgetMs( int budgetMs ) { m_budgetMs = qMax( 1, budgetMs ); }
+
+signals:
+    // 孵化任务全部完成, 异步创建的对象都已就绪
+    void drained();
+
+protected:
+    void incubatingObjectCountChanged( int count ) override;
+
+private:
+    void onFrameSwapped();
+    void incubateSlice();
+
+    QPointer<QQuickWindow> m_window;
+    int m_budgetMs = 5;
+    bool m_firstFrameShown = false;
+    QElapsedTimer m_sinceAttach;
+    QTimer m_fallback;      // 没有帧驱动时按刷新间隔推进
+};
@@ -1,7 +1,14 @@
 #ifndef _GLOBAL_MACRO_HPP_
 #define _GLOBAL_MACRO_HPP_
-#include <iostream>
+#include <sstream>
 
-#define PRINT_LOG(x) std::cout<< x << std::endl;
+#include "async_logger.hpp"
+
+// 保留流式写法: 拼接在调用线程完成, 写出交给异步日志的后台线程, 不再每次都 flush 标准输出
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define PRINT_LOG(x) do { std::ostringstream printLogStream; printLogStream << x; LOG_INFO( "{}", printLogStream.str() ); } while ( 0 );
+#else
+#define PRINT_LOG(x) ( (void)0 );
+#endif
 
 #endif
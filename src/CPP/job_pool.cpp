@@ -0,0 +1,111 @@
+#include "job_pool.hpp"
+#include "trace.hpp"
+
+#include <QThread>
+#include <vector>
+
+class JobHandle::Job : public QRunnable {
+public:
+    explicit Job( std::function<void()> task )
+        : m_task( std::move(task) )
+    {
+        // 生命周期由 shared_ptr 管理, 不能让线程池 delete
+        setAutoDelete(false);
+    }
+
+    void run() override {
+        // 线程池执行结束后释放自引用 (Qt6 在 run() 之前读取 autoDelete, run 返回后不再访问对象)
+        std::shared_ptr<Job> keepAlive = std::move( self );
+
+        // wait() 就地执行时在调用线程上, 已经有名字的线程不改名
+        TRACE_THREAD_NAME_IF_UNSET( "JobPool worker" );
+        {
+            TRACE_SCOPE( "JobPool task" );
+            m_task();
+        }
+
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_finished = true;
+        m_cond.notify_all();
+    }
+
+    bool finished() {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        return m_finished;
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_cond.wait( lock, [this]{ return m_finished; } );
+    }
+
+    // 持有自身的引用, 保证线程池执行期间对象存活
+    std::shared_ptr<Job> self;
+
+private:
+    std::function<void()> m_task;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_finished = false;
+};
+
+bool JobHandle::isFinished() const {
+    return !m_job || m_job->finished();
+}
+
+void JobHandle::wait() {
+    if ( !m_job ) return;
+
+    // 还没被工作线程取走的话 就地执行
+    if ( JobPool::instance().m_pool.tryTake( m_job.get() ) ) {
+        m_job->run();
+    }
+    m_job->wait();
+}
+
+JobPool& JobPool::instance() {
+    static JobPool pool;
+    return pool;
+}
+
+JobPool::JobPool() {
+    // 留一个核给 GUI/渲染线程
+    m_pool.setMaxThreadCount( qMax( 1, QThread::idealThreadCount() - 1 ) );
+    m_pool.setObjectName( "JobPool" );
+}
+
+JobHandle JobPool::submit( std::function<void()> task ) {
+    auto job = std::make_shared<JobHandle::Job>( std::move(task) );
+    job->self = job;
+    m_pool.start( job.get() );
+
+    return JobHandle( job );
+}
+
+void JobPool::parallelFor( int begin, int end, int grain, const std::function<void(int, int)>& fn ) {
+    if ( end <= begin ) return;
+    grain = qMax( 1, grain );
+
+    const int count = end - begin;
+    if ( count <= grain ) {
+        fn( begin, end );
+        return;
+    }
+
+    std::vector<JobHandle> jobs;
+    jobs.reserve( static_cast<size_t>( count / grain + 1 ) );
+
+    int start = begin;
+    while ( start + grain < end ) {
+        const int stop = start + grain;
+        jobs.push_back( submit( [&fn, start, stop]{ fn( start, stop ); } ) );
+        start = stop;
+    }
+
+    // 最后一块在调用线程上执行
+    fn( start, end );
+
+    for ( JobHandle& job : jobs ) {
+        job.wait();
+    }
+}
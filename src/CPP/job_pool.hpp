@@ -0,0 +1,52 @@
+// 单一职责: 基于 QThreadPool 的轻量任务池, 供渲染命令录制等工作线程任务使用
+#pragma once
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+class JobPool;
+
+// 任务句柄: 可等待 可查询完成状态
+// wait() 时若任务还在队列中未开始, 直接从线程池取出在当前线程执行, 避免嵌套等待导致死锁
+class JobHandle {
+public:
+    JobHandle() = default;
+
+    bool isValid() const { return static_cast<bool>(m_job); }
+    bool isFinished() const;
+    void wait();
+
+private:
+    class Job;
+    friend class JobPool;
+
+    explicit JobHandle( std::shared_ptr<Job> job ) : m_job( std::move(job) ) {}
+
+    std::shared_ptr<Job> m_job;
+};
+
+class JobPool {
+public:
+    static JobPool& instance();
+
+    // 提交一个任务到工作线程
+    JobHandle submit( std::function<void()> task );
+
+    // 把 [begin, end) 按 grain 切块并行执行, 调用线程也参与执行最后一块, 返回时全部完成
+    void parallelFor( int begin, int end, int grain, const std::function<void(int, int)>& fn );
+
+    int workerCount() const { return m_pool.maxThreadCount(); }
+
+private:
+    JobPool();
+    JobPool( const JobPool& ) = delete;
+    JobPool& operator=( const JobPool& ) = delete;
+
+    friend class JobHandle;
+
+    QThreadPool m_pool;     // 独立线程池 不与 QtConcurrent 的全局池抢线程
+};
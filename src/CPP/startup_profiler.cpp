@@ -0,0 +1,155 @@
+#include "startup_profiler.hpp"
+#include "trace.hpp"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQuickWindow>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+
+namespace {
+
+QElapsedTimer s_clock;
+std::mutex s_mutex;
+std::vector<StartupMark> s_marks;
+std::atomic<bool> s_finished { false };
+size_t s_syncedMarks = 0;       // 最近一次场景图同步开始时已有的时间点个数, 只在渲染线程读写
+
+QString defaultTracePath() {
+    return QDir::temp().filePath( QStringLiteral( "QMLSQLite_startup_trace.json" ) );
+}
+
+} // namespace
+
+void StartupProfiler::start() {
+    s_clock.start();
+}
+
+bool StartupProfiler::mark( const char* phase ) {
+    if ( s_finished.load( std::memory_order_relaxed ) ) return false;
+
+    const qint64 nsecs = s_clock.nsecsElapsed();
+    std::lock_guard<std::mutex> lock( s_mutex );
+    for ( const StartupMark& existing : s_marks ) {
+        if ( existing.phase == phase ) return false;
+    }
+    s_marks.push_back( { phase, nsecs, quint64( quintptr( QThread::currentThreadId() ) ) } );
+    // 开了 --trace 时启动阶段也出现在时间线上
+    TRACE_INSTANT( phase );
+    return true;
+}
+
+std::vector<StartupMark> StartupProfiler::marks() {
+    std::lock_guard<std::mutex> lock( s_mutex );
+    return s_marks;
+}
+
+void StartupProfiler::finishOnFirstCompleteFrame( QQuickWindow* window, std::vector<const char*> waitFor,
+                                                  std::function<void()> done ) {
+    const auto finish = [done]() {
+        // 帧交换和超时都可能排队调用, 只收尾一次
+        if ( s_finished.exchange( true, std::memory_order_relaxed ) ) return;
+        printSummary();
+        const QString path = defaultTracePath();
+        if ( writeTrace( path ) ) qDebug() << "Startup trace written to" << path;
+        if ( done ) done();
+    };
+    if ( !window ) {
+        qDebug() << "Startup profiler: root object is not a window, no first frame to wait for";
+        finish();
+        return;
+    }
+    // 两个信号都在渲染线程发出; 同步期间 GUI 线程阻塞, 此前 GUI 线程记录的阶段都进了这一帧
+    QObject::connect( window, &QQuickWindow::beforeSynchronizing, window, []() {
+        if ( s_finished.load( std::memory_order_relaxed ) ) return;
+        std::lock_guard<std::mutex> lock( s_mutex );
+        s_syncedMarks = s_marks.size();
+    }, Qt::DirectConnection );
+    QObject::connect( window, &QQuickWindow::frameSwapped, window, [finish, waitFor]() {
+        if ( s_finished.load( std::memory_order_relaxed ) ) return;
+        mark( StartupPhase::kFirstFrameSwap );
+        const quint64 renderThread = quint64( quintptr( QThread::currentThreadId() ) );
+        {
+            std::lock_guard<std::mutex> lock( s_mutex );
+            for ( const char* phase : waitFor ) {
+                const auto found = std::find_if( s_marks.begin(), s_marks.end(),
+                                                 [phase]( const StartupMark& mark ) { return mark.phase == phase; } );
+                if ( found == s_marks.end() ) return;
+                if ( size_t( found - s_marks.begin() ) >= s_syncedMarks && found->threadId != renderThread ) return;
+            }
+        }
+        // 收尾回到 GUI 线程做
+        if ( mark( StartupPhase::kFirstCompleteFrame ) ) {
+            QMetaObject::invokeMethod( QCoreApplication::instance(), finish, Qt::QueuedConnection );
+        }
+    }, Qt::DirectConnection );
+
+    QTimer::singleShot( kCompleteFrameDeadlineMs, QCoreApplication::instance(), [finish, waitFor]() {
+        if ( s_finished.load( std::memory_order_relaxed ) ) return;
+        const std::vector<StartupMark> all = marks();
+        for ( const char* phase : waitFor ) {
+            const bool seen = std::any_of( all.begin(), all.end(), [phase]( const StartupMark& mark ) { return mark.phase == phase; } );
+            if ( !seen ) qDebug() << "Startup profiler: phase" << phase << "not reached within" << kCompleteFrameDeadlineMs << "ms";
+        }
+        finish();
+    } );
+}
+
+void StartupProfiler::printSummary() {
+    const std::vector<StartupMark> all = marks();
+    qDebug().noquote() << "Startup phases:";
+    qint64 previous = 0;
+    for ( const StartupMark& mark : all ) {
+        qDebug().noquote() << QString( "  %1 %2 ms   (%3 ms)" )
+                                  .arg( QString::fromStdString( mark.phase ), -26 )
+                                  .arg( ( mark.nsecs - previous ) / 1e6, 8, 'f', 2 )
+                                  .arg( mark.nsecs / 1e6, 8, 'f', 2 );
+        previous = mark.nsecs;
+    }
+}
+
+bool StartupProfiler::writeTrace( const QString& path ) {
+    const std::vector<StartupMark> all = marks();
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+    qint64 previous = 0;
+    for ( const StartupMark& mark : all ) {
+        // 完整事件, 单位微秒
+        events.append( QJsonObject {
+            { "name", QString::fromStdString( mark.phase ) },
+            { "cat", "startup" },
+            { "ph", "X" },
+            { "ts", previous / 1e3 },
+            { "dur", ( mark.nsecs - previous ) / 1e3 },
+            { "pid", pid },
+            { "tid", qint64( mark.threadId ) },
+        } );
+        previous = mark.nsecs;
+    }
+
+    QFile file( path );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        qDebug() << "Failed to write startup trace" << path;
+        return false;
+    }
+    file.write( QJsonDocument( QJsonObject { { "traceEvents", events }, { "displayTimeUnit", "ms" } } ).toJson() );
+    return true;
+}
+
+void StartupProfiler::printMachineReadable() {
+    for ( const StartupMark& mark : marks() ) {
+        // 整数纳秒: 子进程在 QGuiApplication 设置的区域设置下运行, %f 可能写出逗号小数
+        std::printf( "STARTUP %s\t%lld\n", mark.phase.c_str(), (long long)mark.nsecs );
+    }
+    std::fflush( stdout );
+}
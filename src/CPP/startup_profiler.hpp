@@ -0,0 +1,56 @@
+// 单一职责: 记录启动各阶段的时间点, 第一个完整帧交换后打印摘要并写出 Chrome trace 文件
+// 每个阶段从上一个时间点开始, 到记录它的时间点结束; 时间从 main() 调用 start() 算起, 不含进程加载和静态初始化
+// 启动完成之后 mark() 只剩一次原子读, 渲染线程每帧调用也没有开销
+#pragma once
+
+#include <QString>
+#include <functional>
+#include <string>
+#include <vector>
+
+class QQuickWindow;
+
+namespace StartupPhase {
+constexpr const char* kApplication = "QGuiApplication";
+constexpr const char* kHuskarInit = "HusApp::initialize";
+constexpr const char* kImportPaths = "Import paths";
+constexpr const char* kTypeLoading = "QML type loading";
+constexpr const char* kComponentCreation = "Component creation";
+constexpr const char* kFirstFrameSwap = "First frame swapped";
+constexpr const char* kDeferredContent = "Async content incubated";
+constexpr const char* kFirstOpenGLRender = "First OpenGLItem render";
+constexpr const char* kFirstCompleteFrame = "First complete frame swapped";
+}
+
+struct StartupMark {
+    std::string phase;
+    qint64 nsecs = 0;       // 相对 start()
+    quint64 threadId = 0;
+};
+
+class StartupProfiler {
+public:
+    // main() 最开始调用
+    static void start();
+
+    // 记录一个阶段结束, 任何线程都可以调用; 同名只记第一次, 新记录时返回 true
+    static bool mark( const char* phase );
+
+    // 按记录顺序返回全部时间点
+    static std::vector<StartupMark> marks();
+
+    // 第一帧只含同步创建的部分, 只记 kFirstFrameSwap; 等 waitFor 里的阶段都记录过, 并且都进了同一帧
+    // (GUI 线程记录的要早于这一帧的同步, 渲染线程记录的要早于交换), 这一帧交换后才算启动完成
+    // 完成后在 GUI 线程调用 done, 调用前已打印摘要并写出 trace 文件; 超时仍没凑齐时打印缺少的阶段并照样结束
+    static constexpr int kCompleteFrameDeadlineMs = 10000;
+    static void finishOnFirstCompleteFrame( QQuickWindow* window, std::vector<const char*> waitFor, std::function<void()> done );
+
+    // 每个阶段一行: 阶段名, 耗时, 累计
+    static void printSummary();
+
+    // Chrome trace-event 格式, chrome://tracing 和 Perfetto 都能打开
+    static bool writeTrace( const QString& path );
+
+    // 供 benchmarks startup 的父进程解析: 每行 "STARTUP <阶段>\t<累计纳秒>"
+    static void printMachineReadable();
+};
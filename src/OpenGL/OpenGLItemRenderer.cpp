@@ -1,6 +1,10 @@
 #include "OpenGLItemRenderer.hpp"
 #include "opengl_item.hpp"
 #include "render_factory.hpp"
+#include "render_queue.hpp"
+#include "startup_profiler.hpp"
+#include "async_logger.hpp"
+#include "trace.hpp"
 #include <QOpenGLFramebufferObject>
 #include <QDebug>
 
@@ -10,18 +14,25 @@ OpenGLItemRenderer::OpenGLItemRenderer( OpenGLItem* item )
     , m_rendererInitialized(false)
 {
     initializeOpenGLFunctions();
+    // 在渲染线程上创建; basic 渲染循环下就是 GUI 线程, 不覆盖已有的名字
+    TRACE_THREAD_NAME_IF_UNSET( "Render thread" );
+    m_clock.start();
     m_config = item->config();
     m_currentRendererType = item->renderType();
 }
 
 OpenGLItemRenderer::~OpenGLItemRenderer() {
+    // 工作线程可能还在访问渲染器
+    waitForRecording();
     if ( m_renderer ) {
         m_renderer->cleanup();
     }
+    m_replayer.cleanup();
 }
 
 void OpenGLItemRenderer::render() {
     // 渲染线程中 每一帧都调用
+    TRACE_SCOPE( "OpenGLItemRenderer::render" );
     if ( !m_renderer ) {
         m_renderer = RenderFactory::create( m_currentRendererType.toStdString() );
         if ( m_renderer ) {
@@ -35,19 +46,20 @@ void OpenGLItemRenderer::render() {
         // 获取当前渲染的FBO尺寸
         QSize fboSize = framebufferObject()->size();
 
-        // 创建渲染上下文
-        RenderContext context(
-            fboSize,
-            m_projectMatrix,
-            0.0f
-        );
-        context = context.withFrameNumber(m_frameNumber++);
-
-        // 执行渲染
-        m_renderer->render(context);
-
+        if ( m_renderer->supportsRecording() ) {
+            // 回放工作线程录制好的命令, 回放完马上把下一帧交给工作线程录制
+            // synchronize 只在 item 变脏时才调用, 不能依赖它来派发录制
+            renderRecorded( fboSize );
+            startRecording();
+        } else {
+            // 执行渲染
+            m_renderer->prepareFrame();
+            m_renderer->render( makeContext(fboSize) );
+        }
     }
 
+    StartupProfiler::mark( StartupPhase::kFirstOpenGLRender );
+
     // 触发下一帧 "Call this function when the FBO should be renderered angain."
     update();
 }
@@ -55,6 +67,9 @@ void OpenGLItemRenderer::render() {
 // 第一帧的时候调用  如果设置 QQuickFramebufferObject::textureFollowsItemSize(true); 就会在每次组件大小改变时调用这个 createFrameBuffer
 QOpenGLFramebufferObject* OpenGLItemRenderer::createFramebufferObject( const QSize& size  ) {
     // 创建FBO 当尺寸变化时调用
+    // 工作线程可能正按旧尺寸录制, 先等它结束再改尺寸和渲染器
+    waitForRecording();
+
     QOpenGLFramebufferObjectFormat format;
     format.setAttachment( QOpenGLFramebufferObject::CombinedDepthStencil );
     format.setSamples(4);   // 4x MSAA抗锯齿
@@ -65,6 +80,7 @@ QOpenGLFramebufferObject* OpenGLItemRenderer::createFramebufferObject( const QSi
 
     // 更新投影矩阵
     updateProjectMatrix(size);
+    m_fboSize = size;
 
     // 通知渲染器尺寸变化
     if ( m_renderer && m_rendererInitialized ) {
@@ -76,8 +92,14 @@ QOpenGLFramebufferObject* OpenGLItemRenderer::createFramebufferObject( const QSi
 
 void OpenGLItemRenderer::synchronize( QQuickFramebufferObject* item ) {
     // 从GUI线程同步数据到渲染线程
+    TRACE_SCOPE( "OpenGLItemRenderer::synchronize" );
     OpenGLItem* glItem = static_cast<OpenGLItem*>(item);
 
+    // 上一帧的录制任务必须结束后才能改动渲染器
+    waitForRecording();
+    // 渲染器换掉或重新初始化过时, render() 末尾按旧渲染器录好的命令作废
+    bool rendererChanged = false;
+
     // 同步配置
     if ( m_config.vertexShaderPath() != glItem->config().vertexShaderPath()
         || m_config.fragmentShaderPath() != glItem->config().fragmentShaderPath() )
@@ -86,6 +108,7 @@ void OpenGLItemRenderer::synchronize( QQuickFramebufferObject* item ) {
         if ( m_renderer ) {
             m_renderer->cleanup();
             initializeRenderer();
+            rendererChanged = true;
         }
     }
 
@@ -99,6 +122,7 @@ void OpenGLItemRenderer::synchronize( QQuickFramebufferObject* item ) {
             m_renderer.reset();
         }
         m_rendererInitialized = false;
+        rendererChanged = true;
         // 同步配置 新渲染器需要配置
         m_config = glItem->config();
     } else {
@@ -107,7 +131,7 @@ void OpenGLItemRenderer::synchronize( QQuickFramebufferObject* item ) {
         // 检查各个配置是否变化
         if ( m_config.vertexShaderPath() != newConfig.vertexShaderPath()
             || m_config.fragmentShaderPath() != newConfig.fragmentShaderPath()
-            || m_config.vertexData().size() != newConfig.vertexShaderPath().size() )
+            || m_config.vertexData().size() != newConfig.vertexData().size() )
         {
             m_config = newConfig;
 
@@ -116,9 +140,13 @@ void OpenGLItemRenderer::synchronize( QQuickFramebufferObject* item ) {
                 m_renderer->cleanup();
                 m_rendererInitialized = false;
                 initializeRenderer();
+                rendererChanged = true;
             }
         }
     }
+
+    // 由 render() 在渲染线程重新录制
+    if ( rendererChanged ) m_pendingCommands = nullptr;
 }
 
 void OpenGLItemRenderer::initializeRenderer() {
@@ -140,6 +168,95 @@ void OpenGLItemRenderer::initializeRenderer() {
 }
 
 
+RenderContext OpenGLItemRenderer::makeContext( const QSize& size ) {
+    const float now = m_clock.elapsed() / 1000.0f;
+    const float delta = now - m_lastTime;
+    m_lastTime = now;
+
+    // 创建渲染上下文
+    RenderContext context(
+        size,
+        m_projectMatrix,
+        delta
+    );
+    return context.withFrameNumber(m_frameNumber++).withTime(now);
+}
+
+void OpenGLItemRenderer::startRecording() {
+    if ( !m_renderer || !m_rendererInitialized || !m_renderer->supportsRecording() ) return;
+    // FBO还没创建时没有尺寸可用, 留给下一次 render() 在渲染线程录制
+    if ( m_fboSize.isEmpty() ) return;
+
+    m_recordIndex = ( m_recordIndex + 1 ) % kFramesInFlight;
+    CommandBuffer* commands = &m_commandBuffers[m_recordIndex];
+    IRenderer* renderer = m_renderer.get();
+    RenderContext context = makeContext( m_fboSize );
+
+    // 还在渲染线程上, 录制开始前先让渲染器完成需要GL的准备工作
+    renderer->prepareFrame();
+
+    m_recordedSize = m_fboSize;
+    m_pendingCommands = commands;
+    // 用帧号把 render 和工作线程上的录制连起来
+    const quint64 frame = m_frameNumber;
+    TRACE_FLOW_BEGIN( "Record commands", frame );
+    m_recordJob = JobPool::instance().submit( [renderer, commands, context, frame]() {
+        TRACE_SCOPE( "Record commands" );
+        TRACE_FLOW_END( "Record commands", frame );
+        commands->reset();
+        renderer->record( context, *commands );
+    } );
+}
+
+void OpenGLItemRenderer::renderRecorded( const QSize& fboSize ) {
+    waitForRecording();
+
+    CommandBuffer* commands = m_pendingCommands;
+    m_pendingCommands = nullptr;
+
+    // 没有预录制(第一帧) 或者录制之后FBO尺寸又变了 在渲染线程直接录制
+    if ( !commands || m_recordedSize != fboSize ) {
+        // 尺寸变化时 startRecording 已经调用过 prepareFrame
+        if ( !commands ) m_renderer->prepareFrame();
+        commands = &m_commandBuffers[m_recordIndex];
+        commands->reset();
+        m_renderer->record( makeContext(fboSize), *commands );
+    }
+
+    m_replayer.execute( *commands );
+    m_replayer.finish();
+
+    reportSubmissionStats();
+}
+
+void OpenGLItemRenderer::waitForRecording() {
+    if ( m_recordJob.isValid() ) {
+        TRACE_SCOPE( "Wait for recording" );
+        m_recordJob.wait();
+        m_recordJob = JobHandle();
+    }
+}
+
+void OpenGLItemRenderer::reportSubmissionStats() {
+    // 大约每秒回传一次 避免每帧跨线程投递
+    if ( m_frameNumber % 60 != 0 ) return;
+
+    SubmissionStats stats;
+    if ( !m_renderer->submissionStats( stats ) ) return;
+
+    QVariantMap map;
+    map["drawCount"] = stats.drawCount;
+    map["programSwitchesBefore"] = stats.programSwitchesBefore;
+    map["textureSwitchesBefore"] = stats.textureSwitchesBefore;
+    map["programSwitchesAfter"] = stats.programSwitchesAfter;
+    map["textureSwitchesAfter"] = stats.textureSwitchesAfter;
+    map["culledCount"] = stats.culledCount;
+
+    QMetaObject::invokeMethod( m_item, "setSubmissionStats",
+                               Qt::QueuedConnection,
+                               Q_ARG( QVariantMap, map ) );
+}
+
 // 修改组件宽高之后重新计算矩阵 矩阵会在每一帧参与计算 RenderContext
 void OpenGLItemRenderer::updateProjectMatrix( const QSize& size ) {
     if ( size.width() <= 0 || size.height() <= 0 ) {
@@ -152,8 +269,9 @@ void OpenGLItemRenderer::updateProjectMatrix( const QSize& size ) {
 }
 
 void OpenGLItemRenderer::handleRenderError( RenderError error, const std::string& msg ) {
+    // 渲染线程里调用, 不能阻塞在输出上
+    LOG_ERROR( "Render Error: {}", msg );
     QString errorMsg = QString::fromStdString(msg);
-    qWarning() << "Render Error: " << errorMsg;
 
     // 不能直接发射信号 线程不同
     QMetaObject::invokeMethod( m_item, "renderError",
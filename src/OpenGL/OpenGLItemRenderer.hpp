@@ -3,11 +3,15 @@
 #include <QQuickFramebufferObject>
 #include <QOpenGLFunctions>
 #include <QMatrix4x4>
+#include <QElapsedTimer>
 #include <memory>
 
 #include "irenderer.hpp"
 #include "render_context.hpp"
 #include "render_config.hpp"
+#include "command_buffer.hpp"
+#include "gl_command_replayer.hpp"
+#include "job_pool.hpp"
 
 class OpenGLItem;
 
@@ -26,11 +30,29 @@ private:
     void updateProjectMatrix(const QSize& size);
     void handleRenderError( RenderError error, const std::string& message );
 
+    // 命令录制: render 回放完本帧后把下一帧派发到工作线程, 下一次 render 时等待并回放
+    RenderContext makeContext( const QSize& size );
+    void startRecording();
+    void renderRecorded( const QSize& fboSize );
+    void waitForRecording();
+    void reportSubmissionStats();
+
     OpenGLItem* m_item;         // 指向OpenGLItem 用于访问配置和发射信号!!
     std::unique_ptr<IRenderer> m_renderer;
     RenderConfig m_config;
     QMatrix4x4 m_projectMatrix;
     quint64 m_frameNumber;
+    QElapsedTimer m_clock;      // FrameBlock 中的 time
+    float m_lastTime = 0.0f;
     bool m_rendererInitialized;
     QString m_currentRendererType;
+
+    static constexpr int kFramesInFlight = 2;
+    CommandBuffer m_commandBuffers[kFramesInFlight];   // 每帧一块线性内存 交替使用
+    int m_recordIndex = 0;
+    CommandBuffer* m_pendingCommands = nullptr;         // 工作线程已录制/正在录制的命令
+    QSize m_recordedSize;
+    QSize m_fboSize;
+    JobHandle m_recordJob;
+    GLCommandReplayer m_replayer;
 };
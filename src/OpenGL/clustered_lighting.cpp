@@ -0,0 +1,190 @@
+#include "clustered_lighting.hpp"
+
+#include <QDebug>
+#include <QOpenGLContext>
+#include <algorithm>
+
+namespace {
+
+// 计算着色器的 image 单元, 与 light_cluster.comp.glsl 中的 binding 一致
+constexpr uint32_t kGridImage = 0;
+constexpr uint32_t kIndexImage = 1;
+constexpr uint32_t kCounterImage = 2;
+
+// CPU 路径初始的下标容量 (行), 之后按需翻倍
+constexpr uint32_t kInitialIndexRows = 64;
+
+uint32_t rowsFor( uint32_t indices ) {
+    return ( indices + ClusteredLighting::kIndexRowLength - 1 ) / ClusteredLighting::kIndexRowLength;
+}
+
+} // namespace
+
+bool ClusteredLighting::initialize( const QString& computeShaderPath ) {
+    if ( m_initialized ) return true;
+    initializeOpenGLFunctions();
+
+    const ClusterGridSize& size = m_clusterer.size();
+    m_lightTexture = createDataTexture( GL_RGBA32F, GL_RGBA, GL_FLOAT, int( kMaxLights * 2 ), 1 );
+    m_gridTexture = createDataTexture( GL_RG32UI, GL_RG_INTEGER, GL_UNSIGNED_INT, int( size.tileCount() ), int( size.slices ) );
+
+    // 网格清零, 第一帧录制之前着色器读到的都是空簇
+    const std::vector<uint32_t> zeros( size_t( size.clusterCount() ) * 2, 0 );
+    glBindTexture( GL_TEXTURE_2D, m_gridTexture );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+    glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, int( size.tileCount() ), int( size.slices ), GL_RG_INTEGER, GL_UNSIGNED_INT, zeros.data() );
+
+    if ( !computeShaderPath.isEmpty() ) {
+        m_computeReady = initializeCompute( computeShaderPath );
+    }
+
+    // 计算着色器没有回读, 下标纹理一次按最坏情况分配
+    m_indexRows = m_computeReady ? rowsFor( size.clusterCount() * kMaxLightsPerCluster ) : kInitialIndexRows;
+    m_requiredRows = m_indexRows;
+    m_indexTexture = createDataTexture( GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, int( kIndexRowLength ), int( m_indexRows ) );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    qDebug() << "Clustered lighting:" << ( m_computeReady ? "compute shader" : "CPU" ) << "binning,"
+             << size.tilesX << "x" << size.tilesY << "x" << size.slices << "clusters";
+    m_initialized = m_lightTexture && m_gridTexture && m_indexTexture;
+    return m_initialized;
+}
+
+bool ClusteredLighting::initializeCompute( const QString& path ) {
+    // 计算着色器需要桌面 GL 4.3 (image 原子操作 + rg32ui image 格式)
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if ( !context || context->isOpenGLES() || context->format().version() < qMakePair( 4, 3 ) ) {
+        return false;
+    }
+    if ( !m_computeProgram.addShaderFromSourceFile( QOpenGLShader::Compute, path ) || !m_computeProgram.link() ) {
+        qDebug() << "Light cluster compute shader error, using CPU binning:" << m_computeProgram.log();
+        m_computeProgram.removeAllShaders();
+        return false;
+    }
+
+    m_gridSizeLocation = m_computeProgram.uniformLocation( "gridSize" );
+    m_projectionLocation = m_computeProgram.uniformLocation( "projection" );
+    m_depthLocation = m_computeProgram.uniformLocation( "depthRange" );
+    m_computeProgram.bind();
+    m_computeProgram.setUniformValue( "lightData", 0 );
+    m_computeProgram.release();
+
+    m_counterTexture = createDataTexture( GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, 1, 1 );
+    return m_counterTexture != 0;
+}
+
+GLuint ClusteredLighting::createDataTexture( GLenum internalFormat, GLenum format, GLenum type, int width, int height ) {
+    GLuint texture = 0;
+    glGenTextures( 1, &texture );
+    glBindTexture( GL_TEXTURE_2D, texture );
+    glTexImage2D( GL_TEXTURE_2D, 0, GLint( internalFormat ), width, height, 0, format, type, nullptr );
+    // 只用 texelFetch 读取, 整数纹理也必须是 NEAREST 才完整
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    return texture;
+}
+
+void ClusteredLighting::prepareFrame() {
+    if ( !m_initialized || m_requiredRows <= m_indexRows ) return;
+
+    // 内容每帧整体重写, 扩容时不需要保留
+    uint32_t rows = m_indexRows;
+    while ( rows < m_requiredRows ) rows *= 2;
+    glDeleteTextures( 1, &m_indexTexture );
+    m_indexTexture = createDataTexture( GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, int( kIndexRowLength ), int( rows ) );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+    m_indexRows = rows;
+}
+
+void ClusteredLighting::record( CommandBuffer& commands, const std::vector<PointLight>& lights,
+                                const QMatrix4x4& projection, float nearPlane, float farPlane ) {
+    if ( !m_initialized ) return;
+
+    m_lightCount = uint32_t( std::min<size_t>( lights.size(), kMaxLights ) );
+    m_clusterer.setProjection( projection, nearPlane, farPlane );
+
+    m_lightData.resize( size_t( m_lightCount ) * 8 );
+    m_clusterLights.resize( m_lightCount );
+    for ( uint32_t i = 0; i < m_lightCount; ++i ) {
+        const PointLight& light = lights[i];
+        float* texels = m_lightData.data() + size_t( i ) * 8;
+        texels[0] = light.position.x();
+        texels[1] = light.position.y();
+        texels[2] = light.position.z();
+        texels[3] = light.radius;
+        texels[4] = light.color.x();
+        texels[5] = light.color.y();
+        texels[6] = light.color.z();
+        texels[7] = 0.0f;
+        m_clusterLights[i] = { light.position.x(), light.position.y(), light.position.z(), light.radius };
+    }
+    if ( m_lightCount > 0 ) {
+        commands.uploadTexture( m_lightTexture, PixelFormat::RGBA32F, 0, 0, int( m_lightCount * 2 ), 1, m_lightData.data() );
+    }
+
+    const ClusterGridSize& size = m_clusterer.size();
+    if ( m_computeReady ) {
+        const uint32_t zero = 0;
+        const float* p = m_clusterer.projectionParameters();
+        commands.uploadTexture( m_counterTexture, PixelFormat::R32UI, 0, 0, 1, 1, &zero );
+        commands.bindProgram( m_computeProgram.programId() );
+        commands.setUniform( m_gridSizeLocation, QVector4D( float( size.tilesX ), float( size.tilesY ), float( size.slices ), float( m_lightCount ) ) );
+        commands.setUniform( m_projectionLocation, QVector4D( p[0], p[1], p[2], p[3] ) );
+        commands.setUniform( m_depthLocation, QVector4D( nearPlane, farPlane, float( m_indexRows * kIndexRowLength ), 0.0f ) );
+        commands.bindTexture( 0, m_lightTexture );
+        commands.bindImage( kGridImage, m_gridTexture, PixelFormat::RG32UI, ImageAccess::WriteOnly );
+        commands.bindImage( kIndexImage, m_indexTexture, PixelFormat::R32UI, ImageAccess::WriteOnly );
+        commands.bindImage( kCounterImage, m_counterTexture, PixelFormat::R32UI, ImageAccess::ReadWrite );
+        commands.dispatchCompute( size.tilesX, size.tilesY, size.slices );
+        return;
+    }
+
+    m_clusterer.build( m_clusterLights.data(), m_lightCount );
+
+    // 容量不够时这一帧截断 (靠后的簇会少灯), 下一帧 prepareFrame() 扩容
+    const std::vector<uint32_t>& indices = m_clusterer.indices();
+    const uint32_t total = uint32_t( indices.size() );
+    const uint32_t capacity = m_indexRows * kIndexRowLength;
+    m_requiredRows = rowsFor( total );
+    const std::vector<uint32_t>* grid = &m_clusterer.grid();
+    if ( total > capacity ) {
+        m_truncatedGrid = *grid;
+        for ( size_t cluster = 0; cluster < m_truncatedGrid.size(); cluster += 2 ) {
+            const uint32_t offset = m_truncatedGrid[cluster];
+            m_truncatedGrid[cluster + 1] = offset >= capacity ? 0 : std::min( m_truncatedGrid[cluster + 1], capacity - offset );
+        }
+        grid = &m_truncatedGrid;
+    }
+    commands.uploadTexture( m_gridTexture, PixelFormat::RG32UI, 0, 0, int( size.tileCount() ), int( size.slices ), grid->data() );
+
+    const uint32_t uploaded = std::min( total, capacity );
+    const uint32_t fullRows = uploaded / kIndexRowLength;
+    const uint32_t tail = uploaded % kIndexRowLength;
+    if ( fullRows > 0 ) {
+        commands.uploadTexture( m_indexTexture, PixelFormat::R32UI, 0, 0, int( kIndexRowLength ), int( fullRows ), indices.data() );
+    }
+    if ( tail > 0 ) {
+        commands.uploadTexture( m_indexTexture, PixelFormat::R32UI, 0, int( fullRows ), int( tail ), 1,
+                                indices.data() + size_t( fullRows ) * kIndexRowLength );
+    }
+}
+
+void ClusteredLighting::bind( CommandBuffer& commands, uint32_t firstUnit ) const {
+    commands.bindTexture( firstUnit + 0, m_lightTexture );
+    commands.bindTexture( firstUnit + 1, m_gridTexture );
+    commands.bindTexture( firstUnit + 2, m_indexTexture );
+}
+
+void ClusteredLighting::cleanup() {
+    if ( !m_initialized ) return;
+    const GLuint textures[] = { m_lightTexture, m_gridTexture, m_indexTexture, m_counterTexture };
+    for ( GLuint texture : textures ) {
+        if ( texture ) glDeleteTextures( 1, &texture );
+    }
+    m_lightTexture = m_gridTexture = m_indexTexture = m_counterTexture = 0;
+    m_computeProgram.removeAllShaders();
+    m_computeReady = false;
+    m_initialized = false;
+}
@@ -0,0 +1,77 @@
+// 单一职责: 分簇点光源的 GPU 资源和每帧更新
+// 灯光数据 / 簇网格 / 下标列表放在浮点和整数纹理里, 片元着色器用 texelFetch 读取 (GL 3.3 / ES 3.0 都支持)
+// 桌面 GL 4.3 上由计算着色器分簇, 其余情况在录制线程用 LightClusterer 分簇后上传
+// 所有每帧的 GL 操作都录制进 CommandBuffer, 只有创建和扩容纹理在渲染线程直接调用 GL
+#pragma once
+
+#include "command_buffer.hpp"
+#include "light_clusterer.hpp"
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QVector3D>
+#include <vector>
+
+struct PointLight {
+    QVector3D position;         // 视图空间
+    float radius = 1.0f;        // 影响半径, 边缘平滑衰减到 0
+    QVector3D color;            // 已乘强度
+};
+
+class ClusteredLighting : protected QOpenGLExtraFunctions {
+public:
+    static constexpr uint32_t kMaxLights = 1024;
+    static constexpr uint32_t kIndexRowLength = 1024;       // 下标纹理每行的下标数, 着色器中相同
+    static constexpr uint32_t kMaxLightsPerCluster = 256;   // 计算着色器共享内存的上限
+
+    ClusteredLighting() = default;
+    ~ClusteredLighting() = default;
+
+    // 渲染线程调用; computeShaderPath 为空或上下文低于 GL 4.3 时使用 CPU 分簇
+    bool initialize( const QString& computeShaderPath );
+    bool usesCompute() const { return m_computeReady; }
+
+    // 渲染线程调用, 按最近一次录制的需求扩容下标纹理 (只有 CPU 路径需要)
+    void prepareFrame();
+
+    // 录制线程调用: 分簇 (或派发计算着色器) 并上传灯光数据, lights 超过 kMaxLights 的部分被忽略
+    void record( CommandBuffer& commands, const std::vector<PointLight>& lights,
+                 const QMatrix4x4& projection, float nearPlane, float farPlane );
+
+    // 把三张数据纹理绑定到 firstUnit 开始的连续三个纹理单元: 灯光 / 网格 / 下标
+    void bind( CommandBuffer& commands, uint32_t firstUnit ) const;
+
+    const ClusterGridSize& gridSize() const { return m_clusterer.size(); }
+    float sliceScale() const { return m_clusterer.sliceScale(); }
+    float sliceBias() const { return m_clusterer.sliceBias(); }
+    uint32_t lightCount() const { return m_lightCount; }
+
+    // CPU 路径的统计, 计算着色器路径不回读
+    const ClusterStats& stats() const { return m_clusterer.stats(); }
+
+    void cleanup();
+
+private:
+    GLuint createDataTexture( GLenum internalFormat, GLenum format, GLenum type, int width, int height );
+    bool initializeCompute( const QString& path );
+
+    LightClusterer m_clusterer;
+    std::vector<ClusterLight> m_clusterLights;      // 录制线程的临时数据, 每帧复用
+    std::vector<float> m_lightData;                 // 每盏灯两个 RGBA32F 纹素: 位置 + 半径, 颜色
+    std::vector<uint32_t> m_truncatedGrid;          // 下标容量不够时截断后的网格
+
+    GLuint m_lightTexture = 0;
+    GLuint m_gridTexture = 0;
+    GLuint m_indexTexture = 0;
+    GLuint m_counterTexture = 0;                    // 计算着色器分配下标用的原子计数器
+    uint32_t m_indexRows = 0;                       // 下标纹理的行数
+    uint32_t m_requiredRows = 0;                    // 最近一次录制需要的行数, prepareFrame() 按它扩容
+    uint32_t m_lightCount = 0;
+
+    QOpenGLShaderProgram m_computeProgram;
+    bool m_computeReady = false;
+    int m_gridSizeLocation = -1;
+    int m_projectionLocation = -1;
+    int m_depthLocation = -1;
+    bool m_initialized = false;
+};
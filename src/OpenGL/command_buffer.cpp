@@ -0,0 +1,159 @@
+#include "command_buffer.hpp"
+
+#include <cstring>
+
+CommandBuffer::CommandBuffer( size_t blockSize )
+    : m_allocator( blockSize )
+{
+}
+
+void CommandBuffer::reset() {
+    m_allocator.reset();
+    m_head = nullptr;
+    m_tail = nullptr;
+    m_count = 0;
+}
+
+void CommandBuffer::clear( uint32_t flags, const QVector4D& color, float depth ) {
+    cmd::Clear* c = push<cmd::Clear>();
+    c->flags = flags;
+    c->color[0] = color.x();
+    c->color[1] = color.y();
+    c->color[2] = color.z();
+    c->color[3] = color.w();
+    c->depth = depth;
+}
+
+void CommandBuffer::setViewport( int x, int y, int width, int height ) {
+    cmd::SetViewport* c = push<cmd::SetViewport>();
+    c->x = x;
+    c->y = y;
+    c->width = width;
+    c->height = height;
+}
+
+void CommandBuffer::setRenderState( const RenderState& state ) {
+    push<cmd::SetRenderState>()->state = state;
+}
+
+void CommandBuffer::bindProgram( RenderHandle program ) {
+    push<cmd::BindProgram>()->program = program;
+}
+
+void CommandBuffer::setUniform( int location, const QMatrix4x4& value ) {
+    cmd::SetUniformMat4* c = push<cmd::SetUniformMat4>();
+    c->location = location;
+    std::memcpy( c->value, value.constData(), sizeof(c->value) );
+}
+
+void CommandBuffer::setUniform( int location, const QVector4D& value ) {
+    cmd::SetUniformVec4* c = push<cmd::SetUniformVec4>();
+    c->location = location;
+    c->value[0] = value.x();
+    c->value[1] = value.y();
+    c->value[2] = value.z();
+    c->value[3] = value.w();
+}
+
+void CommandBuffer::bindVertexBuffer( RenderHandle buffer, uint32_t stride, std::initializer_list<VertexAttribute> attributes ) {
+    bindVertexBuffer( buffer, stride, attributes.begin(), static_cast<uint32_t>( attributes.size() ) );
+}
+
+void CommandBuffer::bindVertexBuffer( RenderHandle buffer, uint32_t stride, const VertexAttribute* attributes, uint32_t count ) {
+    cmd::BindVertexBuffer* c = push<cmd::BindVertexBuffer>();
+    c->buffer = buffer;
+    c->stride = stride;
+    c->attributeCount = 0;
+    for ( uint32_t i = 0; i < count; ++i ) {
+        if ( c->attributeCount >= static_cast<uint32_t>( cmd::BindVertexBuffer::kMaxAttributes ) ) break;
+        c->attributes[c->attributeCount++] = attributes[i];
+    }
+}
+
+void CommandBuffer::bindIndexBuffer( RenderHandle buffer, IndexType type ) {
+    cmd::BindIndexBuffer* c = push<cmd::BindIndexBuffer>();
+    c->buffer = buffer;
+    c->indexType = type;
+}
+
+void CommandBuffer::bindTexture( uint32_t unit, RenderHandle texture, TextureTarget target ) {
+    cmd::BindTexture* c = push<cmd::BindTexture>();
+    c->unit = unit;
+    c->texture = texture;
+    c->target = target;
+}
+
+void CommandBuffer::bindUniformBuffer( uint32_t binding, RenderHandle buffer, uint32_t offset, uint32_t size ) {
+    cmd::BindUniformBuffer* c = push<cmd::BindUniformBuffer>();
+    c->binding = binding;
+    c->buffer = buffer;
+    c->offset = offset;
+    c->size = size;
+}
+
+void CommandBuffer::uploadBuffer( BufferTarget target, RenderHandle buffer, uint32_t offset, const void* data, uint32_t size, bool orphan ) {
+    cmd::UploadBuffer* c = push<cmd::UploadBuffer>();
+    c->target = target;
+    c->orphan = orphan;
+    c->buffer = buffer;
+    c->offset = offset;
+    c->size = size;
+
+    // 拷贝到帧内存 回放时源数据可能已经失效
+    void* copy = m_allocator.allocate( size, 16 );
+    std::memcpy( copy, data, size );
+    c->data = copy;
+}
+
+void CommandBuffer::uploadTexture( RenderHandle texture, PixelFormat format, int x, int y, int width, int height, const void* data ) {
+    cmd::UploadTexture* c = push<cmd::UploadTexture>();
+    c->format = format;
+    c->texture = texture;
+    c->x = x;
+    c->y = y;
+    c->width = width;
+    c->height = height;
+
+    const size_t size = size_t( width ) * size_t( height ) * bytesPerPixel( format );
+    void* copy = m_allocator.allocate( size, 16 );
+    std::memcpy( copy, data, size );
+    c->data = copy;
+}
+
+void CommandBuffer::bindImage( uint32_t unit, RenderHandle texture, PixelFormat format, ImageAccess access ) {
+    cmd::BindImage* c = push<cmd::BindImage>();
+    c->unit = unit;
+    c->texture = texture;
+    c->format = format;
+    c->access = access;
+}
+
+void CommandBuffer::dispatchCompute( uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ ) {
+    cmd::DispatchCompute* c = push<cmd::DispatchCompute>();
+    c->groupsX = groupsX;
+    c->groupsY = groupsY;
+    c->groupsZ = groupsZ;
+}
+
+uint32_t CommandBuffer::bytesPerPixel( PixelFormat format ) {
+    switch ( format ) {
+    case PixelFormat::RGBA32F: return 16;
+    case PixelFormat::RG32UI:  return 8;
+    case PixelFormat::R32UI:   return 4;
+    }
+    return 4;
+}
+
+void CommandBuffer::draw( PrimitiveType primitive, uint32_t first, uint32_t count ) {
+    cmd::Draw* c = push<cmd::Draw>();
+    c->primitive = primitive;
+    c->first = first;
+    c->count = count;
+}
+
+void CommandBuffer::drawIndexed( PrimitiveType primitive, uint32_t count, uint32_t firstIndex ) {
+    cmd::DrawIndexed* c = push<cmd::DrawIndexed>();
+    c->primitive = primitive;
+    c->count = count;
+    c->firstIndex = firstIndex;
+}
@@ -0,0 +1,75 @@
+// 单一职责: 录制一帧的渲染命令到线性内存
+// 录制不调用任何图形 API, 可以在工作线程或 synchronize 阶段执行; 回放由后端 (GLCommandReplayer) 在渲染线程完成
+#pragma once
+
+#include "frame_allocator.hpp"
+#include "render_command.hpp"
+
+#include <QMatrix4x4>
+#include <QVector4D>
+#include <initializer_list>
+
+class CommandBuffer {
+public:
+    explicit CommandBuffer( size_t blockSize = 64 * 1024 );
+
+    CommandBuffer( const CommandBuffer& ) = delete;
+    CommandBuffer& operator=( const CommandBuffer& ) = delete;
+
+    // 每帧录制前调用 内存块保留复用
+    void reset();
+
+    // ---- 录制接口 ----
+    void clear( uint32_t flags, const QVector4D& color = QVector4D( 0.0f, 0.0f, 0.0f, 0.0f ), float depth = 1.0f );
+    void setViewport( int x, int y, int width, int height );
+    void setRenderState( const RenderState& state );
+    void bindProgram( RenderHandle program );
+    void setUniform( int location, const QMatrix4x4& value );
+    void setUniform( int location, const QVector4D& value );
+    void bindVertexBuffer( RenderHandle buffer, uint32_t stride, std::initializer_list<VertexAttribute> attributes );
+    void bindVertexBuffer( RenderHandle buffer, uint32_t stride, const VertexAttribute* attributes, uint32_t count );
+    void bindIndexBuffer( RenderHandle buffer, IndexType type );
+    void bindTexture( uint32_t unit, RenderHandle texture, TextureTarget target = TextureTarget::Texture2D );
+    void bindUniformBuffer( uint32_t binding, RenderHandle buffer, uint32_t offset, uint32_t size );
+    void uploadBuffer( BufferTarget target, RenderHandle buffer, uint32_t offset, const void* data, uint32_t size, bool orphan = false );
+    void uploadTexture( RenderHandle texture, PixelFormat format, int x, int y, int width, int height, const void* data );
+    void bindImage( uint32_t unit, RenderHandle texture, PixelFormat format, ImageAccess access );
+    void dispatchCompute( uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ );
+    void draw( PrimitiveType primitive, uint32_t first, uint32_t count );
+    void drawIndexed( PrimitiveType primitive, uint32_t count, uint32_t firstIndex = 0 );
+
+    static uint32_t bytesPerPixel( PixelFormat format );
+
+    // ---- 遍历接口 ----
+    const CommandHeader* begin() const { return m_head; }
+    bool isEmpty() const { return m_head == nullptr; }
+    uint32_t commandCount() const { return m_count; }
+    size_t bytesUsed() const { return m_allocator.bytesUsed(); }
+
+    // 按命令类型取出完整命令
+    template <typename T>
+    static const T& as( const CommandHeader* header ) {
+        return *reinterpret_cast<const T*>( header );
+    }
+
+private:
+    template <typename T>
+    T* push() {
+        T* command = m_allocator.allocate<T>();
+        command->header.type = T::kType;
+        command->header.next = nullptr;
+        if ( m_tail ) {
+            m_tail->next = &command->header;
+        } else {
+            m_head = &command->header;
+        }
+        m_tail = &command->header;
+        ++m_count;
+        return command;
+    }
+
+    FrameAllocator m_allocator;
+    CommandHeader* m_head = nullptr;
+    CommandHeader* m_tail = nullptr;
+    uint32_t m_count = 0;
+};
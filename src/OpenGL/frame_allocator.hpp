@@ -0,0 +1,78 @@
+// 单一职责: 按帧复用的线性内存分配器
+// 分配只做指针递增, 帧结束时整体 reset, 已申请的内存块保留给下一帧复用
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class FrameAllocator {
+public:
+    explicit FrameAllocator( size_t blockSize = 64 * 1024 )
+        : m_blockSize( blockSize )
+    {}
+
+    FrameAllocator( const FrameAllocator& ) = delete;
+    FrameAllocator& operator=( const FrameAllocator& ) = delete;
+
+    void* allocate( size_t size, size_t alignment = alignof(std::max_align_t) ) {
+        while ( m_current < m_blocks.size() ) {
+            Block& block = m_blocks[m_current];
+            const size_t offset = alignUp( block.used, alignment );
+            if ( offset + size <= block.size ) {
+                block.used = offset + size;
+                m_bytesUsed += size;
+                return block.data.get() + offset;
+            }
+            // 当前块放不下 换下一块
+            ++m_current;
+        }
+
+        // 超大的分配单独成块
+        const size_t blockSize = size + alignment > m_blockSize ? size + alignment : m_blockSize;
+        Block block;
+        block.data.reset( new uint8_t[blockSize] );
+        block.size = blockSize;
+        m_blocks.push_back( std::move(block) );
+        m_current = m_blocks.size() - 1;
+        return allocate( size, alignment );
+    }
+
+    template <typename T>
+    T* allocate() {
+        return static_cast<T*>( allocate( sizeof(T), alignof(T) ) );
+    }
+
+    // 帧开始时调用 所有块回到未使用状态
+    void reset() {
+        for ( Block& block : m_blocks ) {
+            block.used = 0;
+        }
+        m_current = 0;
+        m_bytesUsed = 0;
+    }
+
+    size_t bytesUsed() const { return m_bytesUsed; }
+    size_t bytesReserved() const {
+        size_t total = 0;
+        for ( const Block& block : m_blocks ) total += block.size;
+        return total;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    static size_t alignUp( size_t value, size_t alignment ) {
+        return ( value + alignment - 1 ) & ~( alignment - 1 );
+    }
+
+    size_t m_blockSize;
+    std::vector<Block> m_blocks;
+    size_t m_current = 0;
+    size_t m_bytesUsed = 0;
+};
@@ -0,0 +1,276 @@
+#include "gl_command_replayer.hpp"
+
+#ifndef GL_TEXTURE_FETCH_BARRIER_BIT
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#endif
+#ifndef GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#endif
+
+namespace {
+
+GLenum toGL( PrimitiveType primitive ) {
+    switch ( primitive ) {
+    case PrimitiveType::TriangleStrip: return GL_TRIANGLE_STRIP;
+    case PrimitiveType::Lines:         return GL_LINES;
+    case PrimitiveType::Points:        return GL_POINTS;
+    case PrimitiveType::Triangles:
+    default:                           return GL_TRIANGLES;
+    }
+}
+
+GLenum toGL( CompareFunc func ) {
+    switch ( func ) {
+    case CompareFunc::LessEqual: return GL_LEQUAL;
+    case CompareFunc::Equal:     return GL_EQUAL;
+    case CompareFunc::Always:    return GL_ALWAYS;
+    case CompareFunc::Less:
+    default:                     return GL_LESS;
+    }
+}
+
+GLenum toGL( BufferTarget target ) {
+    switch ( target ) {
+    case BufferTarget::Index:   return GL_ELEMENT_ARRAY_BUFFER;
+    case BufferTarget::Uniform: return GL_UNIFORM_BUFFER;
+    case BufferTarget::Vertex:
+    default:                    return GL_ARRAY_BUFFER;
+    }
+}
+
+// 内部格式, 像素格式, 分量类型
+struct PixelFormatGL {
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+};
+
+PixelFormatGL toGL( PixelFormat format ) {
+    switch ( format ) {
+    case PixelFormat::RG32UI:  return { GL_RG32UI, GL_RG_INTEGER, GL_UNSIGNED_INT };
+    case PixelFormat::R32UI:   return { GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT };
+    case PixelFormat::RGBA32F:
+    default:                   return { GL_RGBA32F, GL_RGBA, GL_FLOAT };
+    }
+}
+
+GLenum toGL( ImageAccess access ) {
+    switch ( access ) {
+    case ImageAccess::ReadOnly:  return GL_READ_ONLY;
+    case ImageAccess::WriteOnly: return GL_WRITE_ONLY;
+    case ImageAccess::ReadWrite:
+    default:                     return GL_READ_WRITE;
+    }
+}
+
+} // namespace
+
+void GLCommandReplayer::initialize() {
+    if ( m_initialized ) return;
+    initializeOpenGLFunctions();
+    glGenVertexArrays( 1, &m_vertexArray );
+    m_initialized = true;
+}
+
+void GLCommandReplayer::cleanup() {
+    if ( m_vertexArray ) {
+        glDeleteVertexArrays( 1, &m_vertexArray );
+        m_vertexArray = 0;
+    }
+    m_initialized = false;
+}
+
+void GLCommandReplayer::execute( const CommandBuffer& commands ) {
+    if ( !m_initialized ) initialize();
+    glBindVertexArray( m_vertexArray );
+
+    for ( const CommandHeader* header = commands.begin(); header; header = header->next ) {
+        switch ( header->type ) {
+        case CommandType::Clear: {
+            const auto& c = CommandBuffer::as<cmd::Clear>( header );
+            GLbitfield mask = 0;
+            if ( c.flags & ClearColor ) {
+                glClearColor( c.color[0], c.color[1], c.color[2], c.color[3] );
+                mask |= GL_COLOR_BUFFER_BIT;
+            }
+            if ( c.flags & ClearDepth ) {
+                // 深度写关闭时 glClear 不会清深度
+                glDepthMask( GL_TRUE );
+                m_stateValid = false;
+                glClearDepthf( c.depth );
+                mask |= GL_DEPTH_BUFFER_BIT;
+            }
+            if ( c.flags & ClearStencil ) {
+                glClearStencil( 0 );
+                mask |= GL_STENCIL_BUFFER_BIT;
+            }
+            glClear( mask );
+            break;
+        }
+        case CommandType::SetViewport: {
+            const auto& c = CommandBuffer::as<cmd::SetViewport>( header );
+            glViewport( c.x, c.y, c.width, c.height );
+            break;
+        }
+        case CommandType::SetRenderState:
+            applyRenderState( CommandBuffer::as<cmd::SetRenderState>( header ).state );
+            break;
+        case CommandType::BindProgram: {
+            const auto& c = CommandBuffer::as<cmd::BindProgram>( header );
+            if ( c.program != m_program ) {
+                glUseProgram( c.program );
+                m_program = c.program;
+            }
+            break;
+        }
+        case CommandType::SetUniformMat4: {
+            const auto& c = CommandBuffer::as<cmd::SetUniformMat4>( header );
+            glUniformMatrix4fv( c.location, 1, GL_FALSE, c.value );
+            break;
+        }
+        case CommandType::SetUniformVec4: {
+            const auto& c = CommandBuffer::as<cmd::SetUniformVec4>( header );
+            glUniform4fv( c.location, 1, c.value );
+            break;
+        }
+        case CommandType::BindVertexBuffer:
+            bindVertexBuffer( CommandBuffer::as<cmd::BindVertexBuffer>( header ) );
+            break;
+        case CommandType::BindIndexBuffer: {
+            const auto& c = CommandBuffer::as<cmd::BindIndexBuffer>( header );
+            glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, c.buffer );
+            m_indexType = c.indexType;
+            break;
+        }
+        case CommandType::BindTexture: {
+            const auto& c = CommandBuffer::as<cmd::BindTexture>( header );
+            glActiveTexture( GL_TEXTURE0 + c.unit );
+            glBindTexture( c.target == TextureTarget::TextureCube ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D, c.texture );
+            break;
+        }
+        case CommandType::BindUniformBuffer: {
+            const auto& c = CommandBuffer::as<cmd::BindUniformBuffer>( header );
+            glBindBufferRange( GL_UNIFORM_BUFFER, c.binding, c.buffer, c.offset, c.size );
+            break;
+        }
+        case CommandType::UploadBuffer: {
+            const auto& c = CommandBuffer::as<cmd::UploadBuffer>( header );
+            const GLenum target = toGL( c.target );
+            glBindBuffer( target, c.buffer );
+            if ( c.orphan ) {
+                glBufferData( target, c.size, c.data, GL_STREAM_DRAW );
+            } else {
+                glBufferSubData( target, c.offset, c.size, c.data );
+            }
+            break;
+        }
+        case CommandType::UploadTexture: {
+            const auto& c = CommandBuffer::as<cmd::UploadTexture>( header );
+            const PixelFormatGL format = toGL( c.format );
+            // 借用单元 0 上传, 回放的绑定命令之后会重新设置
+            glActiveTexture( GL_TEXTURE0 );
+            glBindTexture( GL_TEXTURE_2D, c.texture );
+            glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+            glTexSubImage2D( GL_TEXTURE_2D, 0, c.x, c.y, c.width, c.height, format.format, format.type, c.data );
+            break;
+        }
+        case CommandType::BindImage: {
+            const auto& c = CommandBuffer::as<cmd::BindImage>( header );
+            glBindImageTexture( c.unit, c.texture, 0, GL_FALSE, 0, toGL( c.access ), toGL( c.format ).internalFormat );
+            break;
+        }
+        case CommandType::DispatchCompute: {
+            const auto& c = CommandBuffer::as<cmd::DispatchCompute>( header );
+            glDispatchCompute( c.groupsX, c.groupsY, c.groupsZ );
+            glMemoryBarrier( GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
+            break;
+        }
+        case CommandType::Draw: {
+            const auto& c = CommandBuffer::as<cmd::Draw>( header );
+            glDrawArrays( toGL( c.primitive ), static_cast<GLint>( c.first ), static_cast<GLsizei>( c.count ) );
+            break;
+        }
+        case CommandType::DrawIndexed: {
+            const auto& c = CommandBuffer::as<cmd::DrawIndexed>( header );
+            const bool wide = m_indexType == IndexType::UInt32;
+            const uintptr_t offset = uintptr_t( c.firstIndex ) * ( wide ? 4u : 2u );
+            glDrawElements( toGL( c.primitive ), static_cast<GLsizei>( c.count ),
+                            wide ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT,
+                            reinterpret_cast<const void*>( offset ) );
+            break;
+        }
+        }
+    }
+}
+
+void GLCommandReplayer::finish() {
+    for ( int location = 0; location < 32; ++location ) {
+        if ( m_enabledAttributes & ( 1u << location ) ) {
+            glDisableVertexAttribArray( location );
+        }
+    }
+    m_enabledAttributes = 0;
+
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    glBindVertexArray( 0 );
+    glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+    glUseProgram( 0 );
+    m_program = 0;
+
+    // 恢复成默认状态
+    applyRenderState( RenderState() );
+    glActiveTexture( GL_TEXTURE0 );
+    m_stateValid = false;
+}
+
+void GLCommandReplayer::applyRenderState( const RenderState& state ) {
+    if ( m_stateValid && state == m_state ) return;
+
+    auto toggle = [this]( GLenum cap, bool enable ) {
+        if ( enable ) glEnable( cap ); else glDisable( cap );
+    };
+
+    toggle( GL_DEPTH_TEST, state.depthTest );
+    glDepthMask( state.depthWrite ? GL_TRUE : GL_FALSE );
+    glDepthFunc( toGL( state.depthFunc ) );
+
+    toggle( GL_BLEND, state.blend );
+    if ( state.blend ) {
+        glBlendFunc( GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+    }
+
+    toggle( GL_CULL_FACE, state.cullBackFace );
+    if ( state.cullBackFace ) {
+        glCullFace( GL_BACK );
+    }
+
+    const GLboolean color = state.colorWrite ? GL_TRUE : GL_FALSE;
+    glColorMask( color, color, color, color );
+
+    m_state = state;
+    m_stateValid = true;
+}
+
+void GLCommandReplayer::bindVertexBuffer( const cmd::BindVertexBuffer& command ) {
+    glBindBuffer( GL_ARRAY_BUFFER, command.buffer );
+
+    uint32_t wanted = 0;
+    for ( uint32_t i = 0; i < command.attributeCount; ++i ) {
+        const VertexAttribute& attribute = command.attributes[i];
+        glVertexAttribPointer( attribute.location, attribute.components, GL_FLOAT, GL_FALSE,
+                               static_cast<GLsizei>( command.stride ),
+                               reinterpret_cast<const void*>( uintptr_t( attribute.offset ) ) );
+        wanted |= 1u << attribute.location;
+    }
+
+    // 只切换变化的启用位
+    const uint32_t changed = wanted ^ m_enabledAttributes;
+    for ( int location = 0; location < 32; ++location ) {
+        const uint32_t bit = 1u << location;
+        if ( !( changed & bit ) ) continue;
+        if ( wanted & bit ) glEnableVertexAttribArray( location );
+        else glDisableVertexAttribArray( location );
+    }
+    m_enabledAttributes = wanted;
+}
@@ -0,0 +1,36 @@
+// 单一职责: 在渲染线程把 CommandBuffer 翻译成 OpenGL 调用
+#pragma once
+
+#include "command_buffer.hpp"
+
+#include <QOpenGLExtraFunctions>
+
+// 使用 ExtraFunctions (GL 3.x / ES 3.0) 以支持 uniform buffer 的区间绑定
+class GLCommandReplayer : protected QOpenGLExtraFunctions {
+public:
+    GLCommandReplayer() = default;
+
+    // 需要在 GL 上下文当前的线程调用
+    void initialize();
+
+    // 回放一帧的命令, 可以连续回放多个 CommandBuffer (例如多个工作线程各自录制的一段)
+    void execute( const CommandBuffer& commands );
+
+    // 回放结束后恢复默认状态 避免影响 Qt Quick 场景图后续的渲染
+    void finish();
+
+    // 释放 GL 对象, 同样需要上下文当前
+    void cleanup();
+
+private:
+    void applyRenderState( const RenderState& state );
+    void bindVertexBuffer( const cmd::BindVertexBuffer& command );
+
+    bool m_initialized = false;
+    GLuint m_vertexArray = 0;               // core profile 下顶点属性必须记在 VAO 里, 回放期间绑定这一个
+    RenderState m_state;
+    bool m_stateValid = false;
+    RenderHandle m_program = 0;
+    uint32_t m_enabledAttributes = 0;      // 已启用的顶点属性位掩码
+    IndexType m_indexType = IndexType::UInt16;
+};
@@ -0,0 +1,136 @@
+#include "hdr_image.hpp"
+
+#include <QFile>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// 按行读取头部, 返回不含换行的一行, 越界时返回 false
+bool readLine( const QByteArray& data, int& position, std::string& line ) {
+    line.clear();
+    while ( position < data.size() ) {
+        const char c = data[position++];
+        if ( c == '\n' ) return true;
+        line.push_back( c );
+    }
+    return false;
+}
+
+void rgbeToFloat( const uint8_t* rgbe, float* out ) {
+    if ( rgbe[3] == 0 ) {
+        out[0] = out[1] = out[2] = 0.0f;
+        return;
+    }
+    // 尾数取区间中点, 与 Radiance 的参考实现一致
+    const float scale = std::ldexp( 1.0f, int( rgbe[3] ) - ( 128 + 8 ) );
+    out[0] = ( rgbe[0] + 0.5f ) * scale;
+    out[1] = ( rgbe[1] + 0.5f ) * scale;
+    out[2] = ( rgbe[2] + 0.5f ) * scale;
+}
+
+// 新式 RLE: 四个通道分别压缩, 计数 > 128 表示重复下一个字节 (计数 - 128) 次
+bool readRleScanline( const uint8_t*& p, const uint8_t* end, int width, std::vector<uint8_t>& scanline ) {
+    for ( int channel = 0; channel < 4; ++channel ) {
+        int x = 0;
+        while ( x < width ) {
+            if ( p >= end ) return false;
+            int count = *p++;
+            if ( count > 128 ) {
+                count -= 128;
+                if ( p >= end || x + count > width ) return false;
+                const uint8_t value = *p++;
+                for ( int i = 0; i < count; ++i ) scanline[( x++ ) * 4 + channel] = value;
+            } else {
+                if ( count == 0 || end - p < count || x + count > width ) return false;
+                for ( int i = 0; i < count; ++i ) scanline[( x++ ) * 4 + channel] = *p++;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool HdrLoader::load( const QString& path, HdrImage& image, std::string& error ) {
+    QFile file( path );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        error = "Cannot open HDR " + path.toStdString();
+        return false;
+    }
+    if ( !parse( file.readAll(), image, error ) ) {
+        error = path.toStdString() + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+bool HdrLoader::parse( const QByteArray& data, HdrImage& image, std::string& error ) {
+    int position = 0;
+    std::string line;
+    if ( !readLine( data, position, line ) || ( line.rfind( "#?RADIANCE", 0 ) != 0 && line.rfind( "#?RGBE", 0 ) != 0 ) ) {
+        error = "Not a Radiance HDR file";
+        return false;
+    }
+
+    // 头部以空行结束
+    while ( true ) {
+        if ( !readLine( data, position, line ) ) {
+            error = "Truncated header";
+            return false;
+        }
+        if ( line.empty() ) break;
+        if ( line.rfind( "FORMAT=", 0 ) == 0 && line != "FORMAT=32-bit_rle_rgbe" ) {
+            error = "Unsupported pixel format " + line;
+            return false;
+        }
+    }
+
+    if ( !readLine( data, position, line ) ) {
+        error = "Missing resolution line";
+        return false;
+    }
+    int width = 0;
+    int height = 0;
+    char ySign = 0, yAxis = 0, xSign = 0, xAxis = 0;
+    if ( std::sscanf( line.c_str(), "%c%c %d %c%c %d", &ySign, &yAxis, &height, &xSign, &xAxis, &width ) != 6
+         || ySign != '-' || yAxis != 'Y' || xSign != '+' || xAxis != 'X' || width <= 0 || height <= 0 ) {
+        error = "Unsupported orientation " + line;
+        return false;
+    }
+
+    image.width = width;
+    image.height = height;
+    image.rgb.assign( size_t( width ) * height * 3, 0.0f );
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>( data.constData() ) + position;
+    const uint8_t* end = reinterpret_cast<const uint8_t*>( data.constData() ) + data.size();
+    std::vector<uint8_t> scanline( size_t( width ) * 4 );
+
+    for ( int y = 0; y < height; ++y ) {
+        const bool rle = width >= 8 && width < 32768 && end - p >= 4
+                         && p[0] == 2 && p[1] == 2 && ( ( p[2] << 8 ) | p[3] ) == width && !( p[2] & 0x80 );
+        if ( rle ) {
+            p += 4;
+            if ( !readRleScanline( p, end, width, scanline ) ) {
+                error = "Corrupt RLE scanline " + std::to_string( y );
+                return false;
+            }
+        } else {
+            // 未压缩: 逐像素 RGBE
+            if ( end - p < ptrdiff_t( scanline.size() ) ) {
+                error = "Truncated scanline " + std::to_string( y );
+                return false;
+            }
+            std::memcpy( scanline.data(), p, scanline.size() );
+            p += scanline.size();
+        }
+
+        float* out = image.rgb.data() + size_t( y ) * width * 3;
+        for ( int x = 0; x < width; ++x ) {
+            rgbeToFloat( scanline.data() + x * 4, out + x * 3 );
+        }
+    }
+    return true;
+}
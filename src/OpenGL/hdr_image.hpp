@@ -0,0 +1,24 @@
+// 单一职责: 读取 Radiance HDR (.hdr / RGBE) 环境贴图, 输出线性浮点 RGB
+// 支持新式逐通道 RLE 和未压缩扫描线, 只支持标准的 "-Y h +X w" 方向
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <string>
+#include <vector>
+
+struct HdrImage {
+    int width = 0;
+    int height = 0;
+    std::vector<float> rgb;         // width * height * 3, 首行为顶部
+
+    bool isValid() const { return width > 0 && height > 0; }
+};
+
+class HdrLoader {
+public:
+    // path 可以是磁盘路径或 qrc 路径
+    static bool load( const QString& path, HdrImage& image, std::string& error );
+
+    static bool parse( const QByteArray& data, HdrImage& image, std::string& error );
+};
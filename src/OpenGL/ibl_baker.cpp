@@ -0,0 +1,596 @@
+#include "ibl_baker.hpp"
+#include "job_pool.hpp"
+#include "texture_importer.hpp"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+constexpr float kPi = 3.14159265358979323846f;
+
+// 缓存格式: 魔数 + 版本 + 尺寸 + SH + 立方体贴图 + LUT, 全部小端
+const char kMagic[4] = { 'I', 'B', 'L', 'C' };
+constexpr uint32_t kFormatVersion = 1;
+constexpr uint32_t kHeaderBytes = 4 + 4 * 4 + 27 * 4;
+
+// 改动烘焙算法时递增, 让旧缓存失效
+constexpr int kBakeVersion = 1;
+
+// 烘焙时使用的源立方体贴图, 每级 6 个面的浮点 RGB
+struct SourceCube {
+    uint32_t size = 0;
+    std::vector<std::vector<float>> levels;
+
+    uint32_t levelSize( size_t level ) const { return std::max( 1u, size >> level ); }
+};
+
+struct Vec3 {
+    float x, y, z;
+};
+
+Vec3 operator+( Vec3 a, Vec3 b ) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+Vec3 operator-( Vec3 a, Vec3 b ) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+Vec3 operator*( Vec3 a, float s ) { return { a.x * s, a.y * s, a.z * s }; }
+float dot( Vec3 a, Vec3 b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Vec3 cross( Vec3 a, Vec3 b ) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+Vec3 normalize( Vec3 v ) { return v * ( 1.0f / std::sqrt( dot( v, v ) ) ); }
+Vec3 mix( Vec3 a, Vec3 b, float t ) { return a * ( 1.0f - t ) + b * t; }
+
+// 纹素中心在面上的坐标 [-1, 1] → 方向, 与 GL 立方体贴图的面约定一致
+Vec3 texelDirection( uint32_t face, float u, float v ) {
+    switch ( face ) {
+    case 0: return { 1.0f, -v, -u };
+    case 1: return { -1.0f, -v, u };
+    case 2: return { u, 1.0f, v };
+    case 3: return { u, -1.0f, -v };
+    case 4: return { u, -v, 1.0f };
+    default: return { -u, -v, -1.0f };
+    }
+}
+
+// 方向 → 面和面内坐标 [0, 1]
+void faceCoordinates( Vec3 d, uint32_t& face, float& s, float& t ) {
+    const float ax = std::fabs( d.x );
+    const float ay = std::fabs( d.y );
+    const float az = std::fabs( d.z );
+    float ma, sc, tc;
+    if ( ax >= ay && ax >= az ) {
+        ma = ax;
+        face = d.x > 0.0f ? 0 : 1;
+        sc = d.x > 0.0f ? -d.z : d.z;
+        tc = -d.y;
+    } else if ( ay >= az ) {
+        ma = ay;
+        face = d.y > 0.0f ? 2 : 3;
+        sc = d.x;
+        tc = d.y > 0.0f ? d.z : -d.z;
+    } else {
+        ma = az;
+        face = d.z > 0.0f ? 4 : 5;
+        sc = d.z > 0.0f ? d.x : -d.x;
+        tc = -d.y;
+    }
+    s = 0.5f * ( sc / ma + 1.0f );
+    t = 0.5f * ( tc / ma + 1.0f );
+}
+
+Vec3 sampleLevel( const SourceCube& cube, size_t level, Vec3 direction ) {
+    uint32_t face;
+    float s, t;
+    faceCoordinates( direction, face, s, t );
+
+    // 面内双线性, 边缘夹取 (面之间的接缝在粗糙级别由多次采样平均掉)
+    const int size = int( cube.levelSize( level ) );
+    const float fx = std::min( std::max( s * size - 0.5f, 0.0f ), float( size - 1 ) );
+    const float fy = std::min( std::max( t * size - 0.5f, 0.0f ), float( size - 1 ) );
+    const int x0 = int( fx );
+    const int y0 = int( fy );
+    const int x1 = std::min( x0 + 1, size - 1 );
+    const int y1 = std::min( y0 + 1, size - 1 );
+    const float wx = fx - x0;
+    const float wy = fy - y0;
+
+    const float* base = cube.levels[level].data() + size_t( face ) * size * size * 3;
+    auto texel = [&]( int x, int y ) {
+        const float* p = base + ( size_t( y ) * size + x ) * 3;
+        return Vec3 { p[0], p[1], p[2] };
+    };
+    return mix( mix( texel( x0, y0 ), texel( x1, y0 ), wx ), mix( texel( x0, y1 ), texel( x1, y1 ), wx ), wy );
+}
+
+// 三线性采样, lod 超出范围时夹取
+Vec3 sampleCube( const SourceCube& cube, Vec3 direction, float lod ) {
+    const float maxLod = float( cube.levels.size() - 1 );
+    lod = std::min( std::max( lod, 0.0f ), maxLod );
+    const size_t level = size_t( lod );
+    const float fraction = lod - float( level );
+    const Vec3 a = sampleLevel( cube, level, direction );
+    if ( fraction <= 0.0f || level + 1 >= cube.levels.size() ) return a;
+    return mix( a, sampleLevel( cube, level + 1, direction ), fraction );
+}
+
+// 等距柱状投影, 水平方向环绕, 垂直方向夹取; -Z 方向在图像中央
+Vec3 sampleEquirect( const HdrImage& image, Vec3 d ) {
+    const float u = 0.5f + std::atan2( d.x, -d.z ) / ( 2.0f * kPi );
+    const float v = std::acos( std::min( std::max( d.y, -1.0f ), 1.0f ) ) / kPi;
+    const float fx = u * image.width - 0.5f;
+    const float fy = std::min( std::max( v * image.height - 0.5f, 0.0f ), float( image.height - 1 ) );
+    const int x0 = int( std::floor( fx ) );
+    const int y0 = int( fy );
+    const int y1 = std::min( y0 + 1, image.height - 1 );
+    const float wx = fx - std::floor( fx );
+    const float wy = fy - y0;
+
+    auto texel = [&]( int x, int y ) {
+        x = ( ( x % image.width ) + image.width ) % image.width;
+        const float* p = image.rgb.data() + ( size_t( y ) * image.width + x ) * 3;
+        return Vec3 { p[0], p[1], p[2] };
+    };
+    return mix( mix( texel( x0, y0 ), texel( x0 + 1, y0 ), wx ), mix( texel( x0, y1 ), texel( x0 + 1, y1 ), wx ), wy );
+}
+
+// 没有配置 HDR 时的天空: 天顶到地平线的渐变, 地面偏暗, 主光方向附近有一片柔和的亮区
+// 不放太阳圆盘, 直射光已经由着色器的主光负责; 整体亮度与原来的半球环境光相近
+Vec3 proceduralSky( Vec3 d ) {
+    const Vec3 zenith { 0.09f, 0.16f, 0.32f };
+    const Vec3 horizon { 0.38f, 0.40f, 0.43f };
+    const Vec3 ground { 0.06f, 0.055f, 0.05f };
+    const Vec3 sunDirection = normalize( { 0.4f, 0.8f, 0.6f } );
+
+    Vec3 color;
+    if ( d.y >= 0.0f ) {
+        color = mix( zenith, horizon, std::pow( 1.0f - d.y, 4.0f ) );
+    } else {
+        color = mix( horizon * 0.5f, ground, std::min( 1.0f, -d.y * 6.0f ) );
+    }
+    const float glow = std::max( dot( d, sunDirection ), 0.0f );
+    return color + Vec3 { 1.0f, 0.9f, 0.75f } * ( 0.75f * std::pow( glow, 32.0f ) );
+}
+
+// 源立方体贴图: 第 0 级 2x2 超采样, 之后逐级 2x2 平均
+SourceCube buildSourceCube( const std::function<Vec3( Vec3 )>& radiance, uint32_t size ) {
+    SourceCube cube;
+    cube.size = size;
+    cube.levels.emplace_back( size_t( 6 ) * size * size * 3 );
+
+    std::vector<float>& base = cube.levels[0];
+    JobPool::instance().parallelFor( 0, int( 6 * size ), 8, [&]( int begin, int end ) {
+        for ( int row = begin; row < end; ++row ) {
+            const uint32_t face = uint32_t( row ) / size;
+            const uint32_t y = uint32_t( row ) % size;
+            float* out = base.data() + ( size_t( face ) * size + y ) * size * 3;
+            for ( uint32_t x = 0; x < size; ++x ) {
+                Vec3 sum { 0.0f, 0.0f, 0.0f };
+                for ( int sy = 0; sy < 2; ++sy ) {
+                    for ( int sx = 0; sx < 2; ++sx ) {
+                        const float u = 2.0f * ( x + 0.25f + 0.5f * sx ) / size - 1.0f;
+                        const float v = 2.0f * ( y + 0.25f + 0.5f * sy ) / size - 1.0f;
+                        sum = sum + radiance( normalize( texelDirection( face, u, v ) ) );
+                    }
+                }
+                out[x * 3 + 0] = sum.x * 0.25f;
+                out[x * 3 + 1] = sum.y * 0.25f;
+                out[x * 3 + 2] = sum.z * 0.25f;
+            }
+        }
+    } );
+
+    for ( uint32_t previousSize = size; previousSize > 1; previousSize >>= 1 ) {
+        const uint32_t levelSize = previousSize >> 1;
+        const std::vector<float>& previous = cube.levels.back();
+        std::vector<float> level( size_t( 6 ) * levelSize * levelSize * 3 );
+        for ( uint32_t face = 0; face < 6; ++face ) {
+            const float* in = previous.data() + size_t( face ) * previousSize * previousSize * 3;
+            float* out = level.data() + size_t( face ) * levelSize * levelSize * 3;
+            for ( uint32_t y = 0; y < levelSize; ++y ) {
+                for ( uint32_t x = 0; x < levelSize; ++x ) {
+                    for ( int c = 0; c < 3; ++c ) {
+                        const size_t a = ( size_t( y * 2 ) * previousSize + x * 2 ) * 3 + c;
+                        const size_t b = a + size_t( previousSize ) * 3;
+                        out[( size_t( y ) * levelSize + x ) * 3 + c] = 0.25f * ( in[a] + in[a + 3] + in[b] + in[b + 3] );
+                    }
+                }
+            }
+        }
+        cube.levels.push_back( std::move( level ) );
+    }
+    return cube;
+}
+
+Vec3 hammersley( uint32_t i, uint32_t count ) {
+    uint32_t bits = i;
+    bits = ( bits << 16u ) | ( bits >> 16u );
+    bits = ( ( bits & 0x55555555u ) << 1u ) | ( ( bits & 0xAAAAAAAAu ) >> 1u );
+    bits = ( ( bits & 0x33333333u ) << 2u ) | ( ( bits & 0xCCCCCCCCu ) >> 2u );
+    bits = ( ( bits & 0x0F0F0F0Fu ) << 4u ) | ( ( bits & 0xF0F0F0F0u ) >> 4u );
+    bits = ( ( bits & 0x00FF00FFu ) << 8u ) | ( ( bits & 0xFF00FF00u ) >> 8u );
+    return { float( i ) / float( count ), float( bits ) * 2.3283064365386963e-10f, 0.0f };
+}
+
+// GGX 法线分布的重要性采样, 返回切线空间 (N = +Z) 的半角向量
+Vec3 importanceSampleGgx( Vec3 xi, float alpha ) {
+    const float phi = 2.0f * kPi * xi.x;
+    const float cosTheta = std::sqrt( ( 1.0f - xi.y ) / ( 1.0f + ( alpha * alpha - 1.0f ) * xi.y ) );
+    const float sinTheta = std::sqrt( std::max( 0.0f, 1.0f - cosTheta * cosTheta ) );
+    return { sinTheta * std::cos( phi ), sinTheta * std::sin( phi ), cosTheta };
+}
+
+float distributionGgx( float NdotH, float alpha ) {
+    const float a2 = alpha * alpha;
+    const float d = NdotH * NdotH * ( a2 - 1.0f ) + 1.0f;
+    return a2 / ( kPi * d * d );
+}
+
+// 与 pbr.frag.glsl 中的 visibilitySmithGGX 相同
+float visibilitySmithGgx( float NdotV, float NdotL, float alpha ) {
+    const float a2 = alpha * alpha;
+    const float ggxV = NdotL * std::sqrt( NdotV * NdotV * ( 1.0f - a2 ) + a2 );
+    const float ggxL = NdotV * std::sqrt( NdotL * NdotL * ( 1.0f - a2 ) + a2 );
+    const float sum = ggxV + ggxL;
+    return sum > 0.0f ? 0.5f / sum : 0.0f;
+}
+
+// 预滤波一级: 假设 N = V = R, 用 GGX 重要性采样对入射光积分
+// 按样本的立体角在源立方体贴图上选 mip (filtered importance sampling), 少量样本也没有亮斑
+void prefilterLevel( const SourceCube& source, float roughness, uint32_t size, uint32_t samples, float* out ) {
+    const float alpha = roughness * roughness;
+    const float texelSolidAngle = 4.0f * kPi / ( 6.0f * float( source.size ) * float( source.size ) );
+
+    // 所有纹素共享的样本 (切线空间), 只有基底随纹素变化
+    struct Sample {
+        Vec3 direction;     // 切线空间的 L
+        float NdotL;
+        float lod;
+    };
+    std::vector<Sample> table;
+    table.reserve( samples );
+    for ( uint32_t i = 0; i < samples; ++i ) {
+        const Vec3 H = importanceSampleGgx( hammersley( i, samples ), alpha );
+        // L = 2 (V·H) H - V, V = N = +Z
+        const Vec3 reflected { 2.0f * H.z * H.x, 2.0f * H.z * H.y, 2.0f * H.z * H.z - 1.0f };
+        if ( reflected.z <= 0.0f ) continue;
+        // V = N 时 pdf = D · (N·H) / (4 V·H) = D / 4
+        const float pdf = distributionGgx( H.z, alpha ) * 0.25f;
+        const float sampleSolidAngle = 1.0f / ( float( samples ) * pdf + 1e-4f );
+        const float lod = roughness == 0.0f ? 0.0f : 0.5f * std::log2( sampleSolidAngle / texelSolidAngle ) + 1.0f;
+        table.push_back( { reflected, reflected.z, std::max( lod, 0.0f ) } );
+    }
+
+    JobPool::instance().parallelFor( 0, int( 6 * size ), 4, [&]( int begin, int end ) {
+        for ( int row = begin; row < end; ++row ) {
+            const uint32_t face = uint32_t( row ) / size;
+            const uint32_t y = uint32_t( row ) % size;
+            float* line = out + ( size_t( face ) * size + y ) * size * 4;
+            for ( uint32_t x = 0; x < size; ++x ) {
+                const float u = 2.0f * ( x + 0.5f ) / size - 1.0f;
+                const float v = 2.0f * ( y + 0.5f ) / size - 1.0f;
+                const Vec3 N = normalize( texelDirection( face, u, v ) );
+                const Vec3 up = std::fabs( N.z ) < 0.999f ? Vec3 { 0.0f, 0.0f, 1.0f } : Vec3 { 1.0f, 0.0f, 0.0f };
+                const Vec3 T = normalize( cross( up, N ) );
+                const Vec3 B = cross( N, T );
+
+                Vec3 sum { 0.0f, 0.0f, 0.0f };
+                float weight = 0.0f;
+                for ( const Sample& sample : table ) {
+                    const Vec3 L = T * sample.direction.x + B * sample.direction.y + N * sample.direction.z;
+                    sum = sum + sampleCube( source, L, sample.lod ) * sample.NdotL;
+                    weight += sample.NdotL;
+                }
+                const Vec3 color = weight > 0.0f ? sum * ( 1.0f / weight ) : sampleCube( source, N, 0.0f );
+                line[x * 4 + 0] = color.x;
+                line[x * 4 + 1] = color.y;
+                line[x * 4 + 2] = color.z;
+                line[x * 4 + 3] = 1.0f;
+            }
+        }
+    } );
+}
+
+// 9 个实球谐基函数在方向 d 上的值
+void shBasis( Vec3 d, float* y ) {
+    y[0] = 0.282095f;
+    y[1] = 0.488603f * d.y;
+    y[2] = 0.488603f * d.z;
+    y[3] = 0.488603f * d.x;
+    y[4] = 1.092548f * d.x * d.y;
+    y[5] = 1.092548f * d.y * d.z;
+    y[6] = 0.315392f * ( 3.0f * d.z * d.z - 1.0f );
+    y[7] = 1.092548f * d.x * d.z;
+    y[8] = 0.546274f * ( d.x * d.x - d.y * d.y );
+}
+
+// 按纹素立体角把第 0 级投影到 SH9, 再与余弦核卷积 (A0 = π, A1 = 2π/3, A2 = π/4) 并除以 π
+void projectIrradiance( const SourceCube& cube, float sh[9][3] ) {
+    const uint32_t size = cube.size;
+    double partial[6][9][3] = {};
+    JobPool::instance().parallelFor( 0, 6, 1, [&]( int begin, int end ) {
+        for ( int face = begin; face < end; ++face ) {
+            const float* texels = cube.levels[0].data() + size_t( face ) * size * size * 3;
+            for ( uint32_t y = 0; y < size; ++y ) {
+                for ( uint32_t x = 0; x < size; ++x ) {
+                    const float u = 2.0f * ( x + 0.5f ) / size - 1.0f;
+                    const float v = 2.0f * ( y + 0.5f ) / size - 1.0f;
+                    const float r2 = 1.0f + u * u + v * v;
+                    const float solidAngle = 4.0f / ( float( size ) * float( size ) * r2 * std::sqrt( r2 ) );
+                    float basis[9];
+                    shBasis( normalize( texelDirection( uint32_t( face ), u, v ) ), basis );
+                    const float* p = texels + ( size_t( y ) * size + x ) * 3;
+                    for ( int i = 0; i < 9; ++i ) {
+                        const double w = double( basis[i] ) * solidAngle;
+                        partial[face][i][0] += w * p[0];
+                        partial[face][i][1] += w * p[1];
+                        partial[face][i][2] += w * p[2];
+                    }
+                }
+            }
+        }
+    } );
+
+    const float band[9] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+    for ( int i = 0; i < 9; ++i ) {
+        for ( int c = 0; c < 3; ++c ) {
+            double sum = 0.0;
+            for ( int face = 0; face < 6; ++face ) sum += partial[face][i][c];
+            sh[i][c] = float( sum ) * band[i];
+        }
+    }
+}
+
+// 分离求和 LUT: x = NdotV, y = 粗糙度, 输出 (F0 的系数, 偏移)
+void integrateBrdf( uint32_t size, uint32_t samples, float* out ) {
+    JobPool::instance().parallelFor( 0, int( size ), 8, [&]( int begin, int end ) {
+        for ( int y = begin; y < end; ++y ) {
+            const float roughness = ( y + 0.5f ) / size;
+            const float alpha = roughness * roughness;
+            for ( uint32_t x = 0; x < size; ++x ) {
+                const float NdotV = ( x + 0.5f ) / size;
+                const Vec3 V { std::sqrt( 1.0f - NdotV * NdotV ), 0.0f, NdotV };
+                float a = 0.0f;
+                float b = 0.0f;
+                for ( uint32_t i = 0; i < samples; ++i ) {
+                    const Vec3 H = importanceSampleGgx( hammersley( i, samples ), alpha );
+                    const float VdotH = dot( V, H );
+                    const Vec3 L = H * ( 2.0f * VdotH ) - V;
+                    const float NdotL = L.z;
+                    if ( NdotL <= 0.0f || VdotH <= 0.0f ) continue;
+                    // 样本权重 = BRDF · NdotL / pdf, pdf = D · NdotH / (4 VdotH), D 约掉
+                    const float w = visibilitySmithGgx( NdotV, NdotL, alpha ) * 4.0f * NdotL * VdotH / H.z;
+                    const float fc = std::pow( 1.0f - VdotH, 5.0f );
+                    a += ( 1.0f - fc ) * w;
+                    b += fc * w;
+                }
+                out[( size_t( y ) * size + x ) * 2 + 0] = a / samples;
+                out[( size_t( y ) * size + x ) * 2 + 1] = b / samples;
+            }
+        }
+    } );
+}
+
+// float → IEEE 半精度, 就近舍入, 超出范围的值夹到最大有限值 (HDR 高光不变成无穷大)
+uint16_t toHalf( float value ) {
+    uint32_t bits;
+    std::memcpy( &bits, &value, 4 );
+    const uint32_t sign = ( bits >> 16 ) & 0x8000u;
+    const uint32_t magnitude = bits & 0x7FFFFFFFu;
+    if ( magnitude > 0x7F800000u ) return uint16_t( sign | 0x7E00u );
+    if ( magnitude >= 0x477FF000u ) return uint16_t( sign | 0x7BFFu );
+    if ( magnitude < 0x38800000u ) {
+        // 非规格化数
+        if ( magnitude < 0x33000000u ) return uint16_t( sign );
+        const uint32_t exponent = magnitude >> 23;
+        const uint32_t mantissa = ( magnitude & 0x7FFFFFu ) | 0x800000u;
+        const uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        if ( ( mantissa >> ( shift - 1 ) ) & 1u ) ++half;
+        return uint16_t( sign | half );
+    }
+    uint32_t half = ( ( magnitude >> 13 ) - ( 112u << 10 ) );
+    if ( magnitude & 0x1000u ) ++half;
+    return uint16_t( sign | half );
+}
+
+void put32( QByteArray& out, uint32_t value ) {
+    const char bytes[4] = { char( value & 0xFF ), char( ( value >> 8 ) & 0xFF ),
+                            char( ( value >> 16 ) & 0xFF ), char( value >> 24 ) };
+    out.append( bytes, 4 );
+}
+
+uint32_t get32( const uint8_t* p ) {
+    return uint32_t( p[0] ) | ( uint32_t( p[1] ) << 8 ) | ( uint32_t( p[2] ) << 16 ) | ( uint32_t( p[3] ) << 24 );
+}
+
+size_t cubeElements( uint32_t size, uint32_t levels ) {
+    size_t count = 0;
+    for ( uint32_t level = 0; level < levels; ++level ) {
+        const size_t s = std::max( 1u, size >> level );
+        count += 6 * s * s * 4;
+    }
+    return count;
+}
+
+QString cacheKey( const QString& environmentPath, const IblSettings& settings ) {
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    hash.addData( QByteArray::number( kBakeVersion ) );
+    for ( uint32_t value : { settings.cubeSize, settings.cubeLevels, settings.specularSamples,
+                             settings.lutSize, settings.lutSamples } ) {
+        hash.addData( QByteArray::number( value ) );
+    }
+    if ( environmentPath.isEmpty() ) {
+        hash.addData( "procedural-sky" );
+    } else {
+        // 与纹理缓存相同, 用路径 + 大小 + 修改时间代替内容哈希, 命中时不必读 HDR
+        const QFileInfo info( environmentPath );
+        hash.addData( environmentPath.toUtf8() );
+        hash.addData( QByteArray::number( info.size() ) );
+        hash.addData( QByteArray::number( info.lastModified().toMSecsSinceEpoch() ) );
+    }
+    return QString::fromLatin1( hash.result().toHex() );
+}
+
+} // namespace
+
+size_t IblData::faceOffset( uint32_t level, uint32_t face ) const {
+    const size_t s = levelSize( level );
+    return cubeElements( cubeSize, level ) + size_t( face ) * s * s * 4;
+}
+
+IblData IblBaker::bake( const HdrImage* source, const IblSettings& settings ) {
+    std::function<Vec3( Vec3 )> radiance = proceduralSky;
+    if ( source && source->isValid() ) {
+        radiance = [source]( Vec3 d ) { return sampleEquirect( *source, d ); };
+    }
+
+    const SourceCube cube = buildSourceCube( radiance, settings.cubeSize );
+
+    IblData data;
+    data.cubeSize = settings.cubeSize;
+    data.cubeLevels = std::max( 1u, std::min<uint32_t>( settings.cubeLevels, uint32_t( cube.levels.size() ) ) );
+    data.lutSize = settings.lutSize;
+    projectIrradiance( cube, data.sh );
+
+    data.cube.resize( cubeElements( data.cubeSize, data.cubeLevels ) );
+    std::vector<float> level;
+    for ( uint32_t m = 0; m < data.cubeLevels; ++m ) {
+        const uint32_t size = data.levelSize( m );
+        level.assign( size_t( 6 ) * size * size * 4, 0.0f );
+        const float roughness = data.cubeLevels > 1 ? float( m ) / float( data.cubeLevels - 1 ) : 0.0f;
+        if ( m == 0 ) {
+            // 粗糙度 0 就是镜面反射, 直接用源数据
+            const std::vector<float>& texels = cube.levels[0];
+            for ( size_t i = 0; i < texels.size() / 3; ++i ) {
+                level[i * 4 + 0] = texels[i * 3 + 0];
+                level[i * 4 + 1] = texels[i * 3 + 1];
+                level[i * 4 + 2] = texels[i * 3 + 2];
+                level[i * 4 + 3] = 1.0f;
+            }
+        } else {
+            prefilterLevel( cube, roughness, size, settings.specularSamples, level.data() );
+        }
+        uint16_t* out = data.cube.data() + data.faceOffset( m, 0 );
+        for ( size_t i = 0; i < level.size(); ++i ) out[i] = toHalf( level[i] );
+    }
+
+    std::vector<float> lut( size_t( settings.lutSize ) * settings.lutSize * 2 );
+    integrateBrdf( settings.lutSize, settings.lutSamples, lut.data() );
+    data.lut.resize( lut.size() );
+    for ( size_t i = 0; i < lut.size(); ++i ) data.lut[i] = toHalf( lut[i] );
+    return data;
+}
+
+bool IblBaker::loadOrBake( const QString& environmentPath, IblData& data, std::string& error ) {
+    const IblSettings settings;
+    const QString directory = TextureImporter::cacheDirectory();
+    const QString path = directory + "/ibl-" + cacheKey( environmentPath, settings ) + ".bin";
+
+    std::string cacheError;
+    QFile cached( path );
+    if ( cached.open( QIODevice::ReadOnly ) ) {
+        if ( parse( cached.readAll(), data, cacheError ) ) return true;
+        qDebug() << "IBL cache entry rejected:" << QString::fromStdString( cacheError );
+    }
+
+    HdrImage image;
+    if ( !environmentPath.isEmpty() && !HdrLoader::load( environmentPath, image, error ) ) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    data = bake( environmentPath.isEmpty() ? nullptr : &image, settings );
+    qDebug() << "IBL baked" << ( environmentPath.isEmpty() ? QString( "procedural sky" ) : environmentPath )
+             << "in" << timer.elapsed() << "ms";
+
+    // 写缓存失败只影响下次启动的速度
+    QSaveFile file( path );
+    if ( !QDir().mkpath( directory ) || !file.open( QIODevice::WriteOnly )
+         || file.write( serialize( data ) ) < 0 || !file.commit() ) {
+        qDebug() << "IBL cache write failed:" << path;
+    }
+    return true;
+}
+
+QByteArray IblBaker::serialize( const IblData& data ) {
+    QByteArray out;
+    out.reserve( int( kHeaderBytes + ( data.cube.size() + data.lut.size() ) * 2 ) );
+    out.append( kMagic, 4 );
+    put32( out, kFormatVersion );
+    put32( out, data.cubeSize );
+    put32( out, data.cubeLevels );
+    put32( out, data.lutSize );
+    for ( int i = 0; i < 9; ++i ) {
+        for ( int c = 0; c < 3; ++c ) {
+            uint32_t bits;
+            std::memcpy( &bits, &data.sh[i][c], 4 );
+            put32( out, bits );
+        }
+    }
+    // 半精度数据按小端原样写入
+    for ( uint16_t value : data.cube ) {
+        const char bytes[2] = { char( value & 0xFF ), char( value >> 8 ) };
+        out.append( bytes, 2 );
+    }
+    for ( uint16_t value : data.lut ) {
+        const char bytes[2] = { char( value & 0xFF ), char( value >> 8 ) };
+        out.append( bytes, 2 );
+    }
+    return out;
+}
+
+bool IblBaker::parse( const QByteArray& bytes, IblData& data, std::string& error ) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>( bytes.constData() );
+    if ( size_t( bytes.size() ) < kHeaderBytes || std::memcmp( p, kMagic, 4 ) != 0 ) {
+        error = "Not an IBL cache file";
+        return false;
+    }
+    if ( get32( p + 4 ) != kFormatVersion ) {
+        error = "Unsupported IBL cache version";
+        return false;
+    }
+
+    const uint32_t cubeSize = get32( p + 8 );
+    const uint32_t cubeLevels = get32( p + 12 );
+    const uint32_t lutSize = get32( p + 16 );
+    if ( cubeSize == 0 || cubeSize > 4096 || cubeLevels == 0 || cubeLevels > 13 || lutSize == 0 || lutSize > 1024 ) {
+        error = "Corrupt IBL cache header";
+        return false;
+    }
+    const size_t cubeCount = cubeElements( cubeSize, cubeLevels );
+    const size_t lutCount = size_t( lutSize ) * lutSize * 2;
+    if ( size_t( bytes.size() ) != kHeaderBytes + ( cubeCount + lutCount ) * 2 ) {
+        error = "Truncated IBL cache";
+        return false;
+    }
+
+    data.cubeSize = cubeSize;
+    data.cubeLevels = cubeLevels;
+    data.lutSize = lutSize;
+    for ( int i = 0; i < 9; ++i ) {
+        for ( int c = 0; c < 3; ++c ) {
+            const uint32_t bits = get32( p + 20 + ( i * 3 + c ) * 4 );
+            std::memcpy( &data.sh[i][c], &bits, 4 );
+        }
+    }
+
+    const uint8_t* payload = p + kHeaderBytes;
+    data.cube.resize( cubeCount );
+    data.lut.resize( lutCount );
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    std::memcpy( data.cube.data(), payload, cubeCount * 2 );
+    std::memcpy( data.lut.data(), payload + cubeCount * 2, lutCount * 2 );
+#else
+    for ( size_t i = 0; i < cubeCount; ++i ) data.cube[i] = uint16_t( payload[i * 2] | ( payload[i * 2 + 1] << 8 ) );
+    payload += cubeCount * 2;
+    for ( size_t i = 0; i < lutCount; ++i ) data.lut[i] = uint16_t( payload[i * 2] | ( payload[i * 2 + 1] << 8 ) );
+#endif
+    return true;
+}
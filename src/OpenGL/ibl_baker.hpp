@@ -0,0 +1,50 @@
+// 单一职责: 基于图像的光照 (IBL) 预计算, 全部在 CPU 上按 JobPool 并行完成
+//   漫反射: 环境光投影到 SH9 并与余弦核卷积, 着色器只需要 9 个系数
+//   镜面反射: GGX 重要性采样预滤波的立方体贴图, 粗糙度 0 → 1 均匀分布到各级 mip
+//   BRDF LUT: 分离求和近似的 (scale, bias), 与着色器使用同一个高度相关 Smith 可见性项
+// 结果按输入缓存到磁盘, 启动时命中缓存只需读文件, 不做任何计算
+#pragma once
+
+#include "hdr_image.hpp"
+
+#include <QByteArray>
+#include <QString>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct IblSettings {
+    uint32_t cubeSize = 128;            // 预滤波立方体贴图第 0 级的边长
+    uint32_t cubeLevels = 6;            // 级数, 第 0 级为镜面反射, 最后一级粗糙度为 1
+    uint32_t specularSamples = 128;     // 预滤波每个纹素的采样数
+    uint32_t lutSize = 128;
+    uint32_t lutSamples = 256;
+};
+
+struct IblData {
+    float sh[9][3] = {};                // 辐照度 SH9 系数, 已卷积余弦核并除以 π, 乘漫反射颜色即可
+    uint32_t cubeSize = 0;
+    uint32_t cubeLevels = 0;
+    std::vector<uint16_t> cube;         // 半精度 RGBA, 按 级 → 面 (+X -X +Y -Y +Z -Z) → 行 排列
+    uint32_t lutSize = 0;
+    std::vector<uint16_t> lut;          // 半精度 RG, 横轴 NdotV 纵轴粗糙度
+
+    bool isValid() const { return cubeSize > 0 && cubeLevels > 0 && lutSize > 0 && !cube.empty() && !lut.empty(); }
+    uint32_t levelSize( uint32_t level ) const { return cubeSize >> level > 0 ? cubeSize >> level : 1; }
+
+    // 某一级某个面在 cube 中的起始位置 (以 uint16_t 为单位)
+    size_t faceOffset( uint32_t level, uint32_t face ) const;
+};
+
+class IblBaker {
+public:
+    // source 为空时使用程序生成的天空, 天空的亮区与 PBR 着色器的主光方向一致
+    static IblData bake( const HdrImage* source, const IblSettings& settings = IblSettings() );
+
+    // 先读缓存, 未命中时烘焙并写缓存; environmentPath 为空表示程序生成的天空
+    // 较慢 (首次烘焙约数百毫秒), 应在工作线程调用
+    static bool loadOrBake( const QString& environmentPath, IblData& data, std::string& error );
+
+    static QByteArray serialize( const IblData& data );
+    static bool parse( const QByteArray& bytes, IblData& data, std::string& error );
+};
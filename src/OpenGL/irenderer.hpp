@@ -8,6 +8,8 @@
 // 前向声明
 class RenderContext;
 class RenderConfig;
+class CommandBuffer;
+struct SubmissionStats;
 
 enum class RenderError {
     None = 0,
@@ -30,6 +32,25 @@ public:
     
     // 执行渲染
     virtual bool render(const RenderContext& context) = 0;
+
+    // 每帧录制之前在渲染线程调用 (上下文为当前), 可以调用GL函数, 例如流送纹理
+    virtual void prepareFrame() {}
+
+    // 是否支持命令录制; 支持的渲染器由 record() 代替 render()
+    virtual bool supportsRecording() const { return false; }
+
+    // 录制一帧的渲染命令 不允许调用任何GL函数 (可能在工作线程中执行)
+    virtual bool record(const RenderContext& context, CommandBuffer& commands) {
+        (void)context;
+        (void)commands;
+        return false;
+    }
+
+    // 最近一次 record() 的提交统计 (排序前后的状态切换次数), 不支持时返回 false
+    virtual bool submissionStats(SubmissionStats& stats) const {
+        (void)stats;
+        return false;
+    }
     
     // 调整视口大小
     virtual bool resize(int width, int height) = 0;
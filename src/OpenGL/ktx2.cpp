@@ -0,0 +1,232 @@
+#include "ktx2.hpp"
+
+#include <QFile>
+#include <QSaveFile>
+#include <cstring>
+
+namespace {
+
+const uint8_t kIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// 文件头 12 字节标识 + 9 个 uint32 + 索引 (4 个 uint32 + 2 个 uint64)
+constexpr uint32_t kHeaderBytes = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+constexpr uint32_t kLevelIndexBytes = 3 * 8;
+
+// Khronos Data Format 枚举
+constexpr uint32_t kModelRGBSDA = 1;
+constexpr uint32_t kModelBC1A = 128;
+constexpr uint32_t kModelBC4 = 131;
+constexpr uint32_t kModelETC2 = 161;
+constexpr uint32_t kPrimariesBT709 = 1;
+constexpr uint32_t kTransferLinear = 1;
+constexpr uint32_t kTransferSRGB = 2;
+constexpr uint32_t kQualifierLinear = 0x10;
+
+void put32( QByteArray& out, uint32_t value ) {
+    const char bytes[4] = { char( value & 0xFF ), char( ( value >> 8 ) & 0xFF ),
+                            char( ( value >> 16 ) & 0xFF ), char( value >> 24 ) };
+    out.append( bytes, 4 );
+}
+
+void put64( QByteArray& out, uint64_t value ) {
+    put32( out, uint32_t( value & 0xFFFFFFFFu ) );
+    put32( out, uint32_t( value >> 32 ) );
+}
+
+uint32_t get32( const uint8_t* p ) {
+    return uint32_t( p[0] ) | ( uint32_t( p[1] ) << 8 ) | ( uint32_t( p[2] ) << 16 ) | ( uint32_t( p[3] ) << 24 );
+}
+
+uint64_t get64( const uint8_t* p ) {
+    return uint64_t( get32( p ) ) | ( uint64_t( get32( p + 4 ) ) << 32 );
+}
+
+struct DfdSample {
+    uint32_t bitOffset;
+    uint32_t bitLength;
+    uint32_t channel;       // 通道 ID | 限定位
+    uint32_t lower;
+    uint32_t upper;
+};
+
+// 基本数据格式描述块 (含前面的 dfdTotalSize)
+QByteArray makeDfd( TextureFormat format ) {
+    const bool compressed = TextureFormats::isCompressed( format );
+    const bool srgb = TextureFormats::isSrgb( format );
+
+    uint32_t model = kModelRGBSDA;
+    std::vector<DfdSample> samples;
+    switch ( format ) {
+    case TextureFormat::RGBA8:
+    case TextureFormat::RGBA8_SRGB:
+        samples = { { 0, 8, 0, 0, 255 }, { 8, 8, 1, 0, 255 }, { 16, 8, 2, 0, 255 },
+                    { 24, 8, 15u | ( srgb ? kQualifierLinear : 0u ), 0, 255 } };
+        break;
+    case TextureFormat::BC1_RGB:
+    case TextureFormat::BC1_RGB_SRGB:
+        model = kModelBC1A;
+        samples = { { 0, 64, 0, 0, 0xFFFFFFFFu } };    // BC1A_COLOR
+        break;
+    case TextureFormat::BC4_R:
+        model = kModelBC4;
+        samples = { { 0, 64, 0, 0, 0xFFFFFFFFu } };    // BC4_DATA
+        break;
+    case TextureFormat::ETC2_RGB8:
+    case TextureFormat::ETC2_RGB8_SRGB:
+        model = kModelETC2;
+        samples = { { 0, 64, 2, 0, 0xFFFFFFFFu } };    // ETC2_COLOR
+        break;
+    case TextureFormat::EAC_R11:
+        model = kModelETC2;
+        samples = { { 0, 64, 0, 0, 0xFFFFFFFFu } };    // ETC2_RED
+        break;
+    }
+
+    const uint32_t blockSize = 24 + 16 * uint32_t( samples.size() );
+    QByteArray dfd;
+    put32( dfd, 4 + blockSize );                                        // dfdTotalSize
+    put32( dfd, 0 );                                                    // vendorId = Khronos, descriptorType = basic
+    put32( dfd, 2u | ( blockSize << 16 ) );                             // versionNumber = 2
+    put32( dfd, model | ( kPrimariesBT709 << 8 ) | ( ( srgb ? kTransferSRGB : kTransferLinear ) << 16 ) );
+    put32( dfd, compressed ? ( 3u | ( 3u << 8 ) ) : 0u );               // 块尺寸 - 1: 4x4x1x1 或 1x1x1x1
+    put32( dfd, TextureFormats::blockBytes( format ) );                 // bytesPlane0
+    put32( dfd, 0 );
+    for ( const DfdSample& sample : samples ) {
+        put32( dfd, sample.bitOffset | ( ( sample.bitLength - 1 ) << 16 ) | ( sample.channel << 24 ) );
+        put32( dfd, 0 );                                                // samplePosition
+        put32( dfd, sample.lower );
+        put32( dfd, sample.upper );
+    }
+    return dfd;
+}
+
+uint32_t alignUp( uint32_t value, uint32_t alignment ) {
+    return ( value + alignment - 1 ) / alignment * alignment;
+}
+
+} // namespace
+
+QByteArray Ktx2::serialize( const Ktx2Texture& texture ) {
+    const uint32_t levelCount = static_cast<uint32_t>( texture.levels.size() );
+    const QByteArray dfd = makeDfd( texture.format );
+    // 每级数据按 lcm(块大小, 4) 对齐, 这里块大小只有 4 或 8
+    const uint32_t alignment = TextureFormats::blockBytes( texture.format ) == 8 ? 8 : 4;
+
+    const uint32_t dfdOffset = kHeaderBytes + kLevelIndexBytes * levelCount;
+    uint32_t offset = alignUp( dfdOffset + uint32_t( dfd.size() ), alignment );
+
+    // 数据区按 mip 从小到大排列, 读取前几个字节就能拿到最粗的几级
+    std::vector<uint64_t> levelOffsets( levelCount );
+    for ( uint32_t i = levelCount; i-- > 0; ) {
+        levelOffsets[i] = offset;
+        offset = alignUp( offset + uint32_t( texture.levels[i].size() ), alignment );
+    }
+
+    QByteArray out;
+    out.reserve( int( offset ) );
+    out.append( reinterpret_cast<const char*>( kIdentifier ), sizeof( kIdentifier ) );
+    put32( out, TextureFormats::vkFormat( texture.format ) );
+    put32( out, 1 );                        // typeSize
+    put32( out, texture.width );
+    put32( out, texture.height );
+    put32( out, 0 );                        // pixelDepth
+    put32( out, 0 );                        // layerCount
+    put32( out, 1 );                        // faceCount
+    put32( out, levelCount );
+    put32( out, 0 );                        // supercompressionScheme
+    put32( out, dfdOffset );
+    put32( out, uint32_t( dfd.size() ) );
+    put32( out, 0 );                        // kvdByteOffset
+    put32( out, 0 );                        // kvdByteLength
+    put64( out, 0 );                        // sgdByteOffset
+    put64( out, 0 );                        // sgdByteLength
+
+    for ( uint32_t i = 0; i < levelCount; ++i ) {
+        put64( out, levelOffsets[i] );
+        put64( out, texture.levels[i].size() );
+        put64( out, texture.levels[i].size() );
+    }
+    out.append( dfd );
+
+    for ( uint32_t i = levelCount; i-- > 0; ) {
+        out.append( QByteArray( int( levelOffsets[i] - uint64_t( out.size() ) ), '\0' ) );
+        out.append( reinterpret_cast<const char*>( texture.levels[i].data() ), int( texture.levels[i].size() ) );
+    }
+    return out;
+}
+
+bool Ktx2::parse( const QByteArray& data, Ktx2Texture& texture, std::string& error ) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>( data.constData() );
+    const uint64_t size = uint64_t( data.size() );
+
+    if ( size < kHeaderBytes || std::memcmp( p, kIdentifier, sizeof( kIdentifier ) ) != 0 ) {
+        error = "Not a KTX2 file";
+        return false;
+    }
+
+    const uint32_t vkFormat = get32( p + 12 );
+    const uint32_t width = get32( p + 20 );
+    const uint32_t height = get32( p + 24 );
+    const uint32_t depth = get32( p + 28 );
+    const uint32_t layers = get32( p + 32 );
+    const uint32_t faces = get32( p + 36 );
+    const uint32_t levelCount = qMax( 1u, get32( p + 40 ) );
+    const uint32_t supercompression = get32( p + 44 );
+
+    if ( !TextureFormats::fromVkFormat( vkFormat, texture.format ) ) {
+        error = "Unsupported KTX2 vkFormat " + std::to_string( vkFormat );
+        return false;
+    }
+    if ( depth != 0 || layers > 1 || faces != 1 || supercompression != 0 ) {
+        error = "Only uncompressed single 2D KTX2 textures are supported";
+        return false;
+    }
+    if ( width == 0 || height == 0 || levelCount > TextureFormats::mipCount( width, height ) ) {
+        error = "Invalid KTX2 dimensions";
+        return false;
+    }
+    if ( size < kHeaderBytes + uint64_t( kLevelIndexBytes ) * levelCount ) {
+        error = "Truncated KTX2 level index";
+        return false;
+    }
+
+    texture.width = width;
+    texture.height = height;
+    texture.levels.assign( levelCount, {} );
+    for ( uint32_t i = 0; i < levelCount; ++i ) {
+        const uint8_t* entry = p + kHeaderBytes + kLevelIndexBytes * i;
+        const uint64_t offset = get64( entry );
+        const uint64_t length = get64( entry + 8 );
+        const uint32_t expected = TextureFormats::levelBytes( texture.format, texture.levelWidth( i ), texture.levelHeight( i ) );
+        if ( length != expected || offset > size || length > size - offset ) {
+            error = "Corrupt KTX2 level " + std::to_string( i );
+            return false;
+        }
+        texture.levels[i].assign( p + offset, p + offset + length );
+    }
+    return true;
+}
+
+bool Ktx2::write( const QString& path, const Ktx2Texture& texture, std::string& error ) {
+    // 先写临时文件再替换, 中途退出不会留下半个缓存文件
+    QSaveFile file( path );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        error = "Cannot write " + path.toStdString();
+        return false;
+    }
+    file.write( serialize( texture ) );
+    if ( !file.commit() ) {
+        error = "Cannot write " + path.toStdString();
+        return false;
+    }
+    return true;
+}
+
+bool Ktx2::read( const QString& path, Ktx2Texture& texture, std::string& error ) {
+    QFile file( path );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        error = "Cannot open " + path.toStdString();
+        return false;
+    }
+    return parse( file.readAll(), texture, error );
+}
@@ -0,0 +1,38 @@
+// 单一职责: KTX2 容器的读写 (单张 2D 纹理 + 完整 mip 链, 不做超级压缩)
+// 数据格式描述块 (DFD) 按 Khronos Data Format 1.3 的基本描述块生成
+#pragma once
+
+#include "texture_format.hpp"
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <string>
+#include <vector>
+
+struct Ktx2Texture {
+    TextureFormat format = TextureFormat::RGBA8;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<std::vector<uint8_t>> levels;       // levels[0] 为最大一级
+
+    bool isValid() const { return width > 0 && height > 0 && !levels.empty(); }
+
+    uint32_t levelWidth( uint32_t level ) const { return qMax( 1u, width >> level ); }
+    uint32_t levelHeight( uint32_t level ) const { return qMax( 1u, height >> level ); }
+
+    size_t totalBytes() const {
+        size_t total = 0;
+        for ( const auto& level : levels ) total += level.size();
+        return total;
+    }
+};
+
+class Ktx2 {
+public:
+    static QByteArray serialize( const Ktx2Texture& texture );
+    static bool parse( const QByteArray& data, Ktx2Texture& texture, std::string& error );
+
+    static bool write( const QString& path, const Ktx2Texture& texture, std::string& error );
+    static bool read( const QString& path, Ktx2Texture& texture, std::string& error );
+};
@@ -0,0 +1,159 @@
+#include "light_clusterer.hpp"
+#include "job_pool.hpp"
+#include "simd_vec4.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+LightClusterer::LightClusterer( const ClusterGridSize& size )
+    : m_size( size )
+{
+    m_slices.resize( size.slices );
+    m_grid.assign( size_t( size.clusterCount() ) * 2, 0 );
+}
+
+void LightClusterer::setProjection( const QMatrix4x4& projection, float nearPlane, float farPlane ) {
+    const float parameters[4] = { projection( 0, 0 ), projection( 1, 1 ), projection( 0, 2 ), projection( 1, 2 ) };
+    if ( !m_bounds.empty() && std::equal( parameters, parameters + 4, m_projection )
+         && nearPlane == m_near && farPlane == m_far ) {
+        return;
+    }
+    std::copy( parameters, parameters + 4, m_projection );
+    m_near = nearPlane;
+    m_far = farPlane;
+
+    const float logRatio = std::log( farPlane / nearPlane );
+    m_sliceScale = float( m_size.slices ) / logRatio;
+    m_sliceBias = -std::log( nearPlane ) * m_sliceScale;
+
+    // 视图空间 x = (ndc + P02) * d / P00, 其中 d 为正的视图深度
+    m_bounds.resize( m_size.clusterCount() );
+    for ( uint32_t slice = 0; slice < m_size.slices; ++slice ) {
+        const float dn = nearPlane * std::pow( farPlane / nearPlane, float( slice ) / m_size.slices );
+        const float df = nearPlane * std::pow( farPlane / nearPlane, float( slice + 1 ) / m_size.slices );
+        for ( uint32_t ty = 0; ty < m_size.tilesY; ++ty ) {
+            for ( uint32_t tx = 0; tx < m_size.tilesX; ++tx ) {
+                const float ndc[2][2] = { { 2.0f * tx / m_size.tilesX - 1.0f, 2.0f * ( tx + 1 ) / m_size.tilesX - 1.0f },
+                                          { 2.0f * ty / m_size.tilesY - 1.0f, 2.0f * ( ty + 1 ) / m_size.tilesY - 1.0f } };
+                Bounds& bounds = m_bounds[( slice * m_size.tilesY + ty ) * m_size.tilesX + tx];
+                for ( int axis = 0; axis < 2; ++axis ) {
+                    const float a = ( ndc[axis][0] + m_projection[2 + axis] ) / m_projection[axis];
+                    const float b = ( ndc[axis][1] + m_projection[2 + axis] ) / m_projection[axis];
+                    bounds.min[axis] = std::min( std::min( a * dn, a * df ), std::min( b * dn, b * df ) );
+                    bounds.max[axis] = std::max( std::max( a * dn, a * df ), std::max( b * dn, b * df ) );
+                }
+                bounds.min[2] = -df;
+                bounds.max[2] = -dn;
+            }
+        }
+    }
+}
+
+void LightClusterer::build( const ClusterLight* lights, uint32_t count, bool simd, bool parallel ) {
+    if ( parallel ) {
+        JobPool::instance().parallelFor( 0, int( m_size.slices ), 1, [&]( int begin, int end ) {
+            for ( int slice = begin; slice < end; ++slice ) buildSlice( uint32_t( slice ), lights, count, simd );
+        } );
+    } else {
+        for ( uint32_t slice = 0; slice < m_size.slices; ++slice ) buildSlice( slice, lights, count, simd );
+    }
+
+    // 按切片顺序拼接成紧凑列表
+    m_stats = ClusterStats();
+    m_stats.lights = count;
+    m_indices.clear();
+    const uint32_t tiles = m_size.tileCount();
+    for ( uint32_t slice = 0; slice < m_size.slices; ++slice ) {
+        const Slice& data = m_slices[slice];
+        uint32_t offset = uint32_t( m_indices.size() );
+        for ( uint32_t tile = 0; tile < tiles; ++tile ) {
+            const uint32_t cluster = slice * tiles + tile;
+            const uint32_t n = data.counts[tile];
+            m_grid[cluster * 2 + 0] = offset;
+            m_grid[cluster * 2 + 1] = n;
+            offset += n;
+            if ( n > 0 ) ++m_stats.occupiedClusters;
+            m_stats.maxPerCluster = std::max( m_stats.maxPerCluster, n );
+        }
+        m_indices.insert( m_indices.end(), data.indices.begin(), data.indices.end() );
+    }
+    m_stats.indices = uint32_t( m_indices.size() );
+}
+
+void LightClusterer::buildSlice( uint32_t slice, const ClusterLight* lights, uint32_t count, bool simd ) {
+    Slice& data = m_slices[slice];
+    const uint32_t tiles = m_size.tileCount();
+    const Bounds* bounds = m_bounds.data() + size_t( slice ) * tiles;
+    data.indices.clear();
+    data.counts.assign( tiles, 0 );
+
+    // 先按深度范围粗筛, 大部分灯只落在少数几个切片里
+    const float zMin = bounds[0].min[2];
+    const float zMax = bounds[0].max[2];
+    data.x.clear();
+    data.y.clear();
+    data.z.clear();
+    data.radius2.clear();
+    data.lightIndex.clear();
+    for ( uint32_t i = 0; i < count; ++i ) {
+        const ClusterLight& light = lights[i];
+        if ( light.z - light.radius > zMax || light.z + light.radius < zMin ) continue;
+        data.x.push_back( light.x );
+        data.y.push_back( light.y );
+        data.z.push_back( light.z );
+        data.radius2.push_back( light.radius * light.radius );
+        data.lightIndex.push_back( i );
+    }
+    const uint32_t candidates = uint32_t( data.lightIndex.size() );
+    if ( candidates == 0 ) return;
+
+    if ( !simd ) {
+        for ( uint32_t tile = 0; tile < tiles; ++tile ) {
+            const Bounds& box = bounds[tile];
+            for ( uint32_t i = 0; i < candidates; ++i ) {
+                const float c[3] = { data.x[i], data.y[i], data.z[i] };
+                float distance2 = 0.0f;
+                for ( int axis = 0; axis < 3; ++axis ) {
+                    const float d = std::max( std::max( box.min[axis] - c[axis], c[axis] - box.max[axis] ), 0.0f );
+                    distance2 += d * d;
+                }
+                if ( distance2 <= data.radius2[i] ) {
+                    data.indices.push_back( data.lightIndex[i] );
+                    ++data.counts[tile];
+                }
+            }
+        }
+        return;
+    }
+
+    // 补齐到 4 的倍数, 补出来的灯半径平方为负, 永远不会命中
+    const uint32_t padded = ( candidates + 3 ) & ~3u;
+    data.x.resize( padded, 0.0f );
+    data.y.resize( padded, 0.0f );
+    data.z.resize( padded, 0.0f );
+    data.radius2.resize( padded, -1.0f );
+
+    const Vec4 zero = Vec4::zero();
+    for ( uint32_t tile = 0; tile < tiles; ++tile ) {
+        const Bounds& box = bounds[tile];
+        const Vec4 minX = Vec4::splat( box.min[0] ), maxX = Vec4::splat( box.max[0] );
+        const Vec4 minY = Vec4::splat( box.min[1] ), maxY = Vec4::splat( box.max[1] );
+        const Vec4 minZ = Vec4::splat( box.min[2] ), maxZ = Vec4::splat( box.max[2] );
+        for ( uint32_t i = 0; i < padded; i += 4 ) {
+            const Vec4 x = Vec4::load( data.x.data() + i );
+            const Vec4 y = Vec4::load( data.y.data() + i );
+            const Vec4 z = Vec4::load( data.z.data() + i );
+            const Vec4 dx = Vec4::max( Vec4::max( minX - x, x - maxX ), zero );
+            const Vec4 dy = Vec4::max( Vec4::max( minY - y, y - maxY ), zero );
+            const Vec4 dz = Vec4::max( Vec4::max( minZ - z, z - maxZ ), zero );
+            const Vec4 distance2 = Vec4::madd( Vec4::madd( dx * dx, dy, dy ), dz, dz );
+            int mask = Vec4::lessEqualMask( distance2, Vec4::load( data.radius2.data() + i ) );
+            while ( mask ) {
+                const int lane = mask & 1 ? 0 : mask & 2 ? 1 : mask & 4 ? 2 : 3;
+                mask &= mask - 1;
+                data.indices.push_back( data.lightIndex[i + lane] );
+                ++data.counts[tile];
+            }
+        }
+    }
+}
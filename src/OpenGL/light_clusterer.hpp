@@ -0,0 +1,90 @@
+// 单一职责: 分簇前向渲染的灯光分配 (CPU 路径)
+// 视锥按屏幕 tile x 深度切片 (按距离指数分布) 划分成 froxel, 每个 froxel 记录与之相交的点光源
+// 深度切片之间互不依赖, 交给 JobPool 并行; 切片内用 Vec4 一次测试 4 盏灯 (SoA)
+// 结果是紧凑的 (起点, 数量) 网格加一个下标列表, 片元着色器只遍历所在 froxel 的灯
+#pragma once
+
+#include <QMatrix4x4>
+#include <cstdint>
+#include <vector>
+
+// 视图空间的点光源 (相机看向 -Z)
+struct ClusterLight {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float radius = 0.0f;        // 影响半径, 之外的贡献为 0
+};
+
+struct ClusterGridSize {
+    uint32_t tilesX = 16;
+    uint32_t tilesY = 9;
+    uint32_t slices = 24;
+
+    uint32_t tileCount() const { return tilesX * tilesY; }
+    uint32_t clusterCount() const { return tilesX * tilesY * slices; }
+};
+
+struct ClusterStats {
+    uint32_t lights = 0;
+    uint32_t occupiedClusters = 0;      // 至少有一盏灯的簇
+    uint32_t indices = 0;               // 下标列表总长度
+    uint32_t maxPerCluster = 0;
+};
+
+class LightClusterer {
+public:
+    explicit LightClusterer( const ClusterGridSize& size = ClusterGridSize() );
+
+    const ClusterGridSize& size() const { return m_size; }
+
+    // projection 为透视投影, nearPlane / farPlane 是正的视图空间距离
+    // 只在投影变化时重新计算每个 froxel 的视图空间包围盒
+    void setProjection( const QMatrix4x4& projection, float nearPlane, float farPlane );
+
+    // simd 为 false 时逐灯标量测试, parallel 为 false 时在调用线程完成, 两者只用于校验和 benchmark
+    void build( const ClusterLight* lights, uint32_t count, bool simd = true, bool parallel = true );
+
+    // 每个簇两个 uint32: 在 indices() 中的起点和灯数; 簇按 tileX → tileY → 切片 排列, tileY 从屏幕底部开始
+    const std::vector<uint32_t>& grid() const { return m_grid; }
+    const std::vector<uint32_t>& indices() const { return m_indices; }
+    const ClusterStats& stats() const { return m_stats; }
+
+    // 着色器用 slice = log(视图深度) * sliceScale + sliceBias 求切片
+    float sliceScale() const { return m_sliceScale; }
+    float sliceBias() const { return m_sliceBias; }
+
+    // 投影参数, 计算着色器用同样的方式构造 froxel 包围盒: P00 P11 P02 P12
+    const float* projectionParameters() const { return m_projection; }
+    float nearPlane() const { return m_near; }
+    float farPlane() const { return m_far; }
+
+private:
+    struct Bounds {
+        float min[3];
+        float max[3];
+    };
+
+    // 一个深度切片的中间结果, 切片之间并行
+    struct Slice {
+        std::vector<float> x, y, z, radius2;    // 与切片深度范围相交的灯, SoA, 补齐到 4 的倍数
+        std::vector<uint32_t> lightIndex;
+        std::vector<uint32_t> indices;          // 本切片所有 tile 的下标, 按 tile 顺序
+        std::vector<uint32_t> counts;           // 每个 tile 的灯数
+    };
+
+    void buildSlice( uint32_t slice, const ClusterLight* lights, uint32_t count, bool simd );
+
+    ClusterGridSize m_size;
+    float m_projection[4] = { 1.0f, 1.0f, 0.0f, 0.0f };
+    float m_near = 0.1f;
+    float m_far = 100.0f;
+    float m_sliceScale = 0.0f;
+    float m_sliceBias = 0.0f;
+
+    std::vector<Bounds> m_bounds;               // 每个簇的视图空间包围盒
+    std::vector<Slice> m_slices;
+    std::vector<uint32_t> m_grid;
+    std::vector<uint32_t> m_indices;
+    ClusterStats m_stats;
+};
@@ -0,0 +1,79 @@
+// 单一职责: CPU 端的索引网格数据 (顶点 + 索引 + 包围盒)
+#pragma once
+
+#include <QVector2D>
+#include <QVector3D>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// 通用网格顶点: 位置 / 法线 / 纹理坐标, 全部 float 紧密排列
+struct MeshVertex {
+    QVector3D position;
+    QVector3D normal;
+    QVector2D texCoord;
+};
+
+struct MeshData {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    QVector3D boundsMin;
+    QVector3D boundsMax;
+
+    bool isEmpty() const { return vertices.empty() || indices.empty(); }
+
+    // 顶点数不超过 65535 时可以用 16 位索引, 索引缓冲减半
+    bool fitsUInt16() const { return vertices.size() <= 0xFFFF; }
+
+    void computeBounds() {
+        const float inf = std::numeric_limits<float>::max();
+        boundsMin = QVector3D( inf, inf, inf );
+        boundsMax = QVector3D( -inf, -inf, -inf );
+        for ( const MeshVertex& v : vertices ) {
+            boundsMin = QVector3D( std::min( boundsMin.x(), v.position.x() ),
+                                   std::min( boundsMin.y(), v.position.y() ),
+                                   std::min( boundsMin.z(), v.position.z() ) );
+            boundsMax = QVector3D( std::max( boundsMax.x(), v.position.x() ),
+                                   std::max( boundsMax.y(), v.position.y() ),
+                                   std::max( boundsMax.z(), v.position.z() ) );
+        }
+    }
+
+    // 立方体: 每个面 4 个顶点 (法线不共享), 36 个索引
+    static MeshData createCube( float size = 1.0f ) {
+        const float h = size * 0.5f;
+        struct Face { QVector3D normal, u, v; };
+        const Face faces[6] = {
+            { QVector3D(  0,  0,  1 ), QVector3D(  1, 0,  0 ), QVector3D( 0, 1,  0 ) },   // 前
+            { QVector3D(  0,  0, -1 ), QVector3D( -1, 0,  0 ), QVector3D( 0, 1,  0 ) },   // 后
+            { QVector3D(  1,  0,  0 ), QVector3D(  0, 0, -1 ), QVector3D( 0, 1,  0 ) },   // 右
+            { QVector3D( -1,  0,  0 ), QVector3D(  0, 0,  1 ), QVector3D( 0, 1,  0 ) },   // 左
+            { QVector3D(  0,  1,  0 ), QVector3D(  1, 0,  0 ), QVector3D( 0, 0, -1 ) },   // 上
+            { QVector3D(  0, -1,  0 ), QVector3D(  1, 0,  0 ), QVector3D( 0, 0,  1 ) },   // 下
+        };
+
+        MeshData mesh;
+        mesh.vertices.reserve( 24 );
+        mesh.indices.reserve( 36 );
+        for ( const Face& face : faces ) {
+            const uint32_t base = static_cast<uint32_t>( mesh.vertices.size() );
+            const QVector3D center = face.normal * h;
+            const float corners[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+            for ( const auto& c : corners ) {
+                MeshVertex vertex;
+                vertex.position = center + face.u * ( c[0] * h ) + face.v * ( c[1] * h );
+                vertex.normal = face.normal;
+                vertex.texCoord = QVector2D( ( c[0] + 1.0f ) * 0.5f, ( c[1] + 1.0f ) * 0.5f );
+                mesh.vertices.push_back( vertex );
+            }
+            // 逆时针为正面
+            const uint32_t quad[6] = { 0, 1, 2, 0, 2, 3 };
+            for ( uint32_t i : quad ) {
+                mesh.indices.push_back( base + i );
+            }
+        }
+        mesh.computeBounds();
+        return mesh;
+    }
+};
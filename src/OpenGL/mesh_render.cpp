@@ -0,0 +1,284 @@
+#include "mesh_render.hpp"
+#include <QDebug>
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+
+namespace {
+
+// 每帧光栅化的遮挡体数量上限, 按离相机的距离选最近的
+constexpr uint32_t kMaxOccluders = 32;
+
+// 三角形超过这个数的网格不适合作遮挡体, 关闭遮挡剔除
+constexpr size_t kMaxOccluderTriangles = 1024;
+
+} // namespace
+
+MeshRender::MeshRender( MeshData mesh, std::string name )
+    : m_mesh( std::move(mesh) )
+    , m_name( std::move(name) )
+    , m_vbo( QOpenGLBuffer::VertexBuffer )
+    , m_ibo( QOpenGLBuffer::IndexBuffer )
+    , m_indexType( IndexType::UInt16 )
+    , m_indexCount(0)
+    , m_clearColor( 0.0f, 0.0f, 0.0f, 0.0f )
+    , m_rotationSpeed(1.0f)
+    , m_currentAngle(0.0f)
+    , m_instanceGrid(1)
+    , m_depthPrepass(false)
+    , m_occlusionCulling(false)
+    , m_initialized(false)
+{
+}
+
+MeshRender::~MeshRender() {
+    this->cleanup();
+}
+
+bool MeshRender::initialize( const RenderConfig& config ) {
+    initializeOpenGLFunctions();
+
+    if ( m_mesh.isEmpty() ) {
+        reportError( RenderError::InitializationFailed, "Mesh is empty" );
+        return false;
+    }
+
+    // 初始化着色器
+    if ( !initializeShaders( config ) ) {
+        reportError( RenderError::ShaderCompilationFailed, "Failed to compile shader" );
+        return false;
+    }
+
+    // 初始化几何体
+    if ( !initializeGeometry() ) {
+        reportError( RenderError::BufferCreationFailed, "Failed to create mesh buffers" );
+        return false;
+    }
+
+    if ( !m_uniforms.initialize() ) {
+        reportError( RenderError::BufferCreationFailed, "Failed to create uniform buffer" );
+        return false;
+    }
+    m_uniforms.bindBlocks( m_program );
+    if ( m_depthPrepass ) {
+        m_uniforms.bindBlocks( m_depthProgram );
+    }
+
+    // 保存配置
+    m_clearColor = config.clearColor();
+    m_rotationSpeed = config.rotationSpeed();
+    m_instanceGrid = qMax( 1, config.instanceGrid() );
+    m_occlusionCulling = config.occlusionCulling() && m_mesh.indices.size() / 3 <= kMaxOccluderTriangles;
+    m_initialized = true;
+
+    return true;
+}
+
+bool MeshRender::render( const RenderContext& context ) {
+    // 直接渲染: 在渲染线程上录制后立即回放
+    m_directCommands.reset();
+    if ( !record( context, m_directCommands ) ) {
+        return false;
+    }
+    m_replayer.execute( m_directCommands );
+    m_replayer.finish();
+    return true;
+}
+
+bool MeshRender::record( const RenderContext& context, CommandBuffer& commands ) {
+    if ( !m_initialized ) {
+        reportError( RenderError::InitializationFailed, "Render not initialized" );
+        return false;
+    }
+
+    m_currentAngle += m_rotationSpeed;
+    if ( m_currentAngle > 360.0f ) { m_currentAngle -= 360.0f; }
+
+    commands.setViewport( 0, 0, context.width(), context.height() );
+    commands.clear( ClearColor | ClearDepth, m_clearColor );
+
+    m_uniforms.beginFrame( context );
+
+    // 实例排成 grid x grid x grid 的方阵, 沿 -Z 方向分层, 后面的层被前面的遮挡
+    const int grid = m_instanceGrid;
+    const float spacing = grid > 1 ? 2.4f / float( grid - 1 ) : 0.0f;
+    const float origin = -1.2f * ( grid > 1 ? 1.0f : 0.0f );
+    const QMatrix4x4 view = context.viewMatrix();
+
+    // 先算出全部实例, 遮挡剔除要在提交之前看到整个场景
+    m_instances.clear();
+    for ( int z = 0; z < grid; ++z ) {
+        for ( int y = 0; y < grid; ++y ) {
+            for ( int x = 0; x < grid; ++x ) {
+                Instance instance;
+                instance.model.translate( origin + x * spacing, origin + y * spacing, -5.0f - z * spacing );
+                instance.model.rotate( m_currentAngle + 15.0f * ( x + y + z ), 0.4f, 1.0f, 0.2f );
+                instance.color = QVector4D( 0.35f + 0.65f * x / float( grid ),
+                                            0.35f + 0.65f * y / float( grid ),
+                                            0.35f + 0.65f * z / float( grid ),
+                                            1.0f );
+                instance.viewDepth = -( view * instance.model ).column( 3 ).z();
+                m_instances.push_back( instance );
+            }
+        }
+    }
+    if ( m_occlusionCulling ) {
+        cullOccluded( context.projectionMatrix() * view );
+    }
+
+    // 与 OpenGLItemRenderer::updateProjectMatrix 中的近远平面一致
+    m_queue.begin( 3.0f, 10.0f );
+
+    for ( const Instance& instance : m_instances ) {
+        if ( !instance.visible ) continue;
+        const uint32_t objectOffset = m_uniforms.addObject( instance.model, instance.color );
+        DrawItem item;
+        item.vertexBuffer = m_vbo.bufferId();
+        item.indexBuffer = m_ibo.bufferId();
+        item.indexType = m_indexType;
+        item.stride = sizeof( MeshVertex );
+        item.attributeCount = 2;
+        item.attributes[0] = { 0, 3, 0 };                                                           // 位置
+        item.attributes[1] = { 1, 3, static_cast<uint16_t>( offsetof( MeshVertex, normal ) ) };    // 法线
+        item.count = m_indexCount;
+        item.uniformBuffer = m_uniforms.handle();
+        item.objectOffset = objectOffset;
+        item.viewDepth = instance.viewDepth;
+        item.state.depthTest = true;
+        item.state.cullBackFace = true;
+
+        if ( m_depthPrepass ) {
+            // 第一遍只写深度, 从前往后, 片元着色器为空
+            DrawItem depthItem = item;
+            depthItem.pass = 0;
+            depthItem.program = m_depthProgram.programId();
+            depthItem.attributeCount = 1;
+            depthItem.state.colorWrite = false;
+            depthItem.state.depthFunc = CompareFunc::Less;
+            m_queue.add( depthItem );
+
+            // 第二遍只着色深度相等的片元, 被遮挡的片元在着色前就被剔除
+            item.pass = 1;
+            item.state.depthWrite = false;
+            item.state.depthFunc = CompareFunc::LessEqual;
+        }
+        item.program = m_program.programId();
+        m_queue.add( item );
+    }
+
+    // 一次上传全部 uniform, 然后按排序键提交
+    m_uniforms.upload( commands );
+    m_queue.submit( commands );
+
+    return true;
+}
+
+bool MeshRender::submissionStats( SubmissionStats& stats ) const {
+    stats = m_queue.stats();
+    stats.culledCount = m_occlusionCulling ? m_occlusion.stats().culled : 0;
+    return true;
+}
+
+void MeshRender::cullOccluded( const QMatrix4x4& viewProjection ) {
+    // 离相机最近的实例在屏幕上最大, 挡住的也最多
+    const uint32_t count = uint32_t( m_instances.size() );
+    const uint32_t occluders = std::min( count, kMaxOccluders );
+    m_occluderOrder.resize( count );
+    std::iota( m_occluderOrder.begin(), m_occluderOrder.end(), 0u );
+    std::partial_sort( m_occluderOrder.begin(), m_occluderOrder.begin() + occluders, m_occluderOrder.end(),
+                       [this]( uint32_t a, uint32_t b ) { return m_instances[a].viewDepth < m_instances[b].viewDepth; } );
+
+    m_occlusion.begin( viewProjection );
+    for ( uint32_t i = 0; i < occluders; ++i ) {
+        m_occlusion.addOccluder( m_instances[m_occluderOrder[i]].model, m_mesh );
+    }
+    m_occlusion.rasterize();
+
+    // 遮挡体自己的包围盒不会比自己的表面远, 不会被自己剔除
+    for ( Instance& instance : m_instances ) {
+        instance.visible = !m_occlusion.isOccluded( instance.model, m_mesh.boundsMin, m_mesh.boundsMax );
+    }
+}
+
+bool MeshRender::resize( int width, int height ) {
+    glViewport( 0, 0, width, height );
+    return true;
+}
+
+void MeshRender::cleanup() {
+    if ( m_vbo.isCreated() ) {
+        m_vbo.destroy();
+    }
+    if ( m_ibo.isCreated() ) {
+        m_ibo.destroy();
+    }
+    m_uniforms.cleanup();
+    m_program.removeAllShaders();
+    m_depthProgram.removeAllShaders();
+    m_initialized = false;
+}
+
+void MeshRender::setErrorCallback( ErrorCallback callback ) {
+    m_errorCallback = callback;
+}
+
+bool MeshRender::initializeShaders( const RenderConfig& config ) {
+    if ( !m_program.addShaderFromSourceFile( QOpenGLShader::Vertex, config.vertexShaderPath() ) ) {
+        qDebug() << "Vertex shader error:" << m_program.log();
+        return false;
+    }
+    if ( !m_program.addShaderFromSourceFile( QOpenGLShader::Fragment, config.fragmentShaderPath() ) ) {
+        qDebug() << "Fragment shader error:" << m_program.log();
+        return false;
+    }
+    if ( !m_program.link() ) {
+        qDebug() << "Shader link error:" << m_program.log();
+        return false;
+    }
+
+    m_depthPrepass = config.depthPrepass() && !config.depthFragmentShaderPath().isEmpty();
+    if ( !m_depthPrepass ) {
+        return true;
+    }
+
+    // 深度预渲染程序: 失败时退回单遍渲染
+    if ( !m_depthProgram.addShaderFromSourceFile( QOpenGLShader::Vertex, config.vertexShaderPath() )
+         || !m_depthProgram.addShaderFromSourceFile( QOpenGLShader::Fragment, config.depthFragmentShaderPath() )
+         || !m_depthProgram.link() ) {
+        qDebug() << "Depth prepass shader error:" << m_depthProgram.log();
+        m_depthPrepass = false;
+    }
+    return true;
+}
+
+bool MeshRender::initializeGeometry() {
+    if ( !m_vbo.create() || !m_ibo.create() ) {
+        return false;
+    }
+
+    m_vbo.bind();
+    m_vbo.allocate( m_mesh.vertices.data(), static_cast<int>( m_mesh.vertices.size() * sizeof( MeshVertex ) ) );
+    m_vbo.release();
+
+    m_indexCount = static_cast<uint32_t>( m_mesh.indices.size() );
+
+    m_ibo.bind();
+    if ( m_mesh.fitsUInt16() ) {
+        // 16 位索引 减少一半的索引带宽
+        std::vector<uint16_t> indices( m_mesh.indices.begin(), m_mesh.indices.end() );
+        m_ibo.allocate( indices.data(), static_cast<int>( indices.size() * sizeof( uint16_t ) ) );
+        m_indexType = IndexType::UInt16;
+    } else {
+        m_ibo.allocate( m_mesh.indices.data(), static_cast<int>( m_mesh.indices.size() * sizeof( uint32_t ) ) );
+        m_indexType = IndexType::UInt32;
+    }
+    m_ibo.release();
+
+    return true;
+}
+
+void MeshRender::reportError( RenderError error, const std::string& message ) {
+    if ( m_errorCallback ) {
+        m_errorCallback( error, message );
+    }
+}
@@ -0,0 +1,77 @@
+// 单一职责: 通用索引网格渲染器 (glDrawElements + 深度测试 + 可选深度预渲染)
+// 立方体渲染器即是以立方体网格构造的 MeshRender
+// 可选软件遮挡剔除 (见 OcclusionCuller): 最近的实例作遮挡体, 被完全挡住的实例不进入 RenderQueue
+#pragma once
+#include "irenderer.hpp"
+#include "render_config.hpp"
+#include "render_context.hpp"
+#include "render_queue.hpp"
+#include "uniform_buffer.hpp"
+#include "gl_command_replayer.hpp"
+#include "mesh_data.hpp"
+#include "occlusion_culler.hpp"
+
+#include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+#include <QMatrix4x4>
+#include <vector>
+
+class MeshRender : protected QOpenGLFunctions, public IRenderer
+{
+public:
+    MeshRender( MeshData mesh, std::string name );
+    ~MeshRender() override;
+
+    bool initialize( const RenderConfig& config ) override;
+    bool render( const RenderContext& context ) override;
+    bool supportsRecording() const override { return true; }
+    bool record( const RenderContext& context, CommandBuffer& commands ) override;
+    bool submissionStats( SubmissionStats& stats ) const override;
+    bool resize( int width, int height ) override;
+    void cleanup() override;
+    void setErrorCallback( ErrorCallback callback ) override;
+    std::string getName() const override { return m_name; }
+
+private:
+    struct Instance {
+        QMatrix4x4 model;
+        QVector4D color;
+        float viewDepth = 0.0f;
+        bool visible = true;
+    };
+
+    void cullOccluded( const QMatrix4x4& viewProjection );
+    bool initializeShaders( const RenderConfig& config );
+    bool initializeGeometry();
+    void reportError( RenderError error, const std::string& message );
+
+    MeshData m_mesh;
+    std::string m_name;
+
+    QOpenGLShaderProgram m_program;
+    QOpenGLShaderProgram m_depthProgram;    // 深度预渲染: 同一个顶点着色器 + 空片元着色器
+    QOpenGLBuffer m_vbo;
+    QOpenGLBuffer m_ibo;
+    IndexType m_indexType;
+    uint32_t m_indexCount;
+
+    RenderQueue m_queue;
+    UniformBuffer m_uniforms;
+    CommandBuffer m_directCommands;         // render() 直接渲染时使用
+    GLCommandReplayer m_replayer;
+
+    QVector4D m_clearColor;
+    float m_rotationSpeed;
+    float m_currentAngle;
+    int m_instanceGrid;                     // 每个轴上的实例数量
+    bool m_depthPrepass;
+
+    bool m_occlusionCulling;
+    OcclusionCuller m_occlusion;
+    std::vector<Instance> m_instances;      // 录制线程每帧复用
+    std::vector<uint32_t> m_occluderOrder;
+
+    ErrorCallback m_errorCallback;
+    bool m_initialized;
+};
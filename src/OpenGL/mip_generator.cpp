@@ -0,0 +1,270 @@
+#include "mip_generator.hpp"
+#include "job_pool.hpp"
+#include "pixel_convert.hpp"
+#include "simd_vec4.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// 每个任务负责的输出行数; 相邻行带需要的源行有重叠, 行带越高重复的水平滤波越少
+constexpr int kBandRows = 32;
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kKaiserAlpha = 4.0;
+
+double sinc( double x ) {
+    if ( std::fabs( x ) < 1e-6 ) return 1.0;
+    x *= kPi;
+    return std::sin( x ) / x;
+}
+
+// 第一类零阶修正贝塞尔函数, 级数展开
+double bessel0( double x ) {
+    const double q = x * x * 0.25;
+    double sum = 1.0;
+    double term = 1.0;
+    for ( int k = 1; k < 32; ++k ) {
+        term *= q / double( k * k );
+        sum += term;
+        if ( term < sum * 1e-12 ) break;
+    }
+    return sum;
+}
+
+double support( MipFilter filter ) {
+    return filter == MipFilter::Box ? 0.5 : 3.0;
+}
+
+double weight( MipFilter filter, double d ) {
+    switch ( filter ) {
+    case MipFilter::Box:
+        return ( d >= -0.5 && d < 0.5 ) ? 1.0 : 0.0;
+    case MipFilter::Kaiser: {
+        const double r = d / 3.0;
+        if ( std::fabs( r ) >= 1.0 ) return 0.0;
+        return sinc( d ) * bessel0( kKaiserAlpha * std::sqrt( 1.0 - r * r ) ) / bessel0( kKaiserAlpha );
+    }
+    case MipFilter::Lanczos:
+        if ( std::fabs( d ) >= 3.0 ) return 0.0;
+        return sinc( d ) * sinc( d / 3.0 );
+    }
+    return 0.0;
+}
+
+int wrap( int i, int size ) {
+    const int m = i % size;
+    return m < 0 ? m + size : m;
+}
+
+// 一个方向上每个输出像素的源像素和权重 (已归一化)
+struct Contributions {
+    std::vector<int> start;         // 第一个源像素 (未环绕), 用于确定行带需要的源行
+    std::vector<int> offset;        // 在 index / weights 中的起始位置
+    std::vector<int> count;
+    std::vector<int> index;         // 环绕后的源像素下标
+    std::vector<float> weights;
+
+    Contributions( int sourceSize, int targetSize, MipFilter filter ) {
+        const double scale = double( sourceSize ) / double( targetSize );
+        const double filterScale = std::max( scale, 1.0 );
+        const double radius = support( filter ) * filterScale;
+
+        start.resize( targetSize );
+        offset.resize( targetSize );
+        count.resize( targetSize );
+        std::vector<double> taps;
+        for ( int i = 0; i < targetSize; ++i ) {
+            const double center = ( i + 0.5 ) * scale;
+            int lo = int( std::floor( center - radius ) );
+            int hi = int( std::ceil( center + radius ) );
+
+            taps.clear();
+            for ( int j = lo; j < hi; ++j ) {
+                taps.push_back( weight( filter, ( j + 0.5 - center ) / filterScale ) );
+            }
+            // 去掉两端权重为 0 的源像素
+            int first = 0;
+            int last = int( taps.size() );
+            while ( first < last && taps[first] == 0.0 ) ++first;
+            while ( last > first && taps[last - 1] == 0.0 ) --last;
+
+            double sum = 0.0;
+            for ( int t = first; t < last; ++t ) sum += taps[t];
+            if ( first == last || std::fabs( sum ) < 1e-9 ) {
+                // 不会发生 (每个滤波器中心权重都不为 0), 保险起见退回最近点
+                lo = int( center );
+                taps.assign( 1, 1.0 );
+                first = 0;
+                last = 1;
+                sum = 1.0;
+            }
+
+            start[i] = lo + first;
+            offset[i] = int( weights.size() );
+            count[i] = last - first;
+            for ( int t = first; t < last; ++t ) {
+                index.push_back( wrap( lo + t, sourceSize ) );
+                weights.push_back( float( taps[t] / sum ) );
+            }
+        }
+    }
+};
+
+// 一行 RGBA8 转成滤波用的线性浮点
+void loadRow( const uint8_t* source, uint32_t width, const MipOptions& options, float* out ) {
+    if ( options.srgb ) {
+        PixelConvert::srgbToLinear( source, out, width );
+    } else {
+        for ( uint32_t x = 0; x < width; ++x ) {
+            Vec4::fromUnorm8( source + x * 4 ).store( out + x * 4 );
+        }
+    }
+    if ( options.alphaWeighted ) {
+        for ( uint32_t x = 0; x < width; ++x ) {
+            float* p = out + x * 4;
+            p[0] *= p[3];
+            p[1] *= p[3];
+            p[2] *= p[3];
+        }
+    }
+}
+
+// 滤波结果写回 RGBA8, row 会被原地修改
+void storeRow( float* row, uint32_t width, const MipOptions& options, uint8_t* out ) {
+    if ( options.alphaWeighted ) {
+        for ( uint32_t x = 0; x < width; ++x ) {
+            float* p = row + x * 4;
+            const float scale = p[3] > 1e-6f ? 1.0f / p[3] : 0.0f;
+            p[0] *= scale;
+            p[1] *= scale;
+            p[2] *= scale;
+        }
+    }
+    if ( options.normalMap ) {
+        for ( uint32_t x = 0; x < width; ++x ) {
+            float* p = row + x * 4;
+            const float nx = p[0] * 2.0f - 1.0f;
+            const float ny = p[1] * 2.0f - 1.0f;
+            const float nz = p[2] * 2.0f - 1.0f;
+            const float length = std::sqrt( nx * nx + ny * ny + nz * nz );
+            if ( length > 1e-6f ) {
+                const float scale = 0.5f / length;
+                p[0] = nx * scale + 0.5f;
+                p[1] = ny * scale + 0.5f;
+                p[2] = nz * scale + 0.5f;
+            } else {
+                p[0] = 0.5f;
+                p[1] = 0.5f;
+                p[2] = 1.0f;
+            }
+        }
+    }
+    if ( options.srgb ) {
+        PixelConvert::linearToSrgb( row, out, width );
+    } else {
+        for ( uint32_t x = 0; x < width; ++x ) {
+            Vec4::load( row + x * 4 ).toUnorm8( out + x * 4 );
+        }
+    }
+}
+
+} // namespace
+
+const char* MipGenerator::name( MipFilter filter ) {
+    switch ( filter ) {
+    case MipFilter::Box: return "box";
+    case MipFilter::Kaiser: return "kaiser";
+    case MipFilter::Lanczos: return "lanczos";
+    }
+    return "unknown";
+}
+
+std::vector<MipImage> MipGenerator::generate( const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t stride,
+                                              const MipOptions& options ) {
+    std::vector<MipImage> levels;
+    if ( width == 0 || height == 0 ) return levels;
+
+    uint32_t levelCount = 1;
+    for ( uint32_t size = std::max( width, height ); size > 1; size >>= 1 ) ++levelCount;
+    if ( options.maxLevels > 0 ) levelCount = std::min( levelCount, options.maxLevels );
+    levels.reserve( levelCount );
+
+    MipImage base;
+    base.width = width;
+    base.height = height;
+    base.rgba.resize( size_t( width ) * height * 4 );
+    for ( uint32_t y = 0; y < height; ++y ) {
+        std::memcpy( base.rgba.data() + size_t( y ) * width * 4, rgba + size_t( y ) * stride, size_t( width ) * 4 );
+    }
+    levels.push_back( std::move( base ) );
+
+    for ( uint32_t level = 1; level < levelCount; ++level ) {
+        const MipImage& previous = levels.back();
+        MipImage next = downsample( previous, std::max( 1u, previous.width >> 1 ), std::max( 1u, previous.height >> 1 ), options );
+        levels.push_back( std::move( next ) );
+    }
+    return levels;
+}
+
+MipImage MipGenerator::downsample( const MipImage& source, uint32_t width, uint32_t height, const MipOptions& options ) {
+    MipImage target;
+    target.width = width;
+    target.height = height;
+    target.rgba.resize( size_t( width ) * height * 4 );
+
+    const int sourceWidth = int( source.width );
+    const int sourceHeight = int( source.height );
+    const Contributions horizontal( sourceWidth, int( width ), options.filter );
+    const Contributions vertical( sourceHeight, int( height ), options.filter );
+
+    JobPool::instance().parallelFor( 0, int( height ), kBandRows, [&]( int begin, int end ) {
+        // 这一行带需要的源行 (未环绕的连续区间)
+        int lo = INT_MAX;
+        int hi = INT_MIN;
+        for ( int y = begin; y < end; ++y ) {
+            lo = std::min( lo, vertical.start[y] );
+            hi = std::max( hi, vertical.start[y] + vertical.count[y] );
+        }
+
+        std::vector<float> line( size_t( sourceWidth ) * 4 );
+        std::vector<float> filtered( size_t( hi - lo ) * width * 4 );
+        std::vector<float> row( size_t( width ) * 4 );
+
+        // 水平滤波: 源行 -> filtered 的一行
+        for ( int k = lo; k < hi; ++k ) {
+            const int sy = wrap( k, sourceHeight );
+            loadRow( source.rgba.data() + size_t( sy ) * source.width * 4, source.width, options, line.data() );
+
+            float* out = filtered.data() + size_t( k - lo ) * width * 4;
+            for ( uint32_t x = 0; x < width; ++x ) {
+                const int* index = horizontal.index.data() + horizontal.offset[x];
+                const float* w = horizontal.weights.data() + horizontal.offset[x];
+                Vec4 acc = Vec4::zero();
+                for ( int t = 0; t < horizontal.count[x]; ++t ) {
+                    acc = Vec4::madd( acc, Vec4::load( line.data() + index[t] * 4 ), Vec4::splat( w[t] ) );
+                }
+                acc.store( out + x * 4 );
+            }
+        }
+
+        // 垂直滤波: 按行累加, 访问连续
+        for ( int y = begin; y < end; ++y ) {
+            std::fill( row.begin(), row.end(), 0.0f );
+            const float* w = vertical.weights.data() + vertical.offset[y];
+            for ( int t = 0; t < vertical.count[y]; ++t ) {
+                const float* in = filtered.data() + size_t( vertical.start[y] + t - lo ) * width * 4;
+                const Vec4 weight = Vec4::splat( w[t] );
+                for ( uint32_t x = 0; x < width; ++x ) {
+                    Vec4::madd( Vec4::load( row.data() + x * 4 ), Vec4::load( in + x * 4 ), weight ).store( row.data() + x * 4 );
+                }
+            }
+            storeRow( row.data(), width, options, target.rgba.data() + size_t( y ) * width * 4 );
+        }
+    } );
+
+    return target;
+}
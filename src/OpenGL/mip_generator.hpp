@@ -0,0 +1,41 @@
+// 单一职责: 在 CPU 上生成完整的 mip 链 (盒式 / Kaiser / Lanczos 滤波)
+// 颜色贴图先解码到线性空间再滤波, 带 alpha 时按 alpha 加权, 法线贴图滤波后重新归一化
+// 可分离滤波按行带切分交给 JobPool, 内层累加用 Vec4 (SSE2 / NEON)
+// 输出是紧密排列的 RGBA8, 可以直接交给 TextureCodec 压缩, 也可以直接上传
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum class MipFilter {
+    Box,        // 2x2 平均, 最快, 最模糊
+    Kaiser,     // Kaiser 窗 sinc (半径 3, alpha 4), 默认
+    Lanczos     // Lanczos3, 最锐利, 高对比边缘会有轻微振铃
+};
+
+struct MipOptions {
+    MipFilter filter = MipFilter::Kaiser;
+    bool srgb = false;              // RGB 按 sRGB 编码, 在线性空间滤波
+    bool alphaWeighted = false;     // 按 alpha 加权 (预乘后滤波), 避免透明像素的颜色渗出
+    bool normalMap = false;         // RGB 是 [0, 1] 编码的法线, 滤波后重新归一化
+    uint32_t maxLevels = 0;         // 0 表示一直生成到 1x1
+};
+
+struct MipImage {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> rgba;      // width * height * 4, 行间无填充
+};
+
+class MipGenerator {
+public:
+    // levels[0] 是源图像的拷贝, 之后每级宽高减半 (最小为 1), 与 TextureFormats::mipCount 一致
+    // 纹理按 GL_REPEAT 采样, 边缘按环绕取样
+    static std::vector<MipImage> generate( const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t stride,
+                                           const MipOptions& options );
+
+    // 把 source 缩小到 width x height, 每一级都是从上一级缩小得到
+    static MipImage downsample( const MipImage& source, uint32_t width, uint32_t height, const MipOptions& options );
+
+    static const char* name( MipFilter filter );
+};
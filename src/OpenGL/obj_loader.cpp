@@ -0,0 +1,340 @@
+#include "obj_loader.hpp"
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+// 逐行扫描的只读游标, 不拷贝文件内容
+struct Cursor {
+    const char* p;
+    const char* end;
+
+    void skipSpaces() {
+        while ( p < end && ( *p == ' ' || *p == '\t' || *p == '\r' ) ) ++p;
+    }
+    bool atLineEnd() {
+        skipSpaces();
+        return p >= end || *p == '\n';
+    }
+    void nextLine() {
+        while ( p < end && *p != '\n' ) ++p;
+        if ( p < end ) ++p;
+    }
+    // 读一个以空白结束的词
+    std::string word() {
+        skipSpaces();
+        const char* start = p;
+        while ( p < end && !std::isspace( static_cast<unsigned char>( *p ) ) ) ++p;
+        return std::string( start, p );
+    }
+    // 读到行尾 (去掉首尾空白)
+    std::string rest() {
+        skipSpaces();
+        const char* start = p;
+        while ( p < end && *p != '\n' ) ++p;
+        const char* last = p;
+        while ( last > start && std::isspace( static_cast<unsigned char>( last[-1] ) ) ) --last;
+        return std::string( start, last );
+    }
+
+    // 不依赖 locale 的浮点解析 (QGuiApplication 会调用 setlocale, strtof 可能把 ',' 当小数点)
+    float number() {
+        skipSpaces();
+        bool negative = false;
+        if ( p < end && ( *p == '-' || *p == '+' ) ) { negative = *p == '-'; ++p; }
+        double value = 0.0;
+        while ( p < end && *p >= '0' && *p <= '9' ) { value = value * 10.0 + ( *p - '0' ); ++p; }
+        if ( p < end && *p == '.' ) {
+            ++p;
+            double scale = 0.1;
+            while ( p < end && *p >= '0' && *p <= '9' ) { value += ( *p - '0' ) * scale; scale *= 0.1; ++p; }
+        }
+        if ( p < end && ( *p == 'e' || *p == 'E' ) ) {
+            ++p;
+            bool negativeExponent = false;
+            if ( p < end && ( *p == '-' || *p == '+' ) ) { negativeExponent = *p == '-'; ++p; }
+            int exponent = 0;
+            while ( p < end && *p >= '0' && *p <= '9' ) { exponent = exponent * 10 + ( *p - '0' ); ++p; }
+            value *= std::pow( 10.0, negativeExponent ? -exponent : exponent );
+        }
+        return static_cast<float>( negative ? -value : value );
+    }
+
+    // OBJ 索引: 1 起, 负数表示从末尾倒数, 0 表示缺省
+    int index( int count ) {
+        bool negative = false;
+        if ( p < end && *p == '-' ) { negative = true; ++p; }
+        int value = 0;
+        bool any = false;
+        while ( p < end && *p >= '0' && *p <= '9' ) { value = value * 10 + ( *p - '0' ); ++p; any = true; }
+        if ( !any ) return -1;
+        return negative ? count - value : value - 1;
+    }
+};
+
+bool readFile( const QString& path, QByteArray& data, std::string& error ) {
+    QFile file( path );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        error = "Cannot open " + path.toStdString();
+        return false;
+    }
+    data = file.readAll();
+    return true;
+}
+
+// 贴图行可能带 "-bm 1.0" 之类的选项, 文件名取最后一个词
+QString texturePath( const QDir& dir, const std::string& line ) {
+    const size_t split = line.find_last_of( " \t" );
+    const std::string name = split == std::string::npos ? line : line.substr( split + 1 );
+    if ( name.empty() ) return QString();
+    return dir.filePath( QString::fromStdString( name ) );
+}
+
+bool equalsIgnoreCase( const std::string& a, const char* b ) {
+    const size_t n = std::strlen( b );
+    if ( a.size() != n ) return false;
+    for ( size_t i = 0; i < n; ++i ) {
+        if ( std::tolower( static_cast<unsigned char>( a[i] ) ) != std::tolower( static_cast<unsigned char>( b[i] ) ) ) return false;
+    }
+    return true;
+}
+
+struct CornerKey {
+    int position;
+    int texCoord;
+    int normal;
+    bool operator==( const CornerKey& other ) const {
+        return position == other.position && texCoord == other.texCoord && normal == other.normal;
+    }
+};
+
+struct CornerHash {
+    size_t operator()( const CornerKey& key ) const {
+        uint64_t h = uint32_t( key.position );
+        h = h * 0x9E3779B97F4A7C15ull ^ uint32_t( key.texCoord );
+        h = h * 0x9E3779B97F4A7C15ull ^ uint32_t( key.normal );
+        return static_cast<size_t>( h ^ ( h >> 29 ) );
+    }
+};
+
+} // namespace
+
+bool ObjLoader::load( const QString& path, ObjModel& model, std::string& error ) {
+    QByteArray data;
+    if ( !readFile( path, data, error ) ) {
+        return false;
+    }
+
+    model = ObjModel();
+    const QDir dir = QFileInfo( path ).dir();
+
+    std::vector<QVector3D> positions;
+    std::vector<QVector2D> texCoords;
+    std::vector<QVector3D> normals;
+    std::unordered_map<CornerKey, uint32_t, CornerHash> corners;
+    std::unordered_map<std::string, int> materialIndex;
+    std::vector<int> vertexPosition;            // 输出顶点对应的 v 下标, 用于生成法线
+    std::vector<uint32_t> face;
+    bool missingNormals = false;
+
+    auto beginSubmesh = [&model]( int material ) {
+        ObjSubmesh submesh;
+        submesh.firstIndex = static_cast<uint32_t>( model.mesh.indices.size() );
+        submesh.material = material;
+        if ( !model.submeshes.empty() && model.submeshes.back().indexCount == 0 ) {
+            model.submeshes.back() = submesh;
+        } else {
+            model.submeshes.push_back( submesh );
+        }
+    };
+    beginSubmesh( -1 );
+
+    Cursor cursor{ data.constData(), data.constData() + data.size() };
+    while ( cursor.p < cursor.end ) {
+        const std::string keyword = cursor.word();
+
+        if ( keyword == "v" ) {
+            const float x = cursor.number();
+            const float y = cursor.number();
+            const float z = cursor.number();
+            positions.emplace_back( x, y, z );
+        } else if ( keyword == "vt" ) {
+            const float u = cursor.number();
+            const float v = cursor.number();
+            // OBJ 的 v 轴向上, 翻转后与图像首行在上的存储顺序一致, 上传时不需要再镜像图像
+            texCoords.emplace_back( u, 1.0f - v );
+        } else if ( keyword == "vn" ) {
+            const float x = cursor.number();
+            const float y = cursor.number();
+            const float z = cursor.number();
+            normals.emplace_back( x, y, z );
+        } else if ( keyword == "f" ) {
+            face.clear();
+            while ( !cursor.atLineEnd() ) {
+                CornerKey key{ cursor.index( int( positions.size() ) ), -1, -1 };
+                if ( cursor.p < cursor.end && *cursor.p == '/' ) {
+                    ++cursor.p;
+                    key.texCoord = cursor.index( int( texCoords.size() ) );
+                    if ( cursor.p < cursor.end && *cursor.p == '/' ) {
+                        ++cursor.p;
+                        key.normal = cursor.index( int( normals.size() ) );
+                    }
+                }
+                // 位置索引越界视为文件损坏, 纹理坐标/法线越界按缺省处理
+                if ( key.position < 0 || key.position >= int( positions.size() ) ) {
+                    error = "Invalid face index in " + path.toStdString();
+                    return false;
+                }
+                if ( key.texCoord >= int( texCoords.size() ) ) key.texCoord = -1;
+                if ( key.normal >= int( normals.size() ) ) key.normal = -1;
+                // 跳过无法解析的字符, 防止死循环
+                while ( cursor.p < cursor.end && !std::isspace( static_cast<unsigned char>( *cursor.p ) ) ) ++cursor.p;
+
+                auto found = corners.find( key );
+                if ( found == corners.end() ) {
+                    MeshVertex vertex;
+                    vertex.position = positions[key.position];
+                    if ( key.texCoord >= 0 ) vertex.texCoord = texCoords[key.texCoord];
+                    if ( key.normal >= 0 ) vertex.normal = normals[key.normal];
+                    else missingNormals = true;
+
+                    const uint32_t index = static_cast<uint32_t>( model.mesh.vertices.size() );
+                    model.mesh.vertices.push_back( vertex );
+                    vertexPosition.push_back( key.position );
+                    found = corners.emplace( key, index ).first;
+                }
+                face.push_back( found->second );
+            }
+            // 扇形三角化
+            for ( size_t i = 2; i < face.size(); ++i ) {
+                model.mesh.indices.push_back( face[0] );
+                model.mesh.indices.push_back( face[i - 1] );
+                model.mesh.indices.push_back( face[i] );
+            }
+            if ( face.size() >= 3 ) {
+                model.submeshes.back().indexCount += static_cast<uint32_t>( ( face.size() - 2 ) * 3 );
+            }
+        } else if ( keyword == "usemtl" ) {
+            const std::string name = cursor.rest();
+            auto found = materialIndex.find( name );
+            int material = -1;
+            if ( found != materialIndex.end() ) {
+                material = found->second;
+            } else {
+                // mtllib 可能缺失, 先登记名字, 保持 usemtl 分段
+                material = static_cast<int>( model.materials.size() );
+                ObjMaterial placeholder;
+                placeholder.name = name;
+                model.materials.push_back( placeholder );
+                materialIndex.emplace( name, material );
+            }
+            beginSubmesh( material );
+        } else if ( keyword == "mtllib" ) {
+            const QString libraryPath = dir.filePath( QString::fromStdString( cursor.rest() ) );
+            std::vector<ObjMaterial> library;
+            std::string libraryError;
+            if ( loadMaterials( libraryPath, library, libraryError ) ) {
+                for ( ObjMaterial& material : library ) {
+                    auto found = materialIndex.find( material.name );
+                    if ( found != materialIndex.end() ) {
+                        model.materials[found->second] = std::move( material );
+                    } else {
+                        materialIndex.emplace( material.name, int( model.materials.size() ) );
+                        model.materials.push_back( std::move( material ) );
+                    }
+                }
+            }
+            // 材质库读不到时仍然加载几何体, 使用默认材质
+        }
+        cursor.nextLine();
+    }
+
+    if ( model.submeshes.back().indexCount == 0 ) {
+        model.submeshes.pop_back();
+    }
+    // 只有 mtllib 没有 usemtl 时, 整个网格使用第一个材质
+    if ( model.submeshes.size() == 1 && model.submeshes[0].material < 0 && !model.materials.empty() ) {
+        model.submeshes[0].material = 0;
+    }
+
+    if ( model.mesh.isEmpty() ) {
+        error = "No faces in " + path.toStdString();
+        return false;
+    }
+
+    if ( missingNormals ) {
+        // 按 v 下标累加面法线 (叉积长度即两倍面积), 纹理接缝两侧的顶点得到相同的法线
+        std::vector<QVector3D> accumulated( positions.size() );
+        const std::vector<uint32_t>& indices = model.mesh.indices;
+        for ( size_t i = 0; i + 2 < indices.size(); i += 3 ) {
+            const int a = vertexPosition[indices[i]];
+            const int b = vertexPosition[indices[i + 1]];
+            const int c = vertexPosition[indices[i + 2]];
+            const QVector3D n = QVector3D::crossProduct( positions[b] - positions[a], positions[c] - positions[a] );
+            accumulated[a] += n;
+            accumulated[b] += n;
+            accumulated[c] += n;
+        }
+        for ( size_t i = 0; i < model.mesh.vertices.size(); ++i ) {
+            MeshVertex& vertex = model.mesh.vertices[i];
+            if ( vertex.normal.isNull() ) {
+                vertex.normal = accumulated[vertexPosition[i]].normalized();
+            }
+        }
+    }
+
+    model.mesh.computeBounds();
+    return true;
+}
+
+bool ObjLoader::loadMaterials( const QString& path, std::vector<ObjMaterial>& materials, std::string& error ) {
+    QByteArray data;
+    if ( !readFile( path, data, error ) ) {
+        return false;
+    }
+
+    const QDir dir = QFileInfo( path ).dir();
+    ObjMaterial* current = nullptr;
+
+    Cursor cursor{ data.constData(), data.constData() + data.size() };
+    while ( cursor.p < cursor.end ) {
+        const std::string keyword = cursor.word();
+
+        if ( keyword == "newmtl" ) {
+            materials.emplace_back();
+            current = &materials.back();
+            current->name = cursor.rest();
+        } else if ( current ) {
+            if ( keyword == "Kd" ) {
+                const float r = cursor.number();
+                const float g = cursor.number();
+                const float b = cursor.number();
+                current->diffuse = QVector3D( r, g, b );
+            } else if ( keyword == "Pm" ) {
+                current->metallic = cursor.number();
+            } else if ( keyword == "Pr" ) {
+                current->roughness = cursor.number();
+            } else if ( keyword == "map_Kd" ) {
+                current->diffuseMap = texturePath( dir, cursor.rest() );
+            } else if ( keyword == "map_Pm" ) {
+                current->metallicMap = texturePath( dir, cursor.rest() );
+            } else if ( keyword == "map_Pr" ) {
+                current->roughnessMap = texturePath( dir, cursor.rest() );
+            } else if ( equalsIgnoreCase( keyword, "map_ao" ) ) {
+                current->aoMap = texturePath( dir, cursor.rest() );
+            } else if ( equalsIgnoreCase( keyword, "map_bump" ) || keyword == "bump" || keyword == "norm" ) {
+                current->normalMap = texturePath( dir, cursor.rest() );
+            }
+        }
+        cursor.nextLine();
+    }
+
+    return true;
+}
@@ -0,0 +1,46 @@
+// 单一职责: 解析 Wavefront OBJ + MTL, 输出去重后的索引网格和材质描述
+// 只读取渲染需要的字段 (v/vt/vn/f/usemtl/mtllib), 其余行忽略
+#pragma once
+
+#include "mesh_data.hpp"
+
+#include <QString>
+#include <QVector3D>
+#include <string>
+#include <vector>
+
+// MTL 中的一个材质, 贴图路径已解析为相对 MTL 所在目录的完整路径 (没有则为空)
+struct ObjMaterial {
+    std::string name;
+    QVector3D diffuse{ 1.0f, 1.0f, 1.0f };     // Kd
+    float metallic = 0.0f;                      // Pm
+    float roughness = 0.5f;                     // Pr
+    QString diffuseMap;                         // map_Kd
+    QString metallicMap;                        // map_Pm
+    QString roughnessMap;                       // map_Pr
+    QString aoMap;                              // map_ao (非标准, 常见导出器的写法)
+    QString normalMap;                          // map_Bump / bump / norm
+};
+
+// 使用同一材质的一段连续索引
+struct ObjSubmesh {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int material = -1;                          // materials 下标, -1 表示没有材质
+};
+
+struct ObjModel {
+    MeshData mesh;
+    std::vector<ObjSubmesh> submeshes;
+    std::vector<ObjMaterial> materials;
+};
+
+class ObjLoader {
+public:
+    // path 可以是磁盘路径或 qrc 路径 (":/...")
+    // 文件没有法线时按面积加权生成平滑法线, 多边形面按扇形拆成三角形
+    // 纹理坐标的 v 会翻转成图像行序 (首行 v = 0)
+    static bool load( const QString& path, ObjModel& model, std::string& error );
+
+    static bool loadMaterials( const QString& path, std::vector<ObjMaterial>& materials, std::string& error );
+};
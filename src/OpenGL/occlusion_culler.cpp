@@ -0,0 +1,281 @@
+#include "occlusion_culler.hpp"
+#include "job_pool.hpp"
+#include "simd_vec4.hpp"
+
+#include <QVector4D>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 每个并行任务负责的行数, 条带之间不共享像素, 不需要同步
+constexpr int kBandRows = 16;
+
+// w 小于它的顶点视为在近平面附近或之后
+constexpr float kMinW = 1e-4f;
+
+// 选择 Hi-Z 级别时, 包围盒在该级别上最多覆盖的纹素数 (每个方向)
+constexpr int kMaxTestTexels = 4;
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller( int width, int height )
+    : m_width( std::max( 4, width & ~3 ) )
+    , m_height( std::max( 1, height ) )
+{
+    // 奇数尺寸向上取整, 多出的纹素取边缘的值, 保持保守
+    int w = m_width;
+    int h = m_height;
+    m_levelSizes.emplace_back( w, h );
+    while ( w > 1 || h > 1 ) {
+        w = std::max( 1, ( w + 1 ) / 2 );
+        h = std::max( 1, ( h + 1 ) / 2 );
+        m_levelSizes.emplace_back( w, h );
+    }
+    m_levels.resize( m_levelSizes.size() );
+    for ( size_t level = 0; level < m_levels.size(); ++level ) {
+        m_levels[level].assign( size_t( m_levelSizes[level].first ) * m_levelSizes[level].second, 1.0f );
+    }
+}
+
+void OcclusionCuller::begin( const QMatrix4x4& viewProjection ) {
+    m_viewProjection = viewProjection;
+    m_occluders.clear();
+    m_stats = OcclusionStats();
+}
+
+void OcclusionCuller::addOccluder( const QMatrix4x4& model, const MeshData& mesh ) {
+    Occluder occluder;
+    occluder.transform = m_viewProjection * model;
+    occluder.mesh = &mesh;
+    occluder.firstTriangle = m_occluders.empty()
+        ? 0 : m_occluders.back().firstTriangle + uint32_t( m_occluders.back().mesh->indices.size() / 3 );
+    m_occluders.push_back( occluder );
+}
+
+void OcclusionCuller::rasterize( bool simd, bool parallel ) {
+    const uint32_t triangleCount = m_occluders.empty()
+        ? 0 : m_occluders.back().firstTriangle + uint32_t( m_occluders.back().mesh->indices.size() / 3 );
+    m_triangles.resize( triangleCount );
+    m_stats.occluders = uint32_t( m_occluders.size() );
+
+    const int bands = ( m_height + kBandRows - 1 ) / kBandRows;
+    JobPool& pool = JobPool::instance();
+    if ( parallel ) {
+        pool.parallelFor( 0, int( m_occluders.size() ), 4, [this]( int begin, int end ) {
+            for ( int i = begin; i < end; ++i ) setupOccluder( m_occluders[i] );
+        } );
+    } else {
+        for ( const Occluder& occluder : m_occluders ) setupOccluder( occluder );
+    }
+    for ( const Triangle& triangle : m_triangles ) {
+        if ( triangle.minY <= triangle.maxY ) ++m_stats.triangles;
+    }
+
+    // 每个条带先清空再光栅化自己的行
+    const auto rasterizeBands = [this, simd]( int begin, int end ) {
+        for ( int band = begin; band < end; ++band ) {
+            rasterizeBand( band * kBandRows, std::min( m_height, ( band + 1 ) * kBandRows ) - 1, simd );
+        }
+    };
+    if ( parallel ) {
+        pool.parallelFor( 0, bands, 1, rasterizeBands );
+    } else {
+        rasterizeBands( 0, bands );
+    }
+
+    // 逐级生成 Hi-Z, 级别之间有依赖, 级别内按行并行
+    for ( int level = 1; level < levelCount(); ++level ) {
+        const int rows = levelHeight( level );
+        if ( parallel && rows >= kBandRows ) {
+            pool.parallelFor( 0, rows, kBandRows / 2, [this, level]( int begin, int end ) {
+                buildLevel( level, begin, end - 1 );
+            } );
+        } else {
+            buildLevel( level, 0, rows - 1 );
+        }
+    }
+}
+
+void OcclusionCuller::setupOccluder( const Occluder& occluder ) {
+    const MeshData& mesh = *occluder.mesh;
+    const float halfWidth = 0.5f * float( m_width );
+    const float halfHeight = 0.5f * float( m_height );
+
+    for ( size_t first = 0; first + 2 < mesh.indices.size(); first += 3 ) {
+        Triangle& triangle = m_triangles[occluder.firstTriangle + first / 3];
+        triangle.minY = 1;
+        triangle.maxY = 0;
+
+        // 任何一个顶点在近平面之前就放弃这个三角形: 少画遮挡体只会少剔除, 不会出错
+        float x[3], y[3], z[3];
+        bool clipped = false;
+        for ( int i = 0; i < 3; ++i ) {
+            const QVector4D clip = occluder.transform * QVector4D( mesh.vertices[mesh.indices[first + i]].position, 1.0f );
+            if ( clip.w() < kMinW || clip.z() < -clip.w() ) {
+                clipped = true;
+                break;
+            }
+            const float invW = 1.0f / clip.w();
+            x[i] = ( clip.x() * invW + 1.0f ) * halfWidth;
+            y[i] = ( clip.y() * invW + 1.0f ) * halfHeight;
+            z[i] = std::min( clip.z() * invW * 0.5f + 0.5f, 1.0f );
+        }
+        if ( clipped ) continue;
+
+        // 背面或退化
+        const float area = ( x[1] - x[0] ) * ( y[2] - y[0] ) - ( x[2] - x[0] ) * ( y[1] - y[0] );
+        if ( area <= 0.0f ) continue;
+
+        const int minX = std::max( 0, int( std::floor( std::min( { x[0], x[1], x[2] } ) ) ) );
+        const int maxX = std::min( m_width - 1, int( std::floor( std::max( { x[0], x[1], x[2] } ) ) ) );
+        const int minY = std::max( 0, int( std::floor( std::min( { y[0], y[1], y[2] } ) ) ) );
+        const int maxY = std::min( m_height - 1, int( std::floor( std::max( { y[0], y[1], y[2] } ) ) ) );
+        if ( minX > maxX || minY > maxY ) continue;
+
+        // 边 i 与顶点 i 相对, 边函数除以面积后就是顶点 i 的重心坐标
+        const float invArea = 1.0f / area;
+        float depthA = 0.0f, depthB = 0.0f, depthC = 0.0f;
+        for ( int i = 0; i < 3; ++i ) {
+            const int a = ( i + 1 ) % 3;
+            const int b = ( i + 2 ) % 3;
+            const float edgeA = y[a] - y[b];
+            const float edgeB = x[b] - x[a];
+            const float edgeC = -( edgeA * x[a] + edgeB * y[a] );
+            triangle.edge[i][0] = edgeA;
+            triangle.edge[i][1] = edgeB;
+            triangle.edge[i][2] = edgeC;
+            depthA += edgeA * invArea * z[i];
+            depthB += edgeB * invArea * z[i];
+            depthC += edgeC * invArea * z[i];
+        }
+        triangle.depth[0] = depthA;
+        triangle.depth[1] = depthB;
+        triangle.depth[2] = depthC;
+        triangle.minX = minX;
+        triangle.minY = minY;
+        triangle.maxX = maxX;
+        triangle.maxY = maxY;
+    }
+}
+
+void OcclusionCuller::rasterizeBand( int firstRow, int lastRow, bool simd ) {
+    float* depth = m_levels[0].data();
+    std::fill( depth + size_t( firstRow ) * m_width, depth + size_t( lastRow + 1 ) * m_width, 1.0f );
+
+    static const float kLaneOffsets[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+    const Vec4 laneOffsets = Vec4::load( kLaneOffsets );
+    const Vec4 zero = Vec4::zero();
+
+    for ( const Triangle& triangle : m_triangles ) {
+        const int rowBegin = std::max( firstRow, triangle.minY );
+        const int rowEnd = std::min( lastRow, triangle.maxY );
+        if ( rowBegin > rowEnd ) continue;
+
+        for ( int row = rowBegin; row <= rowEnd; ++row ) {
+            // 同一行的 B y + C 只算一次, 标量和 SIMD 的运算顺序相同, 结果逐位一致
+            const float py = float( row ) + 0.5f;
+            const float row0 = triangle.edge[0][1] * py + triangle.edge[0][2];
+            const float row1 = triangle.edge[1][1] * py + triangle.edge[1][2];
+            const float row2 = triangle.edge[2][1] * py + triangle.edge[2][2];
+            const float rowDepth = triangle.depth[1] * py + triangle.depth[2];
+            float* line = depth + size_t( row ) * m_width;
+
+            if ( simd ) {
+                // 从 4 对齐的列开始, width 是 4 的倍数, 不会越界
+                for ( int x = triangle.minX & ~3; x <= triangle.maxX; x += 4 ) {
+                    const Vec4 px = Vec4::splat( float( x ) ) + laneOffsets;
+                    const Vec4 e0 = Vec4::madd( Vec4::splat( row0 ), Vec4::splat( triangle.edge[0][0] ), px );
+                    const Vec4 e1 = Vec4::madd( Vec4::splat( row1 ), Vec4::splat( triangle.edge[1][0] ), px );
+                    const Vec4 e2 = Vec4::madd( Vec4::splat( row2 ), Vec4::splat( triangle.edge[2][0] ), px );
+                    const Vec4 inside = Vec4::lessEqual( zero, Vec4::min( e0, Vec4::min( e1, e2 ) ) );
+                    const Vec4 z = Vec4::madd( Vec4::splat( rowDepth ), Vec4::splat( triangle.depth[0] ), px );
+                    const Vec4 current = Vec4::load( line + x );
+                    Vec4::select( inside, Vec4::min( current, z ), current ).store( line + x );
+                }
+            } else {
+                // 与 SIMD 路径遍历同样的像素 (整块 4 个)
+                for ( int x = triangle.minX & ~3; x <= ( triangle.maxX | 3 ); ++x ) {
+                    const float px = float( x ) + 0.5f;
+                    const float e0 = row0 + triangle.edge[0][0] * px;
+                    const float e1 = row1 + triangle.edge[1][0] * px;
+                    const float e2 = row2 + triangle.edge[2][0] * px;
+                    if ( std::min( e0, std::min( e1, e2 ) ) < 0.0f ) continue;
+                    line[x] = std::min( line[x], rowDepth + triangle.depth[0] * px );
+                }
+            }
+        }
+    }
+}
+
+void OcclusionCuller::buildLevel( int level, int firstRow, int lastRow ) {
+    const std::vector<float>& source = m_levels[level - 1];
+    const int sourceWidth = levelWidth( level - 1 );
+    const int sourceHeight = levelHeight( level - 1 );
+    const int width = levelWidth( level );
+    std::vector<float>& target = m_levels[level];
+
+    for ( int y = firstRow; y <= lastRow; ++y ) {
+        const float* row0 = source.data() + size_t( std::min( 2 * y, sourceHeight - 1 ) ) * sourceWidth;
+        const float* row1 = source.data() + size_t( std::min( 2 * y + 1, sourceHeight - 1 ) ) * sourceWidth;
+        for ( int x = 0; x < width; ++x ) {
+            const int x0 = std::min( 2 * x, sourceWidth - 1 );
+            const int x1 = std::min( 2 * x + 1, sourceWidth - 1 );
+            target[size_t( y ) * width + x] = std::max( std::max( row0[x0], row0[x1] ), std::max( row1[x0], row1[x1] ) );
+        }
+    }
+}
+
+bool OcclusionCuller::screenBounds( const QMatrix4x4& model, const QVector3D& boundsMin, const QVector3D& boundsMax,
+                                    ScreenBounds& bounds ) const {
+    const QMatrix4x4 transform = m_viewProjection * model;
+    float minX = float( m_width ), minY = float( m_height ), maxX = 0.0f, maxY = 0.0f;
+    float minDepth = 1.0f;
+    for ( int corner = 0; corner < 8; ++corner ) {
+        const QVector4D position( corner & 1 ? boundsMax.x() : boundsMin.x(),
+                                  corner & 2 ? boundsMax.y() : boundsMin.y(),
+                                  corner & 4 ? boundsMax.z() : boundsMin.z(), 1.0f );
+        const QVector4D clip = transform * position;
+        if ( clip.w() < kMinW ) return false;
+        const float invW = 1.0f / clip.w();
+        const float x = ( clip.x() * invW + 1.0f ) * 0.5f * float( m_width );
+        const float y = ( clip.y() * invW + 1.0f ) * 0.5f * float( m_height );
+        minX = std::min( minX, x );
+        maxX = std::max( maxX, x );
+        minY = std::min( minY, y );
+        maxY = std::max( maxY, y );
+        minDepth = std::min( minDepth, clip.z() * invW * 0.5f + 0.5f );
+    }
+    if ( maxX < 0.0f || maxY < 0.0f || minX >= float( m_width ) || minY >= float( m_height ) ) return false;
+
+    bounds.minX = std::max( 0, int( std::floor( minX ) ) );
+    bounds.minY = std::max( 0, int( std::floor( minY ) ) );
+    bounds.maxX = std::min( m_width - 1, int( std::floor( maxX ) ) );
+    bounds.maxY = std::min( m_height - 1, int( std::floor( maxY ) ) );
+    bounds.minDepth = minDepth;
+    return true;
+}
+
+bool OcclusionCuller::isOccluded( const QMatrix4x4& model, const QVector3D& boundsMin, const QVector3D& boundsMax ) {
+    ++m_stats.tested;
+    ScreenBounds bounds;
+    if ( !screenBounds( model, boundsMin, boundsMax, bounds ) ) return false;
+
+    // 选一个让包围盒只覆盖几个纹素的级别, 纹素存的是区域内最远的遮挡深度
+    int level = 0;
+    while ( level + 1 < levelCount()
+            && ( ( bounds.maxX >> level ) - ( bounds.minX >> level ) >= kMaxTestTexels
+                 || ( bounds.maxY >> level ) - ( bounds.minY >> level ) >= kMaxTestTexels ) ) {
+        ++level;
+    }
+
+    const std::vector<float>& depth = m_levels[level];
+    const int width = levelWidth( level );
+    for ( int y = bounds.minY >> level; y <= bounds.maxY >> level; ++y ) {
+        for ( int x = bounds.minX >> level; x <= bounds.maxX >> level; ++x ) {
+            if ( depth[size_t( y ) * width + x] >= bounds.minDepth ) return false;
+        }
+    }
+    ++m_stats.culled;
+    return true;
+}
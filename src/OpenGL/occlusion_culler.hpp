@@ -0,0 +1,88 @@
+// 单一职责: 软件遮挡剔除, 不依赖任何 GPU 查询 (llvmpipe 上同样高效)
+// 选出的遮挡体在 CPU 上光栅化成低分辨率深度缓冲, 每次用 Vec4 处理 4 个像素, 缓冲按水平条带交给 JobPool 并行
+// 深度缓冲逐级取最远深度生成 Hi-Z 金字塔, 物体包围盒投影后在合适的级别上比较, 完全在遮挡体之后的物体不提交给 GL
+// 深度为 NDC z 映射到 [0, 1], 行从屏幕底部开始 (与 GL 窗口坐标一致)
+#pragma once
+
+#include "mesh_data.hpp"
+
+#include <QMatrix4x4>
+#include <cstdint>
+#include <vector>
+
+struct OcclusionStats {
+    uint32_t occluders = 0;
+    uint32_t triangles = 0;     // 背面和近平面剔除后实际光栅化的三角形
+    uint32_t tested = 0;
+    uint32_t culled = 0;
+};
+
+// 包围盒在深度缓冲上覆盖的像素范围 (闭区间) 和最近的深度
+struct ScreenBounds {
+    int minX = 0;
+    int minY = 0;
+    int maxX = 0;
+    int maxY = 0;
+    float minDepth = 0.0f;
+};
+
+class OcclusionCuller {
+public:
+    // width 需为 4 的倍数, 两者都取 2 的幂时 Hi-Z 每级正好减半
+    explicit OcclusionCuller( int width = 256, int height = 128 );
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    // 每帧开始时调用, 清空遮挡体和统计
+    void begin( const QMatrix4x4& viewProjection );
+
+    // 遮挡体必须是封闭的, 逆时针为正面, 且不超出它所代表的物体; mesh 要保持有效直到 rasterize() 返回
+    void addOccluder( const QMatrix4x4& model, const MeshData& mesh );
+
+    // 光栅化全部遮挡体并生成 Hi-Z; simd / parallel 为 false 只用于校验和 benchmark
+    void rasterize( bool simd = true, bool parallel = true );
+
+    // 包围盒 (模型空间) 完全被遮挡时返回 true; 穿过近平面或在屏幕外的包围盒一律视为可见
+    bool isOccluded( const QMatrix4x4& model, const QVector3D& boundsMin, const QVector3D& boundsMax );
+
+    // 包围盒投影到深度缓冲上, 穿过近平面或完全在屏幕外时返回 false
+    bool screenBounds( const QMatrix4x4& model, const QVector3D& boundsMin, const QVector3D& boundsMax,
+                       ScreenBounds& bounds ) const;
+
+    // 第 0 级是光栅化的深度缓冲, 之后每级取 2x2 中最远的深度
+    int levelCount() const { return int( m_levels.size() ); }
+    int levelWidth( int level ) const { return m_levelSizes[level].first; }
+    int levelHeight( int level ) const { return m_levelSizes[level].second; }
+    const std::vector<float>& level( int level ) const { return m_levels[level]; }
+
+    const OcclusionStats& stats() const { return m_stats; }
+
+private:
+    struct Occluder {
+        QMatrix4x4 transform;           // viewProjection * model
+        const MeshData* mesh = nullptr;
+        uint32_t firstTriangle = 0;     // 在 m_triangles 中的起点
+    };
+
+    // 屏幕空间的三角形: 三条边的边函数和深度平面, 都以像素中心为采样点
+    struct Triangle {
+        float edge[3][3];               // A B C, 三角形内部 A x + B y + C >= 0
+        float depth[3];                 // depth = A x + B y + C
+        int minX, minY, maxX, maxY;     // 像素范围, minY > maxY 表示已剔除
+    };
+
+    void setupOccluder( const Occluder& occluder );
+    void rasterizeBand( int firstRow, int lastRow, bool simd );
+    void buildLevel( int level, int firstRow, int lastRow );
+
+    int m_width;
+    int m_height;
+    QMatrix4x4 m_viewProjection;
+
+    std::vector<Occluder> m_occluders;
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<float>> m_levels;
+    std::vector<std::pair<int, int>> m_levelSizes;
+    OcclusionStats m_stats;
+};
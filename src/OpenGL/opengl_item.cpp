@@ -38,6 +38,8 @@ void OpenGLItem::setRenderType( const QString& type ) {
     if ( type == m_rendererType ) return;
 
     m_rendererType = type;
+    // 不同渲染器使用各自的着色器和绘制配置
+    m_config = RenderFactory::defaultConfig( type.toStdString() );
 
     emit renderTypeChanged();
     update();
@@ -48,6 +50,12 @@ void OpenGLItem::setRenderConfig( const RenderConfig& config ) {
     update();
 }
 
+void OpenGLItem::setSubmissionStats( const QVariantMap& stats ) {
+    if ( stats == m_submissionStats ) return;
+    m_submissionStats = stats;
+    emit submissionStatsChanged();
+}
+
 /*
 
 
@@ -7,11 +7,13 @@
 #include <QBasicTimer>
 #include <QOpenGLBuffer>
 #include <QOpenGLShaderProgram>
+#include <QVariantMap>
 
 class OpenGLItem : public QQuickFramebufferObject {
     Q_OBJECT
     Q_PROPERTY(int fps READ fps WRITE setFps NOTIFY fpsChanged FINAL)
     Q_PROPERTY(QString renderType READ renderType WRITE setRenderType NOTIFY renderTypeChanged FINAL)
+    Q_PROPERTY(QVariantMap submissionStats READ submissionStats NOTIFY submissionStatsChanged FINAL)
 
 public:
     OpenGLItem();
@@ -27,6 +29,9 @@ public:
     QString renderType() const { return m_rendererType; }
     void setRenderType( const QString& type );
 
+    // 绘制排序前后的 program/纹理 切换次数 由渲染线程定期回传
+    QVariantMap submissionStats() const { return m_submissionStats; }
+
     // 依赖注入接口
     void setRenderer(std::unique_ptr<IRenderer> renderer);
 
@@ -38,6 +43,10 @@ signals:
     void fpsChanged();
     void renderTypeChanged();
     void renderError( const QString& message );
+    void submissionStatsChanged();
+
+private slots:
+    void setSubmissionStats( const QVariantMap& stats );
 
 private:
     RenderConfig m_config;
@@ -46,6 +55,7 @@ private:
     QTime m_lastTime;
     QBasicTimer m_timer;
     QString m_rendererType;
+    QVariantMap m_submissionStats;
     quint64 m_frameNumer;
 
     bool m_rendererInitialized;
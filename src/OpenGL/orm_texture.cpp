@@ -0,0 +1,98 @@
+#include "orm_texture.hpp"
+#include "job_pool.hpp"
+#include "pixel_convert.hpp"
+
+#include <QDebug>
+#include <vector>
+
+namespace {
+
+QImage loadGray( const QString& path, const char* what ) {
+    if ( path.isEmpty() ) {
+        return QImage();
+    }
+    QImage image( path );
+    if ( image.isNull() ) {
+        qDebug() << "ORM: cannot load" << what << "map" << path;
+        return QImage();
+    }
+    return image;
+}
+
+// 转成与目标同尺寸的 8 位单通道图, 空图保持为空
+// 彩色图取 R 通道 (灰度贴图三个通道相同), 不做亮度加权
+QImage toChannel( const QImage& image, const QSize& size ) {
+    if ( image.isNull() ) {
+        return QImage();
+    }
+    QImage gray;
+    if ( image.format() == QImage::Format_Grayscale8 ) {
+        gray = image;
+    } else {
+        const QImage rgba = image.convertToFormat( QImage::Format_RGBA8888 );
+        gray = QImage( rgba.size(), QImage::Format_Grayscale8 );
+        uchar* bits = gray.bits();
+        const qsizetype bytesPerLine = gray.bytesPerLine();
+        for ( int y = 0; y < rgba.height(); ++y ) {
+            PixelConvert::extractChannel( rgba.constScanLine( y ), bits + y * bytesPerLine, size_t( rgba.width() ), 0 );
+        }
+    }
+    if ( gray.size() != size ) {
+        gray = gray.scaled( size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+    }
+    return gray;
+}
+
+uchar toByte( float value ) {
+    return static_cast<uchar>( qBound( 0, qRound( value * 255.0f ), 255 ) );
+}
+
+} // namespace
+
+QImage OrmTexture::pack( const OrmSources& sources ) {
+    return pack( loadGray( sources.aoPath, "ao" ),
+                 loadGray( sources.roughnessPath, "roughness" ),
+                 loadGray( sources.metallicPath, "metallic" ),
+                 sources.roughness, sources.metallic );
+}
+
+QImage OrmTexture::pack( const QImage& ao, const QImage& roughness, const QImage& metallic,
+                         float defaultRoughness, float defaultMetallic ) {
+    QSize size( 1, 1 );
+    for ( const QImage* image : { &ao, &roughness, &metallic } ) {
+        if ( !image->isNull() ) {
+            size = QSize( qMax( size.width(), image->width() ), qMax( size.height(), image->height() ) );
+        }
+    }
+
+    const QImage aoChannel = toChannel( ao, size );
+    const QImage roughnessChannel = toChannel( roughness, size );
+    const QImage metallicChannel = toChannel( metallic, size );
+
+    const uchar aoDefault = 255;
+    const uchar roughnessDefault = toByte( defaultRoughness );
+    const uchar metallicDefault = toByte( defaultMetallic );
+
+    QImage packed( size, QImage::Format_RGBX8888 );
+    // 先在当前线程取得可写指针, 工作线程里调用 scanLine() 会触发 detach 检查
+    uchar* bits = packed.bits();
+    const qsizetype bytesPerLine = packed.bytesPerLine();
+
+    // 缺失的通道用一行常量代替, 交织内核不需要分支
+    const size_t width = size_t( size.width() );
+    const std::vector<uchar> aoRow( width, aoDefault );
+    const std::vector<uchar> roughnessRow( width, roughnessDefault );
+    const std::vector<uchar> metallicRow( width, metallicDefault );
+
+    // 4096x4096 的贴图逐行交给任务池
+    JobPool::instance().parallelFor( 0, size.height(), 64, [&]( int begin, int end ) {
+        for ( int y = begin; y < end; ++y ) {
+            const uchar* a = aoChannel.isNull() ? aoRow.data() : aoChannel.constScanLine( y );
+            const uchar* r = roughnessChannel.isNull() ? roughnessRow.data() : roughnessChannel.constScanLine( y );
+            const uchar* m = metallicChannel.isNull() ? metallicRow.data() : metallicChannel.constScanLine( y );
+            PixelConvert::interleave( a, r, m, bits + y * bytesPerLine, width );
+        }
+    } );
+
+    return packed;
+}
@@ -0,0 +1,25 @@
+// 单一职责: 导入时把 AO / 粗糙度 / 金属度 三张灰度图打包成一张 ORM 纹理
+// 通道约定与 glTF 一致: R = AO, G = roughness, B = metallic
+// 着色时一次采样拿到三个参数, 显存只占一张 RGBA8 (分开上传时每张灰度图同样会按 RGBA8 存放)
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+struct OrmSources {
+    QString aoPath;             // 为空或读取失败时 AO 取 1.0
+    QString roughnessPath;      // 为空或读取失败时使用 roughness
+    QString metallicPath;       // 为空或读取失败时使用 metallic
+    float roughness = 0.5f;
+    float metallic = 0.0f;
+};
+
+class OrmTexture {
+public:
+    // 输出 Format_RGBX8888, 尺寸取输入贴图中最大的一张 (都没有时为 1x1)
+    // 尺寸不同的贴图先缩放到同一尺寸再打包
+    static QImage pack( const OrmSources& sources );
+
+    static QImage pack( const QImage& ao, const QImage& roughness, const QImage& metallic,
+                        float defaultRoughness, float defaultMetallic );
+};
@@ -0,0 +1,501 @@
+#include "pbr_render.hpp"
+#include "orm_texture.hpp"
+
+#include <QColor>
+#include <QDebug>
+#include <QFileInfo>
+#include <QImage>
+#include <QOpenGLContext>
+#include <QVector3D>
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+#ifndef GL_TEXTURE_WRAP_R
+#define GL_TEXTURE_WRAP_R 0x8072
+#endif
+#ifndef GL_TEXTURE_CUBE_MAP_SEAMLESS
+#define GL_TEXTURE_CUBE_MAP_SEAMLESS 0x884F
+#endif
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
+#ifndef GL_RG16F
+#define GL_RG16F 0x822F
+#endif
+#ifndef GL_RG
+#define GL_RG 0x8227
+#endif
+
+namespace {
+
+// 与着色器中 sampler 的纹理单元一致
+constexpr int kBaseColorUnit = 0;
+constexpr int kOrmUnit = 1;
+constexpr int kNormalUnit = 2;
+constexpr int kPrefilteredUnit = 4;     // 不经过 DrawItem, 每帧在提交前绑定一次
+constexpr int kBrdfLutUnit = 5;
+constexpr int kClusterUnit = 6;         // 分簇灯光的三张数据纹理占用 6 7 8
+
+// 与 OpenGLItemRenderer::updateProjectMatrix 中的近远平面一致
+constexpr float kNearPlane = 3.0f;
+constexpr float kFarPlane = 10.0f;
+
+} // namespace
+
+PbrRender::PbrRender()
+    : m_vbo( QOpenGLBuffer::VertexBuffer )
+    , m_ibo( QOpenGLBuffer::IndexBuffer )
+    , m_indexType( IndexType::UInt16 )
+    , m_clearColor( 0.0f, 0.0f, 0.0f, 0.0f )
+    , m_rotationSpeed(1.0f)
+    , m_currentAngle(0.0f)
+    , m_initialized(false)
+{
+}
+
+PbrRender::~PbrRender() {
+    this->cleanup();
+}
+
+bool PbrRender::initialize( const RenderConfig& config ) {
+    initializeOpenGLFunctions();
+
+    // 加载模型
+    ObjModel model;
+    std::string error;
+    if ( !ObjLoader::load( config.modelPath(), model, error ) ) {
+        reportError( RenderError::InitializationFailed, error );
+        return false;
+    }
+
+    // 初始化着色器
+    if ( !initializeShaders( config ) ) {
+        reportError( RenderError::ShaderCompilationFailed, "Failed to compile shader" );
+        return false;
+    }
+
+    // 初始化几何体
+    if ( !initializeGeometry( model ) ) {
+        reportError( RenderError::BufferCreationFailed, "Failed to create mesh buffers" );
+        return false;
+    }
+
+    if ( !m_uniforms.initialize() ) {
+        reportError( RenderError::BufferCreationFailed, "Failed to create uniform buffer" );
+        return false;
+    }
+    m_uniforms.bindBlocks( m_program );
+
+    m_streamer.initialize();
+    m_streamer.setUploadBudget( config.textureUploadBudget() );
+    m_streamer.setMemoryBudget( config.textureMemoryBudget() );
+    initializeMaterials( model );
+
+    // 命中缓存时只是读文件, 未命中时首次烘焙需要几百毫秒, 都放到工作线程
+    auto pending = std::make_shared<PendingIbl>();
+    const QString environmentPath = config.environmentMapPath();
+    m_pendingIbl = pending;
+    m_iblJob = JobPool::instance().submit( [pending, environmentPath]() {
+        pending->ok = IblBaker::loadOrBake( environmentPath, pending->data, pending->error );
+    } );
+
+    // 模型居中, 最长边缩放到 2.0
+    const QVector3D extent = model.mesh.boundsMax - model.mesh.boundsMin;
+    const float longest = qMax( extent.x(), qMax( extent.y(), extent.z() ) );
+    m_modelNormalize.setToIdentity();
+    m_modelNormalize.scale( longest > 0.0f ? 2.0f / longest : 1.0f );
+    m_modelNormalize.translate( -( model.mesh.boundsMin + model.mesh.boundsMax ) * 0.5f );
+
+    if ( config.pointLightCount() > 0 ) {
+        // 初始化失败时只是没有点光源, 不影响其余渲染
+        if ( m_lighting.initialize( config.lightCullingShaderPath() ) ) {
+            initializeLights( config.pointLightCount() );
+        } else {
+            qDebug() << "PBR: clustered lighting unavailable";
+        }
+    }
+
+    // 保存配置
+    m_clearColor = config.clearColor();
+    m_rotationSpeed = config.rotationSpeed();
+    m_initialized = true;
+
+    return true;
+}
+
+void PbrRender::prepareFrame() {
+    if ( !m_initialized ) return;
+
+    if ( m_pendingIbl && m_iblJob.isFinished() ) {
+        std::shared_ptr<PendingIbl> pending = std::move( m_pendingIbl );
+        if ( pending->ok ) {
+            uploadIbl( pending->data );
+        } else {
+            qDebug() << "PBR: IBL unavailable," << QString::fromStdString( pending->error );
+        }
+    }
+
+    m_lighting.prepareFrame();
+
+    m_streamer.update();
+    for ( Material& material : m_materials ) {
+        if ( material.baseColorId >= 0 ) material.baseColor = m_streamer.handle( material.baseColorId );
+        if ( material.ormId >= 0 ) material.orm = m_streamer.handle( material.ormId );
+        if ( material.normalId >= 0 ) material.normal = m_streamer.handle( material.normalId );
+    }
+}
+
+bool PbrRender::render( const RenderContext& context ) {
+    // 直接渲染: 在渲染线程上录制后立即回放
+    m_directCommands.reset();
+    if ( !record( context, m_directCommands ) ) {
+        return false;
+    }
+    m_replayer.execute( m_directCommands );
+    m_replayer.finish();
+    return true;
+}
+
+bool PbrRender::record( const RenderContext& context, CommandBuffer& commands ) {
+    if ( !m_initialized ) {
+        reportError( RenderError::InitializationFailed, "Render not initialized" );
+        return false;
+    }
+
+    m_currentAngle += m_rotationSpeed;
+    if ( m_currentAngle > 360.0f ) { m_currentAngle -= 360.0f; }
+
+    commands.setViewport( 0, 0, context.width(), context.height() );
+    commands.clear( ClearColor | ClearDepth, m_clearColor );
+
+    m_uniforms.beginFrame( context );
+
+    QMatrix4x4 model;
+    model.translate( 0.0f, 0.0f, -5.0f );
+    model.rotate( m_currentAngle, 0.0f, 1.0f, 0.0f );
+    model = model * m_modelNormalize;
+
+    m_queue.begin( kNearPlane, kFarPlane );
+
+    for ( const ObjSubmesh& submesh : m_submeshes ) {
+        const bool hasMaterial = submesh.material >= 0 && submesh.material + 1 < int( m_materials.size() );
+        const Material& material = hasMaterial ? m_materials[submesh.material] : m_materials.back();
+
+        DrawItem item;
+        item.program = m_program.programId();
+        item.texture = material.baseColor;
+        item.extraTextures[kOrmUnit - 1] = material.orm;
+        item.extraTextures[kNormalUnit - 1] = material.normal;
+        item.vertexBuffer = m_vbo.bufferId();
+        item.indexBuffer = m_ibo.bufferId();
+        item.indexType = m_indexType;
+        item.stride = sizeof( MeshVertex );
+        item.attributeCount = 3;
+        item.attributes[0] = { 0, 3, 0 };                                                           // 位置
+        item.attributes[1] = { 1, 3, static_cast<uint16_t>( offsetof( MeshVertex, normal ) ) };    // 法线
+        item.attributes[2] = { 2, 2, static_cast<uint16_t>( offsetof( MeshVertex, texCoord ) ) };  // 纹理坐标
+        item.first = submesh.firstIndex;
+        item.count = submesh.indexCount;
+        item.uniformBuffer = m_uniforms.handle();
+        item.objectOffset = m_uniforms.addObject( model, material.color );
+        item.viewDepth = 5.0f;
+        item.state.depthTest = true;
+        m_queue.add( item );
+    }
+
+    // prepareFrame() 只在录制之前修改这两个句柄, 这里读取是安全的
+    if ( m_prefilteredMap != 0 ) {
+        commands.bindTexture( kPrefilteredUnit, m_prefilteredMap, TextureTarget::TextureCube );
+        commands.bindTexture( kBrdfLutUnit, m_brdfLut, TextureTarget::Texture2D );
+    }
+    recordLights( context, commands );
+
+    // 一次上传全部 uniform, 然后按排序键提交
+    m_uniforms.upload( commands );
+    m_queue.submit( commands );
+
+    return true;
+}
+
+bool PbrRender::submissionStats( SubmissionStats& stats ) const {
+    stats = m_queue.stats();
+    return true;
+}
+
+bool PbrRender::resize( int width, int height ) {
+    glViewport( 0, 0, width, height );
+    return true;
+}
+
+void PbrRender::cleanup() {
+    if ( m_vbo.isCreated() ) {
+        m_vbo.destroy();
+    }
+    if ( m_ibo.isCreated() ) {
+        m_ibo.destroy();
+    }
+    // 删除纹理需要当前上下文, cleanup 在渲染线程调用
+    if ( m_iblJob.isValid() ) {
+        m_iblJob.wait();
+        m_iblJob = JobHandle();
+    }
+    m_pendingIbl.reset();
+    if ( m_prefilteredMap != 0 ) {
+        glDeleteTextures( 1, &m_prefilteredMap );
+        glDeleteTextures( 1, &m_brdfLut );
+        m_prefilteredMap = 0;
+        m_brdfLut = 0;
+    }
+    m_lighting.cleanup();
+    m_orbitLights.clear();
+    m_streamer.cleanup();
+    for ( GLuint texture : m_constantTextures ) {
+        m_streamer.uploader().destroy( texture );
+    }
+    m_constantTextures.clear();
+    m_materials.clear();
+    m_submeshes.clear();
+    m_uniforms.cleanup();
+    m_program.removeAllShaders();
+    m_initialized = false;
+}
+
+void PbrRender::setErrorCallback( ErrorCallback callback ) {
+    m_errorCallback = callback;
+}
+
+bool PbrRender::initializeShaders( const RenderConfig& config ) {
+    if ( !m_program.addShaderFromSourceFile( QOpenGLShader::Vertex, config.vertexShaderPath() ) ) {
+        qDebug() << "Vertex shader error:" << m_program.log();
+        return false;
+    }
+    if ( !m_program.addShaderFromSourceFile( QOpenGLShader::Fragment, config.fragmentShaderPath() ) ) {
+        qDebug() << "Fragment shader error:" << m_program.log();
+        return false;
+    }
+    if ( !m_program.link() ) {
+        qDebug() << "Shader link error:" << m_program.log();
+        return false;
+    }
+
+    // sampler 固定到纹理单元, 之后只需要绑定纹理
+    m_program.bind();
+    m_program.setUniformValue( "baseColorMap", kBaseColorUnit );
+    m_program.setUniformValue( "ormMap", kOrmUnit );
+    m_program.setUniformValue( "normalMap", kNormalUnit );
+    m_program.setUniformValue( "prefilteredMap", kPrefilteredUnit );
+    m_program.setUniformValue( "brdfLut", kBrdfLutUnit );
+    m_program.setUniformValue( "iblReady", 0.0f );
+    m_program.setUniformValue( "clusterLights", kClusterUnit );
+    m_program.setUniformValue( "clusterGrid", kClusterUnit + 1 );
+    m_program.setUniformValue( "clusterIndices", kClusterUnit + 2 );
+    m_program.release();
+    m_clusterSizeLocation = m_program.uniformLocation( "clusterSize" );
+    m_clusterDepthLocation = m_program.uniformLocation( "clusterDepth" );
+    return true;
+}
+
+void PbrRender::initializeLights( int count ) {
+    // 固定种子, 每次启动的灯光布置相同
+    std::mt19937 rng( 1 );
+    std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+    m_orbitLights.resize( size_t( count ) );
+    for ( OrbitLight& light : m_orbitLights ) {
+        const QColor hue = QColor::fromHsvF( unit( rng ), 0.7f, 1.0f );
+        light.color = QVector3D( float( hue.redF() ), float( hue.greenF() ), float( hue.blueF() ) ) * 1.5f;
+        light.radius = 0.6f + 0.6f * unit( rng );
+        light.orbitRadius = 1.0f + 1.2f * unit( rng );
+        light.height = ( unit( rng ) * 2.0f - 1.0f ) * 1.2f;
+        light.speed = ( unit( rng ) < 0.5f ? -1.0f : 1.0f ) * ( 0.3f + 0.7f * unit( rng ) );
+        light.phase = unit( rng ) * 6.2831853f;
+    }
+    m_pointLights.reserve( m_orbitLights.size() );
+}
+
+void PbrRender::recordLights( const RenderContext& context, CommandBuffer& commands ) {
+    // 没有点光源时 clusterSize 保持 0, 着色器跳过整个分簇循环
+    if ( m_orbitLights.empty() || m_clusterSizeLocation < 0 ) return;
+
+    // 灯光转到视图空间后分簇, 与片元着色器的 viewPosition 一致
+    const QMatrix4x4 view = context.viewMatrix();
+    m_pointLights.clear();
+    for ( const OrbitLight& orbit : m_orbitLights ) {
+        const float angle = orbit.phase + orbit.speed * context.time();
+        const QVector3D world( std::cos( angle ) * orbit.orbitRadius, orbit.height, -5.0f + std::sin( angle ) * orbit.orbitRadius );
+        m_pointLights.push_back( { view.map( world ), orbit.radius, orbit.color } );
+    }
+    m_lighting.record( commands, m_pointLights, context.projectionMatrix(), kNearPlane, kFarPlane );
+
+    const ClusterGridSize& size = m_lighting.gridSize();
+    m_lighting.bind( commands, kClusterUnit );
+    commands.bindProgram( m_program.programId() );
+    commands.setUniform( m_clusterSizeLocation, QVector4D( float( size.tilesX ), float( size.tilesY ),
+                                                           float( size.slices ), float( m_lighting.lightCount() ) ) );
+    commands.setUniform( m_clusterDepthLocation, QVector4D( m_lighting.sliceScale(), m_lighting.sliceBias(), 0.0f, 0.0f ) );
+}
+
+bool PbrRender::initializeGeometry( const ObjModel& model ) {
+    if ( !m_vbo.create() || !m_ibo.create() ) {
+        return false;
+    }
+
+    const MeshData& mesh = model.mesh;
+    m_vbo.bind();
+    m_vbo.allocate( mesh.vertices.data(), static_cast<int>( mesh.vertices.size() * sizeof( MeshVertex ) ) );
+    m_vbo.release();
+
+    m_ibo.bind();
+    if ( mesh.fitsUInt16() ) {
+        // 16 位索引 减少一半的索引带宽
+        std::vector<uint16_t> indices( mesh.indices.begin(), mesh.indices.end() );
+        m_ibo.allocate( indices.data(), static_cast<int>( indices.size() * sizeof( uint16_t ) ) );
+        m_indexType = IndexType::UInt16;
+    } else {
+        m_ibo.allocate( mesh.indices.data(), static_cast<int>( mesh.indices.size() * sizeof( uint32_t ) ) );
+        m_indexType = IndexType::UInt32;
+    }
+    m_ibo.release();
+
+    m_submeshes = model.submeshes;
+    return true;
+}
+
+void PbrRender::initializeMaterials( const ObjModel& model ) {
+    m_materials.clear();
+    m_materials.reserve( model.materials.size() + 1 );
+
+    // 贴图缺失或还在加载时使用 1x1 的常量纹理, 着色器不需要分支
+    TextureUploader& uploader = m_streamer.uploader();
+    const GLuint white = uploader.createConstant( 255, 255, 255, 255, true );
+    const GLuint flatNormal = uploader.createConstant( 128, 128, 255, 255, false );
+    const GLuint defaultOrm = uploader.createConstant( 255, 128, 0, 255, false );     // AO 1 粗糙度 0.5 非金属
+    m_constantTextures = { white, flatNormal, defaultOrm };
+
+    for ( const ObjMaterial& source : model.materials ) {
+        Material material;
+        material.color = QVector4D( source.diffuse, 1.0f );
+
+        material.baseColor = white;
+        material.baseColorId = loadTexture( source.diffuseMap, true, false, white, "base color" );
+        material.normal = flatNormal;
+        material.normalId = loadTexture( source.normalMap, false, true, flatNormal, "normal" );
+
+        OrmSources orm;
+        orm.aoPath = source.aoMap;
+        orm.roughnessPath = source.roughnessMap;
+        orm.metallicPath = source.metallicMap;
+        orm.roughness = source.roughness;
+        orm.metallic = source.metallic;
+
+        TextureImportRequest request;
+        for ( const QString& path : { orm.aoPath, orm.roughnessPath, orm.metallicPath } ) {
+            if ( !path.isEmpty() && QFileInfo::exists( path ) ) request.sources << path;
+        }
+        request.variant = QString( "orm %1 %2" ).arg( orm.roughness ).arg( orm.metallic );
+        request.decode = [orm]() { return OrmTexture::pack( orm ); };
+        request.mipmaps = !request.sources.isEmpty();
+
+        // 没有任何贴图时 ORM 只是常量, 不需要流送
+        if ( request.sources.isEmpty() ) {
+            const auto toByte = []( float value ) { return uint8_t( qBound( 0.0f, value, 1.0f ) * 255.0f + 0.5f ); };
+            material.orm = uploader.createConstant( 255, toByte( orm.roughness ), toByte( orm.metallic ), 255, false );
+            m_constantTextures.push_back( material.orm );
+        } else {
+            material.orm = defaultOrm;
+            material.ormId = requestTexture( request, false, defaultOrm );
+        }
+
+        m_materials.push_back( material );
+    }
+
+    // 默认材质: 白色 粗糙度 0.5 非金属
+    Material fallback;
+    fallback.baseColor = white;
+    fallback.normal = flatNormal;
+    fallback.orm = defaultOrm;
+    m_materials.push_back( fallback );
+}
+
+TextureStreamer::TextureId PbrRender::requestTexture( TextureImportRequest request, bool srgb, GLuint fallback ) {
+    // 压缩格式上传失败时 TextureStreamer 会自动退回 RGBA8
+    request.format = TextureFormats::choose( m_streamer.support(), TextureChannels::Rgb, srgb );
+    return m_streamer.request( request, fallback );
+}
+
+TextureStreamer::TextureId PbrRender::loadTexture( const QString& path, bool srgb, bool normalMap,
+                                                   GLuint fallback, const char* what ) {
+    if ( path.isEmpty() ) {
+        return -1;
+    }
+    if ( !QFileInfo::exists( path ) ) {
+        qDebug() << "PBR: missing" << what << "map" << QFileInfo( path ).fileName() << ", using constant";
+        return -1;
+    }
+
+    TextureImportRequest request;
+    request.sources << path;
+    request.decode = [path]() { return QImage( path ); };
+    request.normalMap = normalMap;
+    return requestTexture( request, srgb, fallback );
+}
+
+void PbrRender::uploadIbl( const IblData& data ) {
+    // 半精度数据直接上传, 不在渲染线程做任何转换
+    glGenTextures( 1, &m_prefilteredMap );
+    glBindTexture( GL_TEXTURE_CUBE_MAP, m_prefilteredMap );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    for ( uint32_t level = 0; level < data.cubeLevels; ++level ) {
+        const GLsizei size = GLsizei( data.levelSize( level ) );
+        for ( uint32_t face = 0; face < 6; ++face ) {
+            glTexImage2D( GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, GLint( level ), GL_RGBA16F, size, size, 0,
+                          GL_RGBA, GL_HALF_FLOAT, data.cube.data() + data.faceOffset( level, face ) );
+        }
+    }
+    glTexParameteri( GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, GLint( data.cubeLevels - 1 ) );
+    glTexParameteri( GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+    glTexParameteri( GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE );
+
+    // 桌面 GL 默认不跨面过滤, 粗糙级别的面接缝会很明显; GLES 3 始终跨面过滤
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if ( context && !context->isOpenGLES() ) {
+        glEnable( GL_TEXTURE_CUBE_MAP_SEAMLESS );
+    }
+
+    glGenTextures( 1, &m_brdfLut );
+    glBindTexture( GL_TEXTURE_2D, m_brdfLut );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_RG16F, GLsizei( data.lutSize ), GLsizei( data.lutSize ), 0,
+                  GL_RG, GL_HALF_FLOAT, data.lut.data() );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+    glBindTexture( GL_TEXTURE_CUBE_MAP, 0 );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+
+    QVector3D sh[9];
+    for ( int i = 0; i < 9; ++i ) {
+        sh[i] = QVector3D( data.sh[i][0], data.sh[i][1], data.sh[i][2] );
+    }
+    m_program.bind();
+    m_program.setUniformValueArray( "irradianceSH", sh, 9 );
+    m_program.setUniformValue( "prefilteredLevels", float( data.cubeLevels - 1 ) );
+    m_program.setUniformValue( "iblReady", 1.0f );
+    m_program.release();
+}
+
+void PbrRender::reportError( RenderError error, const std::string& message ) {
+    if ( m_errorCallback ) {
+        m_errorCallback( error, message );
+    }
+}
@@ -0,0 +1,118 @@
+// 单一职责: 加载 OBJ + MTL 模型, 用金属度-粗糙度 BRDF 渲染
+// 金属度/粗糙度/AO 在导入时打包成一张 ORM 纹理 (见 OrmTexture), 片元着色器每个材质只采样三张贴图
+// 贴图经 TextureImporter 压缩成 BC1 / ETC2 并缓存为 KTX2, 上下文不支持时退回 RGBA8
+// 贴图由 TextureStreamer 异步导入并逐级流送, 加载期间先用常量纹理 再从最小的 mip 逐渐变清晰
+// 环境光由 IblBaker 在工作线程烘焙 (或读缓存), 完成前使用半球环境光
+// 可选的环绕点光源经 ClusteredLighting 分簇, 片元只计算所在簇的灯
+#pragma once
+#include "irenderer.hpp"
+#include "render_config.hpp"
+#include "render_context.hpp"
+#include "render_queue.hpp"
+#include "uniform_buffer.hpp"
+#include "gl_command_replayer.hpp"
+#include "clustered_lighting.hpp"
+#include "ibl_baker.hpp"
+#include "job_pool.hpp"
+#include "obj_loader.hpp"
+#include "texture_importer.hpp"
+#include "texture_streamer.hpp"
+
+#include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+#include <QMatrix4x4>
+#include <memory>
+#include <vector>
+
+class PbrRender : protected QOpenGLFunctions, public IRenderer
+{
+public:
+    PbrRender();
+    ~PbrRender() override;
+
+    bool initialize( const RenderConfig& config ) override;
+    bool render( const RenderContext& context ) override;
+    bool supportsRecording() const override { return true; }
+    void prepareFrame() override;
+    bool record( const RenderContext& context, CommandBuffer& commands ) override;
+    bool submissionStats( SubmissionStats& stats ) const override;
+    bool resize( int width, int height ) override;
+    void cleanup() override;
+    void setErrorCallback( ErrorCallback callback ) override;
+    std::string getName() const override { return "PbrRender"; }
+
+private:
+    // GPU 端的材质: 基础色 / ORM / 法线 三张纹理
+    // 纹理句柄每帧在 prepareFrame() 中从 TextureStreamer 刷新, record() 只读取
+    struct Material {
+        GLuint baseColor = 0;
+        GLuint orm = 0;
+        GLuint normal = 0;
+        TextureStreamer::TextureId baseColorId = -1;   // -1 表示始终使用常量纹理
+        TextureStreamer::TextureId ormId = -1;
+        TextureStreamer::TextureId normalId = -1;
+        QVector4D color{ 1.0f, 1.0f, 1.0f, 1.0f };     // Kd, 与基础色贴图相乘
+    };
+
+    // 工作线程的烘焙结果, 完成后由 prepareFrame() 上传
+    struct PendingIbl {
+        IblData data;
+        std::string error;
+        bool ok = false;
+    };
+
+    // 绕模型转动的点光源, 世界空间
+    struct OrbitLight {
+        QVector3D color;
+        float radius = 1.0f;        // 影响半径
+        float orbitRadius = 1.0f;
+        float height = 0.0f;
+        float speed = 1.0f;         // 弧度每秒
+        float phase = 0.0f;
+    };
+
+    bool initializeShaders( const RenderConfig& config );
+    void initializeLights( int count );
+    void recordLights( const RenderContext& context, CommandBuffer& commands );
+    bool initializeGeometry( const ObjModel& model );
+    void initializeMaterials( const ObjModel& model );
+    TextureStreamer::TextureId requestTexture( TextureImportRequest request, bool srgb, GLuint fallback );
+    TextureStreamer::TextureId loadTexture( const QString& path, bool srgb, bool normalMap, GLuint fallback, const char* what );
+    void uploadIbl( const IblData& data );
+    void reportError( RenderError error, const std::string& message );
+
+    QOpenGLShaderProgram m_program;
+    QOpenGLBuffer m_vbo;
+    QOpenGLBuffer m_ibo;
+    IndexType m_indexType;
+
+    std::vector<ObjSubmesh> m_submeshes;
+    std::vector<Material> m_materials;          // 最后一个是没有材质时使用的默认材质
+    std::vector<GLuint> m_constantTextures;     // 缺失贴图的替代纹理, cleanup 时删除
+    TextureStreamer m_streamer;
+    QMatrix4x4 m_modelNormalize;                // 把模型居中并缩放到单位大小
+
+    std::shared_ptr<PendingIbl> m_pendingIbl;
+    JobHandle m_iblJob;
+    GLuint m_prefilteredMap = 0;                // 0 表示 IBL 还没有就绪
+    GLuint m_brdfLut = 0;
+
+    ClusteredLighting m_lighting;
+    std::vector<OrbitLight> m_orbitLights;
+    std::vector<PointLight> m_pointLights;      // 录制线程每帧复用
+    int m_clusterSizeLocation = -1;
+    int m_clusterDepthLocation = -1;
+
+    RenderQueue m_queue;
+    UniformBuffer m_uniforms;
+    CommandBuffer m_directCommands;             // render() 直接渲染时使用
+    GLCommandReplayer m_replayer;
+
+    QVector4D m_clearColor;
+    float m_rotationSpeed;
+    float m_currentAngle;
+
+    ErrorCallback m_errorCallback;
+    bool m_initialized;
+};
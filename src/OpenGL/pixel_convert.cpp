@@ -0,0 +1,530 @@
+#include "pixel_convert.hpp"
+#include "simd_vec4.hpp"
+
+#include <cmath>
+
+#if defined(SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// GCC / Clang 需要给 AVX2 函数单独开启指令集, MSVC 不需要
+#if defined(SIMD_X86) && ( defined(__GNUC__) || defined(__clang__) )
+#define PIXEL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PIXEL_TARGET_AVX2
+#endif
+
+namespace {
+
+// 线性值量化成 12 位后查表编码, 8 位 sRGB 解码再编码可以无损往返
+constexpr int kLinearBits = 12;
+constexpr int kLinearSteps = ( 1 << kLinearBits ) - 1;
+
+struct SrgbTables {
+    float toLinear[256];
+    uint8_t toSrgb[kLinearSteps + 1 + 3];     // 多 3 字节, AVX2 按 32 位 gather 时不会越界
+
+    SrgbTables() {
+        for ( int i = 0; i < 256; ++i ) {
+            const double c = i / 255.0;
+            toLinear[i] = float( c <= 0.04045 ? c / 12.92 : std::pow( ( c + 0.055 ) / 1.055, 2.4 ) );
+        }
+        for ( int i = 0; i <= kLinearSteps; ++i ) {
+            const double l = double( i ) / kLinearSteps;
+            const double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow( l, 1.0 / 2.4 ) - 0.055;
+            toSrgb[i] = uint8_t( std::lround( c * 255.0 ) );
+        }
+        toSrgb[kLinearSteps + 1] = toSrgb[kLinearSteps + 2] = toSrgb[kLinearSteps + 3] = 0;
+    }
+};
+
+const SrgbTables& tables() {
+    static const SrgbTables instance;
+    return instance;
+}
+
+constexpr float kInv255 = 1.0f / 255.0f;
+
+// ---------------------------------------------------------------- 标量参考实现
+
+inline float clampUnit( float x ) {
+    // 与 SSE 的 max/min 语义一致: NaN 变成 0
+    x = x > 0.0f ? x : 0.0f;
+    return x < 1.0f ? x : 1.0f;
+}
+
+inline uint8_t mulDiv255( uint32_t c, uint32_t a ) {
+    const uint32_t t = c * a + 128;
+    return uint8_t( ( t + ( t >> 8 ) ) >> 8 );
+}
+
+void srgbToLinearScalar( const uint8_t* rgba, float* out, size_t pixels ) {
+    const float* lut = tables().toLinear;
+    for ( size_t i = 0; i < pixels; ++i ) {
+        out[i * 4 + 0] = lut[rgba[i * 4 + 0]];
+        out[i * 4 + 1] = lut[rgba[i * 4 + 1]];
+        out[i * 4 + 2] = lut[rgba[i * 4 + 2]];
+        out[i * 4 + 3] = float( rgba[i * 4 + 3] ) * kInv255;
+    }
+}
+
+void linearToSrgbScalar( const float* rgba, uint8_t* out, size_t pixels ) {
+    const uint8_t* lut = tables().toSrgb;
+    // lrintf 在默认舍入模式下与 SIMD 的 cvtps 一样是就近取偶
+    for ( size_t i = 0; i < pixels; ++i ) {
+        out[i * 4 + 0] = lut[std::lrintf( clampUnit( rgba[i * 4 + 0] ) * float( kLinearSteps ) )];
+        out[i * 4 + 1] = lut[std::lrintf( clampUnit( rgba[i * 4 + 1] ) * float( kLinearSteps ) )];
+        out[i * 4 + 2] = lut[std::lrintf( clampUnit( rgba[i * 4 + 2] ) * float( kLinearSteps ) )];
+        out[i * 4 + 3] = uint8_t( std::lrintf( clampUnit( rgba[i * 4 + 3] ) * 255.0f ) );
+    }
+}
+
+void premultiplyScalar( uint8_t* rgba, size_t pixels ) {
+    for ( size_t i = 0; i < pixels; ++i ) {
+        uint8_t* p = rgba + i * 4;
+        const uint32_t a = p[3];
+        p[0] = mulDiv255( p[0], a );
+        p[1] = mulDiv255( p[1], a );
+        p[2] = mulDiv255( p[2], a );
+    }
+}
+
+void swapRedBlueScalar( const uint8_t* src, uint8_t* dst, size_t pixels ) {
+    for ( size_t i = 0; i < pixels; ++i ) {
+        const uint8_t r = src[i * 4 + 0];
+        const uint8_t g = src[i * 4 + 1];
+        const uint8_t b = src[i * 4 + 2];
+        const uint8_t a = src[i * 4 + 3];
+        dst[i * 4 + 0] = b;
+        dst[i * 4 + 1] = g;
+        dst[i * 4 + 2] = r;
+        dst[i * 4 + 3] = a;
+    }
+}
+
+void extractChannelScalar( const uint8_t* rgba, uint8_t* out, size_t pixels, int channel ) {
+    for ( size_t i = 0; i < pixels; ++i ) {
+        out[i] = rgba[i * 4 + channel];
+    }
+}
+
+void interleaveScalar( const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* rgbx, size_t pixels ) {
+    for ( size_t i = 0; i < pixels; ++i ) {
+        rgbx[i * 4 + 0] = r[i];
+        rgbx[i * 4 + 1] = g[i];
+        rgbx[i * 4 + 2] = b[i];
+        rgbx[i * 4 + 3] = 255;
+    }
+}
+
+#ifdef SIMD_X86
+
+// ---------------------------------------------------------------- SSE2
+// 没有 gather, 查表部分逐个读取, 其余部分向量化
+
+void srgbToLinearSse2( const uint8_t* rgba, float* out, size_t pixels ) {
+    const float* lut = tables().toLinear;
+    for ( size_t i = 0; i < pixels; ++i ) {
+        const uint8_t* p = rgba + i * 4;
+        _mm_storeu_ps( out + i * 4, _mm_setr_ps( lut[p[0]], lut[p[1]], lut[p[2]], float( p[3] ) * kInv255 ) );
+    }
+}
+
+void linearToSrgbSse2( const float* rgba, uint8_t* out, size_t pixels ) {
+    const uint8_t* lut = tables().toSrgb;
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps( 1.0f );
+    const __m128 scale = _mm_setr_ps( float( kLinearSteps ), float( kLinearSteps ), float( kLinearSteps ), 255.0f );
+    for ( size_t i = 0; i < pixels; ++i ) {
+        __m128 v = _mm_loadu_ps( rgba + i * 4 );
+        v = _mm_min_ps( _mm_max_ps( v, zero ), one );
+        alignas( 16 ) int32_t index[4];
+        _mm_store_si128( reinterpret_cast<__m128i*>( index ), _mm_cvtps_epi32( _mm_mul_ps( v, scale ) ) );
+        out[i * 4 + 0] = lut[index[0]];
+        out[i * 4 + 1] = lut[index[1]];
+        out[i * 4 + 2] = lut[index[2]];
+        out[i * 4 + 3] = uint8_t( index[3] );
+    }
+}
+
+// 8 个 16 位分量 (2 个像素) 乘各自像素的 alpha, alpha 分量乘 255 保持不变
+inline __m128i premultiplyWords( __m128i x ) {
+    const __m128i alphaLane = _mm_setr_epi16( 0, 0, 0, -1, 0, 0, 0, -1 );
+    __m128i a = _mm_shufflelo_epi16( x, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+    a = _mm_shufflehi_epi16( a, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+    a = _mm_or_si128( _mm_andnot_si128( alphaLane, a ), _mm_and_si128( alphaLane, _mm_set1_epi16( 255 ) ) );
+    __m128i t = _mm_add_epi16( _mm_mullo_epi16( x, a ), _mm_set1_epi16( 128 ) );
+    return _mm_srli_epi16( _mm_add_epi16( t, _mm_srli_epi16( t, 8 ) ), 8 );
+}
+
+void premultiplySse2( uint8_t* rgba, size_t pixels ) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for ( ; i + 4 <= pixels; i += 4 ) {
+        __m128i* p = reinterpret_cast<__m128i*>( rgba + i * 4 );
+        const __m128i v = _mm_loadu_si128( p );
+        const __m128i lo = premultiplyWords( _mm_unpacklo_epi8( v, zero ) );
+        const __m128i hi = premultiplyWords( _mm_unpackhi_epi8( v, zero ) );
+        _mm_storeu_si128( p, _mm_packus_epi16( lo, hi ) );
+    }
+    premultiplyScalar( rgba + i * 4, pixels - i );
+}
+
+void swapRedBlueSse2( const uint8_t* src, uint8_t* dst, size_t pixels ) {
+    const __m128i keep = _mm_set1_epi32( int32_t( 0xFF00FF00u ) );
+    const __m128i low = _mm_set1_epi32( 0x000000FF );
+    size_t i = 0;
+    for ( ; i + 4 <= pixels; i += 4 ) {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i * 4 ) );
+        const __m128i r = _mm_and_si128( _mm_srli_epi32( v, 16 ), low );
+        const __m128i b = _mm_slli_epi32( _mm_and_si128( v, low ), 16 );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i * 4 ),
+                          _mm_or_si128( _mm_and_si128( v, keep ), _mm_or_si128( r, b ) ) );
+    }
+    swapRedBlueScalar( src + i * 4, dst + i * 4, pixels - i );
+}
+
+void extractChannelSse2( const uint8_t* rgba, uint8_t* out, size_t pixels, int channel ) {
+    const __m128i shift = _mm_cvtsi32_si128( channel * 8 );
+    const __m128i low = _mm_set1_epi32( 0xFF );
+    size_t i = 0;
+    for ( ; i + 16 <= pixels; i += 16 ) {
+        const __m128i* p = reinterpret_cast<const __m128i*>( rgba + i * 4 );
+        const __m128i v0 = _mm_and_si128( _mm_srl_epi32( _mm_loadu_si128( p + 0 ), shift ), low );
+        const __m128i v1 = _mm_and_si128( _mm_srl_epi32( _mm_loadu_si128( p + 1 ), shift ), low );
+        const __m128i v2 = _mm_and_si128( _mm_srl_epi32( _mm_loadu_si128( p + 2 ), shift ), low );
+        const __m128i v3 = _mm_and_si128( _mm_srl_epi32( _mm_loadu_si128( p + 3 ), shift ), low );
+        // 值都在 0-255, 有符号饱和打包不会截断
+        const __m128i w0 = _mm_packs_epi32( v0, v1 );
+        const __m128i w1 = _mm_packs_epi32( v2, v3 );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( out + i ), _mm_packus_epi16( w0, w1 ) );
+    }
+    extractChannelScalar( rgba + i * 4, out + i, pixels - i, channel );
+}
+
+void interleaveSse2( const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* rgbx, size_t pixels ) {
+    const __m128i opaque = _mm_set1_epi8( char( 0xFF ) );
+    size_t i = 0;
+    for ( ; i + 16 <= pixels; i += 16 ) {
+        const __m128i vr = _mm_loadu_si128( reinterpret_cast<const __m128i*>( r + i ) );
+        const __m128i vg = _mm_loadu_si128( reinterpret_cast<const __m128i*>( g + i ) );
+        const __m128i vb = _mm_loadu_si128( reinterpret_cast<const __m128i*>( b + i ) );
+        const __m128i rgLo = _mm_unpacklo_epi8( vr, vg );
+        const __m128i rgHi = _mm_unpackhi_epi8( vr, vg );
+        const __m128i bxLo = _mm_unpacklo_epi8( vb, opaque );
+        const __m128i bxHi = _mm_unpackhi_epi8( vb, opaque );
+        __m128i* p = reinterpret_cast<__m128i*>( rgbx + i * 4 );
+        _mm_storeu_si128( p + 0, _mm_unpacklo_epi16( rgLo, bxLo ) );
+        _mm_storeu_si128( p + 1, _mm_unpackhi_epi16( rgLo, bxLo ) );
+        _mm_storeu_si128( p + 2, _mm_unpacklo_epi16( rgHi, bxHi ) );
+        _mm_storeu_si128( p + 3, _mm_unpackhi_epi16( rgHi, bxHi ) );
+    }
+    interleaveScalar( r + i, g + i, b + i, rgbx + i * 4, pixels - i );
+}
+
+// ---------------------------------------------------------------- AVX2
+// 256 位的解包 / 打包按 128 位分半进行, 需要的地方用 permute 恢复顺序
+
+PIXEL_TARGET_AVX2 void srgbToLinearAvx2( const uint8_t* rgba, float* out, size_t pixels ) {
+    const float* lut = tables().toLinear;
+    const __m256 inv255 = _mm256_set1_ps( kInv255 );
+    const __m256 alphaLane = _mm256_castsi256_ps( _mm256_setr_epi32( 0, 0, 0, -1, 0, 0, 0, -1 ) );
+    size_t i = 0;
+    for ( ; i + 2 <= pixels; i += 2 ) {
+        // 2 个像素的 8 个字节扩展成 8 个 32 位下标
+        const __m128i bytes = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( rgba + i * 4 ) );
+        const __m256i index = _mm256_cvtepu8_epi32( bytes );
+        const __m256 color = _mm256_i32gather_ps( lut, index, 4 );
+        const __m256 alpha = _mm256_mul_ps( _mm256_cvtepi32_ps( index ), inv255 );
+        _mm256_storeu_ps( out + i * 4, _mm256_blendv_ps( color, alpha, alphaLane ) );
+    }
+    srgbToLinearScalar( rgba + i * 4, out + i * 4, pixels - i );
+}
+
+PIXEL_TARGET_AVX2 void linearToSrgbAvx2( const float* rgba, uint8_t* out, size_t pixels ) {
+    const uint8_t* lut = tables().toSrgb;
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps( 1.0f );
+    const __m256 scale = _mm256_setr_ps( float( kLinearSteps ), float( kLinearSteps ), float( kLinearSteps ), 255.0f,
+                                         float( kLinearSteps ), float( kLinearSteps ), float( kLinearSteps ), 255.0f );
+    const __m256i alphaLane = _mm256_setr_epi32( 0, 0, 0, -1, 0, 0, 0, -1 );
+    const __m256i low = _mm256_set1_epi32( 0xFF );
+    size_t i = 0;
+    for ( ; i + 4 <= pixels; i += 4 ) {
+        __m256i packed[2];
+        for ( int half = 0; half < 2; ++half ) {
+            __m256 v = _mm256_loadu_ps( rgba + ( i + half * 2 ) * 4 );
+            v = _mm256_min_ps( _mm256_max_ps( v, zero ), one );
+            const __m256i index = _mm256_cvtps_epi32( _mm256_mul_ps( v, scale ) );
+            // 按字节地址 gather 32 位再取低 8 位, alpha 分量直接用量化值
+            const __m256i color = _mm256_and_si256(
+                _mm256_i32gather_epi32( reinterpret_cast<const int*>( lut ), index, 1 ), low );
+            packed[half] = _mm256_blendv_epi8( color, index, alphaLane );
+        }
+        // 32 -> 16 位: [p0 p2 | p1 p3], 恢复成 [p0 p1 | p2 p3] 后再打包成字节
+        __m256i words = _mm256_packus_epi32( packed[0], packed[1] );
+        words = _mm256_permute4x64_epi64( words, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        const __m256i bytes = _mm256_packus_epi16( words, words );
+        const __m256i ordered = _mm256_permute4x64_epi64( bytes, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( out + i * 4 ), _mm256_castsi256_si128( ordered ) );
+    }
+    linearToSrgbScalar( rgba + i * 4, out + i * 4, pixels - i );
+}
+
+PIXEL_TARGET_AVX2 void premultiplyAvx2( uint8_t* rgba, size_t pixels ) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaLane = _mm256_setr_epi16( 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1 );
+    const __m256i alphaOne = _mm256_and_si256( alphaLane, _mm256_set1_epi16( 255 ) );
+    const __m256i half = _mm256_set1_epi16( 128 );
+    size_t i = 0;
+    for ( ; i + 8 <= pixels; i += 8 ) {
+        __m256i* p = reinterpret_cast<__m256i*>( rgba + i * 4 );
+        const __m256i v = _mm256_loadu_si256( p );
+        __m256i words[2] = { _mm256_unpacklo_epi8( v, zero ), _mm256_unpackhi_epi8( v, zero ) };
+        for ( __m256i& x : words ) {
+            __m256i a = _mm256_shufflelo_epi16( x, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+            a = _mm256_shufflehi_epi16( a, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+            a = _mm256_or_si256( _mm256_andnot_si256( alphaLane, a ), alphaOne );
+            const __m256i t = _mm256_add_epi16( _mm256_mullo_epi16( x, a ), half );
+            x = _mm256_srli_epi16( _mm256_add_epi16( t, _mm256_srli_epi16( t, 8 ) ), 8 );
+        }
+        // 解包和打包都在各自的 128 位内进行, 顺序自然还原
+        _mm256_storeu_si256( p, _mm256_packus_epi16( words[0], words[1] ) );
+    }
+    premultiplyScalar( rgba + i * 4, pixels - i );
+}
+
+PIXEL_TARGET_AVX2 void swapRedBlueAvx2( const uint8_t* src, uint8_t* dst, size_t pixels ) {
+    const __m256i order = _mm256_setr_epi8( 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15 );
+    size_t i = 0;
+    for ( ; i + 8 <= pixels; i += 8 ) {
+        const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src + i * 4 ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i * 4 ), _mm256_shuffle_epi8( v, order ) );
+    }
+    swapRedBlueScalar( src + i * 4, dst + i * 4, pixels - i );
+}
+
+PIXEL_TARGET_AVX2 void extractChannelAvx2( const uint8_t* rgba, uint8_t* out, size_t pixels, int channel ) {
+    // 每个 128 位内把所选通道的 4 个字节移到低 32 位, 其余置零
+    alignas( 32 ) int8_t pick[32];
+    for ( int k = 0; k < 32; ++k ) {
+        const int lane = k % 16;
+        pick[k] = lane < 4 ? int8_t( lane * 4 + channel ) : int8_t( -1 );
+    }
+    const __m256i order = _mm256_load_si256( reinterpret_cast<const __m256i*>( pick ) );
+    const __m256i interleaved = _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 );
+    size_t i = 0;
+    for ( ; i + 32 <= pixels; i += 32 ) {
+        const __m256i* p = reinterpret_cast<const __m256i*>( rgba + i * 4 );
+        // 每个结果的第 0 / 4 个 32 位分量分别是 8 个像素中前 4 个和后 4 个的通道值
+        const __m256i v0 = _mm256_shuffle_epi8( _mm256_loadu_si256( p + 0 ), order );
+        const __m256i v1 = _mm256_shuffle_epi8( _mm256_loadu_si256( p + 1 ), order );
+        const __m256i v2 = _mm256_shuffle_epi8( _mm256_loadu_si256( p + 2 ), order );
+        const __m256i v3 = _mm256_shuffle_epi8( _mm256_loadu_si256( p + 3 ), order );
+        // 合并成 [v0 v1 v2 v3 | v0 v1 v2 v3] 的 32 位分量, 再按像素顺序重排
+        const __m256i a = _mm256_unpacklo_epi32( v0, v1 );
+        const __m256i b = _mm256_unpacklo_epi32( v2, v3 );
+        const __m256i ab = _mm256_unpacklo_epi64( a, b );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( out + i ), _mm256_permutevar8x32_epi32( ab, interleaved ) );
+    }
+    extractChannelScalar( rgba + i * 4, out + i, pixels - i, channel );
+}
+
+PIXEL_TARGET_AVX2 void interleaveAvx2( const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* rgbx, size_t pixels ) {
+    const __m256i opaque = _mm256_set1_epi8( char( 0xFF ) );
+    size_t i = 0;
+    for ( ; i + 32 <= pixels; i += 32 ) {
+        // 先把 64 位块排成 0 2 1 3, 分半解包后低半部分正好是前 16 个像素
+        const __m256i vr = _mm256_permute4x64_epi64( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( r + i ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        const __m256i vg = _mm256_permute4x64_epi64( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( g + i ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        const __m256i vb = _mm256_permute4x64_epi64( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( b + i ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        const __m256i rgLo = _mm256_unpacklo_epi8( vr, vg );      // 像素 0-15
+        const __m256i rgHi = _mm256_unpackhi_epi8( vr, vg );      // 像素 16-31
+        const __m256i bxLo = _mm256_unpacklo_epi8( vb, opaque );
+        const __m256i bxHi = _mm256_unpackhi_epi8( vb, opaque );
+
+        const __m256i q0 = _mm256_unpacklo_epi16( rgLo, bxLo );   // 像素 0-3 | 8-11
+        const __m256i q1 = _mm256_unpackhi_epi16( rgLo, bxLo );   // 像素 4-7 | 12-15
+        const __m256i q2 = _mm256_unpacklo_epi16( rgHi, bxHi );
+        const __m256i q3 = _mm256_unpackhi_epi16( rgHi, bxHi );
+
+        __m256i* p = reinterpret_cast<__m256i*>( rgbx + i * 4 );
+        _mm256_storeu_si256( p + 0, _mm256_permute2x128_si256( q0, q1, 0x20 ) );
+        _mm256_storeu_si256( p + 1, _mm256_permute2x128_si256( q0, q1, 0x31 ) );
+        _mm256_storeu_si256( p + 2, _mm256_permute2x128_si256( q2, q3, 0x20 ) );
+        _mm256_storeu_si256( p + 3, _mm256_permute2x128_si256( q2, q3, 0x31 ) );
+    }
+    interleaveScalar( r + i, g + i, b + i, rgbx + i * 4, pixels - i );
+}
+
+bool cpuHasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports( "avx2" );
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid( info, 1 );
+    const bool osxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+    const bool avx = ( info[2] & ( 1 << 28 ) ) != 0;
+    // 操作系统必须保存 YMM 寄存器
+    if ( !osxsave || !avx || ( _xgetbv( 0 ) & 6 ) != 6 ) return false;
+    __cpuidex( info, 7, 0 );
+    return ( info[1] & ( 1 << 5 ) ) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif // SIMD_X86
+
+#ifdef SIMD_NEON
+
+// ---------------------------------------------------------------- NEON
+// vld4 / vst4 直接按通道拆开交错数据; 查表的两个内核没有 gather 可用, 沿用标量版本
+
+void premultiplyNeon( uint8_t* rgba, size_t pixels ) {
+    const uint16x8_t half = vdupq_n_u16( 128 );
+    size_t i = 0;
+    for ( ; i + 16 <= pixels; i += 16 ) {
+        uint8x16x4_t v = vld4q_u8( rgba + i * 4 );
+        for ( int c = 0; c < 3; ++c ) {
+            uint16x8_t lo = vaddq_u16( vmull_u8( vget_low_u8( v.val[c] ), vget_low_u8( v.val[3] ) ), half );
+            uint16x8_t hi = vaddq_u16( vmull_u8( vget_high_u8( v.val[c] ), vget_high_u8( v.val[3] ) ), half );
+            lo = vaddq_u16( lo, vshrq_n_u16( lo, 8 ) );
+            hi = vaddq_u16( hi, vshrq_n_u16( hi, 8 ) );
+            v.val[c] = vcombine_u8( vshrn_n_u16( lo, 8 ), vshrn_n_u16( hi, 8 ) );
+        }
+        vst4q_u8( rgba + i * 4, v );
+    }
+    premultiplyScalar( rgba + i * 4, pixels - i );
+}
+
+void swapRedBlueNeon( const uint8_t* src, uint8_t* dst, size_t pixels ) {
+    size_t i = 0;
+    for ( ; i + 16 <= pixels; i += 16 ) {
+        uint8x16x4_t v = vld4q_u8( src + i * 4 );
+        const uint8x16_t r = v.val[0];
+        v.val[0] = v.val[2];
+        v.val[2] = r;
+        vst4q_u8( dst + i * 4, v );
+    }
+    swapRedBlueScalar( src + i * 4, dst + i * 4, pixels - i );
+}
+
+void extractChannelNeon( const uint8_t* rgba, uint8_t* out, size_t pixels, int channel ) {
+    size_t i = 0;
+    for ( ; i + 16 <= pixels; i += 16 ) {
+        const uint8x16x4_t v = vld4q_u8( rgba + i * 4 );
+        vst1q_u8( out + i, v.val[channel] );
+    }
+    extractChannelScalar( rgba + i * 4, out + i, pixels - i, channel );
+}
+
+void interleaveNeon( const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* rgbx, size_t pixels ) {
+    size_t i = 0;
+    for ( ; i + 16 <= pixels; i += 16 ) {
+        uint8x16x4_t v;
+        v.val[0] = vld1q_u8( r + i );
+        v.val[1] = vld1q_u8( g + i );
+        v.val[2] = vld1q_u8( b + i );
+        v.val[3] = vdupq_n_u8( 255 );
+        vst4q_u8( rgbx + i * 4, v );
+    }
+    interleaveScalar( r + i, g + i, b + i, rgbx + i * 4, pixels - i );
+}
+
+#endif // SIMD_NEON
+
+PixelKernels makeScalar() {
+    PixelKernels k;
+    k.isa = PixelIsa::Scalar;
+    k.srgbToLinear = srgbToLinearScalar;
+    k.linearToSrgb = linearToSrgbScalar;
+    k.premultiply = premultiplyScalar;
+    k.swapRedBlue = swapRedBlueScalar;
+    k.extractChannel = extractChannelScalar;
+    k.interleave = interleaveScalar;
+    return k;
+}
+
+struct KernelTable {
+    PixelKernels scalar = makeScalar();
+    PixelKernels sse2;
+    PixelKernels avx2;
+    PixelKernels neon;
+    bool hasSse2 = false;
+    bool hasAvx2 = false;
+    bool hasNeon = false;
+    const PixelKernels* best = &scalar;
+
+    KernelTable() {
+        tables();   // 查表在第一次选择内核时生成, 之后只读, 工作线程可以并发使用
+#ifdef SIMD_X86
+        // x86-64 的基线包含 SSE2
+        sse2.isa = PixelIsa::Sse2;
+        sse2.srgbToLinear = srgbToLinearSse2;
+        sse2.linearToSrgb = linearToSrgbSse2;
+        sse2.premultiply = premultiplySse2;
+        sse2.swapRedBlue = swapRedBlueSse2;
+        sse2.extractChannel = extractChannelSse2;
+        sse2.interleave = interleaveSse2;
+        hasSse2 = true;
+        best = &sse2;
+
+        if ( cpuHasAvx2() ) {
+            avx2.isa = PixelIsa::Avx2;
+            avx2.srgbToLinear = srgbToLinearAvx2;
+            avx2.linearToSrgb = linearToSrgbAvx2;
+            avx2.premultiply = premultiplyAvx2;
+            avx2.swapRedBlue = swapRedBlueAvx2;
+            avx2.extractChannel = extractChannelAvx2;
+            avx2.interleave = interleaveAvx2;
+            hasAvx2 = true;
+            best = &avx2;
+        }
+#endif
+#ifdef SIMD_NEON
+        neon = makeScalar();
+        neon.isa = PixelIsa::Neon;
+        neon.premultiply = premultiplyNeon;
+        neon.swapRedBlue = swapRedBlueNeon;
+        neon.extractChannel = extractChannelNeon;
+        neon.interleave = interleaveNeon;
+        hasNeon = true;
+        best = &neon;
+#endif
+    }
+};
+
+const KernelTable& kernelTable() {
+    static const KernelTable table;
+    return table;
+}
+
+} // namespace
+
+const PixelKernels& PixelConvert::kernels() {
+    return *kernelTable().best;
+}
+
+const PixelKernels* PixelConvert::kernels( PixelIsa isa ) {
+    const KernelTable& table = kernelTable();
+    switch ( isa ) {
+    case PixelIsa::Scalar: return &table.scalar;
+    case PixelIsa::Sse2: return table.hasSse2 ? &table.sse2 : nullptr;
+    case PixelIsa::Avx2: return table.hasAvx2 ? &table.avx2 : nullptr;
+    case PixelIsa::Neon: return table.hasNeon ? &table.neon : nullptr;
+    }
+    return nullptr;
+}
+
+const char* PixelConvert::name( PixelIsa isa ) {
+    switch ( isa ) {
+    case PixelIsa::Scalar: return "scalar";
+    case PixelIsa::Sse2: return "SSE2";
+    case PixelIsa::Avx2: return "AVX2";
+    case PixelIsa::Neon: return "NEON";
+    }
+    return "unknown";
+}
@@ -0,0 +1,59 @@
+// 单一职责: 解码后图像的逐像素转换 (sRGB <-> 线性, 预乘 alpha, 通道交换 / 提取 / 交织)
+// 每个内核都有标量参考实现和 SSE2 / AVX2 / NEON 版本, 运行时按 CPU 选择最快的一组
+// 所有版本与标量结果逐字节一致 (浮点输出逐位一致), 见 PixelBenchmark
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class PixelIsa {
+    Scalar,
+    Sse2,
+    Avx2,
+    Neon
+};
+
+// 一组内核, 像素均为 RGBA 四通道交错存储, pixels 为像素个数
+struct PixelKernels {
+    PixelIsa isa = PixelIsa::Scalar;
+
+    // RGB 按 sRGB 解码成线性浮点, alpha 按线性除以 255
+    void (*srgbToLinear)( const uint8_t* rgba, float* out, size_t pixels ) = nullptr;
+
+    // 线性浮点编码回 sRGB 字节, 超出 [0, 1] 的值 (包括 NaN) 截断
+    void (*linearToSrgb)( const float* rgba, uint8_t* out, size_t pixels ) = nullptr;
+
+    // 原地预乘 alpha, 结果为 round( c * a / 255 )
+    void (*premultiply)( uint8_t* rgba, size_t pixels ) = nullptr;
+
+    // 交换 R 和 B (BGRA <-> RGBA), src 与 dst 可以相同
+    void (*swapRedBlue)( const uint8_t* src, uint8_t* dst, size_t pixels ) = nullptr;
+
+    // 取出一个通道 (0 - 3) 成单通道图, 例如把金属度贴图打包成 R8
+    void (*extractChannel)( const uint8_t* rgba, uint8_t* out, size_t pixels, int channel ) = nullptr;
+
+    // 三个单通道平面交织成 RGBX, X 固定为 255
+    void (*interleave)( const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* rgbx, size_t pixels ) = nullptr;
+};
+
+class PixelConvert {
+public:
+    // 当前 CPU 上最快的一组内核
+    static const PixelKernels& kernels();
+
+    // 指定指令集的内核, 编译目标或 CPU 不支持时返回 nullptr
+    static const PixelKernels* kernels( PixelIsa isa );
+
+    static const char* name( PixelIsa isa );
+
+    static void srgbToLinear( const uint8_t* rgba, float* out, size_t pixels ) { kernels().srgbToLinear( rgba, out, pixels ); }
+    static void linearToSrgb( const float* rgba, uint8_t* out, size_t pixels ) { kernels().linearToSrgb( rgba, out, pixels ); }
+    static void premultiply( uint8_t* rgba, size_t pixels ) { kernels().premultiply( rgba, pixels ); }
+    static void swapRedBlue( const uint8_t* src, uint8_t* dst, size_t pixels ) { kernels().swapRedBlue( src, dst, pixels ); }
+    static void extractChannel( const uint8_t* rgba, uint8_t* out, size_t pixels, int channel ) {
+        kernels().extractChannel( rgba, out, pixels, channel );
+    }
+    static void interleave( const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* rgbx, size_t pixels ) {
+        kernels().interleave( r, g, b, rgbx, pixels );
+    }
+};
@@ -0,0 +1,241 @@
+// 单一职责: 定义后端无关的渲染命令 (绘制 / 绑定 / 上传 / 计算)
+// 命令是 POD 结构, 录制时按顺序写入 CommandBuffer 的线性内存, 由具体后端在渲染线程回放
+#pragma once
+
+#include <cstdint>
+
+// 后端资源句柄 (GL 后端中即 program / buffer / texture 的对象名)
+using RenderHandle = uint32_t;
+
+enum class CommandType : uint16_t {
+    Clear,
+    SetViewport,
+    SetRenderState,
+    BindProgram,
+    SetUniformMat4,
+    SetUniformVec4,
+    BindVertexBuffer,
+    BindIndexBuffer,
+    BindTexture,
+    BindUniformBuffer,
+    UploadBuffer,
+    UploadTexture,
+    BindImage,
+    DispatchCompute,
+    Draw,
+    DrawIndexed,
+};
+
+enum ClearFlag : uint32_t {
+    ClearColor   = 1u << 0,
+    ClearDepth   = 1u << 1,
+    ClearStencil = 1u << 2,
+};
+
+enum class PrimitiveType : uint8_t {
+    Triangles,
+    TriangleStrip,
+    Lines,
+    Points,
+};
+
+enum class IndexType : uint8_t {
+    UInt16,
+    UInt32,
+};
+
+enum class BufferTarget : uint8_t {
+    Vertex,
+    Index,
+    Uniform,
+};
+
+enum class TextureTarget : uint8_t {
+    Texture2D,
+    TextureCube,
+};
+
+// 纹理数据 / image 的像素格式, 只包含数据纹理用到的非归一化格式
+enum class PixelFormat : uint8_t {
+    RGBA32F,
+    RG32UI,
+    R32UI,
+};
+
+enum class ImageAccess : uint8_t {
+    ReadOnly,
+    WriteOnly,
+    ReadWrite,
+};
+
+enum class CompareFunc : uint8_t {
+    Less,
+    LessEqual,
+    Equal,
+    Always,
+};
+
+// 固定管线状态 整体设置 由后端做差量比较
+struct RenderState {
+    bool depthTest = false;
+    bool depthWrite = true;
+    CompareFunc depthFunc = CompareFunc::Less;
+    bool blend = false;             // 预乘 alpha 混合
+    bool cullBackFace = false;
+    bool colorWrite = true;
+
+    bool operator==( const RenderState& other ) const {
+        return depthTest == other.depthTest && depthWrite == other.depthWrite
+               && depthFunc == other.depthFunc && blend == other.blend
+               && cullBackFace == other.cullBackFace && colorWrite == other.colorWrite;
+    }
+    bool operator!=( const RenderState& other ) const { return !( *this == other ); }
+};
+
+// 顶点属性描述 (只支持 float 分量)
+struct VertexAttribute {
+    uint8_t location;
+    uint8_t components;
+    uint16_t offset;
+};
+
+// 所有命令的公共头, 以单链表串起来; 指针指向同一帧分配器中的内存
+struct CommandHeader {
+    CommandType type;
+    const CommandHeader* next;
+};
+
+namespace cmd {
+
+struct Clear {
+    static constexpr CommandType kType = CommandType::Clear;
+    CommandHeader header;
+    uint32_t flags;
+    float color[4];
+    float depth;
+};
+
+struct SetViewport {
+    static constexpr CommandType kType = CommandType::SetViewport;
+    CommandHeader header;
+    int32_t x, y, width, height;
+};
+
+struct SetRenderState {
+    static constexpr CommandType kType = CommandType::SetRenderState;
+    CommandHeader header;
+    RenderState state;
+};
+
+struct BindProgram {
+    static constexpr CommandType kType = CommandType::BindProgram;
+    CommandHeader header;
+    RenderHandle program;
+};
+
+struct SetUniformMat4 {
+    static constexpr CommandType kType = CommandType::SetUniformMat4;
+    CommandHeader header;
+    int32_t location;
+    float value[16];    // 列主序
+};
+
+struct SetUniformVec4 {
+    static constexpr CommandType kType = CommandType::SetUniformVec4;
+    CommandHeader header;
+    int32_t location;
+    float value[4];
+};
+
+struct BindVertexBuffer {
+    static constexpr int kMaxAttributes = 8;
+    static constexpr CommandType kType = CommandType::BindVertexBuffer;
+    CommandHeader header;
+    RenderHandle buffer;
+    uint32_t stride;
+    uint32_t attributeCount;
+    VertexAttribute attributes[kMaxAttributes];
+};
+
+struct BindIndexBuffer {
+    static constexpr CommandType kType = CommandType::BindIndexBuffer;
+    CommandHeader header;
+    RenderHandle buffer;
+    IndexType indexType;
+};
+
+struct BindTexture {
+    static constexpr CommandType kType = CommandType::BindTexture;
+    CommandHeader header;
+    uint32_t unit;
+    RenderHandle texture;
+    TextureTarget target;
+};
+
+// 把 uniform buffer 的一段绑定到块绑定点 (glBindBufferRange)
+struct BindUniformBuffer {
+    static constexpr CommandType kType = CommandType::BindUniformBuffer;
+    CommandHeader header;
+    uint32_t binding;
+    RenderHandle buffer;
+    uint32_t offset;
+    uint32_t size;
+};
+
+// 数据紧跟在命令之后, 录制时已拷贝到帧内存, 录制线程无需保持源数据存活
+// orphan 为 true 时整块重新分配 (glBufferData), 可用于增长容量, 此时 offset 必须为 0
+struct UploadBuffer {
+    static constexpr CommandType kType = CommandType::UploadBuffer;
+    CommandHeader header;
+    BufferTarget target;
+    bool orphan;
+    RenderHandle buffer;
+    uint32_t offset;
+    uint32_t size;
+    const void* data;
+};
+
+// 更新 2D 纹理的一个矩形 (glTexSubImage2D), 数据同样在录制时拷贝; 纹理必须已按 format 分配好
+struct UploadTexture {
+    static constexpr CommandType kType = CommandType::UploadTexture;
+    CommandHeader header;
+    PixelFormat format;
+    RenderHandle texture;
+    int32_t x, y, width, height;
+    const void* data;
+};
+
+// 把纹理的第 0 级绑定到 image 单元, 供计算着色器读写 (GL 4.3 / ES 3.1)
+struct BindImage {
+    static constexpr CommandType kType = CommandType::BindImage;
+    CommandHeader header;
+    uint32_t unit;
+    RenderHandle texture;
+    PixelFormat format;
+    ImageAccess access;
+};
+
+// 派发计算着色器, 之后插入屏障, 后续的纹理读取和 image 访问能看到写入结果
+struct DispatchCompute {
+    static constexpr CommandType kType = CommandType::DispatchCompute;
+    CommandHeader header;
+    uint32_t groupsX, groupsY, groupsZ;
+};
+
+struct Draw {
+    static constexpr CommandType kType = CommandType::Draw;
+    CommandHeader header;
+    PrimitiveType primitive;
+    uint32_t first;
+    uint32_t count;
+};
+
+struct DrawIndexed {
+    static constexpr CommandType kType = CommandType::DrawIndexed;
+    CommandHeader header;
+    PrimitiveType primitive;
+    uint32_t firstIndex;
+    uint32_t count;
+};
+
+} // namespace cmd
@@ -2,6 +2,8 @@
 #pragma once
 #include <QString>
 #include <QVector3D>
+#include <QVector4D>
+#include <cstddef>
 #include <vector>
 
 
@@ -41,12 +43,81 @@ public:
         return *this;
     }
 
+    // 深度预渲染: 先只写深度 再只着色可见片元
+    RenderConfig& setDepthPrepass( bool enabled ) {
+        m_depthPrepass = enabled;
+        return *this;
+    }
+
+    RenderConfig& setDepthFragmentShaderPath( const QString& path ) {
+        m_depthFragmentShaderPath = path;
+        return *this;
+    }
+
+    // 网格渲染器每个轴上的实例数量
+    RenderConfig& setInstanceGrid( int count ) {
+        m_instanceGrid = count;
+        return *this;
+    }
+
+    // 软件遮挡剔除: 最近的实例光栅化成 CPU 深度缓冲, 被完全挡住的实例不提交
+    RenderConfig& setOcclusionCulling( bool enabled ) {
+        m_occlusionCulling = enabled;
+        return *this;
+    }
+
+    // 模型文件 (OBJ), 材质从同目录的 MTL 读取
+    RenderConfig& setModelPath( const QString& path ) {
+        m_modelPath = path;
+        return *this;
+    }
+
+    // 纹理流送: 每帧最多上传的字节数
+    RenderConfig& setTextureUploadBudget( size_t bytesPerFrame ) {
+        m_textureUploadBudget = bytesPerFrame;
+        return *this;
+    }
+
+    // 纹理流送: 常驻显存上限, 超出时丢弃最细的 mip, 0 表示不限制
+    RenderConfig& setTextureMemoryBudget( size_t bytes ) {
+        m_textureMemoryBudget = bytes;
+        return *this;
+    }
+
+    // 基于图像的光照使用的 Radiance HDR 环境贴图 (等距柱状投影), 为空时使用程序生成的天空
+    RenderConfig& setEnvironmentMapPath( const QString& path ) {
+        m_environmentMapPath = path;
+        return *this;
+    }
+
+    // 分簇点光源的数量, 0 表示不使用
+    RenderConfig& setPointLightCount( int count ) {
+        m_pointLightCount = count;
+        return *this;
+    }
+
+    // 分簇用的计算着色器 (需要桌面 GL 4.3), 为空或不支持时在 CPU 上分簇
+    RenderConfig& setLightCullingShaderPath( const QString& path ) {
+        m_lightCullingShaderPath = path;
+        return *this;
+    }
+
     // Getters
     QString vertexShaderPath() const { return m_vertexShaderPath; }
     QString fragmentShaderPath() const { return m_fragmentShaderPath; }
     const std::vector<VertexData>& vertexData() const { return m_vertexData; }
     QVector4D clearColor() const { return m_clearColor; }
     float rotationSpeed() const { return m_rotationSpeed; }
+    bool depthPrepass() const { return m_depthPrepass; }
+    QString depthFragmentShaderPath() const { return m_depthFragmentShaderPath; }
+    int instanceGrid() const { return m_instanceGrid; }
+    bool occlusionCulling() const { return m_occlusionCulling; }
+    QString modelPath() const { return m_modelPath; }
+    size_t textureUploadBudget() const { return m_textureUploadBudget; }
+    size_t textureMemoryBudget() const { return m_textureMemoryBudget; }
+    QString environmentMapPath() const { return m_environmentMapPath; }
+    int pointLightCount() const { return m_pointLightCount; }
+    QString lightCullingShaderPath() const { return m_lightCullingShaderPath; }
 
 
     /* ------------------------------------------------
@@ -79,6 +150,58 @@ public:
         return config;
     }
 
+    /* ------------------------------------------------
+     * 生成立方体(索引网格)渲染的config
+     * 网格数据由渲染器自己提供, 这里只配置着色器和绘制方式
+    * ------------------------------------------------ */
+    static RenderConfig createCubeConfig() {
+        RenderConfig config;
+
+#ifdef Q_OS_WIN
+        config.setFragmentShaderPath(":/src/Shaders/mesh.frag.glsl")
+            .setVertexShaderPath(":/src/Shaders/mesh.vert.glsl")
+            .setDepthFragmentShaderPath(":/src/Shaders/depth_only.frag.glsl");
+#else
+        config.setFragmentShaderPath(":/src/Shaders/mesh.es.frag.glsl")
+            .setVertexShaderPath(":/src/Shaders/mesh.es.vert.glsl")
+            .setDepthFragmentShaderPath(":/src/Shaders/depth_only.es.frag.glsl");
+#endif
+
+        config.setClearColor(0.0f, 0.0f, 0.0f, 0.0f)
+            .setRotationSpeeed(1.0f)
+            .setDepthPrepass(true)
+            .setInstanceGrid(5)
+            .setOcclusionCulling(true);
+
+        return config;
+    }
+
+    /* ------------------------------------------------
+     * 生成 PBR 模型渲染的config
+     * 默认加载随程序打包的 ddm 模型
+    * ------------------------------------------------ */
+    static RenderConfig createPbrConfig() {
+        RenderConfig config;
+
+#ifdef Q_OS_WIN
+        config.setFragmentShaderPath(":/src/Shaders/pbr.frag.glsl")
+            .setVertexShaderPath(":/src/Shaders/pbr.vert.glsl")
+            .setLightCullingShaderPath(":/src/Shaders/light_cluster.comp.glsl");
+#else
+        config.setFragmentShaderPath(":/src/Shaders/pbr.es.frag.glsl")
+            .setVertexShaderPath(":/src/Shaders/pbr.es.vert.glsl");
+#endif
+
+        config.setClearColor(0.0f, 0.0f, 0.0f, 0.0f)
+            .setRotationSpeeed(0.5f)
+            .setModelPath(":/resources/ddm/2e9f26c85c76492fd28cdb3e2a171095.obj")
+            .setTextureUploadBudget(4u << 20)
+            .setTextureMemoryBudget(64u << 20)
+            .setPointLightCount(64);
+
+        return config;
+    }
+
 
 private:
     QString m_vertexShaderPath;
@@ -86,4 +209,14 @@ private:
     std::vector<VertexData> m_vertexData;
     QVector4D m_clearColor{ 0.0f, 0.0f, 0.0f, 1.0f };   // 为什么不是 () 而是 {}?
     float m_rotationSpeed{1.0f};
+    bool m_depthPrepass{false};
+    QString m_depthFragmentShaderPath;
+    int m_instanceGrid{1};
+    bool m_occlusionCulling{false};
+    QString m_modelPath;
+    size_t m_textureUploadBudget{4u << 20};
+    size_t m_textureMemoryBudget{0};
+    QString m_environmentMapPath;
+    int m_pointLightCount{0};
+    QString m_lightCullingShaderPath;
 };
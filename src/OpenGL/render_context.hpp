@@ -11,6 +11,7 @@ public:
     : m_viewportSize(viewportSize)
     , m_projectionMatrix(projectionMatrix)
     , m_deltaTime(deltaTime)
+    , m_time(0.0f)
     , m_frameNumber(0)
     {}
 
@@ -20,8 +21,10 @@ public:
     int height() const { return m_viewportSize.height(); }
 
     QMatrix4x4 projectionMatrix() const { return m_projectionMatrix; }
+    QMatrix4x4 viewMatrix() const { return m_viewMatrix; }
 
     float deltaTime() const { return m_deltaTime; }
+    float time() const { return m_time; }           // 渲染器启动以来的秒数
     quint64 frameNumer() const { return m_frameNumber; }
 
     // 创建新的上下文(不可变模式)
@@ -38,9 +41,23 @@ public:
         return ctx;
     }
 
+    RenderContext withTime( float seconds ) const {
+        RenderContext ctx = *this;
+        ctx.m_time = seconds;
+        return ctx;
+    }
+
+    RenderContext withViewMatrix( const QMatrix4x4& view ) const {
+        RenderContext ctx = *this;
+        ctx.m_viewMatrix = view;
+        return ctx;
+    }
+
 private:
     QSize m_viewportSize;
     QMatrix4x4 m_projectionMatrix;
+    QMatrix4x4 m_viewMatrix;        // 默认单位矩阵
     float m_deltaTime;
+    float m_time;
     quint64 m_frameNumber;
 };
@@ -1,11 +1,15 @@
 #pragma once
 #include "irenderer.hpp"
 #include "triangle_render.hpp"
+#include "mesh_render.hpp"
+#include "pbr_render.hpp"
+#include "render_config.hpp"
 #include <memory>
 
 enum class RenderType {
     Triangle,
     Cube,
+    Pbr,
     Custom,
 };
 
@@ -17,6 +21,12 @@ public:
         case RenderType::Triangle:
             return std::make_unique<TriangleRender>();
             break;
+        case RenderType::Cube:
+            return std::make_unique<MeshRender>( MeshData::createCube( 0.4f ), "CubeRender" );
+            break;
+        case RenderType::Pbr:
+            return std::make_unique<PbrRender>();
+            break;
         default:
             return nullptr;
             break;
@@ -26,10 +36,24 @@ public:
     static std::unique_ptr<IRenderer> create( const std::string& typeName ) {
         if ( typeName == "triangle" ) {
             return create( RenderType::Triangle );
+        } else if ( typeName == "cube" ) {
+            return create( RenderType::Cube );
+        } else if ( typeName == "pbr" ) {
+            return create( RenderType::Pbr );
         } else {
             return nullptr;
         }
     }
+
+    // 每种渲染器的默认配置
+    static RenderConfig defaultConfig( const std::string& typeName ) {
+        if ( typeName == "cube" ) {
+            return RenderConfig::createCubeConfig();
+        } else if ( typeName == "pbr" ) {
+            return RenderConfig::createPbrConfig();
+        }
+        return RenderConfig::createTriangleConfig();
+    }
 private:
     // 禁止实例化
     RenderFactory() = delete;
@@ -0,0 +1,206 @@
+#include "render_queue.hpp"
+#include "uniform_buffer.hpp"
+
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t kProgramBits = 10;
+constexpr uint32_t kTextureBits = 12;
+constexpr uint32_t kMeshBits = 12;
+constexpr uint32_t kDepthBits = 24;
+constexpr uint32_t kStateBits = kProgramBits + kTextureBits + kMeshBits + 3;
+
+constexpr uint64_t mask( uint32_t bits ) {
+    return ( uint64_t(1) << bits ) - 1;
+}
+
+uint32_t depthStateBits( const RenderState& state ) {
+    return ( state.depthTest ? 1u : 0u ) | ( state.depthWrite ? 2u : 0u );
+}
+
+} // namespace
+
+void RenderQueue::begin( float nearPlane, float farPlane ) {
+    m_items.clear();
+    m_keys.clear();
+    m_programIds.clear();
+    m_textureIds.clear();
+    m_meshIds.clear();
+    m_near = nearPlane;
+    m_far = farPlane > nearPlane ? farPlane : nearPlane + 1.0f;
+    m_stats = SubmissionStats();
+}
+
+void RenderQueue::add( const DrawItem& item ) {
+    const bool translucent = item.state.blend;
+    const uint32_t program = compactId( m_programIds, item.program, kProgramBits );
+    const uint32_t texture = compactId( m_textureIds, item.texture, kTextureBits );
+    const uint32_t mesh = compactId( m_meshIds, item.vertexBuffer, kMeshBits );
+
+    uint32_t depth = quantizeDepth( item.viewDepth );
+    if ( translucent ) {
+        // 从后往前: 越远的键越小
+        depth = uint32_t( mask( kDepthBits ) ) - depth;
+    }
+
+    m_keys.push_back( makeSortKey( item.pass, translucent, program, texture, mesh, item.state.blend,
+                                   depthStateBits( item.state ), depth ) );
+    m_items.push_back( item );
+}
+
+uint64_t RenderQueue::makeSortKey( uint32_t pass, bool translucent, uint32_t program, uint32_t texture, uint32_t mesh,
+                                   bool blend, uint32_t depthState, uint32_t depth ) {
+    const uint64_t state = ( ( uint64_t( program ) & mask( kProgramBits ) ) << ( kTextureBits + kMeshBits + 3 ) )
+                         | ( ( uint64_t( texture ) & mask( kTextureBits ) ) << ( kMeshBits + 3 ) )
+                         | ( ( uint64_t( mesh ) & mask( kMeshBits ) ) << 3 )
+                         | ( uint64_t( blend ? 1 : 0 ) << 2 )
+                         | ( uint64_t( depthState ) & 0x3 );
+    const uint64_t d = uint64_t( depth ) & mask( kDepthBits );
+    const uint64_t head = ( uint64_t( pass & 0x3 ) << 62 ) | ( uint64_t( translucent ? 1 : 0 ) << 61 );
+
+    if ( translucent ) {
+        return head | ( d << kStateBits ) | state;
+    }
+    return head | ( state << kDepthBits ) | d;
+}
+
+void RenderQueue::radixSort( std::vector<uint64_t>& keys, std::vector<uint32_t>& indices,
+                             std::vector<uint64_t>& scratchKeys, std::vector<uint32_t>& scratchIndices ) {
+    const size_t n = keys.size();
+    scratchKeys.resize( n );
+    scratchIndices.resize( n );
+    if ( n < 2 ) return;
+
+    // 一次遍历算出全部 8 个字节的直方图
+    uint32_t histogram[8][256];
+    std::memset( histogram, 0, sizeof(histogram) );
+    for ( size_t i = 0; i < n; ++i ) {
+        const uint64_t key = keys[i];
+        for ( int pass = 0; pass < 8; ++pass ) {
+            ++histogram[pass][( key >> ( pass * 8 ) ) & 0xFF];
+        }
+    }
+
+    uint64_t* srcKeys = keys.data();
+    uint32_t* srcIndices = indices.data();
+    uint64_t* dstKeys = scratchKeys.data();
+    uint32_t* dstIndices = scratchIndices.data();
+
+    for ( int pass = 0; pass < 8; ++pass ) {
+        uint32_t* counts = histogram[pass];
+        // 所有键在这个字节相同 这一轮是空操作
+        if ( counts[( srcKeys[0] >> ( pass * 8 ) ) & 0xFF] == n ) continue;
+
+        uint32_t offset = 0;
+        for ( int bucket = 0; bucket < 256; ++bucket ) {
+            const uint32_t count = counts[bucket];
+            counts[bucket] = offset;
+            offset += count;
+        }
+
+        for ( size_t i = 0; i < n; ++i ) {
+            const uint32_t bucket = uint32_t( ( srcKeys[i] >> ( pass * 8 ) ) & 0xFF );
+            const uint32_t dst = counts[bucket]++;
+            dstKeys[dst] = srcKeys[i];
+            dstIndices[dst] = srcIndices[i];
+        }
+
+        std::swap( srcKeys, dstKeys );
+        std::swap( srcIndices, dstIndices );
+    }
+
+    // 结果留在 scratch 里的话拷回去
+    if ( srcKeys != keys.data() ) {
+        std::memcpy( keys.data(), srcKeys, n * sizeof(uint64_t) );
+        std::memcpy( indices.data(), srcIndices, n * sizeof(uint32_t) );
+    }
+}
+
+void RenderQueue::submit( CommandBuffer& commands ) {
+    const uint32_t n = static_cast<uint32_t>( m_items.size() );
+    m_stats.drawCount = n;
+    if ( n == 0 ) return;
+
+    m_order.resize( n );
+    for ( uint32_t i = 0; i < n; ++i ) m_order[i] = i;
+
+    // 提交顺序下的切换次数
+    countSwitches( m_items, m_order, m_stats.programSwitchesBefore, m_stats.textureSwitchesBefore );
+
+    radixSort( m_keys, m_order, m_scratchKeys, m_scratchOrder );
+
+    countSwitches( m_items, m_order, m_stats.programSwitchesAfter, m_stats.textureSwitchesAfter );
+
+    // 按排序结果写命令 只在状态变化时才记录绑定
+    const DrawItem* previous = nullptr;
+    for ( uint32_t index : m_order ) {
+        const DrawItem& item = m_items[index];
+
+        if ( !previous || previous->state != item.state ) {
+            commands.setRenderState( item.state );
+        }
+        if ( !previous || previous->program != item.program ) {
+            commands.bindProgram( item.program );
+        }
+        if ( item.texture && ( !previous || previous->texture != item.texture ) ) {
+            commands.bindTexture( 0, item.texture );
+        }
+        for ( uint32_t unit = 0; unit < DrawItem::kMaxExtraTextures; ++unit ) {
+            const RenderHandle texture = item.extraTextures[unit];
+            if ( texture && ( !previous || previous->extraTextures[unit] != texture ) ) {
+                commands.bindTexture( unit + 1, texture );
+            }
+        }
+        if ( !previous || previous->vertexBuffer != item.vertexBuffer
+             || previous->stride != item.stride || previous->attributeCount != item.attributeCount
+             || std::memcmp( previous->attributes, item.attributes, sizeof(VertexAttribute) * item.attributeCount ) != 0 ) {
+            commands.bindVertexBuffer( item.vertexBuffer, item.stride, item.attributes, item.attributeCount );
+        }
+        if ( item.indexBuffer && ( !previous || previous->indexBuffer != item.indexBuffer ) ) {
+            commands.bindIndexBuffer( item.indexBuffer, item.indexType );
+        }
+        if ( item.uniformBuffer ) {
+            commands.bindUniformBuffer( ObjectBlockBinding, item.uniformBuffer, item.objectOffset, sizeof(ObjectUniforms) );
+        } else if ( item.transformLocation >= 0 ) {
+            commands.setUniform( item.transformLocation, item.transform );
+        }
+
+        if ( item.indexBuffer ) {
+            commands.drawIndexed( item.primitive, item.count, item.first );
+        } else {
+            commands.draw( item.primitive, item.first, item.count );
+        }
+        previous = &item;
+    }
+}
+
+uint32_t RenderQueue::compactId( std::unordered_map<RenderHandle, uint32_t>& table, RenderHandle handle, uint32_t bits ) {
+    auto it = table.find( handle );
+    if ( it != table.end() ) return it->second;
+
+    // 超出位宽时回绕 只影响排序质量 不影响正确性
+    const uint32_t id = static_cast<uint32_t>( table.size() ) & uint32_t( mask( bits ) );
+    table.emplace( handle, id );
+    return id;
+}
+
+uint32_t RenderQueue::quantizeDepth( float viewDepth ) const {
+    float t = ( viewDepth - m_near ) / ( m_far - m_near );
+    if ( t < 0.0f ) t = 0.0f;
+    if ( t > 1.0f ) t = 1.0f;
+    return static_cast<uint32_t>( t * float( mask( kDepthBits ) ) );
+}
+
+void RenderQueue::countSwitches( const std::vector<DrawItem>& items, const std::vector<uint32_t>& order,
+                                 uint32_t& programSwitches, uint32_t& textureSwitches ) {
+    programSwitches = 0;
+    textureSwitches = 0;
+    const DrawItem* previous = nullptr;
+    for ( uint32_t index : order ) {
+        const DrawItem& item = items[index];
+        if ( !previous || previous->program != item.program ) ++programSwitches;
+        if ( item.texture && ( !previous || previous->texture != item.texture ) ) ++textureSwitches;
+        previous = &item;
+    }
+}
@@ -0,0 +1,94 @@
+// 单一职责: 收集一帧的绘制, 按打包的 64 位状态键排序后写入 CommandBuffer
+// 不透明物体按 program/纹理/网格 聚合并从前往后, 半透明物体从后往前
+#pragma once
+
+#include "command_buffer.hpp"
+
+#include <QMatrix4x4>
+#include <unordered_map>
+#include <vector>
+
+// 一次绘制需要的全部状态
+struct DrawItem {
+    RenderHandle program = 0;
+    RenderHandle texture = 0;           // 纹理单元0 (0 表示不绑定)
+    static constexpr uint32_t kMaxExtraTextures = 3;
+    RenderHandle extraTextures[kMaxExtraTextures] = {};     // 纹理单元1~3, 材质的其余贴图 (不参与排序)
+    RenderHandle vertexBuffer = 0;
+    RenderHandle indexBuffer = 0;       // 0 表示非索引绘制
+    IndexType indexType = IndexType::UInt16;
+    uint32_t stride = 0;
+    uint32_t attributeCount = 0;
+    VertexAttribute attributes[cmd::BindVertexBuffer::kMaxAttributes];
+
+    uint8_t pass = 0;                   // 渲染阶段 (0~3), 先于其他所有状态排序, 例如深度预渲染为 0
+    RenderState state;
+    PrimitiveType primitive = PrimitiveType::Triangles;
+    uint32_t first = 0;                 // 非索引: 起始顶点 索引: 起始索引
+    uint32_t count = 0;
+
+    RenderHandle uniformBuffer = 0;     // ObjectBlock 所在的 UBO (见 UniformBuffer)
+    uint32_t objectOffset = 0;          // ObjectBlock 在 UBO 中的字节偏移
+
+    int transformLocation = -1;         // 不使用 UBO 的 program: 每个绘制单独设置矩阵 uniform
+    QMatrix4x4 transform;
+
+    float viewDepth = 0.0f;             // 观察空间深度 (正数 越大越远)
+};
+
+// 排序前后的状态切换统计
+struct SubmissionStats {
+    uint32_t drawCount = 0;
+    uint32_t programSwitchesBefore = 0;
+    uint32_t textureSwitchesBefore = 0;
+    uint32_t programSwitchesAfter = 0;
+    uint32_t textureSwitchesAfter = 0;
+    uint32_t culledCount = 0;           // 提交之前被遮挡剔除的物体, 由渲染器填写
+};
+
+class RenderQueue {
+public:
+    RenderQueue() = default;
+
+    // 每帧开始时调用, nearPlane/farPlane 用于把深度量化进排序键
+    void begin( float nearPlane, float farPlane );
+
+    void add( const DrawItem& item );
+
+    // 排序并把全部绘制写入命令缓冲 会省略与上一个绘制相同的绑定
+    void submit( CommandBuffer& commands );
+
+    const SubmissionStats& stats() const { return m_stats; }
+    size_t size() const { return m_items.size(); }
+
+    // 排序键布局 (高位优先):
+    //   不透明: pass:2 | 0 | program:10 | texture:12 | mesh:12 | blend:1 | depthState:2 | depth:24 (近→远)
+    //   半透明: pass:2 | 1 | depth:24 (远→近) | program:10 | texture:12 | mesh:12 | blend:1 | depthState:2
+    static uint64_t makeSortKey( uint32_t pass, bool translucent, uint32_t program, uint32_t texture, uint32_t mesh,
+                                 bool blend, uint32_t depthState, uint32_t depth );
+
+    // 对 (key, index) 做 LSD 基数排序, 跳过所有键在该字节相同的轮次
+    static void radixSort( std::vector<uint64_t>& keys, std::vector<uint32_t>& indices,
+                           std::vector<uint64_t>& scratchKeys, std::vector<uint32_t>& scratchIndices );
+
+private:
+    uint32_t compactId( std::unordered_map<RenderHandle, uint32_t>& table, RenderHandle handle, uint32_t bits );
+    uint32_t quantizeDepth( float viewDepth ) const;
+    static void countSwitches( const std::vector<DrawItem>& items, const std::vector<uint32_t>& order,
+                               uint32_t& programSwitches, uint32_t& textureSwitches );
+
+    std::vector<DrawItem> m_items;
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_order;
+    std::vector<uint64_t> m_scratchKeys;
+    std::vector<uint32_t> m_scratchOrder;
+
+    // 把 GL 对象名压缩成连续的小整数 以便塞进有限的位宽
+    std::unordered_map<RenderHandle, uint32_t> m_programIds;
+    std::unordered_map<RenderHandle, uint32_t> m_textureIds;
+    std::unordered_map<RenderHandle, uint32_t> m_meshIds;
+
+    float m_near = 0.1f;
+    float m_far = 100.0f;
+    SubmissionStats m_stats;
+};
@@ -0,0 +1,207 @@
+// 单一职责: 4 个 float 的最小 SIMD 封装 (SSE2 / NEON / 标量), 用于逐像素的 RGBA 浮点运算
+// 以及 SoA 形式一次处理 4 个对象的几何测试 (见 LightClusterer) 和一次 4 个像素的光栅化 (见 OcclusionCuller)
+// 同时定义 SIMD_X86 / SIMD_NEON, 需要直接写内建函数的内核 (见 PixelConvert) 共用同一套检测
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+struct Vec4 {
+#if defined(SIMD_X86)
+    __m128 v;
+#elif defined(SIMD_NEON)
+    float32x4_t v;
+#else
+    float v[4];
+#endif
+
+    static Vec4 load( const float* p ) {
+#if defined(SIMD_X86)
+        return { _mm_loadu_ps( p ) };
+#elif defined(SIMD_NEON)
+        return { vld1q_f32( p ) };
+#else
+        return { { p[0], p[1], p[2], p[3] } };
+#endif
+    }
+
+    static Vec4 splat( float x ) {
+#if defined(SIMD_X86)
+        return { _mm_set1_ps( x ) };
+#elif defined(SIMD_NEON)
+        return { vdupq_n_f32( x ) };
+#else
+        return { { x, x, x, x } };
+#endif
+    }
+
+    static Vec4 zero() { return splat( 0.0f ); }
+
+    void store( float* p ) const {
+#if defined(SIMD_X86)
+        _mm_storeu_ps( p, v );
+#elif defined(SIMD_NEON)
+        vst1q_f32( p, v );
+#else
+        p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p[3] = v[3];
+#endif
+    }
+
+    // 4 个 8 位无符号归一化值 (RGBA 字节) 转成 [0, 1]
+    static Vec4 fromUnorm8( const uint8_t* p ) {
+#if defined(SIMD_X86)
+        int32_t word;
+        std::memcpy( &word, p, 4 );
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ints = _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128( word ), zero ), zero );
+        return { _mm_mul_ps( _mm_cvtepi32_ps( ints ), _mm_set1_ps( 1.0f / 255.0f ) ) };
+#elif defined(SIMD_NEON)
+        const uint8x8_t bytes = vcreate_u8( uint64_t( p[0] ) | uint64_t( p[1] ) << 8 | uint64_t( p[2] ) << 16 | uint64_t( p[3] ) << 24 );
+        const uint32x4_t ints = vmovl_u16( vget_low_u16( vmovl_u8( bytes ) ) );
+        return { vmulq_n_f32( vcvtq_f32_u32( ints ), 1.0f / 255.0f ) };
+#else
+        const float s = 1.0f / 255.0f;
+        return { { p[0] * s, p[1] * s, p[2] * s, p[3] * s } };
+#endif
+    }
+
+    // 截断到 [0, 1] 后就近取整成字节
+    void toUnorm8( uint8_t* p ) const {
+#if defined(SIMD_X86)
+        const __m128 clamped = _mm_min_ps( _mm_max_ps( v, _mm_setzero_ps() ), _mm_set1_ps( 1.0f ) );
+        const __m128i ints = _mm_cvtps_epi32( _mm_mul_ps( clamped, _mm_set1_ps( 255.0f ) ) );
+        const __m128i words = _mm_packs_epi32( ints, ints );
+        const int32_t word = _mm_cvtsi128_si32( _mm_packus_epi16( words, words ) );
+        std::memcpy( p, &word, 4 );
+#elif defined(SIMD_NEON)
+        const float32x4_t clamped = vminq_f32( vmaxq_f32( v, vdupq_n_f32( 0.0f ) ), vdupq_n_f32( 1.0f ) );
+        const uint32x4_t ints = vcvtq_u32_f32( vaddq_f32( vmulq_n_f32( clamped, 255.0f ), vdupq_n_f32( 0.5f ) ) );
+        const uint8x8_t bytes = vmovn_u16( vcombine_u16( vmovn_u32( ints ), vdup_n_u16( 0 ) ) );
+        p[0] = vget_lane_u8( bytes, 0 ); p[1] = vget_lane_u8( bytes, 1 );
+        p[2] = vget_lane_u8( bytes, 2 ); p[3] = vget_lane_u8( bytes, 3 );
+#else
+        for ( int i = 0; i < 4; ++i ) {
+            const float x = v[i] > 0.0f ? ( v[i] < 1.0f ? v[i] : 1.0f ) : 0.0f;
+            p[i] = uint8_t( x * 255.0f + 0.5f );
+        }
+#endif
+    }
+
+    float operator[]( int i ) const {
+        float lanes[4];
+        store( lanes );
+        return lanes[i];
+    }
+
+    friend Vec4 operator+( Vec4 a, Vec4 b ) {
+#if defined(SIMD_X86)
+        return { _mm_add_ps( a.v, b.v ) };
+#elif defined(SIMD_NEON)
+        return { vaddq_f32( a.v, b.v ) };
+#else
+        return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } };
+#endif
+    }
+
+    friend Vec4 operator-( Vec4 a, Vec4 b ) {
+#if defined(SIMD_X86)
+        return { _mm_sub_ps( a.v, b.v ) };
+#elif defined(SIMD_NEON)
+        return { vsubq_f32( a.v, b.v ) };
+#else
+        return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } };
+#endif
+    }
+
+    friend Vec4 operator*( Vec4 a, Vec4 b ) {
+#if defined(SIMD_X86)
+        return { _mm_mul_ps( a.v, b.v ) };
+#elif defined(SIMD_NEON)
+        return { vmulq_f32( a.v, b.v ) };
+#else
+        return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } };
+#endif
+    }
+
+    static Vec4 min( Vec4 a, Vec4 b ) {
+#if defined(SIMD_X86)
+        return { _mm_min_ps( a.v, b.v ) };
+#elif defined(SIMD_NEON)
+        return { vminq_f32( a.v, b.v ) };
+#else
+        Vec4 r;
+        for ( int i = 0; i < 4; ++i ) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+        return r;
+#endif
+    }
+
+    static Vec4 max( Vec4 a, Vec4 b ) {
+#if defined(SIMD_X86)
+        return { _mm_max_ps( a.v, b.v ) };
+#elif defined(SIMD_NEON)
+        return { vmaxq_f32( a.v, b.v ) };
+#else
+        Vec4 r;
+        for ( int i = 0; i < 4; ++i ) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+        return r;
+#endif
+    }
+
+    // 逐分量比较 a <= b, 结果的第 i 位对应第 i 个分量
+    static int lessEqualMask( Vec4 a, Vec4 b ) {
+#if defined(SIMD_X86)
+        return _mm_movemask_ps( _mm_cmple_ps( a.v, b.v ) );
+#elif defined(SIMD_NEON)
+        const uint32x4_t bits = vandq_u32( vcleq_f32( a.v, b.v ), uint32x4_t{ 1u, 2u, 4u, 8u } );
+        return int( vgetq_lane_u32( bits, 0 ) | vgetq_lane_u32( bits, 1 ) | vgetq_lane_u32( bits, 2 ) | vgetq_lane_u32( bits, 3 ) );
+#else
+        int mask = 0;
+        for ( int i = 0; i < 4; ++i ) mask |= ( a.v[i] <= b.v[i] ? 1 : 0 ) << i;
+        return mask;
+#endif
+    }
+
+    // 逐分量比较 a <= b, 成立的分量所有位为 1, 只用作 select 的掩码
+    static Vec4 lessEqual( Vec4 a, Vec4 b ) {
+#if defined(SIMD_X86)
+        return { _mm_cmple_ps( a.v, b.v ) };
+#elif defined(SIMD_NEON)
+        return { vreinterpretq_f32_u32( vcleq_f32( a.v, b.v ) ) };
+#else
+        Vec4 r;
+        for ( int i = 0; i < 4; ++i ) {
+            const uint32_t bits = a.v[i] <= b.v[i] ? 0xFFFFFFFFu : 0u;
+            std::memcpy( &r.v[i], &bits, 4 );
+        }
+        return r;
+#endif
+    }
+
+    // 掩码分量为真时取 a, 否则取 b
+    static Vec4 select( Vec4 mask, Vec4 a, Vec4 b ) {
+#if defined(SIMD_X86)
+        return { _mm_or_ps( _mm_and_ps( mask.v, a.v ), _mm_andnot_ps( mask.v, b.v ) ) };
+#elif defined(SIMD_NEON)
+        return { vbslq_f32( vreinterpretq_u32_f32( mask.v ), a.v, b.v ) };
+#else
+        Vec4 r;
+        for ( int i = 0; i < 4; ++i ) {
+            uint32_t bits;
+            std::memcpy( &bits, &mask.v[i], 4 );
+            r.v[i] = bits ? a.v[i] : b.v[i];
+        }
+        return r;
+#endif
+    }
+
+    // a + b * c
+    static Vec4 madd( Vec4 a, Vec4 b, Vec4 c ) { return a + b * c; }
+};
@@ -0,0 +1,484 @@
+#include "texture_codec.hpp"
+#include "job_pool.hpp"
+
+#include <QtGlobal>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+int clampByte( int value ) {
+    return value < 0 ? 0 : ( value > 255 ? 255 : value );
+}
+
+/* ------------------------------------------------
+ * BC1: 两个 RGB565 端点 + 16 个 2 位索引
+ * 端点取像素在主成分轴上的两端, 再用最小二乘修正一次
+* ------------------------------------------------ */
+uint16_t to565( float r, float g, float b ) {
+    const int R = qBound( 0, int( std::lround( r * 31.0f / 255.0f ) ), 31 );
+    const int G = qBound( 0, int( std::lround( g * 63.0f / 255.0f ) ), 63 );
+    const int B = qBound( 0, int( std::lround( b * 31.0f / 255.0f ) ), 31 );
+    return static_cast<uint16_t>( ( R << 11 ) | ( G << 5 ) | B );
+}
+
+void from565( uint16_t color, int rgb[3] ) {
+    const int r = ( color >> 11 ) & 31;
+    const int g = ( color >> 5 ) & 63;
+    const int b = color & 31;
+    rgb[0] = ( r << 3 ) | ( r >> 2 );
+    rgb[1] = ( g << 2 ) | ( g >> 4 );
+    rgb[2] = ( b << 3 ) | ( b >> 2 );
+}
+
+// 四色模式 (c0 > c1) 下为每个像素选最近的调色板颜色, 返回总误差
+int bc1Indices( const uint8_t* block, uint16_t c0, uint16_t c1, uint32_t& indices ) {
+    int palette[4][3];
+    from565( c0, palette[0] );
+    from565( c1, palette[1] );
+    for ( int c = 0; c < 3; ++c ) {
+        palette[2][c] = ( 2 * palette[0][c] + palette[1][c] ) / 3;
+        palette[3][c] = ( palette[0][c] + 2 * palette[1][c] ) / 3;
+    }
+
+    indices = 0;
+    int total = 0;
+    for ( int i = 0; i < 16; ++i ) {
+        const uint8_t* p = block + i * 4;
+        int best = 0;
+        int bestError = INT_MAX;
+        for ( int k = 0; k < 4; ++k ) {
+            const int dr = p[0] - palette[k][0];
+            const int dg = p[1] - palette[k][1];
+            const int db = p[2] - palette[k][2];
+            const int error = dr * dr + dg * dg + db * db;
+            if ( error < bestError ) { bestError = error; best = k; }
+        }
+        indices |= uint32_t( best ) << ( 2 * i );
+        total += bestError;
+    }
+    return total;
+}
+
+// 保证 c0 > c1 (四色模式), 返回误差
+// 两端相同时调色板四个颜色相同, 索引全为 0, 解码时按三色模式也只会取到 c0
+int bc1Fit( const uint8_t* block, uint16_t& c0, uint16_t& c1, uint32_t& indices ) {
+    if ( c0 < c1 ) std::swap( c0, c1 );
+    return bc1Indices( block, c0, c1, indices );
+}
+
+void writeBC1( uint8_t* out, uint16_t c0, uint16_t c1, uint32_t indices ) {
+    out[0] = uint8_t( c0 & 0xFF );
+    out[1] = uint8_t( c0 >> 8 );
+    out[2] = uint8_t( c1 & 0xFF );
+    out[3] = uint8_t( c1 >> 8 );
+    out[4] = uint8_t( indices & 0xFF );
+    out[5] = uint8_t( ( indices >> 8 ) & 0xFF );
+    out[6] = uint8_t( ( indices >> 16 ) & 0xFF );
+    out[7] = uint8_t( indices >> 24 );
+}
+
+/* ------------------------------------------------
+ * ETC1 / ETC2 RGB8: 两个 2x4 (或 4x2) 子块, 各自一个基色和一张亮度修正表
+ * 只使用 ETC1 的 individual / differential 模式, 差分结果不溢出, 因此同时是合法的 ETC2 块
+* ------------------------------------------------ */
+const int kEtcModifiers[8][2] = {
+    { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 },
+};
+
+struct EtcSubblock {
+    int pixels[8][3];
+    int positions[8];           // 块内位序号 x * 4 + y
+};
+
+struct EtcFit {
+    int table = 0;
+    int error = INT_MAX;
+    uint8_t indices[8] = {};
+};
+
+// 像素索引 (msb, lsb): 00 → +a  01 → +b  10 → -a  11 → -b
+void etcFitSubblock( const EtcSubblock& sub, const int base[3], EtcFit& fit ) {
+    fit.error = INT_MAX;
+    for ( int table = 0; table < 8; ++table ) {
+        int total = 0;
+        uint8_t indices[8];
+        for ( int i = 0; i < 8 && total < fit.error; ++i ) {
+            int bestError = INT_MAX;
+            for ( int index = 0; index < 4; ++index ) {
+                const int modifier = ( index & 2 ) ? -kEtcModifiers[table][index & 1] : kEtcModifiers[table][index & 1];
+                int error = 0;
+                for ( int c = 0; c < 3; ++c ) {
+                    const int d = clampByte( base[c] + modifier ) - sub.pixels[i][c];
+                    error += d * d;
+                }
+                if ( error < bestError ) { bestError = error; indices[i] = uint8_t( index ); }
+            }
+            total += bestError;
+        }
+        if ( total < fit.error ) {
+            fit.error = total;
+            fit.table = table;
+            std::memcpy( fit.indices, indices, sizeof( indices ) );
+        }
+    }
+}
+
+/* ------------------------------------------------
+ * BC4 / EAC R11: 单通道
+* ------------------------------------------------ */
+// EAC 修正表 (与 ETC2 alpha 通道共用)
+const int kEacModifiers[16][8] = {
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+};
+
+int eacDecode( int base, int multiplier, int modifier ) {
+    const int value = multiplier == 0 ? base * 8 + 4 + modifier
+                                      : base * 8 + 4 + modifier * multiplier * 8;
+    return value < 0 ? 0 : ( value > 2047 ? 2047 : value );
+}
+
+// 一种 (基值, 乘数, 表) 组合下每个像素选最近的修正值, 返回总误差
+int eacFit( const int target[16], int base, int multiplier, int table, uint8_t indices[16], int limit ) {
+    int total = 0;
+    for ( int i = 0; i < 16 && total < limit; ++i ) {
+        int bestError = INT_MAX;
+        for ( int k = 0; k < 8; ++k ) {
+            const int d = eacDecode( base, multiplier, kEacModifiers[table][k] ) - target[i];
+            const int error = d * d;
+            if ( error < bestError ) { bestError = error; indices[i] = uint8_t( k ); }
+        }
+        total += bestError;
+    }
+    return total;
+}
+
+// 从 RGBA 图像取一个 4x4 块, 越界部分复制边缘像素
+void gatherBlock( const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t stride,
+                  uint32_t bx, uint32_t by, uint8_t* block ) {
+    for ( uint32_t y = 0; y < 4; ++y ) {
+        const uint32_t sy = std::min( by * 4 + y, height - 1 );
+        const uint8_t* row = rgba + size_t( sy ) * stride;
+        for ( uint32_t x = 0; x < 4; ++x ) {
+            const uint32_t sx = std::min( bx * 4 + x, width - 1 );
+            std::memcpy( block + ( y * 4 + x ) * 4, row + sx * 4, 4 );
+        }
+    }
+}
+
+} // namespace
+
+void TextureCodec::encodeBlockBC1( const uint8_t* block, uint8_t* out ) {
+    // 均值与协方差
+    float mean[3] = { 0, 0, 0 };
+    int minC[3] = { 255, 255, 255 };
+    int maxC[3] = { 0, 0, 0 };
+    for ( int i = 0; i < 16; ++i ) {
+        for ( int c = 0; c < 3; ++c ) {
+            mean[c] += block[i * 4 + c];
+            minC[c] = std::min( minC[c], int( block[i * 4 + c] ) );
+            maxC[c] = std::max( maxC[c], int( block[i * 4 + c] ) );
+        }
+    }
+    for ( float& m : mean ) m /= 16.0f;
+
+    if ( minC[0] == maxC[0] && minC[1] == maxC[1] && minC[2] == maxC[2] ) {
+        // 纯色块
+        const uint16_t c = to565( float( minC[0] ), float( minC[1] ), float( minC[2] ) );
+        writeBC1( out, c, c, 0 );
+        return;
+    }
+
+    float cov[6] = { 0, 0, 0, 0, 0, 0 };     // rr rg rb gg gb bb
+    for ( int i = 0; i < 16; ++i ) {
+        const float r = block[i * 4 + 0] - mean[0];
+        const float g = block[i * 4 + 1] - mean[1];
+        const float b = block[i * 4 + 2] - mean[2];
+        cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+        cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+    }
+
+    // 幂迭代求主轴, 从包围盒对角线出发
+    float axis[3] = { float( maxC[0] - minC[0] ), float( maxC[1] - minC[1] ), float( maxC[2] - minC[2] ) };
+    for ( int iteration = 0; iteration < 4; ++iteration ) {
+        const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        const float scale = std::max( std::fabs( x ), std::max( std::fabs( y ), std::fabs( z ) ) );
+        if ( scale < 1e-6f ) break;
+        axis[0] = x / scale; axis[1] = y / scale; axis[2] = z / scale;
+    }
+
+    int minIndex = 0, maxIndex = 0;
+    float minDot = 1e30f, maxDot = -1e30f;
+    for ( int i = 0; i < 16; ++i ) {
+        const float d = ( block[i * 4 + 0] - mean[0] ) * axis[0]
+                        + ( block[i * 4 + 1] - mean[1] ) * axis[1]
+                        + ( block[i * 4 + 2] - mean[2] ) * axis[2];
+        if ( d < minDot ) { minDot = d; minIndex = i; }
+        if ( d > maxDot ) { maxDot = d; maxIndex = i; }
+    }
+
+    // 端点向内收 1/16, 让中间两个插值色覆盖更多像素
+    float hi[3], lo[3];
+    for ( int c = 0; c < 3; ++c ) {
+        const float a = block[maxIndex * 4 + c];
+        const float b = block[minIndex * 4 + c];
+        const float inset = ( a - b ) / 16.0f;
+        hi[c] = a - inset;
+        lo[c] = b + inset;
+    }
+
+    uint16_t c0 = to565( hi[0], hi[1], hi[2] );
+    uint16_t c1 = to565( lo[0], lo[1], lo[2] );
+    uint32_t indices = 0;
+    int error = bc1Fit( block, c0, c1, indices );
+
+    // 固定索引, 最小二乘求端点
+    if ( c0 != c1 ) {
+        const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };     // 端点0 的权重
+        float aa = 0, bb = 0, ab = 0;
+        float ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+        for ( int i = 0; i < 16; ++i ) {
+            const float alpha = weights[( indices >> ( 2 * i ) ) & 3];
+            const float beta = 1.0f - alpha;
+            aa += alpha * alpha; bb += beta * beta; ab += alpha * beta;
+            for ( int c = 0; c < 3; ++c ) {
+                ax[c] += alpha * block[i * 4 + c];
+                bx[c] += beta * block[i * 4 + c];
+            }
+        }
+        const float det = aa * bb - ab * ab;
+        if ( std::fabs( det ) > 1e-4f ) {
+            float e0[3], e1[3];
+            for ( int c = 0; c < 3; ++c ) {
+                e0[c] = ( bb * ax[c] - ab * bx[c] ) / det;
+                e1[c] = ( aa * bx[c] - ab * ax[c] ) / det;
+            }
+            uint16_t r0 = to565( e0[0], e0[1], e0[2] );
+            uint16_t r1 = to565( e1[0], e1[1], e1[2] );
+            uint32_t refined = 0;
+            const int refinedError = bc1Fit( block, r0, r1, refined );
+            if ( refinedError < error ) {
+                c0 = r0; c1 = r1; indices = refined; error = refinedError;
+            }
+        }
+    }
+
+    writeBC1( out, c0, c1, c0 == c1 ? 0 : indices );
+}
+
+void TextureCodec::encodeBlockBC4( const uint8_t* block, uint8_t* out ) {
+    int lo = 255, hi = 0;
+    for ( int i = 0; i < 16; ++i ) {
+        lo = std::min( lo, int( block[i * 4] ) );
+        hi = std::max( hi, int( block[i * 4] ) );
+    }
+
+    out[0] = uint8_t( hi );
+    out[1] = uint8_t( lo );
+    uint64_t bits = 0;
+    if ( hi > lo ) {
+        // 八值模式 (r0 > r1): 索引 0 = r0, 1 = r1, 2..7 从 r0 到 r1 线性插值
+        for ( int i = 0; i < 16; ++i ) {
+            const int step = ( ( block[i * 4] - lo ) * 14 + ( hi - lo ) ) / ( 2 * ( hi - lo ) );   // round((v-lo)*7/(hi-lo))
+            const int index = step == 7 ? 0 : ( step == 0 ? 1 : 8 - step );
+            bits |= uint64_t( index ) << ( 3 * i );
+        }
+    }
+    for ( int i = 0; i < 6; ++i ) {
+        out[2 + i] = uint8_t( ( bits >> ( 8 * i ) ) & 0xFF );
+    }
+}
+
+void TextureCodec::encodeBlockETC2( const uint8_t* block, uint8_t* out ) {
+    int bestError = INT_MAX;
+    uint8_t best[8] = {};
+
+    for ( int flip = 0; flip < 2; ++flip ) {
+        EtcSubblock sub[2];
+        int counts[2] = { 0, 0 };
+        for ( int y = 0; y < 4; ++y ) {
+            for ( int x = 0; x < 4; ++x ) {
+                // flip = 0: 左右两个 2x4 子块  flip = 1: 上下两个 4x2 子块
+                const int s = flip ? ( y >= 2 ) : ( x >= 2 );
+                const int k = counts[s]++;
+                for ( int c = 0; c < 3; ++c ) sub[s].pixels[k][c] = block[( y * 4 + x ) * 4 + c];
+                sub[s].positions[k] = x * 4 + y;
+            }
+        }
+
+        float average[2][3];
+        for ( int s = 0; s < 2; ++s ) {
+            for ( int c = 0; c < 3; ++c ) {
+                int sum = 0;
+                for ( int k = 0; k < 8; ++k ) sum += sub[s].pixels[k][c];
+                average[s][c] = sum / 8.0f;
+            }
+        }
+
+        // differential: 5 位基色 + 3 位有符号差值
+        int q5[2][3];
+        bool differential = true;
+        for ( int s = 0; s < 2; ++s ) {
+            for ( int c = 0; c < 3; ++c ) q5[s][c] = qBound( 0, int( std::lround( average[s][c] * 31.0f / 255.0f ) ), 31 );
+        }
+        for ( int c = 0; c < 3; ++c ) {
+            const int d = q5[1][c] - q5[0][c];
+            if ( d < -4 || d > 3 ) differential = false;
+        }
+
+        // individual: 每个子块 4 位基色
+        int q4[2][3];
+        for ( int s = 0; s < 2; ++s ) {
+            for ( int c = 0; c < 3; ++c ) q4[s][c] = qBound( 0, int( std::lround( average[s][c] * 15.0f / 255.0f ) ), 15 );
+        }
+
+        for ( int mode = differential ? 0 : 1; mode < 2; ++mode ) {
+            EtcFit fit[2];
+            for ( int s = 0; s < 2; ++s ) {
+                int base[3];
+                for ( int c = 0; c < 3; ++c ) {
+                    base[c] = mode == 0 ? ( ( q5[s][c] << 3 ) | ( q5[s][c] >> 2 ) )
+                                        : ( ( q4[s][c] << 4 ) | q4[s][c] );
+                }
+                etcFitSubblock( sub[s], base, fit[s] );
+            }
+            const int error = fit[0].error + fit[1].error;
+            if ( error >= bestError ) continue;
+            bestError = error;
+
+            uint8_t bytes[8] = {};
+            for ( int c = 0; c < 3; ++c ) {
+                bytes[c] = mode == 0 ? uint8_t( ( q5[0][c] << 3 ) | ( ( q5[1][c] - q5[0][c] ) & 7 ) )
+                                     : uint8_t( ( q4[0][c] << 4 ) | q4[1][c] );
+            }
+            bytes[3] = uint8_t( ( fit[0].table << 5 ) | ( fit[1].table << 2 ) | ( mode == 0 ? 2 : 0 ) | flip );
+
+            uint32_t msb = 0, lsb = 0;
+            for ( int s = 0; s < 2; ++s ) {
+                for ( int k = 0; k < 8; ++k ) {
+                    const int position = sub[s].positions[k];
+                    msb |= uint32_t( ( fit[s].indices[k] >> 1 ) & 1 ) << position;
+                    lsb |= uint32_t( fit[s].indices[k] & 1 ) << position;
+                }
+            }
+            bytes[4] = uint8_t( msb >> 8 );
+            bytes[5] = uint8_t( msb & 0xFF );
+            bytes[6] = uint8_t( lsb >> 8 );
+            bytes[7] = uint8_t( lsb & 0xFF );
+            std::memcpy( best, bytes, sizeof( best ) );
+        }
+    }
+
+    std::memcpy( out, best, sizeof( best ) );
+}
+
+void TextureCodec::encodeBlockEAC( const uint8_t* block, uint8_t* out ) {
+    // 在 11 位精度下比较误差
+    int target[16];
+    int lo = INT_MAX, hi = 0;
+    for ( int i = 0; i < 16; ++i ) {
+        target[i] = ( block[i * 4] * 2047 + 127 ) / 255;
+        lo = std::min( lo, target[i] );
+        hi = std::max( hi, target[i] );
+    }
+
+    int bestError = INT_MAX;
+    int bestBase = 0, bestMultiplier = 1, bestTable = 0;
+    uint8_t bestIndices[16] = {};
+    uint8_t indices[16];
+
+    for ( int table = 0; table < 16 && bestError > 0; ++table ) {
+        const int* modifiers = kEacModifiers[table];
+        const int minModifier = *std::min_element( modifiers, modifiers + 8 );
+        const int maxModifier = *std::max_element( modifiers, modifiers + 8 );
+        const int span = ( maxModifier - minModifier ) * 8;
+        const int guess = qBound( 1, ( hi - lo + span / 2 ) / span, 15 );
+
+        for ( int multiplier = std::max( 1, guess - 1 ); multiplier <= std::min( 15, guess + 1 ); ++multiplier ) {
+            // 让修正范围的中点对齐像素范围的中点
+            const float center = ( lo + hi ) * 0.5f - ( minModifier + maxModifier ) * 0.5f * multiplier * 8 - 4;
+            const int baseGuess = int( std::lround( center / 8.0f ) );
+            for ( int base = baseGuess - 1; base <= baseGuess + 1; ++base ) {
+                if ( base < 0 || base > 255 ) continue;
+                const int error = eacFit( target, base, multiplier, table, indices, bestError );
+                if ( error < bestError ) {
+                    bestError = error;
+                    bestBase = base;
+                    bestMultiplier = multiplier;
+                    bestTable = table;
+                    std::memcpy( bestIndices, indices, sizeof( indices ) );
+                }
+            }
+        }
+    }
+
+    // 大端 64 位: base:8 | multiplier:4 | table:4 | 16 x 3 位索引 (按列优先, 第一个像素在最高位)
+    uint64_t bits = ( uint64_t( bestBase ) << 56 ) | ( uint64_t( bestMultiplier ) << 52 ) | ( uint64_t( bestTable ) << 48 );
+    for ( int y = 0; y < 4; ++y ) {
+        for ( int x = 0; x < 4; ++x ) {
+            const int position = x * 4 + y;
+            bits |= uint64_t( bestIndices[y * 4 + x] ) << ( 45 - 3 * position );
+        }
+    }
+    for ( int i = 0; i < 8; ++i ) {
+        out[i] = uint8_t( ( bits >> ( 56 - 8 * i ) ) & 0xFF );
+    }
+}
+
+void TextureCodec::encode( const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t stride,
+                           TextureFormat format, std::vector<uint8_t>& out ) {
+    if ( !TextureFormats::isCompressed( format ) ) {
+        out.resize( size_t( width ) * height * 4 );
+        for ( uint32_t y = 0; y < height; ++y ) {
+            std::memcpy( out.data() + size_t( y ) * width * 4, rgba + size_t( y ) * stride, width * 4 );
+        }
+        return;
+    }
+
+    void ( *encodeBlock )( const uint8_t*, uint8_t* ) = nullptr;
+    switch ( format ) {
+    case TextureFormat::BC1_RGB:
+    case TextureFormat::BC1_RGB_SRGB:   encodeBlock = &TextureCodec::encodeBlockBC1; break;
+    case TextureFormat::BC4_R:          encodeBlock = &TextureCodec::encodeBlockBC4; break;
+    case TextureFormat::ETC2_RGB8:
+    case TextureFormat::ETC2_RGB8_SRGB: encodeBlock = &TextureCodec::encodeBlockETC2; break;
+    case TextureFormat::EAC_R11:        encodeBlock = &TextureCodec::encodeBlockEAC; break;
+    default: break;
+    }
+
+    const uint32_t blocksX = ( width + 3 ) / 4;
+    const uint32_t blocksY = ( height + 3 ) / 4;
+    out.resize( size_t( blocksX ) * blocksY * 8 );
+    uint8_t* dst = out.data();
+
+    // 每个任务大约 256 个块
+    const int grain = std::max( 1, int( 256 / blocksX ) );
+    JobPool::instance().parallelFor( 0, int( blocksY ), grain, [&]( int begin, int end ) {
+        uint8_t block[64];
+        for ( int by = begin; by < end; ++by ) {
+            for ( uint32_t bx = 0; bx < blocksX; ++bx ) {
+                gatherBlock( rgba, width, height, stride, bx, uint32_t( by ), block );
+                encodeBlock( block, dst + ( size_t( by ) * blocksX + bx ) * 8 );
+            }
+        }
+    } );
+}
@@ -0,0 +1,22 @@
+// 单一职责: CPU 端的 GPU 块压缩编码器 (BC1 / BC4 / ETC2 RGB8 / EAC R11)
+// 每个 4x4 像素块独立编码成 8 字节, 按块行分给 JobPool 并行
+#pragma once
+
+#include "texture_format.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class TextureCodec {
+public:
+    // 把 RGBA8 像素 (行距 stride 字节) 编码成 format, 结果写入 out (覆盖原内容)
+    // 单通道格式只取 R 通道; 宽高不是 4 的倍数时用边缘像素补齐块
+    static void encode( const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t stride,
+                        TextureFormat format, std::vector<uint8_t>& out );
+
+    // 单块编码, block 为 16 个 RGBA 像素 (行优先)
+    static void encodeBlockBC1( const uint8_t* block, uint8_t* out );
+    static void encodeBlockBC4( const uint8_t* block, uint8_t* out );
+    static void encodeBlockETC2( const uint8_t* block, uint8_t* out );
+    static void encodeBlockEAC( const uint8_t* block, uint8_t* out );
+};
@@ -0,0 +1,146 @@
+// 单一职责: 纹理像素格式的描述 (块大小 / 每级字节数 / Vulkan 与 GL 的格式枚举)
+// KTX2 容器按 vkFormat 存储格式, 上传时再映射回 GL 的 internalFormat
+#pragma once
+
+#include <cstdint>
+
+enum class TextureFormat : uint32_t {
+    RGBA8,
+    RGBA8_SRGB,
+    BC1_RGB,            // 桌面 GL: S3TC DXT1, 4 bpp
+    BC1_RGB_SRGB,
+    BC4_R,              // 桌面 GL: RGTC1, 单通道 4 bpp
+    ETC2_RGB8,          // GLES 3.0 核心格式, 4 bpp
+    ETC2_RGB8_SRGB,
+    EAC_R11,            // GLES 3.0 核心格式, 单通道 4 bpp
+};
+
+// 源图像的通道用途, 决定压缩成哪一类格式
+enum class TextureChannels {
+    Rgb,                // 颜色 / 法线 / ORM
+    Single,             // 灰度数据
+};
+
+// 当前上下文支持的压缩格式 (见 TextureUploader::querySupport)
+struct CompressionSupport {
+    bool bc1 = false;
+    bool bc1Srgb = false;
+    bool bc4 = false;
+    bool etc2 = false;
+    bool preferEtc2 = false;    // GLES 上 ETC2 是原生格式, 桌面驱动通常只是软解成 RGBA8
+};
+
+namespace TextureFormats {
+
+inline bool isCompressed( TextureFormat format ) {
+    return format != TextureFormat::RGBA8 && format != TextureFormat::RGBA8_SRGB;
+}
+
+inline bool isSrgb( TextureFormat format ) {
+    return format == TextureFormat::RGBA8_SRGB || format == TextureFormat::BC1_RGB_SRGB
+           || format == TextureFormat::ETC2_RGB8_SRGB;
+}
+
+inline bool isSingleChannel( TextureFormat format ) {
+    return format == TextureFormat::BC4_R || format == TextureFormat::EAC_R11;
+}
+
+// 压缩格式每 4x4 块的字节数, 非压缩格式每像素的字节数
+inline uint32_t blockBytes( TextureFormat format ) {
+    return isCompressed( format ) ? 8u : 4u;
+}
+
+inline uint32_t levelBytes( TextureFormat format, uint32_t width, uint32_t height ) {
+    if ( !isCompressed( format ) ) {
+        return width * height * 4u;
+    }
+    return ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * 8u;
+}
+
+inline uint32_t mipCount( uint32_t width, uint32_t height ) {
+    uint32_t levels = 1;
+    while ( width > 1 || height > 1 ) {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+        ++levels;
+    }
+    return levels;
+}
+
+// VkFormat 取值 (KTX2 头中的 vkFormat)
+inline uint32_t vkFormat( TextureFormat format ) {
+    switch ( format ) {
+    case TextureFormat::RGBA8:          return 37;     // VK_FORMAT_R8G8B8A8_UNORM
+    case TextureFormat::RGBA8_SRGB:     return 43;     // VK_FORMAT_R8G8B8A8_SRGB
+    case TextureFormat::BC1_RGB:        return 131;    // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    case TextureFormat::BC1_RGB_SRGB:   return 132;    // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+    case TextureFormat::BC4_R:          return 139;    // VK_FORMAT_BC4_UNORM_BLOCK
+    case TextureFormat::ETC2_RGB8:      return 147;    // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+    case TextureFormat::ETC2_RGB8_SRGB: return 148;    // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+    case TextureFormat::EAC_R11:        return 153;    // VK_FORMAT_EAC_R11_UNORM_BLOCK
+    }
+    return 0;
+}
+
+inline bool fromVkFormat( uint32_t vk, TextureFormat& format ) {
+    const TextureFormat all[] = {
+        TextureFormat::RGBA8, TextureFormat::RGBA8_SRGB, TextureFormat::BC1_RGB, TextureFormat::BC1_RGB_SRGB,
+        TextureFormat::BC4_R, TextureFormat::ETC2_RGB8, TextureFormat::ETC2_RGB8_SRGB, TextureFormat::EAC_R11,
+    };
+    for ( TextureFormat candidate : all ) {
+        if ( vkFormat( candidate ) == vk ) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// GL internalFormat 取值, 不依赖扩展头文件
+inline uint32_t glInternalFormat( TextureFormat format ) {
+    switch ( format ) {
+    case TextureFormat::RGBA8:          return 0x8058;     // GL_RGBA8
+    case TextureFormat::RGBA8_SRGB:     return 0x8C43;     // GL_SRGB8_ALPHA8
+    case TextureFormat::BC1_RGB:        return 0x83F0;     // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    case TextureFormat::BC1_RGB_SRGB:   return 0x8C4C;     // GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+    case TextureFormat::BC4_R:          return 0x8DBB;     // GL_COMPRESSED_RED_RGTC1
+    case TextureFormat::ETC2_RGB8:      return 0x9274;     // GL_COMPRESSED_RGB8_ETC2
+    case TextureFormat::ETC2_RGB8_SRGB: return 0x9275;     // GL_COMPRESSED_SRGB8_ETC2
+    case TextureFormat::EAC_R11:        return 0x9270;     // GL_COMPRESSED_R11_EAC
+    }
+    return 0;
+}
+
+inline const char* name( TextureFormat format ) {
+    switch ( format ) {
+    case TextureFormat::RGBA8:          return "RGBA8";
+    case TextureFormat::RGBA8_SRGB:     return "RGBA8_SRGB";
+    case TextureFormat::BC1_RGB:        return "BC1";
+    case TextureFormat::BC1_RGB_SRGB:   return "BC1_SRGB";
+    case TextureFormat::BC4_R:          return "BC4";
+    case TextureFormat::ETC2_RGB8:      return "ETC2_RGB8";
+    case TextureFormat::ETC2_RGB8_SRGB: return "ETC2_RGB8_SRGB";
+    case TextureFormat::EAC_R11:        return "EAC_R11";
+    }
+    return "unknown";
+}
+
+// 按上下文支持选择目标格式, 都不支持时退回 RGBA8
+inline TextureFormat choose( const CompressionSupport& support, TextureChannels channels, bool srgb ) {
+    if ( channels == TextureChannels::Single ) {
+        if ( support.etc2 && ( support.preferEtc2 || !support.bc4 ) ) return TextureFormat::EAC_R11;
+        if ( support.bc4 ) return TextureFormat::BC4_R;
+        return TextureFormat::RGBA8;
+    }
+
+    const bool bc1 = srgb ? support.bc1Srgb : support.bc1;
+    if ( support.etc2 && ( support.preferEtc2 || !bc1 ) ) {
+        return srgb ? TextureFormat::ETC2_RGB8_SRGB : TextureFormat::ETC2_RGB8;
+    }
+    if ( bc1 ) {
+        return srgb ? TextureFormat::BC1_RGB_SRGB : TextureFormat::BC1_RGB;
+    }
+    return srgb ? TextureFormat::RGBA8_SRGB : TextureFormat::RGBA8;
+}
+
+} // namespace TextureFormats
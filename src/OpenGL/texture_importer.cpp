@@ -0,0 +1,141 @@
+#include "texture_importer.hpp"
+#include "texture_codec.hpp"
+#include "job_pool.hpp"
+#include "pixel_convert.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <QStandardPaths>
+
+namespace {
+
+// 编码器或容器布局变化时递增, 让旧缓存自然失效
+constexpr int kCacheVersion = 3;
+
+QMutex g_cacheMutex;
+QString g_cacheDirectory;
+
+// 解码器输出的 ARGB32 / RGB32 在小端内存中是 BGRA, 只需交换 R 和 B
+// RGB32 的第四个字节固定为 0xFF, 同样适用; 其余格式交给 Qt 转换
+QImage toRgba8888( const QImage& image ) {
+    const QImage::Format format = image.format();
+    if ( Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+         || ( format != QImage::Format_ARGB32 && format != QImage::Format_RGB32 ) ) {
+        return image.convertToFormat( QImage::Format_RGBA8888 );
+    }
+
+    QImage rgba( image.size(), QImage::Format_RGBA8888 );
+    uchar* bits = rgba.bits();
+    const qsizetype bytesPerLine = rgba.bytesPerLine();
+    JobPool::instance().parallelFor( 0, image.height(), 64, [&]( int begin, int end ) {
+        for ( int y = begin; y < end; ++y ) {
+            PixelConvert::swapRedBlue( image.constScanLine( y ), bits + y * bytesPerLine, size_t( image.width() ) );
+        }
+    } );
+    return rgba;
+}
+
+} // namespace
+
+QString TextureImporter::cacheDirectory() {
+    QMutexLocker locker( &g_cacheMutex );
+    if ( g_cacheDirectory.isEmpty() ) {
+        g_cacheDirectory = QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + "/textures";
+    }
+    return g_cacheDirectory;
+}
+
+void TextureImporter::setCacheDirectory( const QString& directory ) {
+    QMutexLocker locker( &g_cacheMutex );
+    g_cacheDirectory = directory;
+}
+
+QString TextureImporter::cacheKey( const TextureImportRequest& request ) {
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    hash.addData( QByteArray::number( kCacheVersion ) );
+    hash.addData( TextureFormats::name( request.format ) );
+    hash.addData( request.mipmaps ? "mips" : "base" );
+    hash.addData( MipGenerator::name( request.mipFilter ) );
+    hash.addData( request.normalMap ? "normal" : "color" );
+    hash.addData( request.variant.toUtf8() );
+    for ( const QString& source : request.sources ) {
+        // qrc 资源的修改时间是编译时间, 同样能反映内容变化
+        const QFileInfo info( source );
+        hash.addData( source.toUtf8() );
+        hash.addData( QByteArray::number( info.size() ) );
+        hash.addData( QByteArray::number( info.lastModified().toMSecsSinceEpoch() ) );
+    }
+    return QString::fromLatin1( hash.result().toHex() );
+}
+
+bool TextureImporter::import( const TextureImportRequest& request, Ktx2Texture& texture, std::string& error ) {
+    const QString directory = cacheDirectory();
+    const QString path = directory + "/" + cacheKey( request ) + ".ktx2";
+
+    std::string cacheError;
+    if ( QFileInfo::exists( path ) ) {
+        if ( Ktx2::read( path, texture, cacheError ) && texture.format == request.format ) {
+            return true;
+        }
+        qDebug() << "Texture cache entry rejected:" << QString::fromStdString( cacheError );
+    }
+
+    if ( !request.decode ) {
+        error = "No decoder for texture";
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QImage image = request.decode();
+    if ( image.isNull() ) {
+        error = "Failed to decode " + request.sources.join( ", " ).toStdString();
+        return false;
+    }
+
+    texture = encode( image, request.format, request.mipmaps, request.mipFilter, request.normalMap );
+    qDebug() << "Texture imported" << request.sources << TextureFormats::name( request.format )
+             << image.width() << "x" << image.height() << "in" << timer.elapsed() << "ms";
+
+    // 写缓存失败只影响下次启动的速度
+    if ( !QDir().mkpath( directory ) || !Ktx2::write( path, texture, cacheError ) ) {
+        qDebug() << "Texture cache write failed:" << path;
+    }
+    return true;
+}
+
+Ktx2Texture TextureImporter::encode( const QImage& image, TextureFormat format, bool mipmaps,
+                                     MipFilter filter, bool normalMap ) {
+    Ktx2Texture texture;
+    texture.format = format;
+    texture.width = uint32_t( image.width() );
+    texture.height = uint32_t( image.height() );
+
+    const QImage rgba = toRgba8888( image );
+    if ( !mipmaps ) {
+        texture.levels.resize( 1 );
+        TextureCodec::encode( rgba.constBits(), texture.width, texture.height,
+                              uint32_t( rgba.bytesPerLine() ), format, texture.levels[0] );
+        return texture;
+    }
+
+    MipOptions options;
+    options.filter = filter;
+    options.srgb = TextureFormats::isSrgb( format );
+    options.alphaWeighted = image.hasAlphaChannel();
+    options.normalMap = normalMap;
+    const std::vector<MipImage> mips = MipGenerator::generate( rgba.constBits(), texture.width, texture.height,
+                                                               uint32_t( rgba.bytesPerLine() ), options );
+
+    texture.levels.resize( mips.size() );
+    for ( size_t i = 0; i < mips.size(); ++i ) {
+        TextureCodec::encode( mips[i].rgba.data(), mips[i].width, mips[i].height, mips[i].width * 4,
+                              format, texture.levels[i] );
+    }
+    return texture;
+}
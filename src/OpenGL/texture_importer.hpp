@@ -0,0 +1,40 @@
+// 单一职责: 纹理导入 (解码 → 生成 mip → GPU 块压缩 → KTX2), 结果缓存在磁盘上
+// 缓存命中时直接读取 KTX2, 不再解码 PNG 也不再编码
+#pragma once
+
+#include "ktx2.hpp"
+#include "mip_generator.hpp"
+
+#include <QImage>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <string>
+
+struct TextureImportRequest {
+    QStringList sources;                    // 参与生成的源文件, 用于缓存键 (路径 + 大小 + 修改时间)
+    QString variant;                        // 同一组源文件的不同用途 (例如 "orm"), 也进入缓存键
+    std::function<QImage()> decode;         // 缓存未命中时调用, 返回空图表示导入失败
+    TextureFormat format = TextureFormat::RGBA8;
+    bool mipmaps = true;
+    MipFilter mipFilter = MipFilter::Kaiser;
+    bool normalMap = false;                 // 生成 mip 时重新归一化
+};
+
+class TextureImporter {
+public:
+    // 成功时 texture 为完整 mip 链的 KTX2 数据
+    static bool import( const TextureImportRequest& request, Ktx2Texture& texture, std::string& error );
+
+    // 不经过缓存, 把 image 编码成 format
+    // mip 由 MipGenerator 生成: sRGB 格式在线性空间滤波, 带 alpha 的图像按 alpha 加权
+    static Ktx2Texture encode( const QImage& image, TextureFormat format, bool mipmaps,
+                               MipFilter filter = MipFilter::Kaiser, bool normalMap = false );
+
+    // 默认位于 QStandardPaths::CacheLocation/textures
+    static QString cacheDirectory();
+    static void setCacheDirectory( const QString& directory );
+
+private:
+    static QString cacheKey( const TextureImportRequest& request );
+};
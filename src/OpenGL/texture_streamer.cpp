@@ -0,0 +1,202 @@
+#include "texture_streamer.hpp"
+
+#include <QDebug>
+
+namespace {
+
+// 不超过这个尺寸的级别属于 mip tail, 导入完成后一次性上传
+constexpr uint32_t kTailSize = 128;
+
+} // namespace
+
+void TextureStreamer::initialize() {
+    if ( m_initialized ) return;
+    m_uploader.initialize();
+    m_initialized = true;
+}
+
+TextureStreamer::TextureId TextureStreamer::request( const TextureImportRequest& request, GLuint fallback ) {
+    Entry entry;
+    entry.request = request;
+    entry.fallback = fallback;
+    m_entries.push_back( std::move( entry ) );
+    startImport( m_entries.back() );
+    return TextureId( m_entries.size() - 1 );
+}
+
+GLuint TextureStreamer::handle( TextureId id ) const {
+    if ( id < 0 || id >= int( m_entries.size() ) ) return 0;
+    const Entry& entry = m_entries[id];
+    const bool resident = entry.texture && entry.residentBase < entry.data.levels.size();
+    return resident ? entry.texture : entry.fallback;
+}
+
+void TextureStreamer::update() {
+    if ( !m_initialized ) initialize();
+    m_uploadedBytes = 0;
+
+    // 收集已经导入完成的纹理, 立即上传 mip tail
+    for ( Entry& entry : m_entries ) {
+        if ( entry.pending && entry.job.isFinished() ) {
+            finishImport( entry );
+        }
+    }
+
+    // 从粗到细补齐: 每次在所有纹理中选下一级最小的那个, 直到用完本帧预算
+    size_t resident = 0;
+    for ( const Entry& entry : m_entries ) resident += residentBytes( entry );
+
+    while ( true ) {
+        Entry* next = nullptr;
+        size_t nextBytes = 0;
+        for ( Entry& entry : m_entries ) {
+            if ( !entry.texture || entry.stalled || entry.residentBase == 0 ) continue;
+            const size_t bytes = entry.data.levels[entry.residentBase - 1].size();
+            if ( !next || bytes < nextBytes ) {
+                next = &entry;
+                nextBytes = bytes;
+            }
+        }
+        if ( !next ) break;
+        if ( m_uploadedBytes > 0 && m_uploadedBytes + nextBytes > m_uploadBudget ) break;
+        if ( m_memoryBudget > 0 && resident + nextBytes > m_memoryBudget ) break;
+
+        if ( uploadNextLevel( *next ) ) {
+            resident += nextBytes;
+        }
+        m_uploadedBytes += nextBytes;
+    }
+}
+
+void TextureStreamer::setMemoryBudget( size_t bytes ) {
+    m_memoryBudget = bytes;
+    if ( m_memoryBudget > 0 ) {
+        trim( m_memoryBudget );
+    }
+}
+
+void TextureStreamer::trim( size_t targetBytes ) {
+    size_t resident = 0;
+    for ( const Entry& entry : m_entries ) resident += residentBytes( entry );
+
+    // 每次丢弃当前最大的一级, 尽量少动清晰度已经较低的纹理
+    while ( resident > targetBytes ) {
+        Entry* largest = nullptr;
+        size_t largestBytes = 0;
+        for ( Entry& entry : m_entries ) {
+            if ( !entry.texture || entry.residentBase >= tailLevel( entry ) ) continue;
+            const size_t bytes = entry.data.levels[entry.residentBase].size();
+            if ( !largest || bytes > largestBytes ) {
+                largest = &entry;
+                largestBytes = bytes;
+            }
+        }
+        if ( !largest ) break;
+
+        dropFinestLevel( *largest );
+        resident -= largestBytes;
+    }
+}
+
+StreamingStats TextureStreamer::stats() const {
+    StreamingStats stats;
+    stats.textureCount = uint32_t( m_entries.size() );
+    stats.uploadedBytes = m_uploadedBytes;
+    for ( const Entry& entry : m_entries ) {
+        if ( entry.pending ) ++stats.pendingImports;
+        if ( entry.texture && entry.residentBase > 0 ) ++stats.partiallyResident;
+        stats.residentBytes += residentBytes( entry );
+    }
+    return stats;
+}
+
+void TextureStreamer::cleanup() {
+    for ( Entry& entry : m_entries ) {
+        // 工作线程还持有 pending, 必须等它结束
+        if ( entry.job.isValid() ) entry.job.wait();
+        m_uploader.destroy( entry.texture );
+    }
+    m_entries.clear();
+    m_uploadedBytes = 0;
+}
+
+void TextureStreamer::startImport( Entry& entry ) {
+    // 结果写进共享的 PendingImport, 渲染线程只在任务完成后读取
+    auto pending = std::make_shared<PendingImport>();
+    const TextureImportRequest request = entry.request;
+    entry.pending = pending;
+    entry.job = JobPool::instance().submit( [pending, request]() {
+        pending->ok = TextureImporter::import( request, pending->texture, pending->error );
+    } );
+}
+
+void TextureStreamer::finishImport( Entry& entry ) {
+    std::shared_ptr<PendingImport> pending = std::move( entry.pending );
+    entry.job = JobHandle();
+
+    if ( !pending->ok ) {
+        qDebug() << "Texture streaming:" << QString::fromStdString( pending->error );
+        entry.failed = true;
+        return;
+    }
+
+    entry.data = std::move( pending->texture );
+    entry.texture = m_uploader.allocate( entry.data );
+    entry.residentBase = uint32_t( entry.data.levels.size() );
+    entry.stalled = false;
+
+    const uint32_t tail = tailLevel( entry );
+    while ( entry.residentBase > tail ) {
+        if ( uploadNextLevel( entry ) ) continue;
+
+        // 驱动声明支持但上传失败: 删掉这张纹理, 改用 RGBA8 重新导入
+        m_uploader.destroy( entry.texture );
+        entry.texture = 0;
+        entry.data = Ktx2Texture();
+        if ( TextureFormats::isCompressed( entry.request.format ) ) {
+            entry.request.format = TextureFormats::isSrgb( entry.request.format ) ? TextureFormat::RGBA8_SRGB
+                                                                                  : TextureFormat::RGBA8;
+            startImport( entry );
+        } else {
+            entry.failed = true;
+        }
+        return;
+    }
+}
+
+bool TextureStreamer::uploadNextLevel( Entry& entry ) {
+    const uint32_t level = entry.residentBase - 1;
+    if ( !m_uploader.uploadLevel( entry.texture, entry.data, level ) ) {
+        // 已有的级别仍然可用, 只是不再继续变清晰
+        entry.stalled = true;
+        return false;
+    }
+    entry.residentBase = level;
+    m_uploader.setResidentLevels( entry.texture, level, uint32_t( entry.data.levels.size() ) - 1 );
+    return true;
+}
+
+void TextureStreamer::dropFinestLevel( Entry& entry ) {
+    m_uploader.releaseLevel( entry.texture, entry.residentBase );
+    entry.residentBase += 1;
+    m_uploader.setResidentLevels( entry.texture, entry.residentBase, uint32_t( entry.data.levels.size() ) - 1 );
+}
+
+uint32_t TextureStreamer::tailLevel( const Entry& entry ) const {
+    const uint32_t levelCount = uint32_t( entry.data.levels.size() );
+    uint32_t level = 0;
+    while ( level + 1 < levelCount
+            && ( entry.data.levelWidth( level ) > kTailSize || entry.data.levelHeight( level ) > kTailSize ) ) {
+        ++level;
+    }
+    return level;
+}
+
+size_t TextureStreamer::residentBytes( const Entry& entry ) const {
+    if ( !entry.texture ) return 0;
+    size_t total = 0;
+    for ( size_t level = entry.residentBase; level < entry.data.levels.size(); ++level ) {
+        total += entry.data.levels[level].size();
+    }
+    return total;
+}
@@ -0,0 +1,92 @@
+// 单一职责: 渐进式纹理流送
+// 导入 (读缓存 / 编码) 在 JobPool 中异步执行, 完成后先上传最小的几级 (mip tail), 模型立即以低精度显示
+// 之后每帧在上传字节预算内从粗到细补齐更细的 mip, 通过 GL_TEXTURE_BASE_LEVEL 限定可采样的级别
+// 显存超出预算时丢弃最细的 mip
+#pragma once
+
+#include "job_pool.hpp"
+#include "texture_importer.hpp"
+#include "texture_uploader.hpp"
+
+#include <memory>
+#include <vector>
+
+struct StreamingStats {
+    uint32_t textureCount = 0;
+    uint32_t pendingImports = 0;        // 还在工作线程导入的纹理
+    uint32_t partiallyResident = 0;     // 还没有补齐最细一级的纹理
+    uint64_t residentBytes = 0;
+    uint64_t uploadedBytes = 0;         // 最近一次 update() 上传的字节数
+};
+
+class TextureStreamer {
+public:
+    using TextureId = int;
+
+    TextureStreamer() = default;
+    ~TextureStreamer() = default;
+    TextureStreamer( const TextureStreamer& ) = delete;
+    TextureStreamer& operator=( const TextureStreamer& ) = delete;
+
+    // 需要当前上下文
+    void initialize();
+
+    const CompressionSupport& support() const { return m_uploader.support(); }
+    TextureUploader& uploader() { return m_uploader; }
+
+    // 提交异步导入, 导入完成前 handle() 返回 fallback
+    // request.format 为 RGBA8 / RGBA8_SRGB 以外的格式时, 上传失败会自动改用对应的 RGBA8 重新导入
+    TextureId request( const TextureImportRequest& request, GLuint fallback );
+
+    GLuint handle( TextureId id ) const;
+
+    // 渲染线程每帧调用一次 (录制开始之前)
+    void update();
+
+    // 每帧最多上传的字节数; 单级超过预算时每帧仍会上传一级, 保证能前进
+    void setUploadBudget( size_t bytesPerFrame ) { m_uploadBudget = bytesPerFrame; }
+
+    // 常驻显存上限, 0 表示不限制; 降低时立刻丢弃最细的 mip
+    void setMemoryBudget( size_t bytes );
+
+    // 内存压力: 丢弃最细的 mip 直到常驻字节数不超过 targetBytes (每张纹理至少保留 mip tail)
+    void trim( size_t targetBytes );
+
+    StreamingStats stats() const;
+
+    // 等待进行中的导入并删除全部纹理
+    void cleanup();
+
+private:
+    struct PendingImport {
+        Ktx2Texture texture;
+        std::string error;
+        bool ok = false;
+    };
+
+    struct Entry {
+        TextureImportRequest request;
+        GLuint fallback = 0;
+        GLuint texture = 0;
+        Ktx2Texture data;                       // 全部级别的 CPU 副本, 丢弃后可以重新流送
+        JobHandle job;
+        std::shared_ptr<PendingImport> pending;
+        uint32_t residentBase = 0;              // 已上传的最细一级, levelCount 表示什么都没上传
+        bool stalled = false;                   // 某一级上传失败, 停在当前清晰度
+        bool failed = false;
+    };
+
+    void startImport( Entry& entry );
+    void finishImport( Entry& entry );
+    bool uploadNextLevel( Entry& entry );
+    void dropFinestLevel( Entry& entry );
+    uint32_t tailLevel( const Entry& entry ) const;
+    size_t residentBytes( const Entry& entry ) const;
+
+    TextureUploader m_uploader;
+    std::vector<Entry> m_entries;
+    size_t m_uploadBudget = 4u << 20;
+    size_t m_memoryBudget = 0;
+    size_t m_uploadedBytes = 0;
+    bool m_initialized = false;
+};
@@ -0,0 +1,133 @@
+#include "texture_uploader.hpp"
+
+#include <QDebug>
+#include <QOpenGLContext>
+
+#ifndef GL_TEXTURE_BASE_LEVEL
+#define GL_TEXTURE_BASE_LEVEL 0x813C
+#endif
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+
+void TextureUploader::initialize() {
+    if ( m_initialized ) return;
+    initializeOpenGLFunctions();
+    m_support = querySupport();
+    m_initialized = true;
+}
+
+CompressionSupport TextureUploader::querySupport() {
+    CompressionSupport support;
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if ( !context ) {
+        return support;
+    }
+
+    const QSurfaceFormat format = context->format();
+    const int version = format.majorVersion() * 10 + format.minorVersion();
+
+    if ( context->isOpenGLES() ) {
+        // GLES 3.0 核心包含 ETC2/EAC
+        support.etc2 = version >= 30;
+        support.preferEtc2 = true;
+        support.bc1 = context->hasExtension( "GL_EXT_texture_compression_s3tc" )
+                      || context->hasExtension( "GL_EXT_texture_compression_dxt1" );
+        support.bc1Srgb = context->hasExtension( "GL_EXT_texture_compression_s3tc_srgb" );
+        support.bc4 = context->hasExtension( "GL_EXT_texture_compression_rgtc" );
+    } else {
+        support.bc1 = context->hasExtension( "GL_EXT_texture_compression_s3tc" );
+        support.bc1Srgb = support.bc1 && ( version >= 21 || context->hasExtension( "GL_EXT_texture_sRGB" ) );
+        // RGTC 从 GL 3.0 起是核心功能
+        support.bc4 = version >= 30 || context->hasExtension( "GL_ARB_texture_compression_rgtc" );
+        support.etc2 = version >= 43 || context->hasExtension( "GL_ARB_ES3_compatibility" );
+        support.preferEtc2 = false;
+    }
+    return support;
+}
+
+GLuint TextureUploader::create( const Ktx2Texture& texture ) {
+    if ( !texture.isValid() ) return 0;
+
+    const GLuint handle = allocate( texture );
+    const uint32_t levelCount = uint32_t( texture.levels.size() );
+    for ( uint32_t level = levelCount; level-- > 0; ) {
+        if ( !uploadLevel( handle, texture, level ) ) {
+            destroy( handle );
+            return 0;
+        }
+    }
+    setResidentLevels( handle, 0, levelCount - 1 );
+    return handle;
+}
+
+GLuint TextureUploader::allocate( const Ktx2Texture& texture ) {
+    if ( !m_initialized ) initialize();
+
+    GLuint handle = 0;
+    glGenTextures( 1, &handle );
+    glBindTexture( GL_TEXTURE_2D, handle );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+    return handle;
+}
+
+bool TextureUploader::uploadLevel( GLuint handle, const Ktx2Texture& texture, uint32_t level ) {
+    const GLenum internalFormat = TextureFormats::glInternalFormat( texture.format );
+    const GLsizei width = GLsizei( texture.levelWidth( level ) );
+    const GLsizei height = GLsizei( texture.levelHeight( level ) );
+    const std::vector<uint8_t>& data = texture.levels[level];
+
+    // 清掉之前遗留的错误, 下面只检查本次上传
+    for ( int i = 0; i < 8 && glGetError() != GL_NO_ERROR; ++i ) {}
+
+    glBindTexture( GL_TEXTURE_2D, handle );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+    if ( TextureFormats::isCompressed( texture.format ) ) {
+        glCompressedTexImage2D( GL_TEXTURE_2D, GLint( level ), internalFormat, width, height, 0,
+                                GLsizei( data.size() ), data.data() );
+    } else {
+        glTexImage2D( GL_TEXTURE_2D, GLint( level ), GLint( internalFormat ), width, height, 0,
+                      GL_RGBA, GL_UNSIGNED_BYTE, data.data() );
+    }
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    const GLenum error = glGetError();
+    if ( error != GL_NO_ERROR ) {
+        qDebug() << "Texture upload failed:" << TextureFormats::name( texture.format ) << "level" << level << "GL error" << error;
+        return false;
+    }
+    return true;
+}
+
+void TextureUploader::setResidentLevels( GLuint handle, uint32_t baseLevel, uint32_t maxLevel ) {
+    glBindTexture( GL_TEXTURE_2D, handle );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, GLint( baseLevel ) );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint( maxLevel ) );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+}
+
+void TextureUploader::releaseLevel( GLuint handle, uint32_t level ) {
+    // 重新定义成 0x0 的图像即可释放该级存储, 它在 BASE_LEVEL 之外 不影响纹理完整性
+    glBindTexture( GL_TEXTURE_2D, handle );
+    glTexImage2D( GL_TEXTURE_2D, GLint( level ), GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+}
+
+GLuint TextureUploader::createConstant( uint8_t r, uint8_t g, uint8_t b, uint8_t a, bool srgb ) {
+    Ktx2Texture texture;
+    texture.format = srgb ? TextureFormat::RGBA8_SRGB : TextureFormat::RGBA8;
+    texture.width = 1;
+    texture.height = 1;
+    texture.levels.push_back( { r, g, b, a } );
+    return create( texture );
+}
+
+void TextureUploader::destroy( GLuint texture ) {
+    if ( texture ) {
+        glDeleteTextures( 1, &texture );
+    }
+}
@@ -0,0 +1,41 @@
+// 单一职责: 把 KTX2 纹理上传到 GL (压缩格式走 glCompressedTexImage2D)
+// 并查询当前上下文支持哪些块压缩格式, 不支持时由调用方退回 RGBA8
+// 所有函数都需要在渲染线程 (上下文为当前) 调用
+#pragma once
+
+#include "ktx2.hpp"
+#include "texture_format.hpp"
+
+#include <QOpenGLExtraFunctions>
+
+class TextureUploader : protected QOpenGLExtraFunctions
+{
+public:
+    TextureUploader() = default;
+
+    // 需要当前上下文
+    void initialize();
+
+    const CompressionSupport& support() const { return m_support; }
+
+    // 创建纹理并上传全部 mip, 失败返回 0
+    GLuint create( const Ktx2Texture& texture );
+
+    // 逐级上传 (见 TextureStreamer): 先创建空纹理, 再按任意顺序上传各级
+    // 采样范围由 BASE_LEVEL / MAX_LEVEL 限定, 范围外未上传的级别不影响纹理完整性
+    GLuint allocate( const Ktx2Texture& texture );
+    bool uploadLevel( GLuint handle, const Ktx2Texture& texture, uint32_t level );
+    void setResidentLevels( GLuint handle, uint32_t baseLevel, uint32_t maxLevel );
+    void releaseLevel( GLuint handle, uint32_t level );
+
+    // 1x1 的常量颜色纹理, 用作缺失贴图的替代
+    GLuint createConstant( uint8_t r, uint8_t g, uint8_t b, uint8_t a, bool srgb );
+
+    void destroy( GLuint texture );
+
+    static CompressionSupport querySupport();
+
+private:
+    bool m_initialized = false;
+    CompressionSupport m_support;
+};
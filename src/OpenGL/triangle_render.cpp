@@ -29,6 +29,13 @@ bool TriangleRender::initialize( const RenderConfig& config ) {
         reportError( RenderError::BufferCreationFailed, "Failed to create vertex buffer" );
     }
 
+    // 初始化 uniform buffer, 并把着色器中的 uniform 块绑定到固定绑定点
+    if ( !m_uniforms.initialize() ) {
+        reportError( RenderError::BufferCreationFailed, "Failed to create uniform buffer" );
+        return false;
+    }
+    m_uniforms.bindBlocks( m_program );
+
     // 保存配置
     m_clearColor = config.clearColor();
     m_rotationSpeed = config.rotationSpeed();
@@ -39,52 +46,56 @@ bool TriangleRender::initialize( const RenderConfig& config ) {
 
 
 bool TriangleRender::render( const RenderContext& context ) {
-    if ( !m_initialized ) {
-        reportError(RenderError::InitializationFailed, "Render not initialized");
+    // 直接渲染: 在渲染线程上录制后立即回放, 与 record() 共用同一套逻辑
+    m_directCommands.reset();
+    if ( !record( context, m_directCommands ) ) {
         return false;
     }
+    m_replayer.execute( m_directCommands );
+    m_replayer.finish();
+    return true;
+}
 
-    // glClearColor( m_clearColor.x(), m_clearColor.y(), m_clearColor.z(), m_clearColor.w() );
-    glClearColor( 0.0, 0.0, 0.0, 0.0);
-    glClear( GL_COLOR_BUFFER_BIT );
-
-    m_currentAngle += m_rotationSpeed;
-    if ( m_currentAngle > 360.0f  ) { m_currentAngle -= 360.0f; }
-
-    // 模型矩阵
-    QMatrix4x4 modelMatrix;
-    modelMatrix.translate(0.0f, 0.0f, -5.0f);
-    modelMatrix.rotate( m_currentAngle, 0.0f, 0.0f );
-
-    // MVP 矩阵
-    QMatrix4x4 mvp = context.projectionMatrix() * modelMatrix;
-
-    // 绑定着色器程序
-    if ( !m_program.bind() ) {
-        reportError(RenderError::RenderingFailed, "Failed to bind shader program");
+bool TriangleRender::record( const RenderContext& context, CommandBuffer& commands ) {
+    if ( !m_initialized ) {
+        reportError(RenderError::InitializationFailed, "Render not initialized");
         return false;
     }
 
-    // 设置uniform
-    m_program.setUniformValue( "mvp", mvp );
-
-    // 绑定vbo
-    m_vbo.bind();
-
-    int location = 0;
-
-    // 顶点位置
-    m_program.enableAttributeArray( location );
-    m_program.setAttributeBuffer( location, GL_FLOAT, 0, 3, sizeof( VertexData ) );
-    // 顶点颜色
-    m_program.enableAttributeArray(location + 1);
-    m_program.setAttributeBuffer(location + 1, GL_FLOAT, sizeof(QVector3D), 3, sizeof(VertexData) );
+    // 只记录命令 GL调用在渲染线程回放时执行
+    QMatrix4x4 modelMatrix = advanceModelMatrix();
+
+    commands.setViewport( 0, 0, context.width(), context.height() );
+    commands.clear( ClearColor | ClearDepth );
+
+    // 每帧一次上传: FrameBlock + 所有物体的 ObjectBlock
+    m_uniforms.beginFrame( context );
+    const uint32_t objectOffset = m_uniforms.addObject( modelMatrix );
+    m_uniforms.upload( commands );
+
+    DrawItem item;
+    item.program = m_program.programId();
+    item.vertexBuffer = m_vbo.bufferId();
+    item.stride = sizeof( VertexData );
+    item.attributeCount = 2;
+    item.attributes[0] = { 0, 3, 0 };                                             // 顶点位置
+    item.attributes[1] = { 1, 3, static_cast<uint16_t>( sizeof( QVector3D ) ) };  // 顶点颜色
+    item.count = static_cast<uint32_t>( m_vertexCount );
+    item.uniformBuffer = m_uniforms.handle();
+    item.objectOffset = objectOffset;
+    item.viewDepth = 5.0f;
+    item.state.depthTest = true;
+
+    // 与 updateProjectMatrix 中的近远平面一致
+    m_queue.begin( 3.0f, 10.0f );
+    m_queue.add( item );
+    m_queue.submit( commands );
 
-    glDrawArrays( GL_TRIANGLES, 0, m_vertexCount );
-
-    m_vbo.release();
-    m_program.release();
+    return true;
+}
 
+bool TriangleRender::submissionStats( SubmissionStats& stats ) const {
+    stats = m_queue.stats();
     return true;
 }
 
@@ -100,10 +111,22 @@ void TriangleRender::cleanup() {
     if ( m_vbo.isCreated() ) {
         m_vbo.destroy();
     }
+    m_uniforms.cleanup();
     m_initialized = false;
 }
 
 
+QMatrix4x4 TriangleRender::advanceModelMatrix() {
+    m_currentAngle += m_rotationSpeed;
+    if ( m_currentAngle > 360.0f  ) { m_currentAngle -= 360.0f; }
+
+    // 模型矩阵
+    QMatrix4x4 modelMatrix;
+    modelMatrix.translate(0.0f, 0.0f, -5.0f);
+    modelMatrix.rotate( m_currentAngle, 0.0f, 0.0f );
+    return modelMatrix;
+}
+
 void TriangleRender::setErrorCallback( ErrorCallback callback ) {
     m_errorCallback = callback;
 }
@@ -2,6 +2,9 @@
 #include "irenderer.hpp"
 #include "render_config.hpp"
 #include "render_context.hpp"
+#include "render_queue.hpp"
+#include "uniform_buffer.hpp"
+#include "gl_command_replayer.hpp"
 
 #include <QOpenGLFunctions>
 #include <QOpenGLBuffer>
@@ -16,6 +19,9 @@ public:
 
     bool initialize(const RenderConfig& config) override;
     bool render( const RenderContext& context ) override;
+    bool supportsRecording() const override { return true; }
+    bool record( const RenderContext& context, CommandBuffer& commands ) override;
+    bool submissionStats( SubmissionStats& stats ) const override;
     bool resize( int width, int height ) override;
     void cleanup() override;
     void setErrorCallback( ErrorCallback callback ) override;
@@ -24,9 +30,11 @@ public:
 private:
     bool initializeShader( const QString& vertexPath, const QString& fragmentShader );
     bool initializeGeometry( const std::vector<VertexData>& vertices );
+    QMatrix4x4 advanceModelMatrix();
     void reportError( RenderError error, const std::string& message );
 
     QOpenGLShaderProgram m_program;
+    RenderQueue m_queue;
     QOpenGLBuffer m_vbo;
     QMatrix4x4 m_projection;
     QVector4D m_clearColor;
@@ -34,6 +42,10 @@ private:
     float m_currentAngle;
     int m_vertexCount;
 
+    UniformBuffer m_uniforms;
+    CommandBuffer m_directCommands;     // render() 直接渲染时使用
+    GLCommandReplayer m_replayer;
+
     ErrorCallback m_errorCallback;
     bool m_initialized;
 };
@@ -0,0 +1,131 @@
+#include "uniform_buffer.hpp"
+
+#include <QDebug>
+#include <QOpenGLContext>
+#include <algorithm>
+#include <cstring>
+
+bool UniformBuffer::initialize() {
+    // std140 uniform 块从 GL 3.1 / GLES 3.0 起才有; main() 已经请求 3.3 core / ES 3.0,
+    // 驱动只给出更低版本 (比如 macOS 的 2.1 兼容上下文) 时让渲染器初始化失败, 而不是每帧报 GL 错误
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if ( !context ) {
+        qDebug() << "Uniform buffer needs a current OpenGL context";
+        return false;
+    }
+    const QSurfaceFormat format = context->format();
+    const int version = format.majorVersion() * 10 + format.minorVersion();
+    if ( version < ( context->isOpenGLES() ? 30 : 31 ) ) {
+        qDebug() << "Uniform buffers need OpenGL 3.1 or OpenGL ES 3.0, context is" << format.majorVersion() << "."
+                 << format.minorVersion() << ( context->isOpenGLES() ? "ES" : "" );
+        return false;
+    }
+
+    initializeOpenGLFunctions();
+
+    GLint alignment = 0;
+    glGetIntegerv( GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment );
+    if ( alignment > 0 ) {
+        m_alignment = static_cast<uint32_t>( alignment );
+    }
+
+    glGenBuffers( 1, &m_buffer );
+    if ( m_buffer == 0 ) {
+        qDebug() << "Failed to create uniform buffer";
+        return false;
+    }
+
+    // 先分配一个合适的初始容量 上传时按需增长
+    glBindBuffer( GL_UNIFORM_BUFFER, m_buffer );
+    glBufferData( GL_UNIFORM_BUFFER, 16 * 1024, nullptr, GL_STREAM_DRAW );
+    glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+
+    return true;
+}
+
+void UniformBuffer::cleanup() {
+    if ( m_buffer ) {
+        glDeleteBuffers( 1, &m_buffer );
+        m_buffer = 0;
+    }
+    m_staging.clear();
+    m_used = 0;
+}
+
+void UniformBuffer::bindBlocks( QOpenGLShaderProgram& program ) {
+    const GLuint id = program.programId();
+
+    const GLuint frameIndex = glGetUniformBlockIndex( id, "FrameBlock" );
+    if ( frameIndex != GL_INVALID_INDEX ) {
+        glUniformBlockBinding( id, frameIndex, FrameBlockBinding );
+    }
+
+    const GLuint objectIndex = glGetUniformBlockIndex( id, "ObjectBlock" );
+    if ( objectIndex != GL_INVALID_INDEX ) {
+        glUniformBlockBinding( id, objectIndex, ObjectBlockBinding );
+    }
+}
+
+void UniformBuffer::beginFrame( const RenderContext& context ) {
+    FrameUniforms frame;
+
+    const QMatrix4x4 view = context.viewMatrix();
+    const QMatrix4x4 projection = context.projectionMatrix();
+    const QMatrix4x4 viewProjection = projection * view;
+    std::memcpy( frame.view, view.constData(), sizeof(frame.view) );
+    std::memcpy( frame.projection, projection.constData(), sizeof(frame.projection) );
+    std::memcpy( frame.viewProjection, viewProjection.constData(), sizeof(frame.viewProjection) );
+
+    frame.time[0] = context.time();
+    frame.time[1] = context.deltaTime();
+    frame.time[2] = static_cast<float>( context.frameNumer() );
+    frame.time[3] = 0.0f;
+
+    const float width = static_cast<float>( context.width() );
+    const float height = static_cast<float>( context.height() );
+    frame.viewport[0] = width;
+    frame.viewport[1] = height;
+    frame.viewport[2] = width > 0.0f ? 1.0f / width : 0.0f;
+    frame.viewport[3] = height > 0.0f ? 1.0f / height : 0.0f;
+
+    // FrameBlock 固定在偏移 0
+    m_used = align( sizeof(FrameUniforms) );
+    if ( m_staging.size() < m_used ) {
+        m_staging.resize( m_used );
+    }
+    std::memcpy( m_staging.data(), &frame, sizeof(frame) );
+}
+
+uint32_t UniformBuffer::addObject( const QMatrix4x4& model, const QVector4D& color ) {
+    ObjectUniforms object;
+    std::memcpy( object.model, model.constData(), sizeof(object.model) );
+
+    const QMatrix3x3 normal = model.normalMatrix();
+    QMatrix4x4 normal4;
+    for ( int row = 0; row < 3; ++row ) {
+        for ( int column = 0; column < 3; ++column ) {
+            normal4( row, column ) = normal( row, column );
+        }
+    }
+    std::memcpy( object.normalMatrix, normal4.constData(), sizeof(object.normalMatrix) );
+
+    object.color[0] = color.x();
+    object.color[1] = color.y();
+    object.color[2] = color.z();
+    object.color[3] = color.w();
+
+    const uint32_t offset = m_used;
+    m_used += align( sizeof(ObjectUniforms) );
+    if ( m_staging.size() < m_used ) {
+        // 按倍数增长 减少帧间的重新分配
+        m_staging.resize( std::max<size_t>( m_used, m_staging.size() * 2 ) );
+    }
+    std::memcpy( m_staging.data() + offset, &object, sizeof(object) );
+    return offset;
+}
+
+void UniformBuffer::upload( CommandBuffer& commands ) {
+    // 整块重新分配 (orphan) 驱动不必等待上一帧对旧数据的使用
+    commands.uploadBuffer( BufferTarget::Uniform, m_buffer, 0, m_staging.data(), m_used, true );
+    commands.bindUniformBuffer( FrameBlockBinding, m_buffer, 0, sizeof(FrameUniforms) );
+}
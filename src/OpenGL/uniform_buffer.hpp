@@ -0,0 +1,68 @@
+// 单一职责: 管理 std140 uniform 块
+// 每帧一个 FrameBlock (view/projection/time/viewport) 所有 program 共用,
+// 每个物体一个 ObjectBlock, 全部打包进同一个 UBO, 每帧只上传一次, 绘制时按偏移绑定
+#pragma once
+
+#include "command_buffer.hpp"
+#include "render_context.hpp"
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <vector>
+
+// 与着色器中的块绑定点一致
+enum UniformBinding : uint32_t {
+    FrameBlockBinding = 0,
+    ObjectBlockBinding = 1,
+};
+
+// std140 布局: mat4 = 4 个 vec4 列, vec4 按 16 字节对齐
+struct FrameUniforms {
+    float view[16];
+    float projection[16];
+    float viewProjection[16];
+    float time[4];          // x: 运行时间(秒) y: 帧间隔 z: 帧号
+    float viewport[4];      // xy: 尺寸 zw: 1/尺寸
+};
+
+struct ObjectUniforms {
+    float model[16];
+    float normalMatrix[16]; // 只用左上 3x3, 用 mat4 避免 std140 中 mat3 的填充问题
+    float color[4];
+};
+
+static_assert( sizeof(FrameUniforms) == 224, "FrameUniforms must match std140 layout" );
+static_assert( sizeof(ObjectUniforms) == 144, "ObjectUniforms must match std140 layout" );
+
+class UniformBuffer : protected QOpenGLExtraFunctions {
+public:
+    UniformBuffer() = default;
+
+    // ---- 渲染线程 ----
+    bool initialize();
+    void cleanup();
+
+    // 把 program 中的 FrameBlock/ObjectBlock 绑定到固定绑定点 (link 之后调用一次)
+    void bindBlocks( QOpenGLShaderProgram& program );
+
+    // ---- 录制线程 ----
+    void beginFrame( const RenderContext& context );
+
+    // 追加一个物体的数据 返回在 UBO 中的字节偏移
+    uint32_t addObject( const QMatrix4x4& model, const QVector4D& color = QVector4D( 1.0f, 1.0f, 1.0f, 1.0f ) );
+
+    // 整个 UBO 只上传一次, 并绑定 FrameBlock; 必须在所有绘制命令之前调用
+    void upload( CommandBuffer& commands );
+
+    RenderHandle handle() const { return m_buffer; }
+
+private:
+    uint32_t align( uint32_t size ) const {
+        return ( size + m_alignment - 1 ) / m_alignment * m_alignment;
+    }
+
+    GLuint m_buffer = 0;
+    uint32_t m_alignment = 256;             // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    std::vector<uint8_t> m_staging;         // 本帧的 CPU 端数据
+    uint32_t m_used = 0;
+};
@@ -0,0 +1,5 @@
+#version 330 core
+
+// 深度预渲染: 只写深度, 颜色写入已在渲染状态中关闭
+void main() {
+}
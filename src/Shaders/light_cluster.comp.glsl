@@ -0,0 +1,70 @@
+#version 430 core
+
+// 每个工作组负责一个 froxel: 组内线程分摊测试全部灯, 命中的灯先收集到共享内存,
+// 再由一个线程在全局下标列表里原子地分配空间, 最后全组一起写出
+// froxel 的划分与 LightClusterer 完全相同 (tile 均分 NDC, 深度按指数切片)
+layout( local_size_x = 64 ) in;
+
+uniform sampler2D lightData;        // 每盏灯两个纹素: 视图空间位置 + 半径, 颜色
+layout( rg32ui, binding = 0 ) uniform writeonly uimage2D clusterGrid;
+layout( r32ui, binding = 1 ) uniform writeonly uimage2D lightIndices;
+layout( r32ui, binding = 2 ) uniform coherent uimage2D indexCounter;
+
+uniform vec4 gridSize;      // tilesX tilesY slices lightCount
+uniform vec4 projection;    // P00 P11 P02 P12
+uniform vec4 depthRange;    // near far 下标容量
+
+const uint kMaxLightsPerCluster = 256u;     // 与 ClusteredLighting::kMaxLightsPerCluster 一致
+const uint kIndexRowLength = 1024u;         // 与 ClusteredLighting::kIndexRowLength 一致
+
+shared uint s_count;
+shared uint s_offset;
+shared uint s_lights[kMaxLightsPerCluster];
+
+void main() {
+    uvec3 cluster = gl_WorkGroupID;
+    if ( gl_LocalInvocationIndex == 0u ) {
+        s_count = 0u;
+    }
+    barrier();
+
+    // froxel 的视图空间包围盒, 视图空间 x = (ndc + P02) * d / P00
+    float nearPlane = depthRange.x;
+    float farPlane = depthRange.y;
+    float dn = nearPlane * pow( farPlane / nearPlane, float( cluster.z ) / gridSize.z );
+    float df = nearPlane * pow( farPlane / nearPlane, float( cluster.z + 1u ) / gridSize.z );
+    vec2 a = ( vec2( cluster.xy ) / gridSize.xy * 2.0 - 1.0 + projection.zw ) / projection.xy;
+    vec2 b = ( vec2( cluster.xy + 1u ) / gridSize.xy * 2.0 - 1.0 + projection.zw ) / projection.xy;
+    vec3 boxMin = vec3( min( min( a * dn, a * df ), min( b * dn, b * df ) ), -df );
+    vec3 boxMax = vec3( max( max( a * dn, a * df ), max( b * dn, b * df ) ), -dn );
+
+    uint lightCount = uint( gridSize.w );
+    for ( uint i = gl_LocalInvocationIndex; i < lightCount; i += gl_WorkGroupSize.x ) {
+        vec4 light = texelFetch( lightData, ivec2( int( i ) * 2, 0 ), 0 );
+        vec3 d = max( max( boxMin - light.xyz, light.xyz - boxMax ), vec3( 0.0 ) );
+        if ( dot( d, d ) <= light.w * light.w ) {
+            uint slot = atomicAdd( s_count, 1u );
+            if ( slot < kMaxLightsPerCluster ) {
+                s_lights[slot] = i;
+            }
+        }
+    }
+    barrier();
+
+    if ( gl_LocalInvocationIndex == 0u ) {
+        uint count = min( s_count, kMaxLightsPerCluster );
+        uint offset = imageAtomicAdd( indexCounter, ivec2( 0, 0 ), count );
+        uint capacity = uint( depthRange.z );
+        count = offset >= capacity ? 0u : min( count, capacity - offset );
+        s_offset = offset;
+        s_count = count;
+        int tile = int( cluster.x + cluster.y * uint( gridSize.x ) );
+        imageStore( clusterGrid, ivec2( tile, int( cluster.z ) ), uvec4( offset, count, 0u, 0u ) );
+    }
+    barrier();
+
+    for ( uint i = gl_LocalInvocationIndex; i < s_count; i += gl_WorkGroupSize.x ) {
+        uint index = s_offset + i;
+        imageStore( lightIndices, ivec2( int( index % kIndexRowLength ), int( index / kIndexRowLength ) ), uvec4( s_lights[i] ) );
+    }
+}
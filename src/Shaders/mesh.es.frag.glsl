@@ -0,0 +1,19 @@
+#version 300 es
+precision mediump float;
+
+in vec3 fragNormal;
+out vec4 outColor;
+
+layout(std140) uniform ObjectBlock {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+} object;
+
+// 世界空间的方向光
+const vec3 lightDir = vec3( 0.3, 0.6, 0.75 );
+
+void main() {
+    float diffuse = max( dot( normalize( fragNormal ), normalize( lightDir ) ), 0.0 );
+    outColor = vec4( object.color.rgb * ( 0.25 + 0.75 * diffuse ), object.color.a );
+}
@@ -0,0 +1,28 @@
+#version 440
+
+layout(location = 0) in vec2 vTexCoord;
+layout(location = 1) flat in vec4 vColor;
+
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+    float distanceRange;    // 距离场覆盖的总宽度, 图集像素
+};
+
+layout(binding = 1) uniform sampler2D atlas;
+
+float median( float r, float g, float b ) {
+    return max( min( r, g ), min( max( r, g ), b ) );
+}
+
+void main() {
+    vec3 sampled = texture( atlas, vTexCoord ).rgb;
+    // 距离换算成屏幕像素: 图标缩放多少, 过渡带仍然是一个屏幕像素宽
+    vec2 unitRange = vec2( distanceRange ) / vec2( textureSize( atlas, 0 ) );
+    vec2 screenTexSize = vec2( 1.0 ) / fwidth( vTexCoord );
+    float screenPxRange = max( 0.5 * dot( unitRange, screenTexSize ), 1.0 );
+    float screenDistance = screenPxRange * ( median( sampled.r, sampled.g, sampled.b ) - 0.5 );
+    fragColor = vColor * clamp( screenDistance + 0.5, 0.0, 1.0 ) * qt_Opacity;
+}
@@ -0,0 +1,23 @@
+#version 440
+
+// 场景图材质 (qsb), 由 qt_add_shaders 编译; 颜色在顶点里, 不同颜色的图标可以合批
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec4 color;         // 预乘 alpha
+
+layout(location = 0) out vec2 vTexCoord;
+layout(location = 1) flat out vec4 vColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+    float distanceRange;
+};
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    vTexCoord = texCoord;
+    vColor = color;
+    gl_Position = qt_Matrix * position;
+}
@@ -0,0 +1,165 @@
+#version 300 es
+precision highp float;
+
+in vec3 viewPosition;
+in vec3 viewNormal;
+in vec2 fragTexCoord;
+
+out vec4 outColor;
+
+// ES 的 sampler2D / samplerCube 默认是 lowp, 只适合 8 位颜色; 浮点纹理必须显式给精度
+uniform sampler2D baseColorMap;             // 单元 0, sRGB 格式, 采样结果已是线性值
+uniform sampler2D ormMap;                   // 单元 1, R = AO  G = roughness  B = metallic
+uniform sampler2D normalMap;                // 单元 2, 切线空间法线
+uniform mediump samplerCube prefilteredMap; // 单元 4, 预滤波的环境光 (HDR 半精度), mip 级别随粗糙度增加
+uniform mediump sampler2D brdfLut;          // 单元 5, 分离求和近似的 (F0 系数, 偏移)
+
+// IBL 在工作线程烘焙 (见 IblBaker), 完成前 iblReady 为 0, 使用半球环境光
+uniform vec3 irradianceSH[9];       // 漫反射辐照度的 SH9 系数, 已除以 PI
+uniform float prefilteredLevels;    // 预滤波贴图的最大 mip 级别
+uniform float iblReady;
+
+// 分簇点光源 (见 ClusteredLighting), 每个片元只遍历所在 froxel 的灯
+uniform highp sampler2D clusterLights;    // 单元 6, 每盏灯两个纹素: 视图空间位置 + 半径, 颜色
+uniform highp usampler2D clusterGrid;     // 单元 7, 每个簇 (下标起点, 灯数), x = tile, y = 深度切片
+uniform highp usampler2D clusterIndices;  // 单元 8, 灯的下标, 每行 1024 个
+uniform vec4 clusterSize;                 // tilesX tilesY slices lightCount, lightCount 为 0 时跳过
+uniform vec4 clusterDepth;                // 切片 = log(视图深度) * x + y
+
+layout(std140) uniform FrameBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 time;
+    vec4 viewport;
+} frame;
+
+layout(std140) uniform ObjectBlock {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+} object;
+
+const float PI = 3.14159265;
+
+// 世界空间的主光和补光
+const vec3 keyLightDir = vec3( 0.4, 0.8, 0.6 );
+const vec3 keyLightColor = vec3( 3.0 );
+const vec3 fillLightDir = vec3( -0.6, 0.2, -0.4 );
+const vec3 fillLightColor = vec3( 0.8 );
+
+// 没有切线数据, 用屏幕空间导数构造 TBN (Schüler 2013)
+vec3 perturbNormal( vec3 N, vec3 P, vec2 uv ) {
+    vec3 dp1 = dFdx( P );
+    vec3 dp2 = dFdy( P );
+    vec2 duv1 = dFdx( uv );
+    vec2 duv2 = dFdy( uv );
+
+    vec3 dp2perp = cross( dp2, N );
+    vec3 dp1perp = cross( N, dp1 );
+    vec3 T = dp2perp * duv1.x + dp1perp * duv2.x;
+    vec3 B = dp2perp * duv1.y + dp1perp * duv2.y;
+    float invmax = inversesqrt( max( dot( T, T ), dot( B, B ) ) + 1e-12 );
+
+    vec3 tangentNormal = texture( normalMap, uv ).xyz * 2.0 - 1.0;
+    return normalize( mat3( T * invmax, B * invmax, N ) * tangentNormal );
+}
+
+float distributionGGX( float NdotH, float alpha ) {
+    float a2 = alpha * alpha;
+    float d = NdotH * NdotH * ( a2 - 1.0 ) + 1.0;
+    return a2 / ( PI * d * d );
+}
+
+// 高度相关的 Smith 可见性项, 已包含 1 / (4 NdotL NdotV)
+float visibilitySmithGGX( float NdotV, float NdotL, float alpha ) {
+    float a2 = alpha * alpha;
+    float ggxV = NdotL * sqrt( NdotV * NdotV * ( 1.0 - a2 ) + a2 );
+    float ggxL = NdotV * sqrt( NdotL * NdotL * ( 1.0 - a2 ) + a2 );
+    return 0.5 / max( ggxV + ggxL, 1e-5 );
+}
+
+vec3 fresnelSchlick( float VdotH, vec3 F0 ) {
+    return F0 + ( 1.0 - F0 ) * pow( 1.0 - VdotH, 5.0 );
+}
+
+// 世界空间法线方向的辐照度 / PI
+vec3 irradiance( vec3 n ) {
+    return max( irradianceSH[0] * 0.282095
+              + irradianceSH[1] * ( 0.488603 * n.y )
+              + irradianceSH[2] * ( 0.488603 * n.z )
+              + irradianceSH[3] * ( 0.488603 * n.x )
+              + irradianceSH[4] * ( 1.092548 * n.x * n.y )
+              + irradianceSH[5] * ( 1.092548 * n.y * n.z )
+              + irradianceSH[6] * ( 0.315392 * ( 3.0 * n.z * n.z - 1.0 ) )
+              + irradianceSH[7] * ( 1.092548 * n.x * n.z )
+              + irradianceSH[8] * ( 0.546274 * ( n.x * n.x - n.y * n.y ) ), vec3( 0.0 ) );
+}
+
+vec3 shade( vec3 N, vec3 V, vec3 L, vec3 radiance, vec3 diffuseColor, vec3 F0, float alpha ) {
+    vec3 H = normalize( V + L );
+    float NdotL = max( dot( N, L ), 0.0 );
+    float NdotV = max( dot( N, V ), 1e-4 );
+    float NdotH = max( dot( N, H ), 0.0 );
+    float VdotH = max( dot( V, H ), 0.0 );
+
+    vec3 F = fresnelSchlick( VdotH, F0 );
+    vec3 specular = F * distributionGGX( NdotH, alpha ) * visibilitySmithGGX( NdotV, NdotL, alpha );
+    vec3 diffuse = ( 1.0 - F ) * diffuseColor / PI;
+    return ( diffuse + specular ) * radiance * NdotL;
+}
+
+void main() {
+    vec3 baseColor = texture( baseColorMap, fragTexCoord ).rgb * object.color.rgb;
+    vec3 orm = texture( ormMap, fragTexCoord ).rgb;
+    float ao = orm.r;
+    float roughness = clamp( orm.g, 0.045, 1.0 );
+    float metallic = orm.b;
+    float alpha = roughness * roughness;
+
+    vec3 N = perturbNormal( normalize( viewNormal ), viewPosition, fragTexCoord );
+    vec3 V = normalize( -viewPosition );
+
+    vec3 F0 = mix( vec3( 0.04 ), baseColor, metallic );
+    vec3 diffuseColor = baseColor * ( 1.0 - metallic );
+
+    mat3 toView = mat3( frame.view );
+    vec3 color = shade( N, V, normalize( toView * keyLightDir ), keyLightColor, diffuseColor, F0, alpha )
+               + shade( N, V, normalize( toView * fillLightDir ), fillLightColor, diffuseColor, F0, alpha );
+
+    if ( clusterSize.w > 0.0 ) {
+        ivec2 tile = clamp( ivec2( gl_FragCoord.xy * frame.viewport.zw * clusterSize.xy ), ivec2( 0 ), ivec2( clusterSize.xy ) - 1 );
+        int slice = clamp( int( log( -viewPosition.z ) * clusterDepth.x + clusterDepth.y ), 0, int( clusterSize.z ) - 1 );
+        uvec2 cell = texelFetch( clusterGrid, ivec2( tile.x + tile.y * int( clusterSize.x ), slice ), 0 ).rg;
+        for ( uint i = 0u; i < cell.y; ++i ) {
+            uint index = cell.x + i;
+            int light = int( texelFetch( clusterIndices, ivec2( int( index % 1024u ), int( index / 1024u ) ), 0 ).r );
+            vec4 positionRadius = texelFetch( clusterLights, ivec2( light * 2, 0 ), 0 );
+            vec3 toLight = positionRadius.xyz - viewPosition;
+            float distance2 = max( dot( toLight, toLight ), 1e-4 );
+            // 平方反比, 在半径处平滑衰减到 0
+            float window = clamp( 1.0 - distance2 / ( positionRadius.w * positionRadius.w ), 0.0, 1.0 );
+            if ( window > 0.0 ) {
+                vec3 radiance = texelFetch( clusterLights, ivec2( light * 2 + 1, 0 ), 0 ).rgb * ( window * window / distance2 );
+                color += shade( N, V, toLight * inversesqrt( distance2 ), radiance, diffuseColor, F0, alpha );
+            }
+        }
+    }
+
+    // 环境光, 由 AO 遮蔽
+    if ( iblReady > 0.5 ) {
+        mat3 toWorld = transpose( toView );
+        float NdotV = max( dot( N, V ), 1e-4 );
+        vec2 brdf = texture( brdfLut, vec2( NdotV, roughness ) ).rg;
+        vec3 specular = textureLod( prefilteredMap, toWorld * reflect( -V, N ), roughness * prefilteredLevels ).rgb;
+        color += ( irradiance( toWorld * N ) * diffuseColor + specular * ( F0 * brdf.x + brdf.y ) ) * ao;
+    } else {
+        float up = dot( N, normalize( toView * vec3( 0.0, 1.0, 0.0 ) ) ) * 0.5 + 0.5;
+        vec3 ambient = mix( vec3( 0.05, 0.04, 0.03 ), vec3( 0.25, 0.28, 0.32 ), up );
+        color += ambient * ( diffuseColor + F0 * ( 1.0 - roughness ) ) * ao;
+    }
+
+    // Reinhard 色调映射后转回 sRGB
+    color = color / ( color + vec3( 1.0 ) );
+    outColor = vec4( pow( color, vec3( 1.0 / 2.2 ) ), 1.0 );
+}
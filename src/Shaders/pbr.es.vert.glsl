@@ -0,0 +1,35 @@
+#version 300 es
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texCoord;
+
+out vec3 viewPosition;
+out vec3 viewNormal;
+out vec2 fragTexCoord;
+
+// 每帧共享的常量 (绑定点 0)
+layout(std140) uniform FrameBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 time;          // x: 运行时间 y: 帧间隔 z: 帧号
+    vec4 viewport;      // xy: 尺寸 zw: 1/尺寸
+} frame;
+
+// 每个物体的常量 (绑定点 1, 按偏移绑定到同一个 UBO)
+layout(std140) uniform ObjectBlock {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+} object;
+
+void main() {
+    // 在观察空间里做光照, 相机位于原点
+    vec4 world = object.model * vec4( position, 1.0 );
+    vec4 viewPos = frame.view * world;
+    viewPosition = viewPos.xyz;
+    viewNormal = mat3( frame.view ) * ( mat3( object.normalMatrix ) * normal );
+    fragTexCoord = texCoord;
+    gl_Position = frame.projection * viewPos;
+}
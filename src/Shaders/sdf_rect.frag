@@ -0,0 +1,32 @@
+#version 440
+
+layout(location = 0) in vec2 vLocal;
+layout(location = 1) flat in vec2 vHalfSize;
+layout(location = 2) flat in vec4 vRadii;
+layout(location = 3) in vec4 vFillColor;    // 渐变时沿渐变方向插值
+layout(location = 4) flat in vec4 vBorderColor;
+layout(location = 5) flat in float vBorderWidth;
+
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+};
+
+// 圆角矩形的有向距离, 内部为负; y 轴向下, 按所在象限取对应角的半径
+float roundedBoxDistance( vec2 p, vec2 halfSize, vec4 radii ) {
+    float radius = p.x > 0.0 ? ( p.y > 0.0 ? radii.z : radii.y ) : ( p.y > 0.0 ? radii.w : radii.x );
+    vec2 q = abs( p ) - halfSize + radius;
+    return min( max( q.x, q.y ), 0.0 ) + length( max( q, 0.0 ) ) - radius;
+}
+
+void main() {
+    float dist = roundedBoxDistance( vLocal, vHalfSize, vRadii );
+    // 抗锯齿宽度取一个屏幕像素对应的距离, 缩放后边缘仍然是一个像素宽
+    float pixel = max( fwidth( dist ), 1e-4 );
+    float outer = clamp( 0.5 - dist / pixel, 0.0, 1.0 );
+    // 内边界是外轮廓向内平移 borderWidth, 圆角半径随之减小
+    float inner = vBorderWidth > 0.0 ? clamp( 0.5 - ( dist + vBorderWidth ) / pixel, 0.0, 1.0 ) : 1.0;
+    fragColor = mix( vBorderColor, vFillColor, inner ) * outer * qt_Opacity;
+}
@@ -0,0 +1,34 @@
+#version 440
+
+// 场景图材质 (qsb), 由 qt_add_shaders 编译; 每个矩形的参数都在顶点里, 不同矩形可以合批
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 local;         // 相对矩形中心的坐标, 逻辑像素
+layout(location = 2) in vec2 halfSize;
+layout(location = 3) in vec4 radii;         // 左上 右上 右下 左下
+layout(location = 4) in vec4 fillColor;     // 预乘 alpha
+layout(location = 5) in vec4 borderColor;   // 预乘 alpha
+layout(location = 6) in float borderWidth;
+
+layout(location = 0) out vec2 vLocal;
+layout(location = 1) flat out vec2 vHalfSize;
+layout(location = 2) flat out vec4 vRadii;
+layout(location = 3) out vec4 vFillColor;
+layout(location = 4) flat out vec4 vBorderColor;
+layout(location = 5) flat out float vBorderWidth;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+};
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    vLocal = local;
+    vHalfSize = halfSize;
+    vRadii = radii;
+    vFillColor = fillColor;
+    vBorderColor = borderColor;
+    vBorderWidth = borderWidth;
+    gl_Position = qt_Matrix * position;
+}
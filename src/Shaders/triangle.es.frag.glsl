@@ -0,0 +1,9 @@
+#version 300 es
+precision mediump float;
+
+in vec3 fragColor;
+out vec4 outColor;
+
+void main() {
+    outColor = vec4( fragColor, 1.0 );
+}
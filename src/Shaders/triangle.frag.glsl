@@ -1,8 +1,8 @@
 #version 330 core
 
-in vec4 fragColor;
-out vec4 gl_FragColor;
+in vec3 fragColor;
+out vec4 outColor;
 
 void main() {
-    gl_FragColor = fragColor;
+    outColor = vec4( fragColor, 1.0 );
 }
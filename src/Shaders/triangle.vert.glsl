@@ -5,9 +5,23 @@ layout(location = 1) in vec3 color;
 
 out vec3 fragColor;
 
-uniform mat4 mvp;
+// 每帧共享的常量 (绑定点 0)
+layout(std140) uniform FrameBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 time;          // x: 运行时间 y: 帧间隔 z: 帧号
+    vec4 viewport;      // xy: 尺寸 zw: 1/尺寸
+} frame;
+
+// 每个物体的常量 (绑定点 1, 按偏移绑定到同一个 UBO)
+layout(std140) uniform ObjectBlock {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+} object;
 
 void main() {
-    gl_Position = mvp * vec4( position, 1.0 );
-    fragColor = color;
+    gl_Position = frame.viewProjection * object.model * vec4( position, 1.0 );
+    fragColor = color * object.color.rgb;
 }
@@ -0,0 +1,24 @@
+#include "benchmark_suite.hpp"
+#include "light_benchmark.hpp"
+#include "occlusion_benchmark.hpp"
+#include "pixel_benchmark.hpp"
+#include "plot_benchmark.hpp"
+
+#include <cstring>
+
+const std::vector<BenchmarkSuite>& benchmarkSuites() {
+    static const std::vector<BenchmarkSuite> suites = {
+        { "pixel", &PixelBenchmark::verify, &PixelBenchmark::measure },
+        { "light", &LightBenchmark::verify, &LightBenchmark::measure },
+        { "occlusion", &OcclusionBenchmark::verify, &OcclusionBenchmark::measure },
+        { "plot", &PlotBenchmark::verify, &PlotBenchmark::measure },
+    };
+    return suites;
+}
+
+const BenchmarkSuite* findBenchmarkSuite( const char* name ) {
+    for ( const BenchmarkSuite& suite : benchmarkSuites() ) {
+        if ( std::strcmp( suite.name, name ) == 0 ) return &suite;
+    }
+    return nullptr;
+}
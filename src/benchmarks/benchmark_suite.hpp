@@ -0,0 +1,17 @@
+// 单一职责: 登记内核的校验 / 测量套件, 供 selfTests (ctest) 和 benchmarks (控制台程序) 按名字查找
+// verify 全部检查通过时返回 true, 失败的检查逐行写进 report; measure 把耗时打印到标准输出
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct BenchmarkSuite {
+    const char* name;
+    bool ( *verify )( std::string& report );
+    void ( *measure )();
+};
+
+const std::vector<BenchmarkSuite>& benchmarkSuites();
+
+// 没有这个名字时返回 nullptr
+const BenchmarkSuite* findBenchmarkSuite( const char* name );
@@ -0,0 +1,42 @@
+// 控制台程序: benchmarks [套件名...], 不带参数时运行全部套件
+// 每个套件先校验, 校验失败的不测量 (测出来的也不是正确结果的耗时), 退出码为 1
+// benchmarks startup [cold|warm] [次数]: 反复启动界面程序统计启动阶段, 不属于上面的套件
+#include "benchmark_suite.hpp"
+#include "startup_benchmark.hpp"
+
+#include <cstring>
+#include <iostream>
+
+int main( int argc, char* argv[] ) {
+    if ( argc > 1 && std::strcmp( argv[1], "startup" ) == 0 ) {
+        return StartupBenchmark::run( APP_EXECUTABLE, argc - 2, argv + 2 );
+    }
+
+    std::vector<const BenchmarkSuite*> selected;
+    for ( int i = 1; i < argc; ++i ) {
+        const BenchmarkSuite* suite = findBenchmarkSuite( argv[i] );
+        if ( !suite ) {
+            std::cout << "unknown suite: " << argv[i] << ", available:";
+            for ( const BenchmarkSuite& known : benchmarkSuites() ) std::cout << " " << known.name;
+            std::cout << "\n";
+            return 1;
+        }
+        selected.push_back( suite );
+    }
+    if ( selected.empty() ) {
+        for ( const BenchmarkSuite& suite : benchmarkSuites() ) selected.push_back( &suite );
+    }
+
+    bool ok = true;
+    for ( const BenchmarkSuite* suite : selected ) {
+        std::string report;
+        if ( !suite->verify( report ) ) {
+            std::cout << suite->name << ": verification FAILED, not measured\n" << report;
+            ok = false;
+            continue;
+        }
+        std::cout << "== " << suite->name << "\n";
+        suite->measure();
+    }
+    return ok ? 0 : 1;
+}
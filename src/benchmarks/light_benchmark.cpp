@@ -0,0 +1,141 @@
+#include "light_benchmark.hpp"
+#include "light_clusterer.hpp"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kBenchmarkLights = 1000;
+constexpr int kBenchmarkRounds = 20;
+
+// 与 OpenGLItemRenderer::updateProjectMatrix 相同的相机, 16:9 视口
+constexpr float kNear = 3.0f;
+constexpr float kFar = 10.0f;
+
+QMatrix4x4 benchmarkProjection() {
+    QMatrix4x4 projection;
+    projection.perspective( 30.0f, 16.0f / 9.0f, kNear, kFar );
+    return projection;
+}
+
+// 视锥内均匀分布的点光源, 半径 0.3 ~ 1.0
+std::vector<ClusterLight> randomLights( uint32_t count, uint32_t seed ) {
+    std::mt19937 rng( seed );
+    std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+    const float tanY = std::tan( 15.0f * 3.14159265f / 180.0f );
+    const float tanX = tanY * 16.0f / 9.0f;
+
+    std::vector<ClusterLight> lights( count );
+    for ( ClusterLight& light : lights ) {
+        const float depth = kNear + ( kFar - kNear ) * unit( rng );
+        light.x = ( unit( rng ) * 2.0f - 1.0f ) * tanX * depth;
+        light.y = ( unit( rng ) * 2.0f - 1.0f ) * tanY * depth;
+        light.z = -depth;
+        light.radius = 0.3f + 0.7f * unit( rng );
+    }
+    return lights;
+}
+
+// 重复几轮取最快的一次, 返回毫秒
+template <typename Fn>
+double bestOf( Fn&& fn ) {
+    double best = std::numeric_limits<double>::max();
+    for ( int round = 0; round < kBenchmarkRounds; ++round ) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        best = std::min( best, timer.nsecsElapsed() / 1.0e6 );
+    }
+    return best;
+}
+
+} // namespace
+
+bool LightBenchmark::verify( std::string& report ) {
+    bool ok = true;
+    const QMatrix4x4 projection = benchmarkProjection();
+
+    // 灯数取不同的值, 覆盖 SoA 补齐的尾部
+    for ( uint32_t count : { 0u, 1u, 3u, 5u, 64u, 257u } ) {
+        const std::vector<ClusterLight> lights = randomLights( count, count + 7 );
+        LightClusterer scalar;
+        LightClusterer simd;
+        scalar.setProjection( projection, kNear, kFar );
+        simd.setProjection( projection, kNear, kFar );
+        scalar.build( lights.data(), count, false, false );
+        simd.build( lights.data(), count, true, true );
+        if ( scalar.grid() != simd.grid() || scalar.indices() != simd.indices() ) {
+            report += "SIMD clusters differ from scalar (" + std::to_string( count ) + " lights)\n";
+            ok = false;
+        }
+    }
+
+    // 视锥内随机取点, 按着色器的方式求簇, 照到该点的灯必须都在簇的列表里
+    const std::vector<ClusterLight> lights = randomLights( kBenchmarkLights, 1 );
+    LightClusterer clusterer;
+    clusterer.setProjection( projection, kNear, kFar );
+    clusterer.build( lights.data(), kBenchmarkLights );
+    const ClusterGridSize& size = clusterer.size();
+
+    std::mt19937 rng( 2 );
+    std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+    uint32_t missed = 0;
+    for ( int sample = 0; sample < 20000; ++sample ) {
+        const float ndcX = unit( rng ) * 2.0f - 1.0f;
+        const float ndcY = unit( rng ) * 2.0f - 1.0f;
+        const float depth = kNear + ( kFar - kNear ) * unit( rng );
+        const float x = ( ndcX + projection( 0, 2 ) ) * depth / projection( 0, 0 );
+        const float y = ( ndcY + projection( 1, 2 ) ) * depth / projection( 1, 1 );
+
+        const int tileX = std::min( int( ( ndcX * 0.5f + 0.5f ) * size.tilesX ), int( size.tilesX ) - 1 );
+        const int tileY = std::min( int( ( ndcY * 0.5f + 0.5f ) * size.tilesY ), int( size.tilesY ) - 1 );
+        const int slice = std::min( std::max( int( std::log( depth ) * clusterer.sliceScale() + clusterer.sliceBias() ), 0 ),
+                                    int( size.slices ) - 1 );
+        const uint32_t cluster = ( uint32_t( slice ) * size.tilesY + uint32_t( tileY ) ) * size.tilesX + uint32_t( tileX );
+        const uint32_t* first = clusterer.indices().data() + clusterer.grid()[cluster * 2];
+        const uint32_t* last = first + clusterer.grid()[cluster * 2 + 1];
+
+        for ( uint32_t i = 0; i < kBenchmarkLights; ++i ) {
+            const ClusterLight& light = lights[i];
+            const float dx = light.x - x, dy = light.y - y, dz = light.z + depth;
+            // 留一点余量, 切片边界上的浮点误差不算漏检
+            if ( dx * dx + dy * dy + dz * dz > light.radius * light.radius * 0.999f ) continue;
+            if ( std::find( first, last, i ) == last ) ++missed;
+        }
+    }
+    if ( missed > 0 ) {
+        report += std::to_string( missed ) + " lit samples missed their light\n";
+        ok = false;
+    }
+    return ok;
+}
+
+void LightBenchmark::measure() {
+    const std::vector<ClusterLight> lights = randomLights( kBenchmarkLights, 1 );
+    LightClusterer clusterer;
+    clusterer.setProjection( benchmarkProjection(), kNear, kFar );
+    const ClusterGridSize& size = clusterer.size();
+
+    const double scalar = bestOf( [&]() { clusterer.build( lights.data(), kBenchmarkLights, false, false ); } );
+    const double simd = bestOf( [&]() { clusterer.build( lights.data(), kBenchmarkLights, true, false ); } );
+    const double parallel = bestOf( [&]() { clusterer.build( lights.data(), kBenchmarkLights, true, true ); } );
+
+    const ClusterStats& stats = clusterer.stats();
+    std::cout << std::fixed << std::setprecision( 2 );
+    std::cout << kBenchmarkLights << " point lights, " << size.tilesX << "x" << size.tilesY << "x" << size.slices
+              << " clusters, best of " << kBenchmarkRounds << " (ms)\n";
+    std::cout << "  scalar          " << scalar << "\n";
+    std::cout << "  simd            " << simd << " (" << scalar / simd << "x)\n";
+    std::cout << "  simd + jobs     " << parallel << " (" << scalar / parallel << "x)\n";
+    std::cout << "  indices " << stats.indices << ", occupied clusters " << stats.occupiedClusters
+              << ", max per cluster " << stats.maxPerCluster << ", average per occupied cluster "
+              << ( stats.occupiedClusters ? double( stats.indices ) / stats.occupiedClusters : 0.0 )
+              << " (vs " << kBenchmarkLights << " without clustering)\n";
+}
@@ -0,0 +1,12 @@
+// 单一职责: 校验并测量 LightClusterer
+// 校验: SIMD 结果与标量逐项一致; 视锥内随机取点, 照到该点的灯必须出现在它所在的簇里 (与着色器同样的 tile / 切片算法)
+// 测量: 1000 盏点光源, 对比 标量 / SIMD / SIMD + JobPool 的分簇耗时
+#pragma once
+
+#include <string>
+
+class LightBenchmark {
+public:
+    static bool verify( std::string& report );
+    static void measure();
+};
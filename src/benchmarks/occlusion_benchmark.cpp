@@ -0,0 +1,142 @@
+#include "occlusion_benchmark.hpp"
+#include "occlusion_culler.hpp"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr int kGrid = 12;
+constexpr int kOccluders = kGrid * kGrid;      // 最前面一整层
+constexpr int kBenchmarkRounds = 20;
+
+// 与 OpenGLItemRenderer::updateProjectMatrix 相同的相机, 16:9 视口
+QMatrix4x4 benchmarkViewProjection() {
+    QMatrix4x4 projection;
+    projection.perspective( 30.0f, 16.0f / 9.0f, 3.0f, 10.0f );
+    return projection;
+}
+
+// 与 MeshRender 相同的方阵布局, 后面的层被前面的遮挡
+std::vector<QMatrix4x4> cubeGrid( float angle ) {
+    std::vector<QMatrix4x4> models;
+    const float spacing = 2.4f / float( kGrid - 1 );
+    for ( int z = 0; z < kGrid; ++z ) {
+        for ( int y = 0; y < kGrid; ++y ) {
+            for ( int x = 0; x < kGrid; ++x ) {
+                QMatrix4x4 model;
+                model.translate( -1.2f + x * spacing, -1.2f + y * spacing, -5.0f - z * spacing );
+                model.rotate( angle + 15.0f * ( x + y + z ), 0.4f, 1.0f, 0.2f );
+                models.push_back( model );
+            }
+        }
+    }
+    return models;
+}
+
+// 离相机最近的一层立方体作为遮挡体 (方阵按 z 排列, 前面的就是最近的)
+void addOccluders( OcclusionCuller& culler, const std::vector<QMatrix4x4>& models, const MeshData& cube ) {
+    culler.begin( benchmarkViewProjection() );
+    for ( int i = 0; i < kOccluders && i < int( models.size() ); ++i ) {
+        culler.addOccluder( models[i], cube );
+    }
+}
+
+template <typename Fn>
+double bestOf( Fn&& fn ) {
+    double best = std::numeric_limits<double>::max();
+    for ( int round = 0; round < kBenchmarkRounds; ++round ) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        best = std::min( best, timer.nsecsElapsed() / 1.0e6 );
+    }
+    return best;
+}
+
+} // namespace
+
+bool OcclusionBenchmark::verify( std::string& report ) {
+    bool ok = true;
+    const MeshData cube = MeshData::createCube( 0.4f );
+
+    for ( float angle : { 0.0f, 33.0f, 71.0f } ) {
+        const std::vector<QMatrix4x4> models = cubeGrid( angle );
+
+        OcclusionCuller scalar;
+        addOccluders( scalar, models, cube );
+        scalar.rasterize( false, false );
+        OcclusionCuller simd;
+        addOccluders( simd, models, cube );
+        simd.rasterize( true, true );
+        for ( int level = 0; level < scalar.levelCount(); ++level ) {
+            if ( scalar.level( level ) != simd.level( level ) ) {
+                report += "SIMD depth differs from scalar at level " + std::to_string( level ) + "\n";
+                ok = false;
+                break;
+            }
+        }
+
+        // 被剔除的物体逐像素检查第 0 级深度, 不能有任何像素比它远
+        const std::vector<float>& depth = simd.level( 0 );
+        uint32_t wrong = 0;
+        for ( const QMatrix4x4& model : models ) {
+            if ( !simd.isOccluded( model, cube.boundsMin, cube.boundsMax ) ) continue;
+            ScreenBounds bounds;
+            simd.screenBounds( model, cube.boundsMin, cube.boundsMax, bounds );
+            for ( int y = bounds.minY; y <= bounds.maxY; ++y ) {
+                for ( int x = bounds.minX; x <= bounds.maxX; ++x ) {
+                    if ( depth[size_t( y ) * simd.width() + x] >= bounds.minDepth ) ++wrong;
+                }
+            }
+        }
+        if ( wrong > 0 ) {
+            report += std::to_string( wrong ) + " pixels of culled cubes were not covered by occluders\n";
+            ok = false;
+        }
+
+        // 遮挡体自身不能被剔除
+        for ( int i = 0; i < kOccluders; ++i ) {
+            if ( simd.isOccluded( models[i], cube.boundsMin, cube.boundsMax ) ) {
+                report += "an occluder culled itself\n";
+                ok = false;
+                break;
+            }
+        }
+    }
+    return ok;
+}
+
+void OcclusionBenchmark::measure() {
+    const MeshData cube = MeshData::createCube( 0.4f );
+    const std::vector<QMatrix4x4> models = cubeGrid( 33.0f );
+    OcclusionCuller culler;
+
+    const double scalar = bestOf( [&]() { addOccluders( culler, models, cube ); culler.rasterize( false, false ); } );
+    const double simd = bestOf( [&]() { addOccluders( culler, models, cube ); culler.rasterize( true, false ); } );
+    const double parallel = bestOf( [&]() { addOccluders( culler, models, cube ); culler.rasterize( true, true ); } );
+    const double test = bestOf( [&]() {
+        for ( const QMatrix4x4& model : models ) culler.isOccluded( model, cube.boundsMin, cube.boundsMax );
+    } );
+
+    addOccluders( culler, models, cube );
+    culler.rasterize();
+    uint32_t culled = 0;
+    for ( const QMatrix4x4& model : models ) {
+        if ( culler.isOccluded( model, cube.boundsMin, cube.boundsMax ) ) ++culled;
+    }
+
+    const OcclusionStats& stats = culler.stats();
+    std::cout << std::fixed << std::setprecision( 3 );
+    std::cout << models.size() << " cubes, " << stats.occluders << " occluders (" << stats.triangles << " triangles), "
+              << culler.width() << "x" << culler.height() << " depth, best of " << kBenchmarkRounds << " (ms)\n";
+    std::cout << "  rasterize scalar        " << scalar << "\n";
+    std::cout << "  rasterize simd          " << simd << " (" << scalar / simd << "x)\n";
+    std::cout << "  rasterize simd + jobs   " << parallel << " (" << scalar / parallel << "x)\n";
+    std::cout << "  test " << models.size() << " bounds        " << test << "\n";
+    std::cout << "  culled " << culled << " of " << models.size() << " cubes before submission\n";
+}
@@ -0,0 +1,12 @@
+// 单一职责: 校验并测量 OcclusionCuller
+// 校验: SIMD / 多线程光栅化的深度缓冲与标量逐位一致; 每个被剔除的物体, 覆盖范围内第 0 级深度都比它近 (Hi-Z 保守)
+// 测量: 与 CubeRender 相同相机下 12x12x12 个立方体, 对比 标量 / SIMD / SIMD + JobPool 的光栅化耗时和剔除数量
+#pragma once
+
+#include <string>
+
+class OcclusionBenchmark {
+public:
+    static bool verify( std::string& report );
+    static void measure();
+};
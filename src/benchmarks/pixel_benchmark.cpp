@@ -0,0 +1,201 @@
+#include "pixel_benchmark.hpp"
+#include "pixel_convert.hpp"
+
+#include <QElapsedTimer>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr size_t kBenchmarkPixels = 2048 * 2048;
+constexpr int kBenchmarkRounds = 5;
+
+const PixelIsa kSimdIsas[] = { PixelIsa::Sse2, PixelIsa::Avx2, PixelIsa::Neon };
+
+std::vector<uint8_t> randomBytes( size_t count, uint32_t seed ) {
+    std::mt19937 rng( seed );
+    std::vector<uint8_t> bytes( count );
+    for ( uint8_t& b : bytes ) b = uint8_t( rng() );
+    return bytes;
+}
+
+// 覆盖 [-0.25, 1.25] 以及 NaN / 无穷 / 舍入的中点
+std::vector<float> randomLinear( size_t count, uint32_t seed ) {
+    std::mt19937 rng( seed );
+    std::uniform_real_distribution<float> dist( -0.25f, 1.25f );
+    std::vector<float> values( count );
+    for ( float& v : values ) v = dist( rng );
+    const float specials[] = { std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+                               -std::numeric_limits<float>::infinity(), 0.0f, -0.0f, 1.0f,
+                               0.5f / 4095.0f, 1.5f / 4095.0f, 0.5f / 255.0f, 2.5f / 255.0f };
+    for ( size_t i = 0; i < sizeof( specials ) / sizeof( specials[0] ) && i < count; ++i ) {
+        values[i] = specials[i];
+    }
+    return values;
+}
+
+bool sameBytes( const void* a, const void* b, size_t bytes ) {
+    return std::memcmp( a, b, bytes ) == 0;
+}
+
+// 一个指令集的全部内核与标量版本对比, pixels 取不同长度以覆盖尾部
+bool verifyKernels( const PixelKernels& simd, const PixelKernels& scalar, size_t pixels, std::string& report ) {
+    bool ok = true;
+    const std::string suffix = std::string( " (" ) + PixelConvert::name( simd.isa ) + ", " + std::to_string( pixels ) + " px)\n";
+    const auto fail = [&]( const char* kernel ) {
+        report += std::string( kernel ) + " mismatch" + suffix;
+        ok = false;
+    };
+
+    const std::vector<uint8_t> rgba = randomBytes( pixels * 4, uint32_t( pixels ) );
+    const std::vector<float> linear = randomLinear( pixels * 4, uint32_t( pixels ) + 1 );
+
+    {
+        std::vector<float> expected( pixels * 4 ), actual( pixels * 4 );
+        scalar.srgbToLinear( rgba.data(), expected.data(), pixels );
+        simd.srgbToLinear( rgba.data(), actual.data(), pixels );
+        if ( !sameBytes( expected.data(), actual.data(), expected.size() * sizeof( float ) ) ) fail( "srgbToLinear" );
+    }
+    {
+        std::vector<uint8_t> expected( pixels * 4 ), actual( pixels * 4 );
+        scalar.linearToSrgb( linear.data(), expected.data(), pixels );
+        simd.linearToSrgb( linear.data(), actual.data(), pixels );
+        if ( expected != actual ) fail( "linearToSrgb" );
+    }
+    {
+        std::vector<uint8_t> expected = rgba, actual = rgba;
+        scalar.premultiply( expected.data(), pixels );
+        simd.premultiply( actual.data(), pixels );
+        if ( expected != actual ) fail( "premultiply" );
+    }
+    {
+        std::vector<uint8_t> expected( pixels * 4 ), actual = rgba;
+        scalar.swapRedBlue( rgba.data(), expected.data(), pixels );
+        simd.swapRedBlue( actual.data(), actual.data(), pixels );     // 原地交换
+        if ( expected != actual ) fail( "swapRedBlue" );
+    }
+    for ( int channel = 0; channel < 4; ++channel ) {
+        std::vector<uint8_t> expected( pixels ), actual( pixels );
+        scalar.extractChannel( rgba.data(), expected.data(), pixels, channel );
+        simd.extractChannel( rgba.data(), actual.data(), pixels, channel );
+        if ( expected != actual ) fail( "extractChannel" );
+    }
+    {
+        const uint8_t* planes = rgba.data();
+        std::vector<uint8_t> expected( pixels * 4 ), actual( pixels * 4 );
+        scalar.interleave( planes, planes + pixels, planes + pixels * 2, expected.data(), pixels );
+        simd.interleave( planes, planes + pixels, planes + pixels * 2, actual.data(), pixels );
+        if ( expected != actual ) fail( "interleave" );
+    }
+    return ok;
+}
+
+// 重复几轮取最快的一次, 返回毫秒
+template <typename Fn>
+double bestOf( Fn&& fn ) {
+    double best = std::numeric_limits<double>::max();
+    for ( int round = 0; round < kBenchmarkRounds; ++round ) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        best = std::min( best, timer.nsecsElapsed() / 1.0e6 );
+    }
+    return best;
+}
+
+} // namespace
+
+bool PixelBenchmark::verify( std::string& report ) {
+    const PixelKernels& scalar = *PixelConvert::kernels( PixelIsa::Scalar );
+    bool ok = true;
+
+    // 8 位 sRGB 解码再编码必须无损
+    {
+        std::vector<uint8_t> bytes( 256 * 4 ), roundTrip( 256 * 4 );
+        for ( int i = 0; i < 256; ++i ) {
+            bytes[i * 4 + 0] = bytes[i * 4 + 1] = bytes[i * 4 + 2] = bytes[i * 4 + 3] = uint8_t( i );
+        }
+        std::vector<float> linear( 256 * 4 );
+        scalar.srgbToLinear( bytes.data(), linear.data(), 256 );
+        scalar.linearToSrgb( linear.data(), roundTrip.data(), 256 );
+        if ( bytes != roundTrip ) {
+            report += "sRGB round trip is lossy\n";
+            ok = false;
+        }
+    }
+
+    // premultiply 的整数公式必须等于 round( c * a / 255 )
+    for ( int c = 0; c < 256; ++c ) {
+        for ( int a = 0; a < 256; ++a ) {
+            uint8_t pixel[4] = { uint8_t( c ), uint8_t( c ), uint8_t( c ), uint8_t( a ) };
+            scalar.premultiply( pixel, 1 );
+            if ( pixel[0] != uint8_t( std::lround( c * a / 255.0 ) ) || pixel[3] != a ) {
+                report += "premultiply rounding is wrong for c=" + std::to_string( c ) + " a=" + std::to_string( a ) + "\n";
+                ok = false;
+                c = a = 256;
+            }
+        }
+    }
+
+    for ( PixelIsa isa : kSimdIsas ) {
+        const PixelKernels* simd = PixelConvert::kernels( isa );
+        if ( !simd ) continue;
+        for ( size_t pixels : { size_t( 0 ), size_t( 1 ), size_t( 3 ), size_t( 17 ), size_t( 63 ), size_t( 1000 ), size_t( 4099 ) } ) {
+            ok = verifyKernels( *simd, scalar, pixels, report ) && ok;
+        }
+    }
+    return ok;
+}
+
+void PixelBenchmark::measure() {
+    std::cout << "Pixel kernels: best = " << PixelConvert::name( PixelConvert::kernels().isa ) << "\n";
+
+    const size_t pixels = kBenchmarkPixels;
+    const std::vector<uint8_t> rgba = randomBytes( pixels * 4, 1 );
+    std::vector<uint8_t> bytes( pixels * 4 );
+    std::vector<float> linear( pixels * 4 );
+    PixelConvert::kernels( PixelIsa::Scalar )->srgbToLinear( rgba.data(), linear.data(), pixels );
+
+    struct Timing {
+        const char* kernel;
+        double ms[4] = { 0.0, 0.0, 0.0, 0.0 };      // 按 PixelIsa 下标
+    };
+    Timing timings[] = { { "srgbToLinear" }, { "linearToSrgb" }, { "premultiply" },
+                         { "swapRedBlue" }, { "extractChannel" }, { "interleave" } };
+
+    const PixelIsa isas[] = { PixelIsa::Scalar, PixelIsa::Sse2, PixelIsa::Avx2, PixelIsa::Neon };
+    for ( PixelIsa isa : isas ) {
+        const PixelKernels* k = PixelConvert::kernels( isa );
+        if ( !k ) continue;
+        const int column = int( isa );
+        timings[0].ms[column] = bestOf( [&]() { k->srgbToLinear( rgba.data(), linear.data(), pixels ); } );
+        timings[1].ms[column] = bestOf( [&]() { k->linearToSrgb( linear.data(), bytes.data(), pixels ); } );
+        timings[2].ms[column] = bestOf( [&]() {
+            std::memcpy( bytes.data(), rgba.data(), rgba.size() );
+            k->premultiply( bytes.data(), pixels );
+        } );
+        timings[3].ms[column] = bestOf( [&]() { k->swapRedBlue( rgba.data(), bytes.data(), pixels ); } );
+        timings[4].ms[column] = bestOf( [&]() { k->extractChannel( rgba.data(), bytes.data(), pixels, 1 ); } );
+        timings[5].ms[column] = bestOf( [&]() {
+            k->interleave( rgba.data(), rgba.data() + pixels, rgba.data() + pixels * 2, bytes.data(), pixels );
+        } );
+    }
+
+    std::cout << "2048x2048, best of " << kBenchmarkRounds << " (ms, speedup vs scalar)\n";
+    std::cout << std::fixed << std::setprecision( 2 );
+    for ( const Timing& timing : timings ) {
+        std::cout << "  " << std::left << std::setw( 16 ) << timing.kernel << std::right
+                  << PixelConvert::name( PixelIsa::Scalar ) << " " << timing.ms[0];
+        for ( PixelIsa isa : kSimdIsas ) {
+            const double ms = timing.ms[int( isa )];
+            if ( ms <= 0.0 ) continue;
+            std::cout << "  " << PixelConvert::name( isa ) << " " << ms << " (" << timing.ms[0] / ms << "x)";
+        }
+        std::cout << "\n";
+    }
+}
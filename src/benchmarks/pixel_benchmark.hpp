@@ -0,0 +1,12 @@
+// 单一职责: 校验并测量 PixelConvert 各指令集内核
+// 校验: 每个 SIMD 内核在随机数据 / 边界值 / 各种尾部长度上必须与标量版本逐字节一致
+// 测量: 在 2048x2048 的图像上对比标量版本的耗时
+#pragma once
+
+#include <string>
+
+class PixelBenchmark {
+public:
+    static bool verify( std::string& report );
+    static void measure();
+};
@@ -0,0 +1,155 @@
+#include "plot_benchmark.hpp"
+#include "time_series.hpp"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr size_t kSamples = 20000000;
+constexpr size_t kBatch = 4096;
+constexpr int kColumns = 1920;
+constexpr int kBenchmarkRounds = 20;
+
+template <typename Fn>
+double bestOf( Fn&& fn ) {
+    double best = std::numeric_limits<double>::max();
+    for ( int round = 0; round < kBenchmarkRounds; ++round ) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        best = std::min( best, timer.nsecsElapsed() / 1.0e6 );
+    }
+    return best;
+}
+
+// 随机游走叠加偶发尖峰, 尖峰用来检查抽取不会丢掉极值
+std::vector<float> telemetry( size_t count, uint32_t seed ) {
+    std::mt19937 random( seed );
+    std::normal_distribution<float> step( 0.0f, 1.0f );
+    std::uniform_int_distribution<int> spike( 0, 9999 );
+    std::vector<float> samples( count );
+    float value = 0.0f;
+    for ( size_t i = 0; i < count; ++i ) {
+        value += step( random );
+        samples[i] = spike( random ) == 0 ? value + 500.0f : value;
+    }
+    return samples;
+}
+
+TimeSeries::Summary bruteForce( const TimeSeries& series, uint64_t first, uint64_t last ) {
+    TimeSeries::Summary summary;
+    for ( uint64_t i = std::max( first, series.begin() ); i < std::min( last, series.end() ); ++i ) {
+        summary.min = std::min( summary.min, series.at( i ) );
+        summary.max = std::max( summary.max, series.at( i ) );
+    }
+    return summary;
+}
+
+} // namespace
+
+bool PlotBenchmark::verify( std::string& report ) {
+    bool ok = true;
+    // 容量不是 16 的幂, 块与缓冲边界不对齐
+    TimeSeries series( 100000 );
+    const std::vector<float> samples = telemetry( 1000000, 7 );
+    std::mt19937 random( 11 );
+    size_t appended = 0;
+    uint32_t checks = 0;
+    uint32_t wrong = 0;
+    while ( appended < samples.size() ) {
+        // 批量大小从单个样本到超过容量都有
+        const size_t batch = std::min( samples.size() - appended, size_t( std::uniform_int_distribution<int>( 0, 3 )( random ) == 0
+                                                                              ? 1 + random() % 150000
+                                                                              : 1 + random() % 3000 ) );
+        series.append( samples.data() + appended, batch );
+        appended += batch;
+
+        for ( int query = 0; query < 8; ++query ) {
+            const uint64_t a = series.begin() + random() % ( series.size() + 1 );
+            const uint64_t b = series.begin() + random() % ( series.size() + 1 );
+            const uint64_t first = std::min( a, b );
+            const uint64_t last = std::max( a, b ) + 1;
+            const TimeSeries::Summary expected = bruteForce( series, first, last );
+            for ( bool simd : { false, true } ) {
+                const TimeSeries::Summary summary = series.summarize( first, last, simd );
+                ++checks;
+                if ( summary.min != expected.min || summary.max != expected.max ) ++wrong;
+            }
+        }
+    }
+    if ( wrong > 0 ) {
+        report += std::to_string( wrong ) + " of " + std::to_string( checks ) + " range summaries differ from a full scan\n";
+        ok = false;
+    }
+
+    // 逐列抽取: 每列的 min/max 与首尾样本
+    std::vector<TimeSeries::Column> columns( kColumns );
+    const double samplesPerColumn = double( series.size() ) / kColumns;
+    series.columns( double( series.begin() ), samplesPerColumn, kColumns, columns.data() );
+    uint32_t wrongColumns = 0;
+    for ( int i = 0; i < kColumns; ++i ) {
+        const uint64_t from = series.begin() + uint64_t( std::floor( i * samplesPerColumn ) );
+        const uint64_t to = series.begin() + uint64_t( std::floor( ( i + 1 ) * samplesPerColumn ) );
+        const TimeSeries::Summary expected = bruteForce( series, from, to );
+        const TimeSeries::Column& column = columns[i];
+        if ( !column.valid || column.min != expected.min || column.max != expected.max || column.first != series.at( from ) ||
+             column.last != series.at( to - 1 ) ) {
+            ++wrongColumns;
+        }
+    }
+    if ( wrongColumns > 0 ) {
+        report += std::to_string( wrongColumns ) + " columns differ from a full scan\n";
+        ok = false;
+    }
+    return ok;
+}
+
+void PlotBenchmark::measure() {
+    const std::vector<float> samples = telemetry( kSamples, 3 );
+    TimeSeries series( kSamples );
+    QElapsedTimer timer;
+    timer.start();
+    for ( size_t i = 0; i < kSamples; i += kBatch ) {
+        series.append( samples.data() + i, std::min( kBatch, kSamples - i ) );
+    }
+    const double append = timer.nsecsElapsed() / 1.0e6;
+
+    const double fullScan = bestOf( [&]() {
+        TimeSeries::Summary summary;
+        for ( size_t i = 0; i < kSamples; ++i ) {
+            summary.min = std::min( summary.min, samples[i] );
+            summary.max = std::max( summary.max, samples[i] );
+        }
+        volatile float sink = summary.min + summary.max;     // 防止整个循环被优化掉
+        (void)sink;
+    } );
+
+    std::cout << std::fixed << std::setprecision( 3 );
+    std::cout << kSamples << " samples, " << series.levelCount() << " summary levels, "
+              << series.memoryBytes() / ( 1024 * 1024 ) << " MiB, best of " << kBenchmarkRounds << " (ms)\n";
+    std::cout << "  append in batches of " << kBatch << "  " << append << " (" << kSamples / append / 1000.0 << " M samples/s)\n";
+    std::cout << "  full scan min/max          " << fullScan << "\n";
+
+    std::vector<TimeSeries::Column> columns( kColumns );
+    std::vector<float> selected( kColumns );
+    for ( double zoom : { 1.0, 0.01, 0.0001 } ) {
+        const double length = kSamples * zoom;
+        const double start = ( kSamples - length ) * 0.5;
+        const double samplesPerColumn = length / kColumns;
+        const double scalar = bestOf( [&]() { series.columns( start, samplesPerColumn, kColumns, columns.data(), false ); } );
+        const double simd = bestOf( [&]() { series.columns( start, samplesPerColumn, kColumns, columns.data(), true ); } );
+        const double lttb = bestOf( [&]() { TimeSeries::largestTriangle( columns.data(), kColumns, selected.data() ); } );
+        std::cout << "  " << kColumns << " columns at " << std::setprecision( 2 ) << zoom * 100.0 << "% (" << samplesPerColumn
+                  << " samples/column)\n" << std::setprecision( 3 );
+        std::cout << "    min/max scalar           " << scalar << "\n";
+        std::cout << "    min/max simd             " << simd << " (" << scalar / simd << "x)\n";
+        std::cout << "    lttb selection           " << lttb << "\n";
+    }
+}
@@ -0,0 +1,33 @@
+// ctest 每个套件调用一次: selfTests <套件名>; 不带参数时依次运行全部套件
+// 只做校验, 不测量, 返回值即测试结果
+#include "benchmark_suite.hpp"
+
+#include <iostream>
+
+namespace {
+
+bool verifySuite( const BenchmarkSuite& suite ) {
+    std::string report;
+    const bool ok = suite.verify( report );
+    std::cout << suite.name << ": " << ( ok ? "passed" : "FAILED" ) << "\n" << report;
+    return ok;
+}
+
+} // namespace
+
+int main( int argc, char* argv[] ) {
+    bool ok = true;
+    if ( argc < 2 ) {
+        for ( const BenchmarkSuite& suite : benchmarkSuites() ) ok = verifySuite( suite ) && ok;
+        return ok ? 0 : 1;
+    }
+    for ( int i = 1; i < argc; ++i ) {
+        const BenchmarkSuite* suite = findBenchmarkSuite( argv[i] );
+        if ( !suite ) {
+            std::cout << "unknown suite: " << argv[i] << "\n";
+            return 1;
+        }
+        ok = verifySuite( *suite ) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include "startup_benchmark.hpp"
+#include "startup_profiler.hpp"
+
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kDefaultRuns = 10;
+constexpr int kTimeoutMs = 60000;
+
+struct PhaseSamples {
+    int order = 0;                  // 第一次出现的顺序, 打印时按启动顺序排列
+    std::vector<double> cumulative; // 每次运行的累计毫秒
+};
+
+// 跑一次子进程, 解析 "STARTUP <阶段>\t<累计纳秒>"; 有一行解析不了就整次作废
+bool runOnce( const char* program, bool cold, std::map<std::string, PhaseSamples>& phases ) {
+    QProcess child;
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    if ( cold ) environment.insert( "QML_DISABLE_DISK_CACHE", "1" );
+    child.setProcessEnvironment( environment );
+    child.setProcessChannelMode( QProcess::ForwardedErrorChannel );
+    child.start( QString::fromLocal8Bit( program ), { "--startup-once" } );
+    if ( !child.waitForFinished( kTimeoutMs ) || child.exitStatus() != QProcess::NormalExit || child.exitCode() != 0 ) {
+        std::cout << "startup run failed: " << child.errorString().toStdString() << std::endl;
+        child.kill();
+        return false;
+    }
+
+    bool sawFrame = false;      // 超时收尾的运行没有完整帧, 不能算进统计
+    const QStringList lines = QString::fromUtf8( child.readAllStandardOutput() ).split( '\n' );
+    for ( const QString& line : lines ) {
+        if ( !line.startsWith( "STARTUP " ) ) continue;
+        const QStringList fields = line.mid( 8 ).split( '\t' );
+        bool ok = fields.size() == 2;
+        const qlonglong nsecs = ok ? fields[1].trimmed().toLongLong( &ok ) : 0;
+        if ( !ok ) {
+            std::cout << "startup run printed a malformed line: " << line.toStdString() << std::endl;
+            return false;
+        }
+        PhaseSamples& samples = phases[fields[0].toStdString()];
+        if ( samples.cumulative.empty() ) samples.order = int( phases.size() );
+        samples.cumulative.push_back( nsecs / 1e6 );
+        if ( fields[0] == StartupPhase::kFirstCompleteFrame ) sawFrame = true;
+    }
+    if ( !sawFrame ) std::cout << "startup run never swapped a complete frame" << std::endl;
+    return sawFrame;
+}
+
+double median( std::vector<double> values ) {
+    std::sort( values.begin(), values.end() );
+    const size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : ( values[mid - 1] + values[mid] ) / 2;
+}
+
+} // namespace
+
+int StartupBenchmark::run( const char* program, int argc, char* argv[] ) {
+    const bool cold = argc > 0 && std::strcmp( argv[0], "cold" ) == 0;
+    const int runs = argc > 1 ? std::max( 1, std::atoi( argv[1] ) ) : kDefaultRuns;
+
+    std::map<std::string, PhaseSamples> phases;
+    if ( !cold ) {
+        std::map<std::string, PhaseSamples> warmup;
+        if ( !runOnce( program, false, warmup ) ) return 1;
+    }
+    for ( int i = 0; i < runs; ++i ) {
+        if ( !runOnce( program, cold, phases ) ) return 1;
+    }
+
+    std::vector<std::pair<std::string, PhaseSamples>> ordered( phases.begin(), phases.end() );
+    std::sort( ordered.begin(), ordered.end(), []( const auto& a, const auto& b ) { return a.second.order < b.second.order; } );
+
+    std::cout << ( cold ? "cold" : "warm" ) << " start, " << runs << " runs (ms): phase, cumulative median, cumulative min" << std::endl;
+    std::cout << std::fixed << std::setprecision( 2 );
+    double previous = 0.0;
+    for ( const auto& [phase, samples] : ordered ) {
+        const double total = median( samples.cumulative );
+        std::cout << "  " << std::left << std::setw( 26 ) << phase << std::right
+                  << std::setw( 9 ) << total - previous
+                  << std::setw( 10 ) << total
+                  << std::setw( 10 ) << *std::min_element( samples.cumulative.begin(), samples.cumulative.end() )
+                  << "   (" << samples.cumulative.size() << " samples)" << std::endl;
+        previous = total;
+    }
+    return 0;
+}
@@ -0,0 +1,12 @@
+// 单一职责: 反复启动界面程序直到第一个完整帧, 统计 StartupProfiler 各阶段耗时
+// 子进程带 --startup-once 运行, 第一帧后把时间点打到标准输出并退出
+// cold: 子进程关闭 QML 磁盘缓存, 每次都重新编译 QML (操作系统的文件缓存在用户态清不掉, 不在冷启动的范围内)
+// warm: 先跑一次预热, 让 QML 磁盘缓存和文件缓存就绪, 之后的每次都计入
+// 通过 benchmarks startup [cold|warm] [次数] 运行, 界面程序本身是 WIN32 程序, 没有控制台输出
+#pragma once
+
+class StartupBenchmark {
+public:
+    // program 为界面程序的路径, arguments 为 startup 之后的参数; 返回进程退出码
+    static int run( const char* program, int argc, char* argv[] );
+};
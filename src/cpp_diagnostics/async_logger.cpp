@@ -0,0 +1,344 @@
+#include "async_logger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace AsyncLog {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kCapacity = size_t( 1 ) << 18;    // 每个线程 256KB
+constexpr uint32_t kPaddingFlag = 0x80000000u;      // 缓冲尾部放不下时的填充记录
+constexpr auto kFlushInterval = std::chrono::milliseconds( 5 );
+
+struct RecordHeader {
+    uint32_t size;          // 整条记录的字节数 (含记录头), 按 8 字节对齐
+    uint32_t payloadSize;
+    int64_t nsecs;          // 相对日志启动
+    const char* format;
+    uint8_t level;
+    uint8_t truncated;
+};
+
+size_t align8( size_t size ) {
+    return ( size + 7 ) & ~size_t( 7 );
+}
+
+// 单生产者 (所属线程) 单消费者 (持有 drain 锁的线程) 的字节环; head / tail 单调递增, 取模得到偏移
+struct ThreadBuffer {
+    alignas( 64 ) std::atomic<size_t> head { 0 };
+    alignas( 64 ) std::atomic<size_t> tail { 0 };
+    std::atomic<uint64_t> dropped { 0 };
+    std::atomic<bool> retired { false };   // 线程已退出, 排空后释放
+    uint32_t threadIndex = 0;
+    alignas( 8 ) uint8_t data[kCapacity];
+};
+
+class Logger {
+public:
+    static Logger& instance() {
+        // 故意不析构: 其他静态对象析构时仍可能写日志, 退出时由 atexit 排空并停止后台线程
+        static Logger* logger = new Logger;
+        return *logger;
+    }
+
+    ThreadBuffer* registerThread() {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock( m_buffersMutex );
+        buffer->threadIndex = m_nextThreadIndex++;
+        m_buffers.push_back( std::move( buffer ) );
+        return m_buffers.back().get();
+    }
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - m_start ).count();
+    }
+
+    void drain();
+    void stop();
+
+    bool running() const { return m_running.load( std::memory_order_acquire ); }
+
+    uint64_t dropped() {
+        std::lock_guard<std::mutex> lock( m_buffersMutex );
+        uint64_t total = m_droppedRetired;
+        for ( const auto& buffer : m_buffers ) total += buffer->dropped.load( std::memory_order_relaxed );
+        return total;
+    }
+
+private:
+    Logger()
+        : m_start( Clock::now() )
+        , m_flusher( [this]() { run(); } )
+    {
+        std::atexit( []() { Logger::instance().stop(); } );
+    }
+
+    void run() {
+        while ( m_running.load( std::memory_order_relaxed ) ) {
+            std::this_thread::sleep_for( kFlushInterval );
+            drain();
+        }
+    }
+
+    void consume( ThreadBuffer& buffer, std::vector<std::pair<int64_t, std::string>>& lines );
+
+    const Clock::time_point m_start;
+    std::atomic<bool> m_running { true };
+    std::mutex m_buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    uint32_t m_nextThreadIndex = 0;
+    uint64_t m_droppedRetired = 0;
+    uint64_t m_droppedReported = 0;
+    std::mutex m_drainMutex;    // 同一时间只有一个消费者: 后台线程或 flush() 的调用者
+    std::thread m_flusher;
+};
+
+// 写入路径只读这几个平凡析构的 thread_local, 线程退出阶段 (其他 thread_local 和静态对象析构时) 仍然有效
+thread_local ThreadBuffer* t_buffer = nullptr;
+thread_local bool t_retired = false;
+thread_local uint32_t t_threadIndex = 0;
+
+// 线程退出时标记缓冲, 之后由后台线程排空并释放; 这里同时清掉指针, 之后的日志改为同步写出
+struct ThreadRetirer {
+    bool armed = false;
+    ~ThreadRetirer() {
+        if ( t_buffer ) t_buffer->retired.store( true, std::memory_order_release );
+        t_buffer = nullptr;
+        t_retired = true;
+    }
+};
+
+thread_local ThreadRetirer t_retirer;
+
+void appendArgument( std::string& out, const uint8_t*& cursor, const uint8_t* end ) {
+    const detail::Tag tag = detail::Tag( *cursor++ );
+    char text[32];
+    switch ( tag ) {
+    case detail::Tag::Int: {
+        int64_t value;
+        std::memcpy( &value, cursor, sizeof( value ) );
+        cursor += sizeof( value );
+        std::snprintf( text, sizeof( text ), "%" PRId64, value );
+        out += text;
+        break;
+    }
+    case detail::Tag::UInt: {
+        uint64_t value;
+        std::memcpy( &value, cursor, sizeof( value ) );
+        cursor += sizeof( value );
+        std::snprintf( text, sizeof( text ), "%" PRIu64, value );
+        out += text;
+        break;
+    }
+    case detail::Tag::Double: {
+        double value;
+        std::memcpy( &value, cursor, sizeof( value ) );
+        cursor += sizeof( value );
+        std::snprintf( text, sizeof( text ), "%g", value );
+        out += text;
+        break;
+    }
+    case detail::Tag::Bool:
+        out += *cursor++ ? "true" : "false";
+        break;
+    case detail::Tag::Char:
+        out += char( *cursor++ );
+        break;
+    case detail::Tag::String: {
+        uint32_t length;
+        std::memcpy( &length, cursor, sizeof( length ) );
+        cursor += sizeof( length );
+        out.append( reinterpret_cast<const char*>( cursor ), length );
+        cursor += length;
+        break;
+    }
+    case detail::Tag::Pointer: {
+        uintptr_t address;
+        std::memcpy( &address, cursor, sizeof( address ) );
+        cursor += sizeof( address );
+        std::snprintf( text, sizeof( text ), "0x%" PRIxPTR, address );
+        out += text;
+        break;
+    }
+    default:
+        cursor = end;
+        break;
+    }
+}
+
+// "[   1.234567] [D] [T2] 消息"
+std::string formatRecord( const RecordHeader& header, const uint8_t* payload, uint32_t threadIndex ) {
+    static const char kLevels[] = { 'T', 'D', 'I', 'W', 'E' };
+    char prefix[64];
+    std::snprintf( prefix, sizeof( prefix ), "[%12.6f] [%c] [T%u] ", double( header.nsecs ) / 1e9,
+                   kLevels[header.level < 5 ? header.level : 4], threadIndex );
+    std::string line = prefix;
+
+    const uint8_t* cursor = payload;
+    const uint8_t* end = payload + header.payloadSize;
+    for ( const char* c = header.format; *c; ++c ) {
+        if ( c[0] == '{' && c[1] == '{' ) {
+            line += '{';
+            ++c;
+        } else if ( c[0] == '}' && c[1] == '}' ) {
+            line += '}';
+            ++c;
+        } else if ( c[0] == '{' && c[1] == '}' && cursor < end ) {
+            appendArgument( line, cursor, end );
+            ++c;
+        } else {
+            line += *c;
+        }
+    }
+    if ( header.truncated ) line += " ...";
+    line += '\n';
+    return line;
+}
+
+void Logger::consume( ThreadBuffer& buffer, std::vector<std::pair<int64_t, std::string>>& lines ) {
+    size_t tail = buffer.tail.load( std::memory_order_relaxed );
+    const size_t head = buffer.head.load( std::memory_order_acquire );
+    while ( tail != head ) {
+        const uint8_t* record = buffer.data + tail % kCapacity;
+        uint32_t size;
+        std::memcpy( &size, record, sizeof( size ) );
+        if ( size & kPaddingFlag ) {
+            tail += size & ~kPaddingFlag;
+            continue;
+        }
+        RecordHeader header;
+        std::memcpy( &header, record, sizeof( header ) );
+        lines.emplace_back( header.nsecs, formatRecord( header, record + sizeof( header ), buffer.threadIndex ) );
+        tail += size;
+    }
+    buffer.tail.store( tail, std::memory_order_release );
+}
+
+void Logger::drain() {
+    std::lock_guard<std::mutex> drainLock( m_drainMutex );
+
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock( m_buffersMutex );
+        for ( const auto& buffer : m_buffers ) buffers.push_back( buffer.get() );
+    }
+
+    std::vector<std::pair<int64_t, std::string>> lines;
+    std::vector<ThreadBuffer*> finished;
+    for ( ThreadBuffer* buffer : buffers ) {
+        // 先读退出标记再排空: 标记之后线程不会再写, 排空后可以释放
+        const bool retired = buffer->retired.load( std::memory_order_acquire );
+        consume( *buffer, lines );
+        if ( retired ) finished.push_back( buffer );
+    }
+
+    if ( !finished.empty() ) {
+        std::lock_guard<std::mutex> lock( m_buffersMutex );
+        for ( ThreadBuffer* buffer : finished ) {
+            m_droppedRetired += buffer->dropped.load( std::memory_order_relaxed );
+            m_buffers.erase( std::find_if( m_buffers.begin(), m_buffers.end(),
+                                           [buffer]( const auto& owned ) { return owned.get() == buffer; } ) );
+        }
+    }
+
+    const uint64_t droppedNow = dropped();
+    if ( droppedNow != m_droppedReported ) {
+        char text[96];
+        std::snprintf( text, sizeof( text ), "[%12.6f] [W] [log] %" PRIu64 " records dropped, buffer full\n",
+                       double( now() ) / 1e9, droppedNow - m_droppedReported );
+        lines.emplace_back( now(), text );
+        m_droppedReported = droppedNow;
+    }
+    if ( lines.empty() ) return;
+
+    // 各线程内部有序, 合并成全局时间顺序
+    std::stable_sort( lines.begin(), lines.end(), []( const auto& a, const auto& b ) { return a.first < b.first; } );
+    std::string batch;
+    for ( const auto& line : lines ) batch += line.second;
+    std::fwrite( batch.data(), 1, batch.size(), stderr );
+    std::fflush( stderr );
+}
+
+void Logger::stop() {
+    if ( m_running.exchange( false, std::memory_order_acq_rel ) && m_flusher.joinable() ) m_flusher.join();
+    drain();
+}
+
+} // namespace
+
+void detail::Encoder::copy( const void* data, size_t size ) {
+    std::memcpy( m_data + m_size, data, size );
+    m_size += size;
+}
+
+void detail::submit( Level level, const char* format, const Encoder& encoder ) {
+    Logger& logger = Logger::instance();
+
+    RecordHeader header;
+    header.size = uint32_t( align8( sizeof( RecordHeader ) + encoder.size() ) );
+    header.payloadSize = uint32_t( encoder.size() );
+    header.nsecs = logger.now();
+    header.format = format;
+    header.level = uint8_t( level );
+    header.truncated = encoder.truncated();
+
+    // 线程已经退出 (缓冲可能已释放) 或后台线程已经停止: 直接同步写出, 不再进环形缓冲
+    if ( t_retired || !logger.running() ) {
+        const std::string line = formatRecord( header, encoder.data(), t_threadIndex );
+        std::fwrite( line.data(), 1, line.size(), stderr );
+        std::fflush( stderr );
+        return;
+    }
+
+    ThreadBuffer* buffer = t_buffer;
+    if ( !buffer ) {
+        buffer = t_buffer = logger.registerThread();
+        t_threadIndex = buffer->threadIndex;
+        t_retirer.armed = true;     // 触发构造, 线程退出时才会析构
+    }
+
+    const size_t size = header.size;
+    size_t head = buffer->head.load( std::memory_order_relaxed );
+    const size_t tail = buffer->tail.load( std::memory_order_acquire );
+    const size_t offset = head % kCapacity;
+    const size_t padding = kCapacity - offset < size ? kCapacity - offset : 0;
+    if ( kCapacity - ( head - tail ) < padding + size ) {
+        buffer->dropped.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+    if ( padding ) {
+        const uint32_t marker = uint32_t( padding ) | kPaddingFlag;
+        std::memcpy( buffer->data + offset, &marker, sizeof( marker ) );
+        head += padding;
+    }
+
+    uint8_t* record = buffer->data + head % kCapacity;
+    std::memcpy( record, &header, sizeof( header ) );
+    std::memcpy( record + sizeof( header ), encoder.data(), encoder.size() );
+    buffer->head.store( head + size, std::memory_order_release );
+
+    // 检查之后 stop() 才把后台线程停掉时, 这条记录不会再有人排空, 自己排一次
+    if ( !logger.running() ) logger.drain();
+}
+
+void flush() {
+    Logger::instance().drain();
+}
+
+uint64_t droppedCount() {
+    return Logger::instance().dropped();
+}
+
+} // namespace AsyncLog
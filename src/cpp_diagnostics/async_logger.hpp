@@ -0,0 +1,154 @@
+// 单一职责: 异步日志, 调用线程只把参数按值编码进本线程的无锁环形缓冲, 格式化和 I/O 都在后台线程
+// 级别在编译期过滤: 低于 LOG_MIN_LEVEL 的宏展开为空语句, 参数不会求值
+// 格式串用 {} 占位, 必须是字符串字面量 (记录里只存指针); 参数支持算术类型, 枚举, 指针和字符串 (按值拷贝)
+// 缓冲满时丢弃新记录并计数, 调用线程从不等待; 后台线程按时间戳合并各线程的记录后一次写出
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF 5
+
+// 由构建系统统一指定 (见 src/cpp_diagnostics/CMakelists.txt), 单独使用头文件时按构建类型取默认值
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+namespace AsyncLog {
+
+enum class Level : uint8_t { Trace, Debug, Info, Warn, Error };
+
+namespace detail {
+
+enum class Tag : uint8_t { Int, UInt, Double, Bool, Char, String, Pointer };
+
+// 参数在栈上编码, 再整条拷进环形缓冲; 超出 kMaxPayload 的参数被截断
+class Encoder {
+public:
+    static constexpr size_t kMaxPayload = 1024;
+
+    void put( Tag tag, const void* data, size_t size ) {
+        if ( m_size + 1 + size > kMaxPayload ) {
+            m_truncated = true;
+            return;
+        }
+        m_data[m_size++] = uint8_t( tag );
+        copy( data, size );
+    }
+
+    void putString( std::string_view text ) {
+        const size_t room = m_size + 1 + sizeof( uint32_t ) <= kMaxPayload ? kMaxPayload - m_size - 1 - sizeof( uint32_t ) : 0;
+        if ( room == 0 ) {
+            m_truncated = true;
+            return;
+        }
+        const uint32_t length = uint32_t( text.size() < room ? text.size() : room );
+        m_truncated = m_truncated || length < text.size();
+        m_data[m_size++] = uint8_t( Tag::String );
+        copy( &length, sizeof( length ) );
+        copy( text.data(), length );
+    }
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool truncated() const { return m_truncated; }
+
+private:
+    void copy( const void* data, size_t size );
+
+    uint8_t m_data[kMaxPayload];
+    size_t m_size = 0;
+    bool m_truncated = false;
+};
+
+inline void encode( Encoder& encoder, bool value ) { encoder.put( Tag::Bool, &value, sizeof( value ) ); }
+inline void encode( Encoder& encoder, char value ) { encoder.put( Tag::Char, &value, sizeof( value ) ); }
+inline void encode( Encoder& encoder, const char* value ) { encoder.putString( value ? value : "(null)" ); }
+inline void encode( Encoder& encoder, std::string_view value ) { encoder.putString( value ); }
+inline void encode( Encoder& encoder, const std::string& value ) { encoder.putString( value ); }
+
+template<typename T>
+void encode( Encoder& encoder, const T& value ) {
+    // char* 和 char 数组会精确匹配到这个模板而不是上面的 const char* 重载, 按字符串记录, 不当作指针地址
+    if constexpr ( std::is_same_v<std::decay_t<T>, char*> || std::is_same_v<std::decay_t<T>, const char*> ) {
+        encode( encoder, static_cast<const char*>( value ) );
+    } else if constexpr ( std::is_enum_v<T> ) {
+        encode( encoder, static_cast<std::underlying_type_t<T>>( value ) );
+    } else if constexpr ( std::is_integral_v<T> && std::is_signed_v<T> ) {
+        const int64_t wide = value;
+        encoder.put( Tag::Int, &wide, sizeof( wide ) );
+    } else if constexpr ( std::is_integral_v<T> ) {
+        const uint64_t wide = value;
+        encoder.put( Tag::UInt, &wide, sizeof( wide ) );
+    } else if constexpr ( std::is_floating_point_v<T> ) {
+        const double wide = value;
+        encoder.put( Tag::Double, &wide, sizeof( wide ) );
+    } else if constexpr ( std::is_pointer_v<T> ) {
+        const uintptr_t address = reinterpret_cast<uintptr_t>( value );
+        encoder.put( Tag::Pointer, &address, sizeof( address ) );
+    } else {
+        static_assert( std::is_arithmetic_v<T>, "AsyncLog: unsupported argument type, convert it to a number or string first" );
+    }
+}
+
+// 写进当前线程的缓冲, 缓冲满时丢弃
+void submit( Level level, const char* format, const Encoder& encoder );
+
+} // namespace detail
+
+template<typename... Args>
+void write( Level level, const char* format, const Args&... args ) {
+    detail::Encoder encoder;
+    ( detail::encode( encoder, args ), ... );
+    detail::submit( level, format, encoder );
+}
+
+// 同步写出所有线程缓冲中的记录; 崩溃处理和退出前使用, 热路径不要调用
+void flush();
+
+// 因缓冲满被丢弃的记录数
+uint64_t droppedCount();
+
+} // namespace AsyncLog
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE( ... ) ::AsyncLog::write( ::AsyncLog::Level::Trace, __VA_ARGS__ )
+#else
+#define LOG_TRACE( ... ) ( (void)0 )
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG( ... ) ::AsyncLog::write( ::AsyncLog::Level::Debug, __VA_ARGS__ )
+#else
+#define LOG_DEBUG( ... ) ( (void)0 )
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO( ... ) ::AsyncLog::write( ::AsyncLog::Level::Info, __VA_ARGS__ )
+#else
+#define LOG_INFO( ... ) ( (void)0 )
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN( ... ) ::AsyncLog::write( ::AsyncLog::Level::Warn, __VA_ARGS__ )
+#else
+#define LOG_WARN( ... ) ( (void)0 )
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR( ... ) ::AsyncLog::write( ::AsyncLog::Level::Error, __VA_ARGS__ )
+#else
+#define LOG_ERROR( ... ) ( (void)0 )
+#endif
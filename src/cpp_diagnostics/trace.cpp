@@ -0,0 +1,218 @@
+#include "trace.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Trace {
+
+std::atomic<bool> detail::g_enabled { false };
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kChunkEvents = 4096;
+constexpr size_t kMaxChunks = 256;      // 每个线程最多约一百万个事件, 之后丢弃并计数
+
+struct Event {
+    const char* name;
+    int64_t timestamp;      // 纳秒, 相对进程内第一次取时间
+    int64_t duration;
+    double value;
+    uint64_t id;
+    char phase;
+};
+
+// 只有所属线程写入: 先写事件, 再以 release 发布 count; 块指针在发布之前写好, 导出时按 count 读取
+struct ThreadEvents {
+    std::atomic<Event*> chunks[kMaxChunks] {};
+    std::atomic<size_t> count { 0 };
+    std::atomic<uint64_t> dropped { 0 };
+    std::atomic<const char*> name { nullptr };
+    uint32_t threadIndex = 0;
+
+    ~ThreadEvents() {
+        for ( auto& chunk : chunks ) delete[] chunk.load( std::memory_order_relaxed );
+    }
+};
+
+const Clock::time_point s_epoch = Clock::now();
+
+// 线程退出后缓冲保留, 事件要导出; 故意不析构, 退出阶段仍在运行的线程可能还在写
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadEvents>> threads;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+// 线程名先记在这里, 第一次写事件注册缓冲时才带进注册表; 不追踪的线程不分配任何东西
+thread_local const char* t_threadName = nullptr;
+thread_local ThreadEvents* t_events = nullptr;
+
+ThreadEvents& currentThread() {
+    if ( !t_events ) {
+        auto owned = std::make_unique<ThreadEvents>();
+        owned->name.store( t_threadName, std::memory_order_relaxed );
+        Registry& all = registry();
+        std::lock_guard<std::mutex> lock( all.mutex );
+        owned->threadIndex = uint32_t( all.threads.size() ) + 1;
+        t_events = owned.get();
+        all.threads.push_back( std::move( owned ) );
+    }
+    return *t_events;
+}
+
+void writeEscaped( FILE* file, const char* text ) {
+    std::fputc( '"', file );
+    for ( const char* c = text ? text : ""; *c; ++c ) {
+        if ( *c == '"' || *c == '\\' ) {
+            std::fputc( '\\', file );
+            std::fputc( *c, file );
+        } else if ( uint8_t( *c ) < 0x20 ) {
+            std::fprintf( file, "\\u%04x", unsigned( uint8_t( *c ) ) );
+        } else {
+            std::fputc( *c, file );
+        }
+    }
+    std::fputc( '"', file );
+}
+
+// QGuiApplication 在 Unix 上调用过 setlocale(LC_ALL, ""), printf 的 %f 在逗号小数的区域设置下会写出 1234,567;
+// JSON 的数字只能用点, 这里不经过区域设置
+void writeMicros( FILE* file, int64_t nanos ) {
+    const char* sign = nanos < 0 ? "-" : "";
+    const uint64_t magnitude = nanos < 0 ? uint64_t( -( nanos + 1 ) ) + 1 : uint64_t( nanos );
+    std::fprintf( file, "%s%llu.%03u", sign, (unsigned long long)( magnitude / 1000 ), unsigned( magnitude % 1000 ) );
+}
+
+void writeNumber( FILE* file, double value ) {
+    // JSON 没有 nan / inf, 写成 null 让查看器跳过这个点
+    if ( !std::isfinite( value ) ) {
+        std::fputs( "null", file );
+        return;
+    }
+    char text[32];
+    const std::to_chars_result result = std::to_chars( text, text + sizeof( text ), value );
+    std::fwrite( text, 1, size_t( result.ptr - text ), file );
+}
+
+} // namespace
+
+int64_t detail::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - s_epoch ).count();
+}
+
+void detail::record( char phase, const char* name, int64_t timestamp, int64_t duration, double value, uint64_t id ) {
+    ThreadEvents& events = currentThread();
+    const size_t index = events.count.load( std::memory_order_relaxed );
+    const size_t chunkIndex = index / kChunkEvents;
+    if ( chunkIndex >= kMaxChunks ) {
+        events.dropped.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+    Event* chunk = events.chunks[chunkIndex].load( std::memory_order_relaxed );
+    if ( !chunk ) {
+        chunk = new Event[kChunkEvents];
+        events.chunks[chunkIndex].store( chunk, std::memory_order_relaxed );
+    }
+    chunk[index % kChunkEvents] = { name, timestamp, duration, value, id, phase };
+    events.count.store( index + 1, std::memory_order_release );
+}
+
+void start() {
+    detail::g_enabled.store( true, std::memory_order_relaxed );
+}
+
+void stop() {
+    detail::g_enabled.store( false, std::memory_order_relaxed );
+}
+
+void setThreadName( const char* name, bool replace ) {
+    if ( !replace && t_threadName ) return;
+    t_threadName = name;
+    // 已经写过事件的线程直接改注册表里的名字
+    if ( t_events ) t_events->name.store( name, std::memory_order_relaxed );
+}
+
+bool writeJson( const char* path ) {
+    FILE* file = std::fopen( path, "wb" );
+    if ( !file ) {
+        std::fprintf( stderr, "Trace: failed to open %s\n", path );
+        return false;
+    }
+
+    std::vector<ThreadEvents*> threads;
+    {
+        Registry& all = registry();
+        std::lock_guard<std::mutex> lock( all.mutex );
+        for ( const auto& events : all.threads ) threads.push_back( events.get() );
+    }
+
+    // 时间单位是微秒; pid 固定, 同一文件里只有这一个进程
+    std::fputs( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file );
+    bool first = true;
+    const auto separator = [&]() {
+        if ( !first ) std::fputs( ",\n", file );
+        first = false;
+    };
+    uint64_t dropped = 0;
+    for ( ThreadEvents* events : threads ) {
+        const char* name = events->name.load( std::memory_order_relaxed );
+        std::string fallback = "Thread " + std::to_string( events->threadIndex );
+        separator();
+        std::fprintf( file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", events->threadIndex );
+        writeEscaped( file, name ? name : fallback.c_str() );
+        std::fputs( "}}", file );
+
+        const size_t count = events->count.load( std::memory_order_acquire );
+        dropped += events->dropped.load( std::memory_order_relaxed );
+        for ( size_t i = 0; i < count; ++i ) {
+            const Event& event = events->chunks[i / kChunkEvents].load( std::memory_order_relaxed )[i % kChunkEvents];
+            separator();
+            std::fputs( "{\"name\":", file );
+            writeEscaped( file, event.name );
+            std::fprintf( file, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":", event.phase, events->threadIndex );
+            writeMicros( file, event.timestamp );
+            switch ( event.phase ) {
+            case 'X':
+                std::fputs( ",\"dur\":", file );
+                writeMicros( file, event.duration );
+                break;
+            case 'C':
+                std::fputs( ",\"args\":{\"value\":", file );
+                writeNumber( file, event.value );
+                std::fputc( '}', file );
+                break;
+            case 'i':
+                std::fputs( ",\"s\":\"t\"", file );
+                break;
+            case 's':
+                std::fprintf( file, ",\"cat\":\"flow\",\"id\":%llu", (unsigned long long)event.id );
+                break;
+            case 'f':
+                // 绑定到包含它的区间, 而不是下一个区间
+                std::fprintf( file, ",\"cat\":\"flow\",\"id\":%llu,\"bp\":\"e\"", (unsigned long long)event.id );
+                break;
+            default:
+                break;
+            }
+            std::fputc( '}', file );
+        }
+    }
+    std::fputs( "\n]}\n", file );
+    const bool ok = std::fclose( file ) == 0;
+    if ( dropped ) std::fprintf( stderr, "Trace: %llu events dropped, per-thread buffer full\n", (unsigned long long)dropped );
+    return ok;
+}
+
+} // namespace Trace
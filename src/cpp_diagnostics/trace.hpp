@@ -0,0 +1,105 @@
+// 单一职责: 跨线程的时间线追踪, 导出为 Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev 都能打开)
+// 每个线程写自己的分块缓冲, 只有第一次写入时注册一次, 之后不加锁; 导出时按块读取已发布的事件
+// 运行时没有 start() 时每个宏只有一次原子读; 配置 -DENABLE_TRACING=OFF 时宏展开为空
+// 名字参数必须是字符串字面量或生命周期覆盖整个进程的字符串, 事件里只保存指针
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef TRACING_ENABLED
+#define TRACING_ENABLED 1
+#endif
+
+namespace Trace {
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+
+int64_t now();
+void record( char phase, const char* name, int64_t timestamp, int64_t duration, double value, uint64_t id );
+} // namespace detail
+
+inline bool enabled() {
+    return detail::g_enabled.load( std::memory_order_relaxed );
+}
+
+// 开始 / 停止记录; 事件一直保留到进程结束, 可以停止后再导出
+void start();
+void stop();
+
+// 写出到目前为止记录的所有事件
+bool writeJson( const char* path );
+
+// 时间线上的线程名; replace 为 false 时已经有名字的线程保持不变
+// 只记在 thread_local 里, 线程第一次写事件时才进入注册表, 没有写过事件的线程不出现在导出里
+void setThreadName( const char* name, bool replace = true );
+
+// 同一线程内成对使用, 可以跨函数
+inline void begin( const char* name ) {
+    if ( enabled() ) detail::record( 'B', name, detail::now(), 0, 0.0, 0 );
+}
+inline void end( const char* name ) {
+    if ( enabled() ) detail::record( 'E', name, detail::now(), 0, 0.0, 0 );
+}
+
+inline void instant( const char* name ) {
+    if ( enabled() ) detail::record( 'i', name, detail::now(), 0, 0.0, 0 );
+}
+
+inline void counter( const char* name, double value ) {
+    if ( enabled() ) detail::record( 'C', name, detail::now(), 0, value, 0 );
+}
+
+// 流事件把不同线程上的两个区间连起来, 两端用相同的 name 和 id, 都要在某个区间之内调用
+inline void flowBegin( const char* name, uint64_t id ) {
+    if ( enabled() ) detail::record( 's', name, detail::now(), 0, 0.0, id );
+}
+inline void flowEnd( const char* name, uint64_t id ) {
+    if ( enabled() ) detail::record( 'f', name, detail::now(), 0, 0.0, id );
+}
+
+// 作用域区间, 结束时写一条完整事件
+class Scope {
+public:
+    explicit Scope( const char* name )
+        : m_name( enabled() ? name : nullptr )
+        , m_start( m_name ? detail::now() : 0 )
+    {}
+    ~Scope() {
+        if ( m_name ) detail::record( 'X', m_name, m_start, detail::now() - m_start, 0.0, 0 );
+    }
+    Scope( const Scope& ) = delete;
+    Scope& operator=( const Scope& ) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_start;
+};
+
+} // namespace Trace
+
+#define TRACE_CONCAT_IMPL( a, b ) a##b
+#define TRACE_CONCAT( a, b ) TRACE_CONCAT_IMPL( a, b )
+
+#if TRACING_ENABLED
+#define TRACE_SCOPE( name ) ::Trace::Scope TRACE_CONCAT( traceScope, __LINE__ )( name )
+#define TRACE_THREAD_NAME( name ) ::Trace::setThreadName( name )
+#define TRACE_THREAD_NAME_IF_UNSET( name ) ::Trace::setThreadName( name, false )
+#define TRACE_BEGIN( name ) ::Trace::begin( name )
+#define TRACE_END( name ) ::Trace::end( name )
+#define TRACE_INSTANT( name ) ::Trace::instant( name )
+#define TRACE_COUNTER( name, value ) ::Trace::counter( name, value )
+#define TRACE_FLOW_BEGIN( name, id ) ::Trace::flowBegin( name, id )
+#define TRACE_FLOW_END( name, id ) ::Trace::flowEnd( name, id )
+#else
+#define TRACE_SCOPE( name ) ( (void)0 )
+#define TRACE_THREAD_NAME( name ) ( (void)0 )
+#define TRACE_THREAD_NAME_IF_UNSET( name ) ( (void)0 )
+#define TRACE_BEGIN( name ) ( (void)0 )
+#define TRACE_END( name ) ( (void)0 )
+#define TRACE_INSTANT( name ) ( (void)0 )
+#define TRACE_COUNTER( name, value ) ( (void)0 )
+#define TRACE_FLOW_BEGIN( name, id ) ( (void)0 )
+#define TRACE_FLOW_END( name, id ) ( (void)0 )
+#endif
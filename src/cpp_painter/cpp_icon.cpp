@@ -0,0 +1,236 @@
+#include "cpp_icon.hpp"
+
+#include "msdf_atlas.hpp"
+
+#include <QDebug>
+#include <QMatrix4x4>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGMaterial>
+#include <QSGMaterialShader>
+#include <QSGTexture>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+struct IconVertex {
+    float x, y;
+    float u, v;
+    uchar color[4];     // 预乘 alpha
+};
+
+const QSGGeometry::AttributeSet& iconAttributes() {
+    static const QSGGeometry::Attribute data[] = {
+        QSGGeometry::Attribute::createWithAttributeType( 0, 2, QSGGeometry::FloatType, QSGGeometry::PositionAttribute ),
+        QSGGeometry::Attribute::createWithAttributeType( 1, 2, QSGGeometry::FloatType, QSGGeometry::TexCoordAttribute ),
+        QSGGeometry::Attribute::createWithAttributeType( 2, 4, QSGGeometry::UnsignedByteType, QSGGeometry::ColorAttribute ),
+    };
+    static const QSGGeometry::AttributeSet set = { 3, int( sizeof( IconVertex ) ), data };
+    return set;
+}
+
+// 构建时烘焙进资源的图集, 第一次用到时读取; 每个窗口一张纹理, 场景图销毁时释放
+class IconAtlas {
+public:
+    static IconAtlas& instance() {
+        static IconAtlas atlas;
+        return atlas;
+    }
+
+    const MsdfAtlas& atlas() const { return m_atlas; }
+
+    // 渲染线程调用
+    QSGTexture* texture( QQuickWindow* window ) {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        QSGTexture*& texture = m_textures[window];
+        if ( !texture ) {
+            // 不进图集, 纹理坐标直接对应整张图
+            texture = window->createTextureFromImage( m_atlas.image() );
+            texture->setFiltering( QSGTexture::Linear );
+            QObject::connect( window, &QQuickWindow::sceneGraphInvalidated, window, [this, window]() {
+                std::lock_guard<std::mutex> lock( m_mutex );
+                delete m_textures[window];
+                m_textures.erase( window );
+            }, Qt::DirectConnection );
+        }
+        return texture;
+    }
+
+private:
+    IconAtlas() {
+        if ( !m_atlas.load( QStringLiteral( ":/cpp_painter/icons" ) ) ) {
+            qDebug() << "Icon atlas not baked, configure with -DHUS_ICON_FONT=<icon font>";
+        }
+    }
+
+    MsdfAtlas m_atlas;
+    std::mutex m_mutex;
+    std::unordered_map<QQuickWindow*, QSGTexture*> m_textures;
+};
+
+class MsdfIconMaterial : public QSGMaterial {
+public:
+    MsdfIconMaterial( QSGTexture* texture, float distanceRange )
+        : m_texture( texture )
+        , m_distanceRange( distanceRange )
+    {
+        setFlag( Blending );
+    }
+
+    QSGTexture* texture() const { return m_texture; }
+    void setTexture( QSGTexture* texture ) { m_texture = texture; }
+    float distanceRange() const { return m_distanceRange; }
+
+    QSGMaterialType* type() const override {
+        static QSGMaterialType type;
+        return &type;
+    }
+
+    QSGMaterialShader* createShader( QSGRendererInterface::RenderMode ) const override;
+
+    // 同一窗口的图标纹理相同, 可以合批
+    int compare( const QSGMaterial* other ) const override {
+        const MsdfIconMaterial* icon = static_cast<const MsdfIconMaterial*>( other );
+        if ( m_texture != icon->m_texture ) return m_texture < icon->m_texture ? -1 : 1;
+        if ( m_distanceRange != icon->m_distanceRange ) return m_distanceRange < icon->m_distanceRange ? -1 : 1;
+        return 0;
+    }
+
+private:
+    QSGTexture* m_texture;
+    float m_distanceRange;
+};
+
+class MsdfIconShader : public QSGMaterialShader {
+public:
+    MsdfIconShader() {
+        setShaderFileName( VertexStage, QStringLiteral( ":/cpp_painter/shaders/msdf_icon.vert.qsb" ) );
+        setShaderFileName( FragmentStage, QStringLiteral( ":/cpp_painter/shaders/msdf_icon.frag.qsb" ) );
+    }
+
+    // 布局与着色器中的 buf 一致: 矩阵, 不透明度, 距离范围
+    bool updateUniformData( RenderState& state, QSGMaterial* newMaterial, QSGMaterial* oldMaterial ) override {
+        QByteArray* buffer = state.uniformData();
+        bool changed = false;
+        if ( state.isMatrixDirty() ) {
+            const QMatrix4x4 matrix = state.combinedMatrix();
+            std::memcpy( buffer->data(), matrix.constData(), 64 );
+            changed = true;
+        }
+        if ( state.isOpacityDirty() ) {
+            const float opacity = state.opacity();
+            std::memcpy( buffer->data() + 64, &opacity, sizeof( float ) );
+            changed = true;
+        }
+        const float range = static_cast<MsdfIconMaterial*>( newMaterial )->distanceRange();
+        if ( !oldMaterial || static_cast<MsdfIconMaterial*>( oldMaterial )->distanceRange() != range ) {
+            std::memcpy( buffer->data() + 68, &range, sizeof( float ) );
+            changed = true;
+        }
+        return changed;
+    }
+
+    void updateSampledImage( RenderState& state, int binding, QSGTexture** texture, QSGMaterial* newMaterial,
+                             QSGMaterial* ) override {
+        if ( binding != 1 ) return;
+        QSGTexture* atlas = static_cast<MsdfIconMaterial*>( newMaterial )->texture();
+        atlas->commitTextureOperations( state.rhi(), state.resourceUpdateBatch() );
+        *texture = atlas;
+    }
+};
+
+QSGMaterialShader* MsdfIconMaterial::createShader( QSGRendererInterface::RenderMode ) const {
+    return new MsdfIconShader;
+}
+
+} // namespace
+
+CppIcon::CppIcon( QQuickItem* parent )
+    : QQuickItem( parent )
+{
+    setFlag( ItemHasContents, true );
+    setImplicitSize( m_iconSize, m_iconSize );
+}
+
+void CppIcon::setIconSource( int iconSource ) {
+    if ( iconSource == m_iconSource ) return;
+    m_iconSource = iconSource;
+    update();
+    emit iconSourceChanged();
+}
+
+void CppIcon::setIconSize( int iconSize ) {
+    if ( iconSize == m_iconSize ) return;
+    m_iconSize = iconSize;
+    setImplicitSize( iconSize, iconSize );
+    update();
+    emit iconSizeChanged();
+}
+
+void CppIcon::setColorIcon( const QColor& colorIcon ) {
+    if ( colorIcon == m_colorIcon ) return;
+    m_colorIcon = colorIcon;
+    update();
+    emit colorIconChanged();
+}
+
+void CppIcon::geometryChange( const QRectF& newGeometry, const QRectF& oldGeometry ) {
+    QQuickItem::geometryChange( newGeometry, oldGeometry );
+    // 图标在 item 中居中
+    if ( newGeometry.size() != oldGeometry.size() ) update();
+}
+
+QSGNode* CppIcon::updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* ) {
+    IconAtlas& icons = IconAtlas::instance();
+    const MsdfGlyph* glyph = icons.atlas().glyph( uint32_t( m_iconSource ) );
+    if ( !glyph || m_iconSize <= 0 ) {
+        delete oldNode;
+        return nullptr;
+    }
+
+    QSGTexture* texture = icons.texture( window() );
+    QSGGeometryNode* node = static_cast<QSGGeometryNode*>( oldNode );
+    if ( !node ) {
+        node = new QSGGeometryNode;
+        QSGGeometry* geometry = new QSGGeometry( iconAttributes(), 6 );
+        geometry->setDrawingMode( QSGGeometry::DrawTriangles );
+        node->setGeometry( geometry );
+        node->setFlag( QSGNode::OwnsGeometry );
+        node->setMaterial( new MsdfIconMaterial( texture, icons.atlas().distanceRange() ) );
+        node->setFlag( QSGNode::OwnsMaterial );
+    }
+    MsdfIconMaterial* material = static_cast<MsdfIconMaterial*>( node->material() );
+    if ( material->texture() != texture ) {
+        material->setTexture( texture );
+        node->markDirty( QSGNode::DirtyMaterial );
+    }
+
+    // em 框居中, 字形范围 (含距离场留边) 按 em 框缩放
+    const qreal side = m_iconSize;
+    const QPointF origin( ( width() - side ) / 2, ( height() - side ) / 2 );
+    const QRectF quad( origin.x() + glyph->plane.x() * side, origin.y() + glyph->plane.y() * side,
+                       glyph->plane.width() * side, glyph->plane.height() * side );
+    const QSizeF atlasSize = icons.atlas().image().size();
+    const QRectF uv( glyph->atlasRect.x() / atlasSize.width(), glyph->atlasRect.y() / atlasSize.height(),
+                     glyph->atlasRect.width() / atlasSize.width(), glyph->atlasRect.height() / atlasSize.height() );
+
+    const int alpha = m_colorIcon.alpha();
+    const uchar color[4] = { uchar( m_colorIcon.red() * alpha / 255 ), uchar( m_colorIcon.green() * alpha / 255 ),
+                             uchar( m_colorIcon.blue() * alpha / 255 ), uchar( alpha ) };
+    const auto corner = [&]( bool right, bool bottom ) {
+        IconVertex vertex;
+        vertex.x = float( right ? quad.right() : quad.left() );
+        vertex.y = float( bottom ? quad.bottom() : quad.top() );
+        vertex.u = float( right ? uv.right() : uv.left() );
+        vertex.v = float( bottom ? uv.bottom() : uv.top() );
+        std::memcpy( vertex.color, color, 4 );
+        return vertex;
+    };
+    const IconVertex vertices[6] = { corner( false, false ), corner( true, false ), corner( true, true ),
+                                     corner( false, false ), corner( true, true ), corner( false, true ) };
+    std::memcpy( node->geometry()->vertexData(), vertices, sizeof( vertices ) );
+    node->markDirty( QSGNode::DirtyGeometry );
+    return node;
+}
@@ -0,0 +1,45 @@
+// 单一职责: HusIconText 的替代, 图标取自构建时烘焙的 MSDF 图集, 不再整形和光栅化字形
+// 同一窗口的所有 CppIcon 共享一张图集纹理和同一种材质, 颜色写在顶点里, 场景图把它们合并成一次绘制;
+// 多通道距离场在片元着色器中重建轮廓, 任意缩放下边缘都是一个屏幕像素的抗锯齿
+#pragma once
+
+#include <QColor>
+#include <QQuickItem>
+#include <QtQml/qqmlregistration.h>
+
+class CppIcon : public QQuickItem {
+    Q_OBJECT
+    QML_ELEMENT     // 自动注册为QML组件
+    Q_PROPERTY(int iconSource READ iconSource WRITE setIconSource NOTIFY iconSourceChanged FINAL)
+    Q_PROPERTY(int iconSize READ iconSize WRITE setIconSize NOTIFY iconSizeChanged FINAL)
+    Q_PROPERTY(QColor colorIcon READ colorIcon WRITE setColorIcon NOTIFY colorIconChanged FINAL)
+
+public:
+    explicit CppIcon( QQuickItem* parent = nullptr );
+
+    // HusIcon.Type 的值, 即图标字体中的码位
+    int iconSource() const { return m_iconSource; }
+    void setIconSource( int iconSource );
+
+    // em 框的边长, 与 HusIconText 的字号相同; 也是默认的 implicitWidth / implicitHeight
+    int iconSize() const { return m_iconSize; }
+    void setIconSize( int iconSize );
+
+    QColor colorIcon() const { return m_colorIcon; }
+    void setColorIcon( const QColor& colorIcon );
+
+signals:
+    void iconSourceChanged();
+    void iconSizeChanged();
+    void colorIconChanged();
+
+protected:
+    // 渲染线程在同步阶段调用, 此时 GUI 线程阻塞, 可以直接读取属性
+    QSGNode* updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* data ) override;
+    void geometryChange( const QRectF& newGeometry, const QRectF& oldGeometry ) override;
+
+private:
+    int m_iconSource = 0;
+    int m_iconSize = 16;
+    QColor m_colorIcon = Qt::black;
+};
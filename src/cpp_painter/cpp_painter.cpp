@@ -1,10 +1,306 @@
 #include "cpp_painter.hpp"
 
+#include <QQuickWindow>
+#include <QRandomGenerator>
+#include <QSGImageNode>
+#include <QThreadPool>
+#include <algorithm>
+#include <vector>
+
+
+namespace {
+
+// 工作线程绘制用的快照, 与 item 之后的修改无关
+struct PaintSnapshot {
+    DrawList drawList;
+    TimeSeriesPlot::Polyline plot;
+    TextCache::Mode textMode;
+    qreal devicePixelRatio;
+};
+
+// 异步模式下新块在第一次画好之前还没有图像, 先用一个透明像素占位
+const QImage& transparentPixel() {
+    static const QImage pixel = []() {
+        QImage image( 1, 1, QImage::Format_ARGB32_Premultiplied );
+        image.fill( Qt::transparent );
+        return image;
+    }();
+    return pixel;
+}
+
+} // namespace
+
+CppPainter::~CppPainter() {
+    std::lock_guard<std::mutex> lock( m_async->mutex );
+    m_async->item = nullptr;
+}
 
 void CppPainter::randomPaint() {
-    qDebug() << "牛魔的" ;
+    LOG_DEBUG( "牛魔的" );
+    const size_t first = m_drawList.primitives().size();
+    m_drawList.addRandomShapes( boundingRect(), *QRandomGenerator::global() );
+    for ( size_t i = first; i < m_drawList.primitives().size(); ++i ) {
+        m_store.invalidate( DrawList::bounds( m_drawList.primitives()[i] ) );
+    }
+    update();
+}
+
+void CppPainter::drawLine( qreal x1, qreal y1, qreal x2, qreal y2, const QColor& color, qreal width ) {
+    m_drawList.addLine( QPointF( x1, y1 ), QPointF( x2, y2 ), color, float( width ) );
+    invalidateLast();
+}
+
+void CppPainter::drawRect( qreal x, qreal y, qreal width, qreal height, const QColor& color, bool filled ) {
+    m_drawList.addRect( QRectF( x, y, width, height ), color, filled );
+    invalidateLast();
+}
+
+void CppPainter::drawTriangle( qreal x1, qreal y1, qreal x2, qreal y2, qreal x3, qreal y3, const QColor& color ) {
+    m_drawList.addTriangle( QPointF( x1, y1 ), QPointF( x2, y2 ), QPointF( x3, y3 ), color );
+    invalidateLast();
+}
+
+void CppPainter::drawText( qreal x, qreal y, const QString& text, const QColor& color, int pixelSize ) {
+    m_drawList.addText( QPointF( x, y ), text, color, pixelSize );
+    invalidateLast();
+}
+
+void CppPainter::clear() {
+    m_store.invalidate( m_drawList.bounds() );
+    m_drawList.clear();
+    update();
 }
 
 void CppPainter::outputString(const QString& str) {
     qDebug() << str;
 }
+
+QString CppPainter::textRenderMode() const {
+    switch ( m_textMode ) {
+    case TextCache::Mode::StaticText: return QStringLiteral( "staticText" );
+    case TextCache::Mode::GlyphAtlas: return QStringLiteral( "glyphAtlas" );
+    case TextCache::Mode::DistanceField: return QStringLiteral( "distanceField" );
+    }
+    return QString();
+}
+
+void CppPainter::setTextRenderMode( const QString& mode ) {
+    TextCache::Mode textMode;
+    if ( mode == "staticText" ) {
+        textMode = TextCache::Mode::StaticText;
+    } else if ( mode == "glyphAtlas" ) {
+        textMode = TextCache::Mode::GlyphAtlas;
+    } else if ( mode == "distanceField" ) {
+        textMode = TextCache::Mode::DistanceField;
+    } else {
+        qDebug() << "Unknown text render mode:" << mode;
+        return;
+    }
+    if ( textMode == m_textMode ) return;
+    m_textMode = textMode;
+    // 已画好的块里的文字是旧模式光栅化的
+    m_store.invalidateAll();
+    update();
+    emit textRenderModeChanged();
+}
+
+QVariantMap CppPainter::textCacheStats() const {
+    const TextCache::Stats stats = TextCache::instance().stats();
+    const auto rate = []( uint64_t hits, uint64_t misses ) {
+        return hits + misses > 0 ? double( hits ) / double( hits + misses ) : 0.0;
+    };
+    QVariantMap map;
+    map["layoutHitRate"] = rate( stats.layoutHits, stats.layoutMisses );
+    map["glyphHitRate"] = rate( stats.glyphHits, stats.glyphMisses );
+    map["layouts"] = stats.layouts;
+    map["glyphs"] = stats.glyphs;
+    map["distanceFields"] = stats.distanceFields;
+    map["atlasResets"] = stats.atlasResets;
+    map["layoutBytes"] = qulonglong( stats.layoutBytes );
+    map["atlasBytes"] = qulonglong( stats.atlasBytes );
+    map["distanceFieldBytes"] = qulonglong( stats.distanceFieldBytes );
+    return map;
+}
+
+void CppPainter::appendSample( qreal value ) {
+    const float sample = float( value );
+    appendSamples( &sample, 1 );
+}
+
+void CppPainter::appendSamples( const QList<qreal>& values ) {
+    std::vector<float> samples( values.begin(), values.end() );
+    appendSamples( samples.data(), samples.size() );
+}
+
+void CppPainter::appendSamples( const float* values, size_t count ) {
+    m_plot.series().append( values, count );
+    // 变化的列在 updatePaintNode 里由 m_plot.update() 算出
+    update();
+}
+
+void CppPainter::clearSamples() {
+    m_plot.series().clear();
+    update();
+}
+
+void CppPainter::setPlotCapacity( int samples ) {
+    m_plot.series().setCapacity( size_t( std::max( samples, 1 ) ) );
+    update();
+}
+
+void CppPainter::setPlotWindow( qreal start, qreal length ) {
+    m_plot.setWindow( start, length );
+    update();
+}
+
+void CppPainter::followPlotTail( qreal length ) {
+    m_plot.followTail( length );
+    update();
+}
+
+QString CppPainter::plotDecimation() const {
+    return m_plot.decimation() == TimeSeriesPlot::Decimation::Lttb ? QStringLiteral( "lttb" ) : QStringLiteral( "minMax" );
+}
+
+void CppPainter::setPlotDecimation( const QString& decimation ) {
+    TimeSeriesPlot::Decimation value;
+    if ( decimation == "minMax" ) {
+        value = TimeSeriesPlot::Decimation::MinMax;
+    } else if ( decimation == "lttb" ) {
+        value = TimeSeriesPlot::Decimation::Lttb;
+    } else {
+        qDebug() << "Unknown plot decimation:" << decimation;
+        return;
+    }
+    if ( value == m_plot.decimation() ) return;
+    m_plot.setDecimation( value );
+    update();
+    emit plotDecimationChanged();
+}
+
+void CppPainter::setPlotColor( const QColor& color ) {
+    if ( color == m_plot.color() ) return;
+    m_plot.setColor( color );
+    update();
+    emit plotColorChanged();
+}
+
+void CppPainter::setAsyncPaint( bool async ) {
+    if ( async == m_asyncPaint ) return;
+    m_asyncPaint = async;
+    update();
+    emit asyncPaintChanged();
+}
+
+void CppPainter::takeAsyncResult() {
+    std::vector<TiledBackingStore::PendingTile> tiles;
+    {
+        std::lock_guard<std::mutex> lock( m_async->mutex );
+        if ( !m_async->ready ) return;
+        tiles = std::move( m_async->tiles );
+        m_async->ready = false;
+        m_async->busy = false;
+    }
+    // 快照之后又被标记的块会被丢弃, 它们已经在等下一轮重画
+    for ( TiledBackingStore::PendingTile& tile : tiles ) {
+        m_store.setTileImage( std::move( tile ) );
+    }
+}
+
+void CppPainter::startAsyncPaint() {
+    {
+        std::lock_guard<std::mutex> lock( m_async->mutex );
+        if ( m_async->busy || !m_store.hasDirtyTiles() ) return;
+        m_async->busy = true;
+    }
+
+    auto snapshot = std::make_shared<PaintSnapshot>( PaintSnapshot{ m_drawList, m_plot.polyline(), m_textMode, m_store.devicePixelRatio() } );
+    auto tiles = std::make_shared<std::vector<TiledBackingStore::PendingTile>>( m_store.takeDirtyTiles() );
+    std::shared_ptr<AsyncFrame> frame = m_async;
+    QThreadPool::globalInstance()->start( [frame, snapshot, tiles]() {
+        for ( TiledBackingStore::PendingTile& tile : *tiles ) {
+            TiledBackingStore::paintTile( tile.image, tile.rect, snapshot->devicePixelRatio, [&]( QPainter* painter, const QRect& clip ) {
+                paint( painter, clip, snapshot->drawList, snapshot->plot, snapshot->textMode );
+            } );
+        }
+
+        std::lock_guard<std::mutex> lock( frame->mutex );
+        frame->tiles = std::move( *tiles );
+        frame->ready = true;
+        // 回到 GUI 线程请求下一帧, 在 updatePaintNode 里换入
+        if ( frame->item ) QMetaObject::invokeMethod( frame->item, "update", Qt::QueuedConnection );
+    } );
+}
+
+void CppPainter::invalidateLast() {
+    m_store.invalidate( DrawList::bounds( m_drawList.primitives().back() ) );
+    update();
+}
+
+void CppPainter::geometryChange( const QRectF& newGeometry, const QRectF& oldGeometry ) {
+    QQuickItem::geometryChange( newGeometry, oldGeometry );
+    // 块网格在 updatePaintNode 中按新大小调整
+    if ( newGeometry.size() != oldGeometry.size() ) update();
+}
+
+QSGNode* CppPainter::updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* ) {
+    // 先调整网格: 新出现的块是脏的, 已有块保留内容; 图元的失效范围在网格之外时被忽略,
+    // 所以网格必须先覆盖全部可见区域, 初次调整之前加入的图元随新块一起画出
+    const QSize itemSize = size().toSize();
+    m_store.resize( itemSize, window()->effectiveDevicePixelRatio() );
+
+    // 曲线按像素列重新抽取, 只标记折线变化的范围
+    m_store.invalidate( m_plot.update( size(), window()->effectiveDevicePixelRatio() ) );
+
+    QSGNode* root = oldNode;
+    if ( !root ) root = new QSGNode;
+
+    // 网格变化时重建全部块节点, 每个块一个 QSGImageNode, 按行优先排列;
+    // resize 会把保留的块挪到新的行优先下标, 所以列数或行数任一变化都要重建并重新上传
+    const int tileCount = m_store.columns() * m_store.rows();
+    if ( root->childCount() != tileCount || m_store.columns() != m_nodeColumns || m_store.rows() != m_nodeRows ) {
+        m_nodeColumns = m_store.columns();
+        m_nodeRows = m_store.rows();
+        while ( QSGNode* child = root->firstChild() ) {
+            root->removeChildNode( child );
+            delete child;
+        }
+        for ( int i = 0; i < tileCount; ++i ) {
+            root->appendChildNode( window()->createImageNode() );
+        }
+        m_store.markAllForUpload();
+    }
+
+    // 先换入已经画好的块 (包括关闭异步模式之前提交的那一帧)
+    takeAsyncResult();
+    if ( m_asyncPaint ) {
+        startAsyncPaint();
+    } else {
+        m_store.repaint( [this]( QPainter* painter, const QRect& clip ) {
+            paint( painter, clip, m_drawList, m_plot.polyline(), m_textMode );
+        } );
+    }
+
+    QSGNode* child = root->firstChild();
+    for ( int row = 0; row < m_store.rows(); ++row ) {
+        for ( int column = 0; column < m_store.columns(); ++column, child = child->nextSibling() ) {
+            QSGImageNode* node = static_cast<QSGImageNode*>( child );
+            TiledBackingStore::Tile& tile = m_store.tile( column, row );
+            const QImage& image = tile.image.isNull() ? transparentPixel() : tile.image;
+            if ( tile.needsUpload ) {
+                node->setTexture( window()->createTextureFromImage( image ) );
+                node->setOwnsTexture( true );
+                tile.needsUpload = false;
+            }
+
+            // 右边和下边的块只显示落在 item 内的部分
+            const QRect tileRect = m_store.tileRect( column, row );
+            const QRect visible = m_store.visibleRect( column, row );
+            const qreal scale = tile.image.isNull() ? 0.0 : qreal( image.width() ) / TiledBackingStore::kTileSize;
+            node->setRect( visible );
+            node->setSourceRect( QRectF( ( visible.x() - tileRect.x() ) * scale, ( visible.y() - tileRect.y() ) * scale,
+                                         visible.width() * scale, visible.height() * scale ) );
+        }
+    }
+    return root;
+}
@@ -1,31 +1,126 @@
 #pragma once
 
+#include "async_logger.hpp"
+#include "draw_list.hpp"
+#include "tiled_backing_store.hpp"
+#include "time_series_plot.hpp"
+
 #include <QObject>
 // #include <QQmlEngine>
-#include <QQuickPaintedItem>
+#include <QQuickItem>
 #include <QPainter>
+#include <QVariantMap>
 #include <QtQml/qqmlregistration.h>
+#include <memory>
+#include <mutex>
+#include <vector>
 
-class CppPainter : public QQuickPaintedItem {
+// QPainter 光栅化版本, 内容保存在 256x256 的分块纹理里
+// 绘制接口记录每个图元的覆盖范围, update() 时只重绘并重新上传被这些范围碰到的块
+// 文字经过所有 CppPainter 共享的 TextCache, textRenderMode 选择 "staticText" / "glyphAtlas" / "distanceField"
+// 曲线模式: appendSamples 追加到环形缓冲, 每个设备像素一列按 min/max 或 LTTB 抽取, 画在图元下面
+// asyncPaint 为 true 时脏块由工作线程按图元快照画进新图像, 画好后在下一次 updatePaintNode 换入, 渲染线程不再等待绘制
+// 图元接口与 CppSGPainter 相同, 两者可以在 QML 中直接替换
+class CppPainter : public QQuickItem {
     Q_OBJECT
     QML_ELEMENT     // 自动注册为QML组件
+    Q_PROPERTY(QString textRenderMode READ textRenderMode WRITE setTextRenderMode NOTIFY textRenderModeChanged FINAL)
+    Q_PROPERTY(QString plotDecimation READ plotDecimation WRITE setPlotDecimation NOTIFY plotDecimationChanged FINAL)
+    Q_PROPERTY(QColor plotColor READ plotColor WRITE setPlotColor NOTIFY plotColorChanged FINAL)
+    Q_PROPERTY(bool asyncPaint READ asyncPaint WRITE setAsyncPaint NOTIFY asyncPaintChanged FINAL)
 
 public:
-    explicit CppPainter( QQuickPaintedItem* parent = nullptr )
-        :QQuickPaintedItem(parent)
+    explicit CppPainter( QQuickItem* parent = nullptr )
+        :QQuickItem(parent)
+        ,m_async( std::make_shared<AsyncFrame>() )
     {
-        qDebug() << "Create Painter";
+        LOG_DEBUG( "Create Painter" );
+        setFlag( ItemHasContents, true );
+        m_async->item = this;
+        m_drawList.addText( QPointF( 50, 50 ), "haha", Qt::black );
     }
+    ~CppPainter() override;
 
     Q_INVOKABLE void randomPaint();
 
+    // 图元接口, 坐标为 item 的本地坐标
+    Q_INVOKABLE void drawLine( qreal x1, qreal y1, qreal x2, qreal y2, const QColor& color, qreal width = 1.0 );
+    Q_INVOKABLE void drawRect( qreal x, qreal y, qreal width, qreal height, const QColor& color, bool filled = true );
+    Q_INVOKABLE void drawTriangle( qreal x1, qreal y1, qreal x2, qreal y2, qreal x3, qreal y3, const QColor& color );
+    Q_INVOKABLE void drawText( qreal x, qreal y, const QString& text, const QColor& color, int pixelSize = 16 );
+    Q_INVOKABLE void clear();
+
+    QString textRenderMode() const;
+    void setTextRenderMode( const QString& mode );
+
+    // 共享文字缓存的命中率和内存占用
+    Q_INVOKABLE QVariantMap textCacheStats() const;
+
+    // 曲线: 样本序号从 0 开始递增, 缓冲写满后丢弃最旧的样本
+    Q_INVOKABLE void appendSample( qreal value );
+    Q_INVOKABLE void appendSamples( const QList<qreal>& values );
+    Q_INVOKABLE void clearSamples();
+    Q_INVOKABLE void setPlotCapacity( int samples );
+    // 固定显示样本 [start, start + length), 或始终显示最新的 length 个 (<= 0 为全部)
+    Q_INVOKABLE void setPlotWindow( qreal start, qreal length );
+    Q_INVOKABLE void followPlotTail( qreal length = 0 );
+
+    // C++ 数据源直接追加, 只能在 GUI 线程调用
+    void appendSamples( const float* values, size_t count );
+
+    QString plotDecimation() const;
+    void setPlotDecimation( const QString& decimation );
+    QColor plotColor() const { return m_plot.color(); }
+    void setPlotColor( const QColor& color );
+
+    bool asyncPaint() const { return m_asyncPaint; }
+    void setAsyncPaint( bool async );
+
 public slots:
     void outputString(const QString& str);
 signals:
+    void textRenderModeChanged();
+    void plotDecimationChanged();
+    void plotColorChanged();
+    void asyncPaintChanged();
+protected:
+    // 渲染线程在同步阶段调用, 此时 GUI 线程阻塞, 可以直接读写 m_drawList 和 m_store
+    QSGNode* updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* data ) override;
+    void geometryChange( const QRectF& newGeometry, const QRectF& oldGeometry ) override;
+
 private:
-    QPoint trianglePos = {0,0};
-    void paint(QPainter* painter) override {
-        qDebug() << "Painting";
-        painter->drawText( QPoint(50, 50), "haha" );
+    DrawList m_drawList;
+    TiledBackingStore m_store;
+    // 块节点按这个网格形状建立; 形状变了而块数不变时 (2x3 -> 3x2), 节点下标对应的块也变了
+    int m_nodeColumns = 0;
+    int m_nodeRows = 0;
+    TimeSeriesPlot m_plot;
+    TextCache::Mode m_textMode = TextCache::Mode::StaticText;    // 只在 GUI 线程或同步阶段读写
+
+    // 异步绘制的共享状态, 工作线程持有一份引用, item 销毁后仍然有效
+    struct AsyncFrame {
+        std::mutex mutex;
+        CppPainter* item = nullptr;     // item 析构时置空, 之后画完的结果直接丢弃
+        bool busy = false;              // 同一时间只画一帧, 画得慢只降低这个 item 自己的刷新率
+        bool ready = false;
+        std::vector<TiledBackingStore::PendingTile> tiles;
+    };
+    std::shared_ptr<AsyncFrame> m_async;
+    bool m_asyncPaint = false;
+
+    // 标记最新加入的图元覆盖的块
+    void invalidateLast();
+
+    // 同步阶段调用: 换入工作线程画好的块 / 把脏块和图元快照交给工作线程
+    void takeAsyncResult();
+    void startAsyncPaint();
+
+    // 只画与 clip 相交的图元, painter 已经裁剪到 clip; 异步模式下在工作线程里对快照调用
+    static void paint( QPainter* painter, const QRectF& clip, const DrawList& drawList, const TimeSeriesPlot::Polyline& plot,
+                       TextCache::Mode textMode ) {
+        // 每块每帧一次, 默认编译期去掉
+        LOG_TRACE( "Painting" );
+        plot.paint( painter, clip );
+        drawList.paint( painter, clip, textMode );
     }
 };
@@ -0,0 +1,153 @@
+#include "cpp_rectangle.hpp"
+
+#include "sdf_rect_material.hpp"
+
+#include <QDebug>
+#include <QQmlListReference>
+#include <QSGGeometryNode>
+#include <QtMath>
+#include <algorithm>
+#include <cstring>
+
+void CppPen::setWidth( qreal width ) {
+    if ( qFuzzyCompare( width, m_width ) ) return;
+    m_width = width;
+    emit widthChanged();
+}
+
+void CppPen::setColor( const QColor& color ) {
+    if ( color == m_color ) return;
+    m_color = color;
+    emit colorChanged();
+}
+
+void CppPen::setStyle( int style ) {
+    if ( style == m_style ) return;
+    m_style = style;
+    emit styleChanged();
+}
+
+CppRectangle::CppRectangle( QQuickItem* parent )
+    : QQuickItem( parent )
+    , m_border( new CppPen( this ) )
+{
+    setFlag( ItemHasContents, true );
+    connect( m_border, &CppPen::widthChanged, this, &QQuickItem::update );
+    connect( m_border, &CppPen::colorChanged, this, &QQuickItem::update );
+}
+
+void CppRectangle::setColor( const QColor& color ) {
+    if ( color == m_color ) return;
+    m_color = color;
+    update();
+    emit colorChanged();
+}
+
+void CppRectangle::setGradient( const QJSValue& gradient ) {
+    if ( QObject* old = m_gradient.toQObject() ) disconnect( old, nullptr, this, nullptr );
+    m_gradient = gradient;
+    // QtQuick 的 Gradient 在色标变化时发出 updated()
+    QObject* object = gradient.toQObject();
+    if ( object && object->metaObject()->indexOfSignal( "updated()" ) >= 0 ) {
+        connect( object, SIGNAL( updated() ), this, SLOT( updateGradient() ) );
+    } else if ( !object && !gradient.isUndefined() && !gradient.isNull() ) {
+        qDebug() << "Unsupported gradient:" << gradient.toString();
+    }
+    updateGradient();
+}
+
+void CppRectangle::resetGradient() {
+    setGradient( QJSValue() );
+}
+
+void CppRectangle::updateGradient() {
+    m_stops.clear();
+    m_gradientOrientation = Qt::Vertical;
+    if ( QObject* object = m_gradient.toQObject() ) {
+        // Gradient.Vertical / Gradient.Horizontal 的值与 Qt::Orientation 相同
+        if ( object->property( "orientation" ).toInt() == Qt::Horizontal ) m_gradientOrientation = Qt::Horizontal;
+        QQmlListReference stops( object, "stops" );
+        for ( qsizetype i = 0; i < stops.count(); ++i ) {
+            const QObject* stop = stops.at( i );
+            m_stops.emplace_back( stop->property( "position" ).toReal(), stop->property( "color" ).value<QColor>() );
+        }
+        std::stable_sort( m_stops.begin(), m_stops.end(),
+                          []( const auto& a, const auto& b ) { return a.first < b.first; } );
+    }
+    update();
+}
+
+void CppRectangle::setRadius( qreal radius ) {
+    if ( qFuzzyCompare( radius, m_radius ) ) return;
+    m_radius = radius;
+    update();
+    emit radiusChanged();
+}
+
+bool CppRectangle::setCornerRadius( int corner, qreal radius ) {
+    if ( qFuzzyCompare( radius, m_cornerRadius[corner] ) ) return false;
+    m_cornerRadius[corner] = radius;
+    update();
+    return true;
+}
+
+void CppRectangle::setTopLeftRadius( qreal radius ) {
+    if ( setCornerRadius( 0, radius ) ) emit topLeftRadiusChanged();
+}
+
+void CppRectangle::setTopRightRadius( qreal radius ) {
+    if ( setCornerRadius( 1, radius ) ) emit topRightRadiusChanged();
+}
+
+void CppRectangle::setBottomRightRadius( qreal radius ) {
+    if ( setCornerRadius( 2, radius ) ) emit bottomRightRadiusChanged();
+}
+
+void CppRectangle::setBottomLeftRadius( qreal radius ) {
+    if ( setCornerRadius( 3, radius ) ) emit bottomLeftRadiusChanged();
+}
+
+void CppRectangle::geometryChange( const QRectF& newGeometry, const QRectF& oldGeometry ) {
+    QQuickItem::geometryChange( newGeometry, oldGeometry );
+    if ( newGeometry.size() != oldGeometry.size() ) update();
+}
+
+QSGNode* CppRectangle::updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* ) {
+    SdfRectStyle style;
+    style.rect = boundingRect();
+    for ( int i = 0; i < 4; ++i ) {
+        style.radii[i] = float( m_cornerRadius[i] >= 0 ? m_cornerRadius[i] : m_radius );
+    }
+    style.color = m_color;
+    style.gradient = m_stops;
+    style.gradientOrientation = m_gradientOrientation;
+    if ( m_border->isValid() ) {
+        style.borderColor = m_border->color();
+        style.borderWidth = float( m_border->width() );
+    }
+
+    std::vector<SdfRectVertex> vertices;
+    appendSdfRect( style, vertices );
+    if ( vertices.empty() ) {
+        delete oldNode;
+        return nullptr;
+    }
+
+    QSGGeometryNode* node = static_cast<QSGGeometryNode*>( oldNode );
+    if ( !node ) {
+        node = new QSGGeometryNode;
+        QSGGeometry* geometry = new QSGGeometry( SdfRectMaterial::attributes(), 0 );
+        geometry->setDrawingMode( QSGGeometry::DrawTriangles );
+        node->setGeometry( geometry );
+        node->setFlag( QSGNode::OwnsGeometry );
+        // 材质没有状态, 每个节点一份也能合批
+        node->setMaterial( new SdfRectMaterial );
+        node->setFlag( QSGNode::OwnsMaterial );
+    }
+
+    QSGGeometry* geometry = node->geometry();
+    geometry->allocate( int( vertices.size() ) );
+    std::memcpy( geometry->vertexData(), vertices.data(), vertices.size() * sizeof( SdfRectVertex ) );
+    node->markDirty( QSGNode::DirtyGeometry );
+    return node;
+}
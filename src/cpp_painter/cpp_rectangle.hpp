@@ -0,0 +1,115 @@
+// 单一职责: HusRectangle 的 GPU 版本, 属性相同, 可以在 QML 中直接替换
+// 圆角、边框、抗锯齿由 SdfRectMaterial 在片元着色器中按有向距离计算, 不做 CPU 光栅化也不上传纹理;
+// 材质没有参数, 相邻的 CppRectangle 被场景图合并成一批, 几百个卡片 / 按钮只需要几次绘制
+#pragma once
+
+#include <QColor>
+#include <QJSValue>
+#include <QObject>
+#include <QQuickItem>
+#include <QtQml/qqmlregistration.h>
+#include <utility>
+#include <vector>
+
+// 边框, 作为 CppRectangle 的分组属性 border.width / border.color 使用
+class CppPen : public QObject {
+    Q_OBJECT
+    QML_ANONYMOUS
+    Q_PROPERTY(qreal width READ width WRITE setWidth NOTIFY widthChanged FINAL)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged FINAL)
+    Q_PROPERTY(int style READ style WRITE setStyle NOTIFY styleChanged FINAL)
+
+public:
+    explicit CppPen( QObject* parent = nullptr ) : QObject( parent ) {}
+
+    qreal width() const { return m_width; }
+    void setWidth( qreal width );
+
+    QColor color() const { return m_color; }
+    void setColor( const QColor& color );
+
+    // 只画实线, 其它线型为了兼容 HusPen 保留, 按实线处理
+    int style() const { return m_style; }
+    void setStyle( int style );
+
+    bool isValid() const { return m_width > 0 && m_color.isValid() && m_color.alpha() > 0; }
+
+signals:
+    void widthChanged();
+    void colorChanged();
+    void styleChanged();
+
+private:
+    qreal m_width = 1;
+    QColor m_color = Qt::transparent;
+    int m_style = Qt::SolidLine;
+};
+
+class CppRectangle : public QQuickItem {
+    Q_OBJECT
+    QML_ELEMENT     // 自动注册为QML组件
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged FINAL)
+    Q_PROPERTY(QJSValue gradient READ gradient WRITE setGradient RESET resetGradient)
+    Q_PROPERTY(CppPen* border READ border CONSTANT)
+
+    Q_PROPERTY(qreal radius READ radius WRITE setRadius NOTIFY radiusChanged FINAL)
+    Q_PROPERTY(qreal topLeftRadius READ topLeftRadius WRITE setTopLeftRadius NOTIFY topLeftRadiusChanged FINAL)
+    Q_PROPERTY(qreal topRightRadius READ topRightRadius WRITE setTopRightRadius NOTIFY topRightRadiusChanged FINAL)
+    Q_PROPERTY(qreal bottomLeftRadius READ bottomLeftRadius WRITE setBottomLeftRadius NOTIFY bottomLeftRadiusChanged FINAL)
+    Q_PROPERTY(qreal bottomRightRadius READ bottomRightRadius WRITE setBottomRightRadius NOTIFY bottomRightRadiusChanged FINAL)
+
+public:
+    explicit CppRectangle( QQuickItem* parent = nullptr );
+
+    QColor color() const { return m_color; }
+    void setColor( const QColor& color );
+
+    CppPen* border() { return m_border; }
+
+    // 接受 QtQuick 的 Gradient 对象 (stops 和 orientation), 设置后代替 color
+    QJSValue gradient() const { return m_gradient; }
+    void setGradient( const QJSValue& gradient );
+    void resetGradient();
+
+    qreal radius() const { return m_radius; }
+    void setRadius( qreal radius );
+
+    // 单独的角半径, 小于 0 (默认) 时使用 radius
+    qreal topLeftRadius() const { return m_cornerRadius[0]; }
+    void setTopLeftRadius( qreal radius );
+    qreal topRightRadius() const { return m_cornerRadius[1]; }
+    void setTopRightRadius( qreal radius );
+    qreal bottomRightRadius() const { return m_cornerRadius[2]; }
+    void setBottomRightRadius( qreal radius );
+    qreal bottomLeftRadius() const { return m_cornerRadius[3]; }
+    void setBottomLeftRadius( qreal radius );
+
+signals:
+    void colorChanged();
+    void radiusChanged();
+    void topLeftRadiusChanged();
+    void topRightRadiusChanged();
+    void bottomLeftRadiusChanged();
+    void bottomRightRadiusChanged();
+
+protected:
+    // 渲染线程在同步阶段调用, 此时 GUI 线程阻塞, 可以直接读取属性
+    QSGNode* updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* data ) override;
+    void geometryChange( const QRectF& newGeometry, const QRectF& oldGeometry ) override;
+
+private slots:
+    // Gradient 的色标或方向变化时重新读取
+    void updateGradient();
+
+private:
+    // 顺序为 左上 右上 右下 左下, 与 SdfRectStyle::radii 一致
+    bool setCornerRadius( int corner, qreal radius );
+
+    QColor m_color = Qt::white;
+    CppPen* m_border;
+    QJSValue m_gradient;
+    std::vector<std::pair<qreal, QColor>> m_stops;
+    Qt::Orientation m_gradientOrientation = Qt::Vertical;
+    qreal m_radius = 0;
+    qreal m_cornerRadius[4] = { -1, -1, -1, -1 };
+};
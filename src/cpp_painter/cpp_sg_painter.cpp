@@ -0,0 +1,201 @@
+#include "cpp_sg_painter.hpp"
+
+#include <QDebug>
+#include <QQuickWindow>
+#include <QRandomGenerator>
+#include <QSGGeometryNode>
+#include <QSGTextNode>
+#include <QSGVertexColorMaterial>
+#include <QTextLayout>
+#include <QtMath>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using Vertex = QSGGeometry::ColoredPoint2D;
+
+// 根节点: 几何节点在前, 文字节点都挂在 texts 下 (文字总是画在几何之上)
+class PainterNode : public QSGNode {
+public:
+    QSGGeometryNode* geometry = nullptr;
+    QSGNode* texts = nullptr;
+    uint64_t geometryRevision = 0;
+    uint64_t textRevision = 0;
+    bool built = false;
+};
+
+// QSGVertexColorMaterial 要求顶点颜色预乘 alpha
+void appendTriangle( std::vector<Vertex>& vertices, const QPointF& a, const QPointF& b, const QPointF& c, const QColor& color ) {
+    const int alpha = color.alpha();
+    const uchar red = uchar( color.red() * alpha / 255 );
+    const uchar green = uchar( color.green() * alpha / 255 );
+    const uchar blue = uchar( color.blue() * alpha / 255 );
+    for ( const QPointF& point : { a, b, c } ) {
+        Vertex vertex;
+        vertex.set( float( point.x() ), float( point.y() ), red, green, blue, uchar( alpha ) );
+        vertices.push_back( vertex );
+    }
+}
+
+void appendQuad( std::vector<Vertex>& vertices, const QPointF& p0, const QPointF& p1, const QPointF& p2, const QPointF& p3,
+                 const QColor& color ) {
+    appendTriangle( vertices, p0, p1, p2, color );
+    appendTriangle( vertices, p0, p2, p3, color );
+}
+
+void appendRect( std::vector<Vertex>& vertices, const QRectF& rect, const QColor& color ) {
+    appendQuad( vertices, rect.topLeft(), rect.topRight(), rect.bottomRight(), rect.bottomLeft(), color );
+}
+
+// 线展开成沿法线方向加宽的四边形
+void appendLine( std::vector<Vertex>& vertices, const QPointF& from, const QPointF& to, float width, const QColor& color ) {
+    const QPointF direction = to - from;
+    const qreal length = qSqrt( QPointF::dotProduct( direction, direction ) );
+    if ( length <= 0.0 ) return;
+    const QPointF normal = QPointF( -direction.y(), direction.x() ) * ( 0.5 * width / length );
+    appendQuad( vertices, from + normal, to + normal, to - normal, from - normal, color );
+}
+
+// 描边与 QPainter 相同, 以矩形边为中线; 四条边拼成一个框, 角上不重叠
+void appendFrame( std::vector<Vertex>& vertices, const QRectF& rect, float width, const QColor& color ) {
+    const qreal half = 0.5 * width;
+    const QRectF outer = rect.adjusted( -half, -half, half, half );
+    const QRectF inner = rect.adjusted( half, half, -half, -half );
+    if ( inner.width() <= 0.0 || inner.height() <= 0.0 ) {
+        appendRect( vertices, outer, color );
+        return;
+    }
+    appendRect( vertices, QRectF( outer.left(), outer.top(), outer.width(), inner.top() - outer.top() ), color );
+    appendRect( vertices, QRectF( outer.left(), inner.bottom(), outer.width(), outer.bottom() - inner.bottom() ), color );
+    appendRect( vertices, QRectF( outer.left(), inner.top(), inner.left() - outer.left(), inner.height() ), color );
+    appendRect( vertices, QRectF( inner.right(), inner.top(), outer.right() - inner.right(), inner.height() ), color );
+}
+
+void tessellate( const DrawList& list, std::vector<Vertex>& vertices ) {
+    for ( const DrawPrimitive& primitive : list.primitives() ) {
+        switch ( primitive.type ) {
+        case DrawPrimitive::Type::Line:
+            appendLine( vertices, primitive.points[0], primitive.points[1], primitive.width, primitive.color );
+            break;
+        case DrawPrimitive::Type::Rect:
+            if ( primitive.filled ) {
+                appendRect( vertices, primitive.rect, primitive.color );
+            } else {
+                appendFrame( vertices, primitive.rect, primitive.width, primitive.color );
+            }
+            break;
+        case DrawPrimitive::Type::Triangle:
+            appendTriangle( vertices, primitive.points[0], primitive.points[1], primitive.points[2], primitive.color );
+            break;
+        case DrawPrimitive::Type::Text:
+            break;
+        }
+    }
+}
+
+} // namespace
+
+CppSGPainter::CppSGPainter( QQuickItem* parent )
+    : QQuickItem( parent )
+{
+    setFlag( ItemHasContents, true );
+    m_drawList.addText( QPointF( 50, 50 ), "haha", Qt::black );
+}
+
+void CppSGPainter::randomPaint() {
+    m_drawList.addRandomShapes( boundingRect(), *QRandomGenerator::global() );
+    update();
+}
+
+void CppSGPainter::drawLine( qreal x1, qreal y1, qreal x2, qreal y2, const QColor& color, qreal width ) {
+    m_drawList.addLine( QPointF( x1, y1 ), QPointF( x2, y2 ), color, float( width ) );
+    update();
+}
+
+void CppSGPainter::drawRect( qreal x, qreal y, qreal width, qreal height, const QColor& color, bool filled ) {
+    m_drawList.addRect( QRectF( x, y, width, height ), color, filled );
+    update();
+}
+
+void CppSGPainter::drawTriangle( qreal x1, qreal y1, qreal x2, qreal y2, qreal x3, qreal y3, const QColor& color ) {
+    m_drawList.addTriangle( QPointF( x1, y1 ), QPointF( x2, y2 ), QPointF( x3, y3 ), color );
+    update();
+}
+
+void CppSGPainter::drawText( qreal x, qreal y, const QString& text, const QColor& color, int pixelSize ) {
+    m_drawList.addText( QPointF( x, y ), text, color, pixelSize );
+    update();
+}
+
+void CppSGPainter::clear() {
+    m_drawList.clear();
+    update();
+}
+
+void CppSGPainter::outputString( const QString& str ) {
+    qDebug() << str;
+}
+
+QSGNode* CppSGPainter::updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* ) {
+    PainterNode* root = static_cast<PainterNode*>( oldNode );
+    if ( !root ) {
+        root = new PainterNode;
+
+        QSGGeometry* geometry = new QSGGeometry( QSGGeometry::defaultAttributes_ColoredPoint2D(), 0 );
+        geometry->setDrawingMode( QSGGeometry::DrawTriangles );
+        root->geometry = new QSGGeometryNode;
+        root->geometry->setGeometry( geometry );
+        root->geometry->setFlag( QSGNode::OwnsGeometry );
+        root->geometry->setMaterial( new QSGVertexColorMaterial );
+        root->geometry->setFlag( QSGNode::OwnsMaterial );
+        root->appendChildNode( root->geometry );
+
+        root->texts = new QSGNode;
+        root->appendChildNode( root->texts );
+    }
+
+    // 几何: 全部重新展开进同一个顶点缓冲, 一个节点一次绘制
+    if ( !root->built || root->geometryRevision != m_drawList.geometryRevision() ) {
+        std::vector<Vertex> vertices;
+        vertices.reserve( m_drawList.primitives().size() * 6 );
+        tessellate( m_drawList, vertices );
+
+        QSGGeometry* geometry = root->geometry->geometry();
+        geometry->allocate( int( vertices.size() ) );
+        if ( !vertices.empty() ) {
+            std::memcpy( geometry->vertexDataAsColoredPoint2D(), vertices.data(), vertices.size() * sizeof( Vertex ) );
+        }
+        root->geometry->markDirty( QSGNode::DirtyGeometry );
+        root->geometryRevision = m_drawList.geometryRevision();
+    }
+
+    // 文字: 每个文字图元一个 QSGTextNode, 字形由场景图的字形缓存管理
+    if ( !root->built || root->textRevision != m_drawList.textRevision() ) {
+        while ( QSGNode* child = root->texts->firstChild() ) {
+            root->texts->removeChildNode( child );
+            delete child;
+        }
+        for ( const DrawPrimitive& primitive : m_drawList.primitives() ) {
+            if ( primitive.type != DrawPrimitive::Type::Text ) continue;
+
+            QFont font;
+            font.setPixelSize( primitive.pixelSize );
+            QTextLayout layout( primitive.text, font );
+            layout.beginLayout();
+            QTextLine line = layout.createLine();
+            layout.endLayout();
+            if ( !line.isValid() ) continue;
+
+            // 与 QPainter::drawText 一致, 给出的点是基线起点
+            QSGTextNode* text = window()->createTextNode();
+            text->setColor( primitive.color );
+            text->addTextLayout( primitive.points[0] - QPointF( 0.0, line.ascent() ), &layout );
+            root->texts->appendChildNode( text );
+        }
+        root->textRevision = m_drawList.textRevision();
+    }
+
+    root->built = true;
+    return root;
+}
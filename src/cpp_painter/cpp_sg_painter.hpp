@@ -0,0 +1,36 @@
+// 单一职责: CppPainter 的场景图版本, 图元直接变成场景图节点, 不经过 CPU 光栅化和纹理上传
+// 所有线 / 矩形 / 三角形合并进一个带顶点颜色的 QSGGeometryNode (一次绘制), 文字用 QSGTextNode
+// 只有图元变化时才重建对应的节点, 其余帧场景图原样复用
+#pragma once
+
+#include "draw_list.hpp"
+
+#include <QQuickItem>
+#include <QtQml/qqmlregistration.h>
+
+class CppSGPainter : public QQuickItem {
+    Q_OBJECT
+    QML_ELEMENT     // 自动注册为QML组件
+
+public:
+    explicit CppSGPainter( QQuickItem* parent = nullptr );
+
+    Q_INVOKABLE void randomPaint();
+
+    // 图元接口与 CppPainter 相同, 坐标为 item 的本地坐标
+    Q_INVOKABLE void drawLine( qreal x1, qreal y1, qreal x2, qreal y2, const QColor& color, qreal width = 1.0 );
+    Q_INVOKABLE void drawRect( qreal x, qreal y, qreal width, qreal height, const QColor& color, bool filled = true );
+    Q_INVOKABLE void drawTriangle( qreal x1, qreal y1, qreal x2, qreal y2, qreal x3, qreal y3, const QColor& color );
+    Q_INVOKABLE void drawText( qreal x, qreal y, const QString& text, const QColor& color, int pixelSize = 16 );
+    Q_INVOKABLE void clear();
+
+public slots:
+    void outputString( const QString& str );
+
+protected:
+    // 渲染线程在同步阶段调用, 此时 GUI 线程阻塞, 可以直接读取 m_drawList
+    QSGNode* updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* data ) override;
+
+private:
+    DrawList m_drawList;
+};
@@ -0,0 +1,198 @@
+#include "cpp_watermark.hpp"
+
+#include <QDebug>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGTextureMaterial>
+#include <QtMath>
+#include <rhi/qrhi.h>
+
+namespace {
+
+// 一个重复寻址的纹理四边形, 纹理归节点所有
+class WatermarkNode : public QSGGeometryNode {
+public:
+    WatermarkNode()
+        : geometry( QSGGeometry::defaultAttributes_TexturedPoint2D(), 4 )
+    {
+        material.setFiltering( QSGTexture::Linear );
+        material.setHorizontalWrapMode( QSGTexture::Repeat );
+        material.setVerticalWrapMode( QSGTexture::Repeat );
+        setGeometry( &geometry );
+        setMaterial( &material );
+    }
+    ~WatermarkNode() override { delete texture; }
+
+    QSGGeometry geometry;
+    QSGTextureMaterial material;
+    QSGTexture* texture = nullptr;
+    qreal devicePixelRatio = 0.0;
+};
+
+int powerOfTwoAtLeast( int value ) {
+    int result = 1;
+    while ( result < value ) result *= 2;
+    return result;
+}
+
+// OpenGL ES 2 等后端不支持非 2 的幂纹理的重复寻址
+bool needsPowerOfTwo( QQuickWindow* window ) {
+    QRhi* rhi = window->rhi();
+    return rhi && !rhi->isFeatureSupported( QRhi::NPOTTextureRepeat );
+}
+
+} // namespace
+
+CppWatermark::CppWatermark( QQuickItem* parent )
+    : QQuickItem( parent )
+{
+    setFlag( ItemHasContents, true );
+    m_font.setPixelSize( 16 );
+}
+
+void CppWatermark::setText( const QString& text ) {
+    if ( text == m_text ) return;
+    m_text = text;
+    invalidateCell();
+    emit textChanged();
+}
+
+void CppWatermark::setImage( const QUrl& image ) {
+    if ( image == m_image ) return;
+    m_image = image;
+
+    QString path;
+    if ( image.isLocalFile() ) {
+        path = image.toLocalFile();
+    } else if ( image.scheme() == "qrc" ) {
+        path = ":" + image.path();
+    } else if ( !image.isEmpty() ) {
+        qDebug() << "Unsupported watermark image:" << image;
+    }
+    m_markImage = path.isEmpty() ? QImage() : QImage( path );
+    if ( !path.isEmpty() && m_markImage.isNull() ) {
+        qDebug() << "Failed to load watermark image:" << path;
+    }
+    invalidateCell();
+    emit imageChanged();
+}
+
+void CppWatermark::setMarkSize( const QSize& markSize ) {
+    if ( markSize == m_markSize ) return;
+    m_markSize = markSize;
+    invalidateCell();
+    emit markSizeChanged();
+}
+
+void CppWatermark::setGap( const QPointF& gap ) {
+    if ( gap == m_gap ) return;
+    m_gap = gap;
+    invalidateCell();
+    emit gapChanged();
+}
+
+void CppWatermark::setOffset( const QPointF& offset ) {
+    if ( offset == m_offset ) return;
+    m_offset = offset;
+    // 只平移纹理坐标, 单元不用重画
+    update();
+    emit offsetChanged();
+}
+
+void CppWatermark::setRotate( qreal rotate ) {
+    if ( qFuzzyCompare( rotate, m_rotate ) ) return;
+    m_rotate = rotate;
+    invalidateCell();
+    emit rotateChanged();
+}
+
+void CppWatermark::setFont( const QFont& font ) {
+    if ( font == m_font ) return;
+    m_font = font;
+    invalidateCell();
+    emit fontChanged();
+}
+
+void CppWatermark::setColorText( const QColor& colorText ) {
+    if ( colorText == m_colorText ) return;
+    m_colorText = colorText;
+    invalidateCell();
+    emit colorTextChanged();
+}
+
+void CppWatermark::invalidateCell() {
+    m_cellDirty = true;
+    update();
+}
+
+QSizeF CppWatermark::cellSize() const {
+    return QSizeF( std::max( m_markSize.width() + m_gap.x(), 1.0 ), std::max( m_markSize.height() + m_gap.y(), 1.0 ) );
+}
+
+QImage CppWatermark::renderCell( qreal devicePixelRatio ) const {
+    const QSizeF cell = cellSize();
+    QImage image( qCeil( cell.width() * devicePixelRatio ), qCeil( cell.height() * devicePixelRatio ),
+                  QImage::Format_ARGB32_Premultiplied );
+    image.setDevicePixelRatio( devicePixelRatio );
+    image.fill( Qt::transparent );
+
+    // 水印绕单元中心旋转, 超出单元的部分被裁掉
+    QPainter painter( &image );
+    painter.setRenderHint( QPainter::Antialiasing );
+    painter.setRenderHint( QPainter::TextAntialiasing );
+    painter.setRenderHint( QPainter::SmoothPixmapTransform );
+    painter.translate( cell.width() / 2, cell.height() / 2 );
+    painter.rotate( m_rotate );
+    const QRectF markRect( -m_markSize.width() / 2.0, -m_markSize.height() / 2.0, m_markSize.width(), m_markSize.height() );
+    if ( !m_markImage.isNull() ) {
+        painter.drawImage( markRect, m_markImage );
+    } else {
+        painter.setFont( m_font );
+        painter.setPen( m_colorText );
+        painter.drawText( markRect, Qt::AlignCenter, m_text );
+    }
+    return image;
+}
+
+void CppWatermark::geometryChange( const QRectF& newGeometry, const QRectF& oldGeometry ) {
+    QQuickItem::geometryChange( newGeometry, oldGeometry );
+    // 只需要重新计算纹理坐标
+    if ( newGeometry.size() != oldGeometry.size() ) update();
+}
+
+QSGNode* CppWatermark::updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* ) {
+    WatermarkNode* node = static_cast<WatermarkNode*>( oldNode );
+    if ( width() <= 0 || height() <= 0 || ( m_text.isEmpty() && m_markImage.isNull() ) ) {
+        delete node;
+        m_cellDirty = true;
+        return nullptr;
+    }
+    if ( !node ) node = new WatermarkNode;
+
+    // 单元内容或设备像素比变化时重画并重新上传这一个单元
+    const qreal devicePixelRatio = window()->effectiveDevicePixelRatio();
+    if ( m_cellDirty || devicePixelRatio != node->devicePixelRatio ) {
+        QImage image = renderCell( devicePixelRatio );
+        if ( needsPowerOfTwo( window() ) ) {
+            // 拉伸到 2 的幂, 纹理坐标按单元的逻辑大小计算, 显示大小不变
+            image = image.scaled( powerOfTwoAtLeast( image.width() ), powerOfTwoAtLeast( image.height() ),
+                                  Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+        }
+        // 不进图集: 图集里的子纹理不能重复寻址
+        delete node->texture;
+        node->texture = window()->createTextureFromImage( image, QQuickWindow::TextureHasAlphaChannel );
+        node->material.setTexture( node->texture );
+        node->devicePixelRatio = devicePixelRatio;
+        node->markDirty( QSGNode::DirtyMaterial );
+        m_cellDirty = false;
+    }
+
+    // 一个四边形覆盖整个 item, 纹理坐标以单元为单位, 原点在 offset
+    const QSizeF cell = cellSize();
+    const QRectF textureRect( -m_offset.x() / cell.width(), -m_offset.y() / cell.height(),
+                              width() / cell.width(), height() / cell.height() );
+    QSGGeometry::updateTexturedRectGeometry( &node->geometry, boundingRect(), textureRect );
+    node->markDirty( QSGNode::DirtyGeometry );
+    return node;
+}
@@ -0,0 +1,91 @@
+// 单一职责: HusWatermark 的场景图版本, 属性相同, 可以在 QML 中直接替换
+// 只把一个单元 (水印 + 间距) 光栅化成纹理, 整个 item 用一个重复寻址的纹理四边形铺满;
+// 属性变化时重画这一个单元, 尺寸变化只改纹理坐标, 不再按整个窗口重新光栅化
+#pragma once
+
+#include <QColor>
+#include <QFont>
+#include <QImage>
+#include <QPointF>
+#include <QQuickItem>
+#include <QSize>
+#include <QUrl>
+#include <QtQml/qqmlregistration.h>
+
+class CppWatermark : public QQuickItem {
+    Q_OBJECT
+    QML_ELEMENT     // 自动注册为QML组件
+    Q_PROPERTY(QString text READ text WRITE setText NOTIFY textChanged FINAL)
+    Q_PROPERTY(QUrl image READ image WRITE setImage NOTIFY imageChanged FINAL)
+    Q_PROPERTY(QSize markSize READ markSize WRITE setMarkSize NOTIFY markSizeChanged FINAL)
+    Q_PROPERTY(QPointF gap READ gap WRITE setGap NOTIFY gapChanged FINAL)
+    Q_PROPERTY(QPointF offset READ offset WRITE setOffset NOTIFY offsetChanged FINAL)
+    Q_PROPERTY(qreal rotate READ rotate WRITE setRotate NOTIFY rotateChanged FINAL)
+    Q_PROPERTY(QFont font READ font WRITE setFont NOTIFY fontChanged FINAL)
+    Q_PROPERTY(QColor colorText READ colorText WRITE setColorText NOTIFY colorTextChanged FINAL)
+
+public:
+    explicit CppWatermark( QQuickItem* parent = nullptr );
+
+    QString text() const { return m_text; }
+    void setText( const QString& text );
+
+    // 支持本地文件和 qrc, 设置了图片时只画图片
+    QUrl image() const { return m_image; }
+    void setImage( const QUrl& image );
+
+    QSize markSize() const { return m_markSize; }
+    void setMarkSize( const QSize& markSize );
+
+    QPointF gap() const { return m_gap; }
+    void setGap( const QPointF& gap );
+
+    // 第一个单元左上角相对 item 的位置
+    QPointF offset() const { return m_offset; }
+    void setOffset( const QPointF& offset );
+
+    qreal rotate() const { return m_rotate; }
+    void setRotate( qreal rotate );
+
+    QFont font() const { return m_font; }
+    void setFont( const QFont& font );
+
+    QColor colorText() const { return m_colorText; }
+    void setColorText( const QColor& colorText );
+
+signals:
+    void textChanged();
+    void imageChanged();
+    void markSizeChanged();
+    void gapChanged();
+    void offsetChanged();
+    void rotateChanged();
+    void fontChanged();
+    void colorTextChanged();
+
+protected:
+    // 渲染线程在同步阶段调用, 此时 GUI 线程阻塞, 可以直接读取属性
+    QSGNode* updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* data ) override;
+    void geometryChange( const QRectF& newGeometry, const QRectF& oldGeometry ) override;
+
+private:
+    // 一个单元的逻辑大小: 水印加上两个方向的间距
+    QSizeF cellSize() const;
+
+    // 按设备像素比画出一个单元, 水印旋转后居中
+    QImage renderCell( qreal devicePixelRatio ) const;
+
+    // 单元内容变化, 下一帧重新光栅化
+    void invalidateCell();
+
+    QString m_text;
+    QUrl m_image;
+    QImage m_markImage;
+    QSize m_markSize = QSize( 120, 64 );
+    QPointF m_gap = QPointF( 100, 100 );
+    QPointF m_offset = QPointF( 50, 50 );
+    qreal m_rotate = -22;
+    QFont m_font;
+    QColor m_colorText = QColor( 0, 0, 0, 38 );
+    bool m_cellDirty = true;
+};
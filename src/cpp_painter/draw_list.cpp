@@ -0,0 +1,147 @@
+#include "draw_list.hpp"
+
+#include <QPainter>
+#include <QPolygonF>
+#include <QRandomGenerator>
+#include <algorithm>
+
+void DrawList::addLine( const QPointF& from, const QPointF& to, const QColor& color, float width ) {
+    DrawPrimitive primitive;
+    primitive.type = DrawPrimitive::Type::Line;
+    primitive.points[0] = from;
+    primitive.points[1] = to;
+    primitive.color = color;
+    primitive.width = width;
+    m_primitives.push_back( primitive );
+    ++m_geometryRevision;
+}
+
+void DrawList::addRect( const QRectF& rect, const QColor& color, bool filled, float width ) {
+    DrawPrimitive primitive;
+    primitive.type = DrawPrimitive::Type::Rect;
+    primitive.rect = rect.normalized();
+    primitive.color = color;
+    primitive.filled = filled;
+    primitive.width = width;
+    m_primitives.push_back( primitive );
+    ++m_geometryRevision;
+}
+
+void DrawList::addTriangle( const QPointF& a, const QPointF& b, const QPointF& c, const QColor& color ) {
+    DrawPrimitive primitive;
+    primitive.type = DrawPrimitive::Type::Triangle;
+    primitive.points[0] = a;
+    primitive.points[1] = b;
+    primitive.points[2] = c;
+    primitive.color = color;
+    m_primitives.push_back( primitive );
+    ++m_geometryRevision;
+}
+
+void DrawList::addText( const QPointF& baseline, const QString& text, const QColor& color, int pixelSize ) {
+    DrawPrimitive primitive;
+    primitive.type = DrawPrimitive::Type::Text;
+    primitive.points[0] = baseline;
+    primitive.text = text;
+    primitive.color = color;
+    primitive.pixelSize = pixelSize;
+    primitive.rect = TextCache::instance().boundingRect( text, pixelSize ).translated( baseline );
+    m_primitives.push_back( primitive );
+    ++m_textRevision;
+}
+
+void DrawList::addRandomShapes( const QRectF& bounds, QRandomGenerator& random ) {
+    const auto randomPoint = [&]() {
+        return QPointF( bounds.left() + random.bounded( bounds.width() ), bounds.top() + random.bounded( bounds.height() ) );
+    };
+    const auto randomColor = [&]() {
+        return QColor::fromHsv( random.bounded( 360 ), 160 + random.bounded( 96 ), 200 + random.bounded( 56 ), 200 );
+    };
+
+    // 三角形边长限制在 bounds 的四分之一左右, 避免一个三角形盖住整个窗口
+    const QPointF center = randomPoint();
+    const qreal extent = qMin( bounds.width(), bounds.height() ) * 0.125;
+    const auto around = [&]() {
+        return center + QPointF( ( random.generateDouble() * 2.0 - 1.0 ) * extent, ( random.generateDouble() * 2.0 - 1.0 ) * extent );
+    };
+    addTriangle( around(), around(), around(), randomColor() );
+    addLine( randomPoint(), randomPoint(), randomColor(), 1.0f + float( random.bounded( 4 ) ) );
+}
+
+void DrawList::clear() {
+    if ( m_primitives.empty() ) return;
+    m_primitives.clear();
+    ++m_geometryRevision;
+    ++m_textRevision;
+}
+
+QRectF DrawList::bounds( const DrawPrimitive& primitive ) {
+    // 抗锯齿会向外多画一个像素
+    constexpr qreal kAntialias = 1.0;
+    switch ( primitive.type ) {
+    case DrawPrimitive::Type::Line: {
+        const qreal margin = 0.5 * primitive.width + kAntialias;
+        return QRectF( primitive.points[0], primitive.points[1] ).normalized().adjusted( -margin, -margin, margin, margin );
+    }
+    case DrawPrimitive::Type::Rect: {
+        const qreal margin = ( primitive.filled ? 0.0 : 0.5 * primitive.width ) + kAntialias;
+        return primitive.rect.adjusted( -margin, -margin, margin, margin );
+    }
+    case DrawPrimitive::Type::Triangle: {
+        const QPointF* p = primitive.points;
+        const qreal left = std::min( { p[0].x(), p[1].x(), p[2].x() } );
+        const qreal top = std::min( { p[0].y(), p[1].y(), p[2].y() } );
+        const qreal right = std::max( { p[0].x(), p[1].x(), p[2].x() } );
+        const qreal bottom = std::max( { p[0].y(), p[1].y(), p[2].y() } );
+        return QRectF( left, top, right - left, bottom - top ).adjusted( -kAntialias, -kAntialias, kAntialias, kAntialias );
+    }
+    case DrawPrimitive::Type::Text:
+        return primitive.rect.adjusted( -kAntialias, -kAntialias, kAntialias, kAntialias );
+    }
+    return QRectF();
+}
+
+QRectF DrawList::bounds() const {
+    QRectF united;
+    for ( const DrawPrimitive& primitive : m_primitives ) {
+        united = united.united( bounds( primitive ) );
+    }
+    return united;
+}
+
+void DrawList::paint( QPainter* painter ) const {
+    paint( painter, QRectF() );
+}
+
+void DrawList::paint( QPainter* painter, const QRectF& clip, TextCache::Mode textMode ) const {
+    painter->setRenderHint( QPainter::Antialiasing );
+    for ( const DrawPrimitive& primitive : m_primitives ) {
+        if ( !clip.isNull() && !bounds( primitive ).intersects( clip ) ) continue;
+        switch ( primitive.type ) {
+        case DrawPrimitive::Type::Line:
+            painter->setPen( QPen( primitive.color, primitive.width ) );
+            painter->drawLine( primitive.points[0], primitive.points[1] );
+            break;
+        case DrawPrimitive::Type::Rect:
+            if ( primitive.filled ) {
+                painter->fillRect( primitive.rect, primitive.color );
+            } else {
+                painter->setPen( QPen( primitive.color, primitive.width ) );
+                painter->setBrush( Qt::NoBrush );
+                painter->drawRect( primitive.rect );
+            }
+            break;
+        case DrawPrimitive::Type::Triangle: {
+            const QPolygonF polygon( { primitive.points[0], primitive.points[1], primitive.points[2] } );
+            painter->setPen( Qt::NoPen );
+            painter->setBrush( primitive.color );
+            painter->drawPolygon( polygon );
+            break;
+        }
+        case DrawPrimitive::Type::Text:
+            // 相同的文字只整形一次, 图集模式下字形也只光栅化一次
+            TextCache::instance().draw( painter, primitive.points[0], primitive.text, primitive.color, primitive.pixelSize, textMode );
+            break;
+        }
+    }
+}
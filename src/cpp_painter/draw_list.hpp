@@ -0,0 +1,74 @@
+// 单一职责: 保存绘制图元 (线 / 矩形 / 三角形 / 文字), 供 CppPainter 和 CppSGPainter 共用
+// 图元只记录不绘制: QPainter 路径用 paint() 回放, 场景图路径把它们转成批量的几何节点
+// 几何和文字分别计数修订号, 场景图只重建真正变化的部分
+// 每个图元可以求出覆盖范围 (含线宽和抗锯齿), CppPainter 据此只重绘变化的区域
+#pragma once
+
+#include "text_cache.hpp"
+
+#include <QColor>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+class QPainter;
+class QRandomGenerator;
+
+struct DrawPrimitive {
+    enum class Type {
+        Line,
+        Rect,
+        Triangle,
+        Text,
+    };
+
+    Type type = Type::Line;
+    QPointF points[3];          // 线用前两个点, 三角形用三个点, 文字用第一个点 (基线起点)
+    QRectF rect;                // 矩形; 文字图元保存加入时量出的范围
+    QColor color;
+    float width = 1.0f;         // 线宽, 矩形描边宽度
+    bool filled = true;         // 矩形: 填充或只描边
+    QString text;
+    int pixelSize = 16;         // 文字像素大小
+};
+
+class DrawList {
+public:
+    DrawList() = default;
+
+    void addLine( const QPointF& from, const QPointF& to, const QColor& color, float width = 1.0f );
+    void addRect( const QRectF& rect, const QColor& color, bool filled = true, float width = 1.0f );
+    void addTriangle( const QPointF& a, const QPointF& b, const QPointF& c, const QColor& color );
+    void addText( const QPointF& baseline, const QString& text, const QColor& color, int pixelSize = 16 );
+
+    // 在 bounds 内随机加一个三角形和一条线, randomPaint() 使用
+    void addRandomShapes( const QRectF& bounds, QRandomGenerator& random );
+
+    void clear();
+
+    const std::vector<DrawPrimitive>& primitives() const { return m_primitives; }
+    bool isEmpty() const { return m_primitives.empty(); }
+
+    // 几何图元 (线 / 矩形 / 三角形) 或文字变化时递增
+    uint64_t geometryRevision() const { return m_geometryRevision; }
+    uint64_t textRevision() const { return m_textRevision; }
+
+    // 图元可能触及的像素范围, 线宽和抗锯齿都计算在内
+    static QRectF bounds( const DrawPrimitive& primitive );
+
+    // 全部图元范围的并集
+    QRectF bounds() const;
+
+    // 用 QPainter 按顺序回放全部图元
+    void paint( QPainter* painter ) const;
+
+    // 只回放与 clip 相交的图元, 分块重绘时使用; 文字经过共享的 TextCache
+    void paint( QPainter* painter, const QRectF& clip, TextCache::Mode textMode = TextCache::Mode::StaticText ) const;
+
+private:
+    std::vector<DrawPrimitive> m_primitives;
+    uint64_t m_geometryRevision = 0;
+    uint64_t m_textRevision = 0;
+};
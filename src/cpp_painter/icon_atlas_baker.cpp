@@ -0,0 +1,39 @@
+// 构建时运行的图标图集烘焙工具: iconAtlasBaker <字体文件> <输出目录> [首码位 末码位]
+// 默认烘焙整个基本多文种平面的私用区, HusIcon::Type 的所有码位都在其中
+#include "msdf_atlas.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QRawFont>
+
+int main( int argc, char* argv[] ) {
+    // QRawFont 需要字体数据库, 用 offscreen 平台以免构建机上没有显示
+    qputenv( "QT_QPA_PLATFORM", "offscreen" );
+    QGuiApplication app( argc, argv );
+
+    const QStringList arguments = app.arguments();
+    if ( arguments.size() != 3 && arguments.size() != 5 ) {
+        qDebug() << "Usage: iconAtlasBaker <font> <output directory> [first last]";
+        return 1;
+    }
+    uint32_t first = 0xe000;
+    uint32_t last = 0xf8ff;
+    if ( arguments.size() == 5 ) {
+        first = arguments[3].toUInt( nullptr, 0 );
+        last = arguments[4].toUInt( nullptr, 0 );
+    }
+
+    const QRawFont font( arguments[1], MsdfAtlas::kPixelSize );
+    if ( !font.isValid() ) {
+        qDebug() << "Failed to load font" << arguments[1];
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    MsdfAtlas atlas;
+    if ( !atlas.bake( font, first, last ) || !atlas.save( arguments[2] ) ) return 1;
+    qDebug() << "Baked" << atlas.glyphCount() << "icons into" << atlas.image().size() << "in" << timer.elapsed() << "ms";
+    return 0;
+}
@@ -0,0 +1,380 @@
+#include "msdf_atlas.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainterPath>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int kPadding = int( MsdfAtlas::kDistanceRange / 2 ) + 1;
+constexpr int kCurveSteps = 8;              // 每段三次曲线展开成的折线数
+constexpr double kCornerSine = 0.1411;      // sin(3 rad), 与 msdfgen 默认的拐角阈值相同
+constexpr double kTieEpsilon = 1e-4;
+
+constexpr int kRed = 1;
+constexpr int kGreen = 2;
+constexpr int kBlue = 4;
+constexpr int kWhite = kRed | kGreen | kBlue;
+constexpr int kCyan = kGreen | kBlue;
+constexpr int kMagenta = kRed | kBlue;
+constexpr int kYellow = kRed | kGreen;
+
+const QString kImageName = QStringLiteral( "icon_atlas.png" );
+const QString kMetaName = QStringLiteral( "icon_atlas.json" );
+
+// 轮廓的一段 (直线或三次曲线), 曲线已展开成折线
+struct Segment {
+    std::vector<QPointF> points;
+    QPointF startTangent;
+    QPointF endTangent;
+};
+using Contour = std::vector<Segment>;
+
+// 展开后的一条直线边
+struct Edge {
+    QPointF a;
+    QPointF b;
+    int channels = kWhite;
+    bool extendStart = false;   // a 是原始段的端点: 越过它时按到延长线的距离 (伪距离) 计算
+    bool extendEnd = false;
+    double inside = 1.0;        // 左侧为形状内部时为 1, 否则为 -1
+};
+
+double dot( const QPointF& a, const QPointF& b ) { return a.x() * b.x() + a.y() * b.y(); }
+double cross( const QPointF& a, const QPointF& b ) { return a.x() * b.y() - a.y() * b.x(); }
+double length( const QPointF& a ) { return std::sqrt( dot( a, a ) ); }
+
+QPointF normalized( const QPointF& a ) {
+    const double len = length( a );
+    return len > 0.0 ? a / len : QPointF();
+}
+
+QPointF firstNonZero( std::initializer_list<QPointF> candidates ) {
+    for ( const QPointF& candidate : candidates ) {
+        if ( !candidate.isNull() ) return candidate;
+    }
+    return QPointF();
+}
+
+std::vector<Contour> contours( const QPainterPath& path ) {
+    std::vector<Contour> result;
+    QPointF start;
+    QPointF current;
+    const auto closeContour = [&]() {
+        if ( !result.empty() && !result.back().empty() && current != start ) {
+            result.back().push_back( Segment{ { current, start }, start - current, start - current } );
+        }
+        current = start;
+    };
+
+    for ( int i = 0; i < path.elementCount(); ++i ) {
+        const QPainterPath::Element element = path.elementAt( i );
+        const QPointF point( element.x, element.y );
+        if ( element.isMoveTo() ) {
+            closeContour();
+            result.emplace_back();
+            start = current = point;
+        } else if ( element.isLineTo() ) {
+            if ( point == current ) continue;
+            result.back().push_back( Segment{ { current, point }, point - current, point - current } );
+            current = point;
+        } else if ( element.isCurveTo() && i + 2 < path.elementCount() ) {
+            const QPointF c1 = point;
+            const QPointF c2( path.elementAt( i + 1 ).x, path.elementAt( i + 1 ).y );
+            const QPointF end( path.elementAt( i + 2 ).x, path.elementAt( i + 2 ).y );
+            i += 2;
+            Segment segment;
+            for ( int step = 0; step <= kCurveSteps; ++step ) {
+                const double t = double( step ) / kCurveSteps;
+                const double s = 1.0 - t;
+                segment.points.push_back( s * s * s * current + 3 * s * s * t * c1 + 3 * s * t * t * c2 + t * t * t * end );
+            }
+            segment.startTangent = firstNonZero( { c1 - current, c2 - current, end - current } );
+            segment.endTangent = firstNonZero( { end - c2, end - c1, end - current } );
+            if ( !segment.startTangent.isNull() ) result.back().push_back( std::move( segment ) );
+            current = end;
+        }
+    }
+    closeContour();
+    return result;
+}
+
+// 按拐角给轮廓的各段分配通道: 拐角两侧的段至少有一个通道不同, 中值才能保留拐角
+std::vector<int> colorContour( const Contour& contour ) {
+    const int count = int( contour.size() );
+    std::vector<int> corners;
+    for ( int i = 0; i < count; ++i ) {
+        const QPointF before = normalized( contour[( i + count - 1 ) % count].endTangent );
+        const QPointF after = normalized( contour[i].startTangent );
+        if ( dot( before, after ) <= 0.0 || std::abs( cross( before, after ) ) > kCornerSine ) corners.push_back( i );
+    }
+
+    std::vector<int> colors( count, kWhite );
+    if ( corners.empty() ) return colors;
+
+    if ( corners.size() == 1 ) {
+        // 水滴形: 从唯一的拐角开始分成三份, 两端颜色不同
+        const int parts[3] = { kMagenta, kWhite, kYellow };
+        for ( int k = 0; k < count; ++k ) {
+            colors[( corners[0] + k ) % count] = parts[std::min( 2, 3 * k / count )];
+        }
+        return colors;
+    }
+
+    const int cycle[3] = { kCyan, kMagenta, kYellow };
+    const int splines = int( corners.size() );
+    for ( int spline = 0; spline < splines; ++spline ) {
+        int color = cycle[spline % 3];
+        // 最后一段与第一段相邻, 颜色相同时换成第三种
+        if ( spline == splines - 1 && splines % 3 == 1 ) color = cycle[1];
+        const int first = corners[spline];
+        const int last = corners[( spline + 1 ) % splines];
+        int i = first;
+        do {
+            colors[i] = color;
+            i = ( i + 1 ) % count;
+        } while ( i != last );
+    }
+    return colors;
+}
+
+// 非零环绕规则, 与字体轮廓的填充规则一致; side 是 p 相对边的叉积
+int crossing( const Edge& edge, const QPointF& p, double side ) {
+    if ( edge.a.y() <= p.y() && edge.b.y() > p.y() && side > 0 ) return 1;
+    if ( edge.b.y() <= p.y() && edge.a.y() > p.y() && side < 0 ) return -1;
+    return 0;
+}
+
+int winding( const std::vector<Edge>& edges, const QPointF& p ) {
+    int result = 0;
+    for ( const Edge& edge : edges ) {
+        result += crossing( edge, p, cross( edge.b - edge.a, p - edge.a ) );
+    }
+    return result;
+}
+
+std::vector<Edge> edges( const QPainterPath& path ) {
+    std::vector<Edge> result;
+    for ( const Contour& contour : contours( path ) ) {
+        const std::vector<int> colors = colorContour( contour );
+        for ( size_t s = 0; s < contour.size(); ++s ) {
+            const std::vector<QPointF>& points = contour[s].points;
+            for ( size_t i = 1; i < points.size(); ++i ) {
+                if ( points[i] == points[i - 1] ) continue;
+                Edge edge;
+                edge.a = points[i - 1];
+                edge.b = points[i];
+                edge.channels = colors[s];
+                edge.extendStart = i == 1;
+                edge.extendEnd = i + 1 == points.size();
+                result.push_back( edge );
+            }
+        }
+    }
+    // 在每条边中点的左侧取一点判断内外, 与轮廓方向无关
+    for ( Edge& edge : result ) {
+        const QPointF direction = normalized( edge.b - edge.a );
+        const QPointF probe = ( edge.a + edge.b ) / 2 + QPointF( -direction.y(), direction.x() ) * 0.01;
+        edge.inside = winding( result, probe ) != 0 ? 1.0 : -1.0;
+    }
+    return result;
+}
+
+uchar encode( double distance ) {
+    return uchar( std::clamp( ( distance / MsdfAtlas::kDistanceRange + 0.5 ) * 255.0 + 0.5, 0.0, 255.0 ) );
+}
+
+double median( double a, double b, double c ) {
+    return std::max( std::min( a, b ), std::min( std::max( a, b ), c ) );
+}
+
+// origin 是纹素 (0, 0) 左上角在字形坐标中的位置
+void renderGlyph( const std::vector<Edge>& edges, const QPointF& origin, QImage& image, const QRect& target ) {
+    struct Nearest {
+        double distance = std::numeric_limits<double>::infinity();
+        double orthogonality = 1.0;
+        const Edge* edge = nullptr;
+        double t = 0.0;
+    };
+
+    for ( int y = 0; y < target.height(); ++y ) {
+        uchar* line = image.scanLine( target.y() + y ) + target.x() * 3;
+        for ( int x = 0; x < target.width(); ++x ) {
+            const QPointF p = origin + QPointF( x + 0.5, y + 0.5 );
+            Nearest nearest[3];
+            double trueDistance = std::numeric_limits<double>::infinity();
+            int windingNumber = 0;
+            for ( const Edge& edge : edges ) {
+                const QPointF ab = edge.b - edge.a;
+                windingNumber += crossing( edge, p, cross( ab, p - edge.a ) );
+                const double t = dot( p - edge.a, ab ) / dot( ab, ab );
+                const QPointF offset = p - ( edge.a + std::clamp( t, 0.0, 1.0 ) * ab );
+                const double distance = length( offset );
+                trueDistance = std::min( trueDistance, distance );
+                // 同一个顶点到两条边距离相等时, 取与连线更垂直的那条 (它的伪距离更准确)
+                const double orthogonality = distance > 0.0 ? std::abs( dot( normalized( ab ), offset / distance ) ) : 0.0;
+                for ( int c = 0; c < 3; ++c ) {
+                    if ( !( edge.channels & ( 1 << c ) ) ) continue;
+                    Nearest& best = nearest[c];
+                    if ( distance < best.distance - kTieEpsilon
+                         || ( distance < best.distance + kTieEpsilon && orthogonality < best.orthogonality ) ) {
+                        best = Nearest{ distance, orthogonality, &edge, t };
+                    }
+                }
+            }
+
+            const double sign = windingNumber != 0 ? 1.0 : -1.0;
+            double values[3];
+            for ( int c = 0; c < 3; ++c ) {
+                const Nearest& best = nearest[c];
+                if ( !best.edge ) {
+                    values[c] = sign * trueDistance;
+                } else if ( ( best.t < 0.0 && best.edge->extendStart ) || ( best.t > 1.0 && best.edge->extendEnd ) ) {
+                    const QPointF ab = best.edge->b - best.edge->a;
+                    values[c] = best.edge->inside * cross( ab, p - best.edge->a ) / length( ab );
+                } else {
+                    values[c] = sign * best.distance;
+                }
+            }
+            // 中值与真实内外不符 (几条边在纹素附近交错) 时退回单通道距离场
+            if ( ( median( values[0], values[1], values[2] ) > 0.0 ) != ( sign > 0.0 ) ) {
+                values[0] = values[1] = values[2] = sign * trueDistance;
+            }
+            for ( int c = 0; c < 3; ++c ) {
+                line[x * 3 + c] = encode( values[c] );
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool MsdfAtlas::bake( const QRawFont& font, uint32_t first, uint32_t last ) {
+    if ( !font.isValid() ) {
+        qDebug() << "Invalid icon font";
+        return false;
+    }
+    QRawFont raw = font;
+    raw.setPixelSize( kPixelSize );
+    const double ascent = raw.ascent();
+    const double em = raw.ascent() + raw.descent();
+
+    struct Pending {
+        uint32_t codepoint;
+        std::vector<Edge> edges;
+        QRect cell;             // 字形坐标中的纹素范围
+        QPoint position;        // 图集中的左上角
+    };
+    std::vector<Pending> pending;
+    for ( uint32_t codepoint = first; codepoint <= last; ++codepoint ) {
+        if ( !raw.supportsCharacter( codepoint ) ) continue;
+        const char32_t character = codepoint;
+        const QList<quint32> indexes = raw.glyphIndexesForString( QString::fromUcs4( &character, 1 ) );
+        if ( indexes.isEmpty() || indexes.front() == 0 ) continue;
+        const QPainterPath path = raw.pathForGlyph( indexes.front() );
+        if ( path.isEmpty() ) continue;
+
+        const QRectF bounds = path.boundingRect();
+        const int left = int( std::floor( bounds.left() ) ) - kPadding;
+        const int top = int( std::floor( bounds.top() ) ) - kPadding;
+        const int right = int( std::ceil( bounds.right() ) ) + kPadding;
+        const int bottom = int( std::ceil( bounds.bottom() ) ) + kPadding;
+        pending.push_back( Pending{ codepoint, edges( path ), QRect( left, top, right - left, bottom - top ), QPoint() } );
+    }
+    if ( pending.empty() ) {
+        qDebug() << "No glyphs in icon font range" << Qt::hex << first << last;
+        return false;
+    }
+
+    // 按行排列; 图标大小相近, 不需要更紧的装箱
+    int x = 0;
+    int y = 0;
+    int rowHeight = 0;
+    for ( Pending& glyph : pending ) {
+        if ( x + glyph.cell.width() > kMaxWidth ) {
+            x = 0;
+            y += rowHeight;
+            rowHeight = 0;
+        }
+        glyph.position = QPoint( x, y );
+        x += glyph.cell.width();
+        rowHeight = std::max( rowHeight, glyph.cell.height() );
+    }
+
+    m_image = QImage( kMaxWidth, y + rowHeight, QImage::Format_RGB888 );
+    m_image.fill( Qt::black );
+    m_distanceRange = kDistanceRange;
+    m_glyphs.clear();
+    for ( const Pending& glyph : pending ) {
+        const QRect target( glyph.position, glyph.cell.size() );
+        renderGlyph( glyph.edges, glyph.cell.topLeft(), m_image, target );
+        m_glyphs[glyph.codepoint] = MsdfGlyph{ target, QRectF( glyph.cell.x() / em, ( glyph.cell.y() + ascent ) / em,
+                                                               glyph.cell.width() / em, glyph.cell.height() / em ) };
+    }
+    return true;
+}
+
+bool MsdfAtlas::save( const QString& directory ) const {
+    if ( !QDir().mkpath( directory ) ) {
+        qDebug() << "Failed to create" << directory;
+        return false;
+    }
+    if ( !m_image.save( QDir( directory ).filePath( kImageName ), "PNG" ) ) {
+        qDebug() << "Failed to write icon atlas image";
+        return false;
+    }
+
+    QJsonObject glyphs;
+    for ( const auto& [codepoint, glyph] : m_glyphs ) {
+        const QRect& r = glyph.atlasRect;
+        const QRectF& p = glyph.plane;
+        glyphs[QString::number( codepoint )] = QJsonArray{ r.x(), r.y(), r.width(), r.height(), p.x(), p.y(), p.width(), p.height() };
+    }
+    QJsonObject root;
+    root["pixelSize"] = kPixelSize;
+    root["distanceRange"] = m_distanceRange;
+    root["glyphs"] = glyphs;
+
+    QFile file( QDir( directory ).filePath( kMetaName ) );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        qDebug() << "Failed to write icon atlas metadata";
+        return false;
+    }
+    file.write( QJsonDocument( root ).toJson( QJsonDocument::Compact ) );
+    return true;
+}
+
+bool MsdfAtlas::load( const QString& directory ) {
+    QFile file( QDir( directory ).filePath( kMetaName ) );
+    if ( !file.open( QIODevice::ReadOnly ) ) return false;
+    const QJsonObject root = QJsonDocument::fromJson( file.readAll() ).object();
+    const QImage image( QDir( directory ).filePath( kImageName ) );
+    if ( image.isNull() || root.isEmpty() ) {
+        qDebug() << "Broken icon atlas in" << directory;
+        return false;
+    }
+
+    m_image = image;
+    m_distanceRange = float( root["distanceRange"].toDouble( kDistanceRange ) );
+    m_glyphs.clear();
+    const QJsonObject glyphs = root["glyphs"].toObject();
+    for ( auto it = glyphs.begin(); it != glyphs.end(); ++it ) {
+        const QJsonArray v = it.value().toArray();
+        if ( v.size() != 8 ) continue;
+        m_glyphs[it.key().toUInt()] = MsdfGlyph{ QRect( v[0].toInt(), v[1].toInt(), v[2].toInt(), v[3].toInt() ),
+                                                 QRectF( v[4].toDouble(), v[5].toDouble(), v[6].toDouble(), v[7].toDouble() ) };
+    }
+    return true;
+}
+
+const MsdfGlyph* MsdfAtlas::glyph( uint32_t codepoint ) const {
+    const auto it = m_glyphs.find( codepoint );
+    return it == m_glyphs.end() ? nullptr : &it->second;
+}
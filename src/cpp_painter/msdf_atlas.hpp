@@ -0,0 +1,44 @@
+// 单一职责: 把图标字体烘焙成多通道有向距离场 (MSDF) 图集, 以及图集的读写
+// 每个字形的轮廓按拐角分段着色, RGB 三个通道各自只记录部分边的距离, 取三者中值重建时拐角仍然尖锐;
+// 烘焙时另算一份普通的有向距离, 中值符号出错的纹素改用它; 图集不带 alpha, 上传时不会被预乘破坏
+// 图集在构建时由 iconAtlasBaker 生成 (PNG + JSON), 运行时只读文件, 不再整形和光栅化字形
+#pragma once
+
+#include <QImage>
+#include <QRawFont>
+#include <QRect>
+#include <QRectF>
+#include <QString>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct MsdfGlyph {
+    QRect atlasRect;    // 图集中的像素范围, 包含距离场的留边
+    QRectF plane;       // 同一范围在 em 框中的位置, 以 em 框左上角为原点, 单位为 em
+};
+
+class MsdfAtlas {
+public:
+    static constexpr int kPixelSize = 32;       // 烘焙字号, 即 em 框的像素高度
+    static constexpr float kDistanceRange = 4;  // 距离场覆盖的总宽度 (内外各一半), 图集像素
+    static constexpr int kMaxWidth = 2048;
+
+    // 烘焙字体里 [first, last] 中存在的码位, 图集按行依次排列
+    bool bake( const QRawFont& font, uint32_t first, uint32_t last );
+
+    // 目录下的 icon_atlas.png 和 icon_atlas.json
+    bool save( const QString& directory ) const;
+    bool load( const QString& directory );
+
+    bool isValid() const { return !m_image.isNull(); }
+    const QImage& image() const { return m_image; }
+    float distanceRange() const { return m_distanceRange; }
+    const MsdfGlyph* glyph( uint32_t codepoint ) const;
+    size_t glyphCount() const { return m_glyphs.size(); }
+
+private:
+    QImage m_image;
+    float m_distanceRange = kDistanceRange;
+    std::unordered_map<uint32_t, MsdfGlyph> m_glyphs;
+};
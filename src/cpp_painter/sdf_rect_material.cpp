@@ -0,0 +1,149 @@
+#include "sdf_rect_material.hpp"
+
+#include <QMatrix4x4>
+#include <QSGMaterialShader>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+// 抗锯齿的过渡带落在矩形外侧, 四边形向外扩出这么多逻辑像素
+constexpr float kMargin = 1.0f;
+
+class SdfRectShader : public QSGMaterialShader {
+public:
+    SdfRectShader() {
+        setShaderFileName( VertexStage, QStringLiteral( ":/cpp_painter/shaders/sdf_rect.vert.qsb" ) );
+        setShaderFileName( FragmentStage, QStringLiteral( ":/cpp_painter/shaders/sdf_rect.frag.qsb" ) );
+    }
+
+    // uniform 只有场景图自带的矩阵和不透明度, 布局与着色器中的 buf 一致
+    bool updateUniformData( RenderState& state, QSGMaterial*, QSGMaterial* ) override {
+        QByteArray* buffer = state.uniformData();
+        bool changed = false;
+        if ( state.isMatrixDirty() ) {
+            const QMatrix4x4 matrix = state.combinedMatrix();
+            std::memcpy( buffer->data(), matrix.constData(), 64 );
+            changed = true;
+        }
+        if ( state.isOpacityDirty() ) {
+            const float opacity = state.opacity();
+            std::memcpy( buffer->data() + 64, &opacity, sizeof( float ) );
+            changed = true;
+        }
+        return changed;
+    }
+};
+
+void premultiply( const QColor& color, uchar* out ) {
+    const int alpha = color.alpha();
+    out[0] = uchar( color.red() * alpha / 255 );
+    out[1] = uchar( color.green() * alpha / 255 );
+    out[2] = uchar( color.blue() * alpha / 255 );
+    out[3] = uchar( alpha );
+}
+
+// 渐变在 position 处的颜色, 两端之外取端点色标
+QColor gradientColor( const std::vector<std::pair<qreal, QColor>>& stops, qreal position ) {
+    if ( position <= stops.front().first ) return stops.front().second;
+    for ( size_t i = 1; i < stops.size(); ++i ) {
+        if ( position > stops[i].first ) continue;
+        const qreal span = stops[i].first - stops[i - 1].first;
+        const qreal t = span > 0.0 ? ( position - stops[i - 1].first ) / span : 1.0;
+        const QColor& from = stops[i - 1].second;
+        const QColor& to = stops[i].second;
+        return QColor::fromRgbF( float( from.redF() + ( to.redF() - from.redF() ) * t ),
+                                 float( from.greenF() + ( to.greenF() - from.greenF() ) * t ),
+                                 float( from.blueF() + ( to.blueF() - from.blueF() ) * t ),
+                                 float( from.alphaF() + ( to.alphaF() - from.alphaF() ) * t ) );
+    }
+    return stops.back().second;
+}
+
+} // namespace
+
+SdfRectMaterial::SdfRectMaterial() {
+    setFlag( Blending );
+}
+
+const QSGGeometry::AttributeSet& SdfRectMaterial::attributes() {
+    static const QSGGeometry::Attribute data[] = {
+        QSGGeometry::Attribute::createWithAttributeType( 0, 2, QSGGeometry::FloatType, QSGGeometry::PositionAttribute ),
+        QSGGeometry::Attribute::createWithAttributeType( 1, 2, QSGGeometry::FloatType, QSGGeometry::UnknownAttribute ),
+        QSGGeometry::Attribute::createWithAttributeType( 2, 2, QSGGeometry::FloatType, QSGGeometry::UnknownAttribute ),
+        QSGGeometry::Attribute::createWithAttributeType( 3, 4, QSGGeometry::FloatType, QSGGeometry::UnknownAttribute ),
+        QSGGeometry::Attribute::createWithAttributeType( 4, 4, QSGGeometry::UnsignedByteType, QSGGeometry::ColorAttribute ),
+        QSGGeometry::Attribute::createWithAttributeType( 5, 4, QSGGeometry::UnsignedByteType, QSGGeometry::ColorAttribute ),
+        QSGGeometry::Attribute::createWithAttributeType( 6, 1, QSGGeometry::FloatType, QSGGeometry::UnknownAttribute ),
+    };
+    static const QSGGeometry::AttributeSet set = { 7, int( sizeof( SdfRectVertex ) ), data };
+    return set;
+}
+
+QSGMaterialType* SdfRectMaterial::type() const {
+    static QSGMaterialType type;
+    return &type;
+}
+
+QSGMaterialShader* SdfRectMaterial::createShader( QSGRendererInterface::RenderMode ) const {
+    return new SdfRectShader;
+}
+
+int SdfRectMaterial::compare( const QSGMaterial* ) const {
+    // 没有材质参数, 任意两个实例都可以合批
+    return 0;
+}
+
+void appendSdfRect( const SdfRectStyle& style, std::vector<SdfRectVertex>& vertices ) {
+    const QRectF& rect = style.rect;
+    if ( rect.width() <= 0 || rect.height() <= 0 ) return;
+
+    SdfRectVertex base;
+    base.halfWidth = float( rect.width() / 2 );
+    base.halfHeight = float( rect.height() / 2 );
+    const float maxRadius = std::min( base.halfWidth, base.halfHeight );
+    for ( int i = 0; i < 4; ++i ) {
+        base.radii[i] = std::clamp( style.radii[i], 0.0f, maxRadius );
+    }
+    premultiply( style.borderColor, base.border );
+    base.borderWidth = style.borderColor.alpha() > 0 ? std::clamp( style.borderWidth, 0.0f, maxRadius ) : 0.0f;
+
+    // 沿渐变方向切成若干段, 每个色标是一条分界线; 纯色只有首尾两条
+    const bool horizontal = style.gradientOrientation == Qt::Horizontal;
+    const float length = horizontal ? float( rect.width() ) : float( rect.height() );
+    std::vector<float> cuts{ -kMargin };
+    for ( const auto& stop : style.gradient ) {
+        const float cut = float( stop.first ) * length;
+        if ( cut > cuts.back() && cut < length + kMargin ) cuts.push_back( cut );
+    }
+    if ( cuts.back() < length + kMargin ) cuts.push_back( length + kMargin );
+
+    const float centerX = float( rect.center().x() );
+    const float centerY = float( rect.center().y() );
+    const auto vertex = [&]( float along, float across ) {
+        SdfRectVertex v = base;
+        // along 沿渐变方向, across 垂直于它, 都以矩形左上角为原点
+        const float dx = horizontal ? along : across;
+        const float dy = horizontal ? across : along;
+        v.x = float( rect.x() ) + dx;
+        v.y = float( rect.y() ) + dy;
+        v.localX = v.x - centerX;
+        v.localY = v.y - centerY;
+        const QColor color = style.gradient.empty() ? style.color
+                                                    : gradientColor( style.gradient, std::clamp( along / length, 0.0f, 1.0f ) );
+        premultiply( color, v.fill );
+        return v;
+    };
+
+    const float breadth = horizontal ? float( rect.height() ) : float( rect.width() );
+    for ( size_t i = 1; i < cuts.size(); ++i ) {
+        const SdfRectVertex a = vertex( cuts[i - 1], -kMargin );
+        const SdfRectVertex b = vertex( cuts[i - 1], breadth + kMargin );
+        const SdfRectVertex c = vertex( cuts[i], breadth + kMargin );
+        const SdfRectVertex d = vertex( cuts[i], -kMargin );
+        for ( const SdfRectVertex& v : { a, b, c, a, c, d } ) {
+            vertices.push_back( v );
+        }
+    }
+}
@@ -0,0 +1,46 @@
+// 单一职责: 圆角矩形的有向距离场材质, 轮廓 / 边框 / 抗锯齿都在片元着色器里算, 不做 CPU 光栅化
+// 每个矩形的尺寸、四角半径、颜色、边框都写在顶点属性里, 材质本身没有参数,
+// 所有实例的 compare() 相等, 场景图可以把不同 item 的几何合并进同一批一次绘制
+#pragma once
+
+#include <QColor>
+#include <QRectF>
+#include <QSGGeometry>
+#include <QSGMaterial>
+#include <utility>
+#include <vector>
+
+struct SdfRectVertex {
+    float x, y;                     // item 本地坐标
+    float localX, localY;           // 相对矩形中心
+    float halfWidth, halfHeight;
+    float radii[4];                 // 左上 右上 右下 左下
+    uchar fill[4];                  // 预乘 alpha
+    uchar border[4];                // 预乘 alpha
+    float borderWidth;
+};
+
+class SdfRectMaterial : public QSGMaterial {
+public:
+    SdfRectMaterial();
+
+    static const QSGGeometry::AttributeSet& attributes();
+
+    QSGMaterialType* type() const override;
+    QSGMaterialShader* createShader( QSGRendererInterface::RenderMode renderMode ) const override;
+    int compare( const QSGMaterial* other ) const override;
+};
+
+// 一个矩形的外观, 用来生成顶点
+struct SdfRectStyle {
+    QRectF rect;
+    float radii[4] = {};                                // 左上 右上 右下 左下, 超过短边一半时截断
+    QColor color = Qt::white;
+    std::vector<std::pair<qreal, QColor>> gradient;     // 按位置排序; 非空时代替 color
+    Qt::Orientation gradientOrientation = Qt::Vertical;
+    QColor borderColor = Qt::transparent;
+    float borderWidth = 0.0f;
+};
+
+// 生成 DrawTriangles 的顶点: 纯色一个四边形, 渐变每两个相邻色标之间一个四边形, 颜色在其中线性插值
+void appendSdfRect( const SdfRectStyle& style, std::vector<SdfRectVertex>& vertices );
@@ -0,0 +1,348 @@
+#include "text_cache.hpp"
+
+#include <QFontMetricsF>
+#include <QGlyphRun>
+#include <QPainter>
+#include <QPainterPath>
+#include <QTextLayout>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+size_t TextCache::LayoutKeyHash::operator()( const LayoutKey& key ) const {
+    return size_t( qHash( key.text ) ) ^ ( size_t( key.pixelSize ) * 0x9e3779b97f4a7c15ull );
+}
+
+size_t TextCache::SpriteKeyHash::operator()( const SpriteKey& key ) const {
+    uint64_t hash = ( uint64_t( key.font ) << 32 ) ^ key.index;
+    hash = hash * 0x9e3779b97f4a7c15ull ^ ( uint64_t( key.pixelSize ) << 1 | uint64_t( key.distanceField ) );
+    hash = hash * 0x9e3779b97f4a7c15ull ^ key.color;
+    return size_t( hash );
+}
+
+TextCache& TextCache::instance() {
+    static TextCache cache;
+    return cache;
+}
+
+TextCache::TextCache() = default;
+
+void TextCache::draw( QPainter* painter, const QPointF& baseline, const QString& text, const QColor& color, int pixelSize, Mode mode ) {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    const Layout& layout = findLayout( text, pixelSize );
+
+    // 图集里的字形按设备像素光栅化, 只能处理平移加等比缩放; 特别大的字也不进图集
+    const QTransform transform = painter->transform();
+    const qreal scale = transform.m11();
+    const int devicePixelSize = qRound( pixelSize * scale );
+    const bool axisAligned = transform.type() <= QTransform::TxScale && qFuzzyCompare( scale, transform.m22() );
+    if ( mode == Mode::StaticText || !axisAligned || devicePixelSize <= 0 || devicePixelSize > kAtlasSize / 4 ) {
+        painter->setFont( layout.font );
+        painter->setPen( color );
+        painter->drawStaticText( baseline - QPointF( 0.0, layout.ascent ), layout.staticText );
+        return;
+    }
+
+    // 字形原点对齐到设备像素, 图集内容一比一拷贝
+    painter->save();
+    painter->resetTransform();
+    SpriteKey key;
+    key.pixelSize = devicePixelSize;
+    key.color = color.rgba();
+    key.distanceField = mode == Mode::DistanceField;
+    for ( const Glyph& glyph : layout.glyphs ) {
+        key.font = glyph.font;
+        key.index = glyph.index;
+        const Sprite& sprite = findSprite( key, color );
+        if ( sprite.rect.isEmpty() ) continue;
+        const QPointF origin = transform.map( baseline + glyph.position );
+        painter->drawImage( QPoint( qRound( origin.x() ) + sprite.offset.x(), qRound( origin.y() ) + sprite.offset.y() ), m_atlas,
+                            sprite.rect );
+    }
+    painter->restore();
+}
+
+QRectF TextCache::boundingRect( const QString& text, int pixelSize ) {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return findLayout( text, pixelSize ).bounds;
+}
+
+TextCache::Stats TextCache::stats() const {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    Stats stats = m_stats;
+    stats.layouts = int( m_layouts.size() );
+    stats.glyphs = int( m_sprites.size() );
+    stats.distanceFields = int( m_distanceFields.size() );
+    stats.atlasBytes = size_t( m_atlas.sizeInBytes() );
+    return stats;
+}
+
+void TextCache::resetStats() {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_stats.layoutHits = 0;
+    m_stats.layoutMisses = 0;
+    m_stats.glyphHits = 0;
+    m_stats.glyphMisses = 0;
+    m_stats.atlasResets = 0;
+}
+
+void TextCache::clear() {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_layouts.clear();
+    m_recent.clear();
+    m_fonts.clear();
+    m_sprites.clear();
+    m_shelves.clear();
+    m_distanceFields.clear();
+    m_atlas = QImage();
+    m_stats.layoutBytes = 0;
+    m_stats.distanceFieldBytes = 0;
+}
+
+const TextCache::Layout& TextCache::findLayout( const QString& text, int pixelSize ) {
+    LayoutKey key{ text, pixelSize };
+    auto found = m_layouts.find( key );
+    if ( found != m_layouts.end() ) {
+        ++m_stats.layoutHits;
+        m_recent.splice( m_recent.begin(), m_recent, found->second.recent );
+        return found->second.layout;
+    }
+    ++m_stats.layoutMisses;
+
+    Layout layout;
+    layout.font.setPixelSize( pixelSize );
+    const QFontMetricsF metrics( layout.font );
+    layout.ascent = metrics.ascent();
+    layout.bounds = metrics.boundingRect( text );
+
+    layout.staticText.setText( text );
+    layout.staticText.setTextFormat( Qt::PlainText );
+    layout.staticText.setPerformanceHint( QStaticText::AggressiveCaching );
+    layout.staticText.prepare( QTransform(), layout.font );
+
+    // 整形只在这里做一次, 图集模式直接使用字形序号和位置
+    QTextLayout textLayout( text, layout.font );
+    textLayout.beginLayout();
+    QTextLine line = textLayout.createLine();
+    textLayout.endLayout();
+    if ( line.isValid() ) {
+        const QPointF origin( 0.0, line.ascent() );
+        for ( const QGlyphRun& run : line.glyphRuns() ) {
+            const int font = registerFont( run.rawFont() );
+            const QList<quint32> indexes = run.glyphIndexes();
+            const QList<QPointF> positions = run.positions();
+            for ( qsizetype i = 0; i < indexes.size(); ++i ) {
+                layout.glyphs.push_back( { font, indexes[i], positions[i] - origin } );
+            }
+        }
+    }
+
+    // 估算: 键和 QStaticText 各保存一份文字, QStaticText 内部另存字形序号和位置
+    layout.bytes = sizeof( LayoutEntry ) + sizeof( LayoutKey ) + 2 * size_t( text.size() ) * sizeof( QChar ) +
+                   layout.glyphs.size() * ( sizeof( Glyph ) + sizeof( quint32 ) + sizeof( QPointF ) );
+    m_stats.layoutBytes += layout.bytes;
+
+    while ( m_layouts.size() >= size_t( kMaxLayouts ) ) {
+        auto oldest = m_layouts.find( m_recent.back() );
+        m_stats.layoutBytes -= oldest->second.layout.bytes;
+        m_layouts.erase( oldest );
+        m_recent.pop_back();
+    }
+
+    m_recent.push_front( key );
+    auto inserted = m_layouts.emplace( std::move( key ), LayoutEntry{ std::move( layout ), m_recent.begin() } ).first;
+    return inserted->second.layout;
+}
+
+int TextCache::registerFont( const QRawFont& font ) {
+    QRawFont normalized = font;
+    normalized.setPixelSize( kDistanceFieldSize );
+    for ( size_t i = 0; i < m_fonts.size(); ++i ) {
+        if ( m_fonts[i] == normalized ) return int( i );
+    }
+    m_fonts.push_back( normalized );
+    return int( m_fonts.size() - 1 );
+}
+
+const TextCache::Sprite& TextCache::findSprite( const SpriteKey& key, const QColor& color ) {
+    auto found = m_sprites.find( key );
+    if ( found != m_sprites.end() ) {
+        ++m_stats.glyphHits;
+        return found->second;
+    }
+    ++m_stats.glyphMisses;
+
+    Sprite sprite;
+    const QImage image = key.distanceField ? reconstructGlyph( key, color, sprite.offset ) : rasterizeGlyph( key, color, sprite.offset );
+    if ( !image.isNull() ) {
+        if ( m_atlas.isNull() ) {
+            m_atlas = QImage( kAtlasSize, kAtlasSize, QImage::Format_ARGB32_Premultiplied );
+            m_atlas.fill( Qt::transparent );
+        }
+        // 图集写满时整体清空: 已经画出去的字形不受影响, 之后用到的字形重新光栅化
+        if ( !allocate( image.size(), sprite.rect ) ) {
+            resetAtlas();
+            allocate( image.size(), sprite.rect );
+        }
+        QPainter painter( &m_atlas );
+        painter.setCompositionMode( QPainter::CompositionMode_Source );
+        painter.drawImage( sprite.rect.topLeft(), image );
+    }
+    return m_sprites.emplace( key, sprite ).first->second;
+}
+
+QImage TextCache::rasterizeGlyph( const SpriteKey& key, const QColor& color, QPoint& offset ) {
+    QRawFont font = m_fonts[key.font];
+    font.setPixelSize( key.pixelSize );
+    const QPainterPath path = font.pathForGlyph( key.index );
+    const QRectF bounds = path.boundingRect();
+    if ( path.isEmpty() || bounds.isEmpty() ) return QImage();
+
+    // 四周留一个像素给抗锯齿
+    const int left = qFloor( bounds.left() ) - 1;
+    const int top = qFloor( bounds.top() ) - 1;
+    const int right = qCeil( bounds.right() ) + 1;
+    const int bottom = qCeil( bounds.bottom() ) + 1;
+    QImage image( right - left, bottom - top, QImage::Format_ARGB32_Premultiplied );
+    image.fill( Qt::transparent );
+
+    QPainter painter( &image );
+    painter.setRenderHint( QPainter::Antialiasing );
+    painter.translate( -left, -top );
+    painter.fillPath( path, color );
+    painter.end();
+
+    offset = QPoint( left, top );
+    return image;
+}
+
+const TextCache::DistanceField& TextCache::findDistanceField( int font, uint32_t index ) {
+    const uint64_t key = ( uint64_t( font ) << 32 ) | index;
+    auto found = m_distanceFields.find( key );
+    if ( found != m_distanceFields.end() ) return found->second;
+
+    DistanceField field;
+    const QPainterPath path = m_fonts[font].pathForGlyph( index );
+    const QRectF bounds = path.boundingRect();
+    if ( !path.isEmpty() && !bounds.isEmpty() ) {
+        const int pad = kDistanceFieldSpread + 1;
+        const int left = qFloor( bounds.left() ) - pad;
+        const int top = qFloor( bounds.top() ) - pad;
+        field.width = qCeil( bounds.right() ) + pad - left;
+        field.height = qCeil( bounds.bottom() ) + pad - top;
+        field.offset = QPoint( left, top );
+
+        QImage coverage( field.width, field.height, QImage::Format_Alpha8 );
+        coverage.fill( Qt::transparent );
+        QPainter painter( &coverage );
+        painter.setRenderHint( QPainter::Antialiasing );
+        painter.translate( -left, -top );
+        painter.fillPath( path, Qt::black );
+        painter.end();
+
+        // 以覆盖率过半作为内外分界, 逐像素在 spread 范围内找最近的另一侧像素
+        // 边缘像素直接用覆盖率估计到轮廓的距离, 比整像素距离更精细
+        const auto at = [&]( int x, int y ) { return coverage.constScanLine( y )[x]; };
+        const int spread = kDistanceFieldSpread;
+        field.values.resize( size_t( field.width ) * field.height );
+        for ( int y = 0; y < field.height; ++y ) {
+            for ( int x = 0; x < field.width; ++x ) {
+                const uint8_t value = at( x, y );
+                const bool inside = value >= 128;
+                qreal distance;
+                if ( value > 0 && value < 255 ) {
+                    distance = value / 255.0 - 0.5;
+                } else {
+                    int nearest = ( spread + 1 ) * ( spread + 1 );
+                    for ( int dy = -spread; dy <= spread; ++dy ) {
+                        const int sy = y + dy;
+                        if ( sy < 0 || sy >= field.height ) continue;
+                        for ( int dx = -spread; dx <= spread; ++dx ) {
+                            const int sx = x + dx;
+                            if ( sx < 0 || sx >= field.width ) continue;
+                            if ( ( at( sx, sy ) >= 128 ) != inside ) nearest = std::min( nearest, dx * dx + dy * dy );
+                        }
+                    }
+                    const qreal magnitude = std::sqrt( qreal( nearest ) ) - 0.5;
+                    distance = inside ? magnitude : -magnitude;
+                }
+                const qreal encoded = std::clamp( 0.5 + distance / ( 2.0 * spread ), 0.0, 1.0 );
+                field.values[size_t( y ) * field.width + x] = uint8_t( qRound( encoded * 255.0 ) );
+            }
+        }
+    }
+
+    m_stats.distanceFieldBytes += field.values.size();
+    return m_distanceFields.emplace( key, std::move( field ) ).first->second;
+}
+
+QImage TextCache::reconstructGlyph( const SpriteKey& key, const QColor& color, QPoint& offset ) {
+    const DistanceField& field = findDistanceField( key.font, key.index );
+    if ( field.values.empty() ) return QImage();
+
+    const qreal scale = qreal( key.pixelSize ) / kDistanceFieldSize;
+    const int left = qFloor( field.offset.x() * scale );
+    const int top = qFloor( field.offset.y() * scale );
+    const int right = qCeil( ( field.offset.x() + field.width ) * scale );
+    const int bottom = qCeil( ( field.offset.y() + field.height ) * scale );
+    QImage image( right - left, bottom - top, QImage::Format_ARGB32_Premultiplied );
+
+    // 距离场外的采样视为字形外部
+    const auto sample = [&]( int x, int y ) -> qreal {
+        if ( x < 0 || y < 0 || x >= field.width || y >= field.height ) return 0.0;
+        return field.values[size_t( y ) * field.width + x] / 255.0;
+    };
+
+    // 编码值每变化 1 对应基准字号下 2 * spread 像素, 换算到目标字号后得到覆盖率的斜率
+    const qreal slope = 2.0 * kDistanceFieldSpread * scale;
+    const int red = color.red();
+    const int green = color.green();
+    const int blue = color.blue();
+    const int alpha = color.alpha();
+    for ( int y = 0; y < image.height(); ++y ) {
+        QRgb* line = reinterpret_cast<QRgb*>( image.scanLine( y ) );
+        const qreal fy = ( top + y + 0.5 ) / scale - field.offset.y() - 0.5;
+        const int y0 = qFloor( fy );
+        const qreal ty = fy - y0;
+        for ( int x = 0; x < image.width(); ++x ) {
+            const qreal fx = ( left + x + 0.5 ) / scale - field.offset.x() - 0.5;
+            const int x0 = qFloor( fx );
+            const qreal tx = fx - x0;
+            const qreal value = ( sample( x0, y0 ) * ( 1.0 - tx ) + sample( x0 + 1, y0 ) * tx ) * ( 1.0 - ty ) +
+                                ( sample( x0, y0 + 1 ) * ( 1.0 - tx ) + sample( x0 + 1, y0 + 1 ) * tx ) * ty;
+            const qreal cover = std::clamp( ( value - 0.5 ) * slope + 0.5, 0.0, 1.0 );
+            const int a = qRound( cover * alpha );
+            line[x] = qRgba( red * a / 255, green * a / 255, blue * a / 255, a );
+        }
+    }
+
+    offset = QPoint( left, top );
+    return image;
+}
+
+bool TextCache::allocate( const QSize& size, QRect& rect ) {
+    // 字形之间留一个像素, 避免缩放采样时混入邻居
+    const int width = size.width() + 1;
+    const int height = size.height() + 1;
+    if ( width > kAtlasSize || height > kAtlasSize ) return false;
+
+    for ( Shelf& shelf : m_shelves ) {
+        if ( height <= shelf.height && shelf.x + width <= kAtlasSize ) {
+            rect = QRect( QPoint( shelf.x, shelf.y ), size );
+            shelf.x += width;
+            return true;
+        }
+    }
+    const int y = m_shelves.empty() ? 0 : m_shelves.back().y + m_shelves.back().height;
+    if ( y + height > kAtlasSize ) return false;
+    m_shelves.push_back( { y, height, width } );
+    rect = QRect( QPoint( 0, y ), size );
+    return true;
+}
+
+void TextCache::resetAtlas() {
+    m_atlas.fill( Qt::transparent );
+    m_shelves.clear();
+    m_sprites.clear();
+    ++m_stats.atlasResets;
+}
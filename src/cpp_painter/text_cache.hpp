@@ -0,0 +1,153 @@
+// 单一职责: QPainter 路径的文字缓存, 所有 CppPainter 共享一个实例
+// 排版缓存: 相同 (文字, 字号) 只整形排版一次, 结果保存为 QStaticText 和以基线为原点的字形序列, 按最近使用淘汰
+// 字形图集: 每个 (字形, 设备字号, 颜色) 只光栅化一次到共享图集, 之后按整像素位置从图集拷贝, 不再走字体引擎
+// 距离场模式: 每个字形只在基准字号光栅化一次并转成距离场, 任意字号的字形都从距离场重建, 放大后边缘仍然锐利
+#pragma once
+
+#include <QColor>
+#include <QFont>
+#include <QImage>
+#include <QPointF>
+#include <QRawFont>
+#include <QRect>
+#include <QRectF>
+#include <QStaticText>
+#include <QString>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class QPainter;
+
+class TextCache {
+public:
+    enum class Mode {
+        StaticText,         // 只缓存排版, 光栅化交给 QPainter
+        GlyphAtlas,         // 排版 + 字形图集
+        DistanceField,      // 排版 + 从距离场重建的字形图集
+    };
+
+    struct Stats {
+        uint64_t layoutHits = 0;
+        uint64_t layoutMisses = 0;
+        uint64_t glyphHits = 0;
+        uint64_t glyphMisses = 0;
+        int layouts = 0;
+        int glyphs = 0;             // 图集中的字形数
+        int distanceFields = 0;
+        int atlasResets = 0;        // 图集写满后清空重来的次数
+        size_t layoutBytes = 0;
+        size_t atlasBytes = 0;
+        size_t distanceFieldBytes = 0;
+    };
+
+    static constexpr int kMaxLayouts = 2048;
+    static constexpr int kAtlasSize = 1024;
+    static constexpr int kDistanceFieldSize = 48;   // 距离场的基准字号
+    static constexpr int kDistanceFieldSpread = 6;  // 距离场覆盖的范围, 基准字号下的像素
+
+    static TextCache& instance();
+
+    // 与 QPainter::drawText 一致, baseline 是基线起点; painter 带旋转或非等比缩放时退回 StaticText 模式
+    void draw( QPainter* painter, const QPointF& baseline, const QString& text, const QColor& color, int pixelSize, Mode mode );
+
+    // 以基线起点为原点的文字范围
+    QRectF boundingRect( const QString& text, int pixelSize );
+
+    Stats stats() const;
+    void resetStats();
+    void clear();
+
+private:
+    TextCache();
+    TextCache( const TextCache& ) = delete;
+    TextCache& operator=( const TextCache& ) = delete;
+
+    struct Glyph {
+        int font = 0;               // m_fonts 下标
+        uint32_t index = 0;
+        QPointF position;           // 相对基线起点
+    };
+
+    struct Layout {
+        QFont font;
+        QStaticText staticText;
+        qreal ascent = 0.0;         // QStaticText 以左上角定位
+        QRectF bounds;
+        std::vector<Glyph> glyphs;
+        size_t bytes = 0;
+    };
+
+    struct LayoutKey {
+        QString text;
+        int pixelSize = 0;
+        bool operator==( const LayoutKey& other ) const { return pixelSize == other.pixelSize && text == other.text; }
+    };
+    struct LayoutKeyHash {
+        size_t operator()( const LayoutKey& key ) const;
+    };
+
+    struct LayoutEntry {
+        Layout layout;
+        std::list<LayoutKey>::iterator recent;
+    };
+
+    struct SpriteKey {
+        int font = 0;
+        uint32_t index = 0;
+        int pixelSize = 0;          // 设备像素
+        QRgb color = 0;
+        bool distanceField = false;
+        bool operator==( const SpriteKey& other ) const {
+            return font == other.font && index == other.index && pixelSize == other.pixelSize && color == other.color &&
+                   distanceField == other.distanceField;
+        }
+    };
+    struct SpriteKeyHash {
+        size_t operator()( const SpriteKey& key ) const;
+    };
+
+    // rect 是图集中的位置, offset 是其左上角相对字形原点的偏移; 空白字形 rect 为空
+    struct Sprite {
+        QRect rect;
+        QPoint offset;
+    };
+
+    // 基准字号下的距离场, 0.5 是轮廓, 大于 0.5 在字形内部
+    struct DistanceField {
+        int width = 0;
+        int height = 0;
+        QPoint offset;
+        std::vector<uint8_t> values;
+    };
+
+    const Layout& findLayout( const QString& text, int pixelSize );
+    const Sprite& findSprite( const SpriteKey& key, const QColor& color );
+    const DistanceField& findDistanceField( int font, uint32_t index );
+    int registerFont( const QRawFont& font );
+
+    QImage rasterizeGlyph( const SpriteKey& key, const QColor& color, QPoint& offset );
+    QImage reconstructGlyph( const SpriteKey& key, const QColor& color, QPoint& offset );
+    bool allocate( const QSize& size, QRect& rect );
+    void resetAtlas();
+
+    mutable std::mutex m_mutex;     // 多个窗口的渲染线程可能同时绘制
+
+    std::unordered_map<LayoutKey, LayoutEntry, LayoutKeyHash> m_layouts;
+    std::list<LayoutKey> m_recent;  // 最近使用的在前
+    std::vector<QRawFont> m_fonts;  // 统一为基准字号, 用下标作为字形键
+
+    struct Shelf {
+        int y = 0;
+        int height = 0;
+        int x = 0;
+    };
+    QImage m_atlas;
+    std::vector<Shelf> m_shelves;
+    std::unordered_map<SpriteKey, Sprite, SpriteKeyHash> m_sprites;
+    std::unordered_map<uint64_t, DistanceField> m_distanceFields;
+
+    Stats m_stats;
+};
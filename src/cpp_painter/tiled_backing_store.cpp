@@ -0,0 +1,127 @@
+#include "tiled_backing_store.hpp"
+
+#include <QPainter>
+#include <QtMath>
+#include <algorithm>
+
+void TiledBackingStore::resize( const QSize& size, qreal devicePixelRatio ) {
+    const int columns = ( std::max( 0, size.width() ) + kTileSize - 1 ) / kTileSize;
+    const int rows = ( std::max( 0, size.height() ) + kTileSize - 1 ) / kTileSize;
+    const bool ratioChanged = devicePixelRatio != m_devicePixelRatio;
+    m_size = size;
+    m_devicePixelRatio = devicePixelRatio;
+
+    if ( columns != m_columns || rows != m_rows ) {
+        // 保留两个网格重叠部分的块, 内容与位置无关, 不需要重画
+        std::vector<Tile> tiles( size_t( columns ) * rows );
+        for ( Tile& tile : tiles ) tile.version = ++m_version;
+        for ( int row = 0; row < std::min( rows, m_rows ); ++row ) {
+            for ( int column = 0; column < std::min( columns, m_columns ); ++column ) {
+                tiles[size_t( row ) * columns + column] = std::move( m_tiles[size_t( row ) * m_columns + column] );
+            }
+        }
+        m_tiles = std::move( tiles );
+        m_columns = columns;
+        m_rows = rows;
+    }
+    if ( ratioChanged ) {
+        invalidateAll();
+    }
+}
+
+void TiledBackingStore::invalidate( const QRectF& rect ) {
+    const QRect area = rect.toAlignedRect().intersected( QRect( 0, 0, m_columns * kTileSize, m_rows * kTileSize ) );
+    if ( area.isEmpty() ) return;
+    for ( int row = area.top() / kTileSize; row <= area.bottom() / kTileSize; ++row ) {
+        for ( int column = area.left() / kTileSize; column <= area.right() / kTileSize; ++column ) {
+            Tile& tile = this->tile( column, row );
+            tile.dirty = true;
+            tile.version = ++m_version;
+        }
+    }
+}
+
+void TiledBackingStore::invalidateAll() {
+    for ( Tile& tile : m_tiles ) {
+        tile.dirty = true;
+        tile.version = ++m_version;
+    }
+}
+
+bool TiledBackingStore::hasDirtyTiles() const {
+    return std::any_of( m_tiles.begin(), m_tiles.end(), []( const Tile& tile ) { return tile.dirty; } );
+}
+
+void TiledBackingStore::markAllForUpload() {
+    for ( Tile& tile : m_tiles ) tile.needsUpload = true;
+}
+
+void TiledBackingStore::paintTile( QImage& image, const QRect& rect, qreal devicePixelRatio,
+                                   const std::function<void( QPainter*, const QRect& )>& paint ) {
+    const int pixels = qCeil( kTileSize * devicePixelRatio );
+    if ( image.width() != pixels ) {
+        image = QImage( pixels, pixels, QImage::Format_ARGB32_Premultiplied );
+    }
+    image.fill( Qt::transparent );
+
+    QPainter painter( &image );
+    painter.scale( devicePixelRatio, devicePixelRatio );
+    painter.translate( -rect.x(), -rect.y() );
+    painter.setClipRect( rect );
+    paint( &painter, rect );
+    painter.end();
+}
+
+int TiledBackingStore::repaint( const std::function<void( QPainter*, const QRect& )>& paint ) {
+    int repainted = 0;
+    for ( int row = 0; row < m_rows; ++row ) {
+        for ( int column = 0; column < m_columns; ++column ) {
+            Tile& tile = this->tile( column, row );
+            if ( !tile.dirty ) continue;
+
+            paintTile( tile.image, tileRect( column, row ), m_devicePixelRatio, paint );
+            tile.dirty = false;
+            tile.needsUpload = true;
+            ++repainted;
+        }
+    }
+    return repainted;
+}
+
+std::vector<TiledBackingStore::PendingTile> TiledBackingStore::takeDirtyTiles() {
+    std::vector<PendingTile> pending;
+    for ( int row = 0; row < m_rows; ++row ) {
+        for ( int column = 0; column < m_columns; ++column ) {
+            Tile& tile = this->tile( column, row );
+            if ( !tile.dirty ) continue;
+            tile.dirty = false;
+
+            PendingTile item;
+            item.column = column;
+            item.row = row;
+            item.version = tile.version;
+            item.rect = tileRect( column, row );
+            pending.push_back( std::move( item ) );
+        }
+    }
+    return pending;
+}
+
+bool TiledBackingStore::setTileImage( PendingTile&& pending ) {
+    if ( pending.column >= m_columns || pending.row >= m_rows ) return false;
+    Tile& tile = this->tile( pending.column, pending.row );
+    if ( tile.version != pending.version ) return false;
+
+    // 正在显示的图像继续留给已经生成的纹理, 新图像换进来等待上传
+    tile.image = std::move( pending.image );
+    tile.needsUpload = true;
+    return true;
+}
+
+QRect TiledBackingStore::tileRect( int column, int row ) const {
+    return QRect( column * kTileSize, row * kTileSize, kTileSize, kTileSize );
+}
+
+QRect TiledBackingStore::visibleRect( int column, int row ) const {
+    return tileRect( column, row ).intersected( QRect( QPoint( 0, 0 ), m_size ) );
+}
@@ -0,0 +1,76 @@
+// 单一职责: QPainter 内容的分块后备存储
+// 内容按固定大小的块保存在各自的 QImage 里, 绘制接口只标记变化的矩形, 重绘时只画并上传被标记的块
+// 块按 item 左上角对齐, 改变大小时已有的块保持有效, 只有新出现的块需要绘制
+// 也可以异步重绘: 取出脏块交给其他线程画进新图像, 画好后换入; 期间又被标记的块丢弃这次结果
+#pragma once
+
+#include <QImage>
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class QPainter;
+
+class TiledBackingStore {
+public:
+    static constexpr int kTileSize = 256;       // 逻辑像素
+
+    struct Tile {
+        QImage image;                   // 设备像素, 预乘 alpha
+        bool dirty = true;              // 内容需要重绘
+        bool needsUpload = true;        // 图像已更新, 还没有生成纹理
+        uint64_t version = 0;           // 每次被标记时更新
+    };
+
+    // 交给其他线程绘制的块
+    struct PendingTile {
+        int column = 0;
+        int row = 0;
+        uint64_t version = 0;
+        QRect rect;                     // 逻辑范围
+        QImage image;                   // 绘制结果
+    };
+
+    // 覆盖 size 需要的块数变化时增删块; 设备像素比变化时全部重绘
+    void resize( const QSize& size, qreal devicePixelRatio );
+
+    void invalidate( const QRectF& rect );
+    void invalidateAll();
+    bool hasDirtyTiles() const;
+
+    // 重绘所有脏块: paint 收到的 painter 已经平移并裁剪到块的逻辑范围 (第二个参数), 返回重绘的块数
+    int repaint( const std::function<void( QPainter*, const QRect& )>& paint );
+
+    // 异步重绘: 取出全部脏块并清除标记; 用 paintTile 在任意线程画好后, 由 setTileImage 换入
+    std::vector<PendingTile> takeDirtyTiles();
+    // 块在取出之后又被标记过 (或已不存在) 时丢弃结果并返回 false, 它会在下一轮重画
+    bool setTileImage( PendingTile&& tile );
+
+    // 把 rect 范围的内容画进 image (大小不符时重新分配), 不访问任何成员, 可以在工作线程调用
+    static void paintTile( QImage& image, const QRect& rect, qreal devicePixelRatio,
+                           const std::function<void( QPainter*, const QRect& )>& paint );
+
+    // 所有块都需要重新生成纹理, 例如场景图节点被重建之后
+    void markAllForUpload();
+
+    int columns() const { return m_columns; }
+    int rows() const { return m_rows; }
+    QSize size() const { return m_size; }
+    qreal devicePixelRatio() const { return m_devicePixelRatio; }
+    Tile& tile( int column, int row ) { return m_tiles[size_t( row ) * m_columns + column]; }
+
+    // 块的逻辑范围, 以及裁剪到 item 大小之后实际显示的部分
+    QRect tileRect( int column, int row ) const;
+    QRect visibleRect( int column, int row ) const;
+
+private:
+    std::vector<Tile> m_tiles;
+    QSize m_size;
+    qreal m_devicePixelRatio = 1.0;
+    int m_columns = 0;
+    int m_rows = 0;
+    uint64_t m_version = 0;
+};
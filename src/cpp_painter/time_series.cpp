@@ -0,0 +1,238 @@
+#include "time_series.hpp"
+
+#include "simd_vec4.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// mins / maxs 的前 count 个值合并进 summary; 原始样本两个指针相同
+void reduceScalar( const float* mins, const float* maxs, size_t count, TimeSeries::Summary& summary ) {
+    for ( size_t i = 0; i < count; ++i ) {
+        summary.min = std::min( summary.min, mins[i] );
+        summary.max = std::max( summary.max, maxs[i] );
+    }
+}
+
+// 两组累加器交替, 隐藏 min/max 的延迟; 尾部不足 4 个的走标量
+void reduceSimd( const float* mins, const float* maxs, size_t count, TimeSeries::Summary& summary ) {
+    Vec4 min0 = Vec4::splat( summary.min );
+    Vec4 max0 = Vec4::splat( summary.max );
+    Vec4 min1 = min0;
+    Vec4 max1 = max0;
+    size_t i = 0;
+    for ( ; i + 8 <= count; i += 8 ) {
+        min0 = Vec4::min( min0, Vec4::load( mins + i ) );
+        min1 = Vec4::min( min1, Vec4::load( mins + i + 4 ) );
+        max0 = Vec4::max( max0, Vec4::load( maxs + i ) );
+        max1 = Vec4::max( max1, Vec4::load( maxs + i + 4 ) );
+    }
+    for ( ; i + 4 <= count; i += 4 ) {
+        min0 = Vec4::min( min0, Vec4::load( mins + i ) );
+        max0 = Vec4::max( max0, Vec4::load( maxs + i ) );
+    }
+    float lanes[4];
+    Vec4::min( min0, min1 ).store( lanes );
+    summary.min = std::min( std::min( lanes[0], lanes[1] ), std::min( lanes[2], lanes[3] ) );
+    Vec4::max( max0, max1 ).store( lanes );
+    summary.max = std::max( std::max( lanes[0], lanes[1] ), std::max( lanes[2], lanes[3] ) );
+    reduceScalar( mins + i, maxs + i, count - i, summary );
+}
+
+// 金字塔查询每段通常不到一个块 (16 个值), 这么短时 SIMD 的广播和横向归约不划算
+void reduce( const float* mins, const float* maxs, size_t count, TimeSeries::Summary& summary, bool simd ) {
+    if ( simd && count >= 16 ) {
+        reduceSimd( mins, maxs, count, summary );
+    } else {
+        reduceScalar( mins, maxs, count, summary );
+    }
+}
+
+} // namespace
+
+TimeSeries::TimeSeries( size_t capacity )
+    : m_capacity( std::max<size_t>( capacity, kFanout ) )
+{
+}
+
+void TimeSeries::setCapacity( size_t capacity ) {
+    m_capacity = std::max<size_t>( capacity, kFanout );
+    m_samples.clear();
+    m_samples.shrink_to_fit();
+    m_levels.clear();
+    m_end = 0;
+}
+
+void TimeSeries::clear() {
+    m_end = 0;
+}
+
+void TimeSeries::allocate() {
+    m_samples.assign( m_capacity, 0.0f );
+    m_levels.clear();
+    // 至少能放下 kFanout 个整块的层才有意义
+    for ( uint64_t size = kFanout; size * kFanout <= m_capacity; size *= kFanout ) {
+        Level level;
+        level.blockSize = size;
+        // 两端各可能有一个不完整的块
+        level.slotCount = size_t( m_capacity / size ) + 2;
+        level.mins.assign( level.slotCount, 0.0f );
+        level.maxs.assign( level.slotCount, 0.0f );
+        m_levels.push_back( std::move( level ) );
+    }
+}
+
+size_t TimeSeries::memoryBytes() const {
+    size_t bytes = m_samples.capacity() * sizeof( float );
+    for ( const Level& level : m_levels ) {
+        bytes += ( level.mins.capacity() + level.maxs.capacity() ) * sizeof( float );
+    }
+    return bytes;
+}
+
+void TimeSeries::append( const float* values, size_t count ) {
+    if ( count == 0 ) return;
+    if ( m_samples.empty() ) allocate();
+
+    // 一次追加超过容量时, 前面的样本写进去也会马上被覆盖
+    uint64_t first = m_end;
+    if ( count > m_capacity ) {
+        const size_t skipped = count - m_capacity;
+        values += skipped;
+        count = m_capacity;
+        first += skipped;
+    }
+
+    const size_t slot = size_t( first % m_capacity );
+    const size_t head = std::min( count, m_capacity - slot );
+    std::memcpy( m_samples.data() + slot, values, head * sizeof( float ) );
+    std::memcpy( m_samples.data(), values + head, ( count - head ) * sizeof( float ) );
+    const uint64_t last = first + count;
+    m_end = last;
+
+    // 逐层只更新与新样本相交的块: 新样本对应的下一层块在本轮已经更新过, 直接合并;
+    // 块开头在新样本之前的部分已经汇总在旧值里 (它们的子块也只含同一块内的样本)
+    for ( int level = 1; level <= int( m_levels.size() ); ++level ) {
+        Level& target = m_levels[level - 1];
+        const uint64_t childSize = blockSize( level - 1 );
+        for ( uint64_t block = first / target.blockSize; block <= ( last - 1 ) / target.blockSize; ++block ) {
+            const uint64_t blockStart = block * target.blockSize;
+            const size_t blockSlot = size_t( block % target.slotCount );
+            Summary summary;
+            if ( blockStart < first ) {
+                summary.min = target.mins[blockSlot];
+                summary.max = target.maxs[blockSlot];
+            }
+            const uint64_t childFirst = std::max( blockStart, first ) / childSize;
+            const uint64_t childLast = ( std::min( blockStart + target.blockSize, last ) + childSize - 1 ) / childSize;
+            reduceBlocks( level - 1, childFirst, childLast, summary, true );
+            target.mins[blockSlot] = summary.min;
+            target.maxs[blockSlot] = summary.max;
+        }
+    }
+}
+
+void TimeSeries::reduceBlocks( int level, uint64_t first, uint64_t last, Summary& summary, bool simd ) const {
+    if ( first >= last ) return;
+    const float* mins;
+    const float* maxs;
+    size_t slotCount;
+    if ( level == 0 ) {
+        mins = maxs = m_samples.data();
+        slotCount = m_capacity;
+    } else {
+        const Level& source = m_levels[level - 1];
+        mins = source.mins.data();
+        maxs = source.maxs.data();
+        slotCount = source.slotCount;
+    }
+    // 环形数组里最多分成两段连续内存
+    const size_t start = size_t( first % slotCount );
+    const size_t count = size_t( last - first );
+    const size_t head = std::min( count, slotCount - start );
+    reduce( mins + start, maxs + start, head, summary, simd );
+    reduce( mins, maxs, count - head, summary, simd );
+}
+
+void TimeSeries::accumulate( int level, uint64_t first, uint64_t last, Summary& summary, bool simd ) const {
+    if ( first >= last ) return;
+    if ( level == 0 ) {
+        reduceBlocks( 0, first, last, summary, simd );
+        return;
+    }
+    // 区间内对齐的整块用本层, 两端不满一块的部分交给下一层
+    const uint64_t size = blockSize( level );
+    const uint64_t firstBlock = ( first + size - 1 ) / size;
+    const uint64_t lastBlock = last / size;
+    if ( firstBlock >= lastBlock ) {
+        accumulate( level - 1, first, last, summary, simd );
+        return;
+    }
+    accumulate( level - 1, first, firstBlock * size, summary, simd );
+    reduceBlocks( level, firstBlock, lastBlock, summary, simd );
+    accumulate( level - 1, lastBlock * size, last, summary, simd );
+}
+
+TimeSeries::Summary TimeSeries::summarize( uint64_t first, uint64_t last, bool simd ) const {
+    Summary summary;
+    first = std::max( first, begin() );
+    last = std::min( last, end() );
+    if ( first >= last ) return summary;
+
+    // 从块大小不超过区间长度的最高层开始; first 不早于最旧样本, 所以用到的整块都完整保留
+    int level = int( m_levels.size() );
+    while ( level > 0 && blockSize( level ) > last - first ) --level;
+    accumulate( level, first, last, summary, simd );
+    return summary;
+}
+
+void TimeSeries::columns( double first, double samplesPerColumn, int count, Column* out, bool simd ) const {
+    const double lowest = double( begin() );
+    const double highest = double( end() );
+    for ( int i = 0; i < count; ++i ) {
+        // 列边界取整后相邻列首尾相接, 每个样本恰好属于一列
+        const double from = std::clamp( std::floor( first + i * samplesPerColumn ), lowest, highest );
+        const double to = std::clamp( std::floor( first + ( i + 1 ) * samplesPerColumn ), lowest, highest );
+        Column& column = out[i];
+        column.valid = to > from;
+        if ( !column.valid ) continue;
+
+        const Summary summary = summarize( uint64_t( from ), uint64_t( to ), simd );
+        column.min = summary.min;
+        column.max = summary.max;
+        column.first = at( uint64_t( from ) );
+        column.last = at( uint64_t( to ) - 1 );
+    }
+}
+
+void TimeSeries::largestTriangle( const Column* columns, int count, float* values ) {
+    bool havePrevious = false;
+    float previous = 0.0f;
+    for ( int i = 0; i < count; ++i ) {
+        const Column& column = columns[i];
+        if ( !column.valid ) continue;
+
+        // 第一列取首个样本, 最后一列 (后面没有有效列) 取末个样本
+        const Column* next = nullptr;
+        for ( int j = i + 1; j < count && !next; ++j ) {
+            if ( columns[j].valid ) next = &columns[j];
+        }
+        float value;
+        if ( !havePrevious ) {
+            value = column.first;
+        } else if ( !next ) {
+            value = column.last;
+        } else {
+            // 三点横坐标为 i - 1, i, i + 1: 面积正比于 |(c - a) - 2 (b - a)|
+            const float target = 0.5f * ( next->min + next->max );
+            const float areaMin = std::abs( ( target - previous ) - 2.0f * ( column.min - previous ) );
+            const float areaMax = std::abs( ( target - previous ) - 2.0f * ( column.max - previous ) );
+            value = areaMax > areaMin ? column.max : column.min;
+        }
+        values[i] = value;
+        previous = value;
+        havePrevious = true;
+    }
+}
@@ -0,0 +1,81 @@
+// 单一职责: 定长环形缓冲中的时间序列, 带多分辨率的 min/max 摘要金字塔
+// 第 L 层的每个块汇总 16^L 个连续样本的最小 / 最大值; 任意区间的 min/max 由各层对齐的整块拼出,
+// 每层最多读两端各 15 个块, 代价只与层数有关, 与区间长度无关
+// 追加只更新各层最末尾的块; 缓冲写满后覆盖最旧的样本, 起点早于最旧样本的块不再参与查询
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class TimeSeries {
+public:
+    static constexpr int kFanout = 16;
+
+    struct Summary {
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        bool isEmpty() const { return min > max; }
+    };
+
+    // 一个像素列: 区间内的最小 / 最大值, 以及首尾样本 (与相邻列连线用)
+    struct Column {
+        float min = 0.0f;
+        float max = 0.0f;
+        float first = 0.0f;
+        float last = 0.0f;
+        bool valid = false;
+    };
+
+    // 缓冲在第一次追加时才分配
+    explicit TimeSeries( size_t capacity = size_t( 1 ) << 22 );
+
+    void append( float value ) { append( &value, 1 ); }
+    void append( const float* values, size_t count );
+
+    // 清空样本, 样本序号从 0 重新开始
+    void clear();
+    void setCapacity( size_t capacity );
+
+    // 样本序号单调递增, 保留的样本是 [begin(), end())
+    size_t capacity() const { return m_capacity; }
+    uint64_t begin() const { return m_end > m_capacity ? m_end - m_capacity : 0; }
+    uint64_t end() const { return m_end; }
+    size_t size() const { return size_t( m_end - begin() ); }
+    float at( uint64_t index ) const { return m_samples[size_t( index % m_capacity )]; }
+
+    // [first, last) 与保留区间的交集的 min/max
+    Summary summarize( uint64_t first, uint64_t last, bool simd = true ) const;
+
+    // 从样本位置 first 开始, 每 samplesPerColumn 个样本一列, 共 count 列; 超出保留区间的列 valid 为 false
+    void columns( double first, double samplesPerColumn, int count, Column* out, bool simd = true ) const;
+
+    // 每列从 min / max 中选一个点, 使它与前一列选中的点和后一列的中点组成的三角形面积最大 (LTTB)
+    static void largestTriangle( const Column* columns, int count, float* values );
+
+    int levelCount() const { return int( m_levels.size() ); }
+    size_t memoryBytes() const;
+
+private:
+    struct Level {
+        uint64_t blockSize = 0;     // 每块的样本数
+        size_t slotCount = 0;       // 环形数组长度, 块号对它取模
+        std::vector<float> mins;
+        std::vector<float> maxs;
+    };
+
+    void allocate();
+    uint64_t blockSize( int level ) const { return level == 0 ? 1 : m_levels[level - 1].blockSize; }
+
+    // 第 level 层 (0 是原始样本) 的块 [first, last) 合并进 summary
+    void reduceBlocks( int level, uint64_t first, uint64_t last, Summary& summary, bool simd ) const;
+
+    // 样本区间 [first, last) 从 level 层往下拼
+    void accumulate( int level, uint64_t first, uint64_t last, Summary& summary, bool simd ) const;
+
+    size_t m_capacity;
+    uint64_t m_end = 0;
+    std::vector<float> m_samples;
+    std::vector<Level> m_levels;
+};
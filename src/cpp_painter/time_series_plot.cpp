@@ -0,0 +1,157 @@
+#include "time_series_plot.hpp"
+
+#include <QPainter>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void TimeSeriesPlot::setDecimation( Decimation decimation ) {
+    if ( decimation == m_decimation ) return;
+    m_decimation = decimation;
+    m_styleChanged = true;
+}
+
+void TimeSeriesPlot::setColor( const QColor& color ) {
+    if ( color == m_polyline.color ) return;
+    m_polyline.color = color;
+    m_styleChanged = true;
+}
+
+void TimeSeriesPlot::setWindow( double start, double length ) {
+    m_following = false;
+    m_start = start;
+    m_length = std::max( length, 1.0 );
+}
+
+void TimeSeriesPlot::followTail( double length ) {
+    m_following = true;
+    m_length = length;
+}
+
+QRectF TimeSeriesPlot::update( const QSizeF& size, qreal devicePixelRatio ) {
+    const double length = m_following && m_length <= 0.0 ? double( m_series.size() ) : m_length;
+    const double start = m_following ? double( m_series.end() ) - length : m_start;
+    const int count = std::max( 0, qCeil( size.width() * devicePixelRatio ) );
+    const double samplesPerColumn = count > 0 ? length / count : 0.0;
+    const uint64_t begin = m_series.begin();
+    const uint64_t end = m_series.end();
+    const bool unchanged = !m_styleChanged && size == m_size && devicePixelRatio == m_devicePixelRatio &&
+                           start == m_viewStart && samplesPerColumn == m_samplesPerColumn && begin == m_seenBegin &&
+                           end == m_seenEnd;
+    if ( unchanged ) return QRectF();
+
+    const QRectF full( QPointF( 0, 0 ), size );
+    std::vector<QPointF>& points = m_polyline.points;
+    const bool wasEmpty = points.empty();
+
+    // 纵向范围取可见部分的包络; 样本比像素列少时直接连每个样本
+    const bool raw = samplesPerColumn < 1.0;
+    const double rawFirst = std::max( double( begin ), std::ceil( start ) );
+    const double rawLast = std::min( double( end ), start + length );
+    float low = std::numeric_limits<float>::infinity();
+    float high = -std::numeric_limits<float>::infinity();
+    if ( count > 0 && length > 0.0 ) {
+        if ( raw ) {
+            for ( double index = rawFirst; index < rawLast; index += 1.0 ) {
+                const float value = m_series.at( uint64_t( index ) );
+                low = std::min( low, value );
+                high = std::max( high, value );
+            }
+        } else {
+            m_columns.resize( size_t( count ) );
+            m_series.columns( start, samplesPerColumn, count, m_columns.data() );
+            for ( const TimeSeries::Column& column : m_columns ) {
+                if ( !column.valid ) continue;
+                low = std::min( low, column.min );
+                high = std::max( high, column.max );
+            }
+        }
+    }
+
+    // 范围向外取整到跨度八分之一的二次幂刻度, 数据小幅变化时映射不变, 只需重绘新样本所在的列
+    if ( low <= high ) {
+        const float span = std::max( high - low, 1e-6f );
+        const float step = std::exp2( std::ceil( std::log2( span ) ) ) / 8.0f;
+        low = std::floor( low / step ) * step;
+        high = std::ceil( high / step ) * step;
+        if ( high <= low ) high = low + step;
+    }
+
+    const bool mappingChanged = m_styleChanged || size != m_size || devicePixelRatio != m_devicePixelRatio ||
+                                start != m_viewStart || samplesPerColumn != m_samplesPerColumn || low != m_low ||
+                                high != m_high || end < m_seenEnd || ( begin != m_seenBegin && double( begin ) > start );
+    QRectF dirty;
+    if ( mappingChanged || wasEmpty ) {
+        dirty = full;
+    } else if ( samplesPerColumn > 0.0 ) {
+        // 只有 [m_seenEnd, end) 是新样本; 连到上一个样本的线段也会变, 左边从上一个样本再多留一列
+        const double x0 = ( ( double( m_seenEnd ) - 1.0 - start ) / samplesPerColumn - 1.0 ) / devicePixelRatio;
+        const double x1 = ( ( double( end ) - start ) / samplesPerColumn + 1.0 ) / devicePixelRatio;
+        dirty = QRectF( x0, 0.0, x1 - x0, size.height() ).intersected( full );
+    }
+
+    m_size = size;
+    m_devicePixelRatio = devicePixelRatio;
+    m_viewStart = start;
+    m_samplesPerColumn = samplesPerColumn;
+    m_seenBegin = begin;
+    m_seenEnd = end;
+    m_low = low;
+    m_high = high;
+    m_styleChanged = false;
+
+    points.clear();
+    if ( low > high ) return dirty;
+
+    if ( raw ) {
+        for ( double index = rawFirst; index < rawLast; index += 1.0 ) {
+            const qreal x = ( index + 0.5 - start ) / samplesPerColumn / devicePixelRatio;
+            points.emplace_back( x, toY( m_series.at( uint64_t( index ) ) ) );
+        }
+    } else if ( m_decimation == Decimation::MinMax ) {
+        // 同一列的四个点 x 相同: 竖线覆盖 min..max, 首末样本与相邻列相连
+        for ( int i = 0; i < count; ++i ) {
+            const TimeSeries::Column& column = m_columns[i];
+            if ( !column.valid ) continue;
+            const qreal x = ( i + 0.5 ) / devicePixelRatio;
+            points.emplace_back( x, toY( column.first ) );
+            points.emplace_back( x, toY( column.min ) );
+            points.emplace_back( x, toY( column.max ) );
+            points.emplace_back( x, toY( column.last ) );
+        }
+    } else {
+        m_selected.resize( size_t( count ) );
+        TimeSeries::largestTriangle( m_columns.data(), count, m_selected.data() );
+        for ( int i = 0; i < count; ++i ) {
+            if ( !m_columns[i].valid ) continue;
+            points.emplace_back( ( i + 0.5 ) / devicePixelRatio, toY( m_selected[i] ) );
+        }
+    }
+    return dirty;
+}
+
+qreal TimeSeriesPlot::toY( float value ) const {
+    return m_size.height() * ( 1.0 - qreal( value - m_low ) / qreal( m_high - m_low ) );
+}
+
+void TimeSeriesPlot::Polyline::paint( QPainter* painter, const QRectF& clip ) const {
+    auto first = points.begin();
+    auto last = points.end();
+    if ( !clip.isNull() ) {
+        first = std::lower_bound( points.begin(), points.end(), clip.left(),
+                                  []( const QPointF& point, qreal x ) { return point.x() < x; } );
+        last = std::upper_bound( first, points.end(), clip.right(), []( qreal x, const QPointF& point ) { return x < point.x(); } );
+        // 两端各多带一个点, 跨过 clip 边界的线段也要画
+        if ( first != points.begin() ) --first;
+        if ( last != points.end() ) ++last;
+    }
+    if ( last - first < 2 ) return;
+
+    // 每列正好一个设备像素, 用不抗锯齿的 1 像素画笔
+    painter->save();
+    painter->setRenderHint( QPainter::Antialiasing, false );
+    painter->setPen( QPen( color, 0 ) );
+    painter->drawPolyline( &*first, int( last - first ) );
+    painter->restore();
+}
@@ -0,0 +1,76 @@
+// 单一职责: 把 TimeSeries 画成折线, 每个设备像素一列, 计算量只与像素数有关
+// 每列用摘要金字塔求出 min/max 包络, 按 MinMax (首 / 最小 / 最大 / 末四个点, 不丢峰值) 或 LTTB (每列一个点) 生成折线
+// 视图不变时只有新样本所在的列会变化, update() 返回这部分的范围, 配合分块后备存储只重绘末尾的块
+#pragma once
+
+#include "time_series.hpp"
+
+#include <QColor>
+#include <QPointF>
+#include <QRectF>
+#include <QSizeF>
+#include <vector>
+
+class QPainter;
+
+class TimeSeriesPlot {
+public:
+    enum class Decimation {
+        MinMax,
+        Lttb,
+    };
+
+    // 生成好的折线, 可以复制给工作线程绘制
+    struct Polyline {
+        std::vector<QPointF> points;    // x 单调不减
+        QColor color;
+
+        // 只画与 clip 相交的一段, clip 为空时全部画出
+        void paint( QPainter* painter, const QRectF& clip ) const;
+    };
+
+    TimeSeries& series() { return m_series; }
+    const TimeSeries& series() const { return m_series; }
+
+    void setDecimation( Decimation decimation );
+    Decimation decimation() const { return m_decimation; }
+
+    void setColor( const QColor& color );
+    QColor color() const { return m_polyline.color; }
+
+    // 固定显示样本 [start, start + length)
+    void setWindow( double start, double length );
+
+    // 始终显示最新的 length 个样本, length <= 0 时显示全部保留的样本
+    void followTail( double length );
+
+    // 按 item 大小重新生成折线 (数据和视图都没变时直接返回), 返回需要重绘的范围, 逻辑坐标
+    QRectF update( const QSizeF& size, qreal devicePixelRatio );
+
+    const Polyline& polyline() const { return m_polyline; }
+    void paint( QPainter* painter, const QRectF& clip ) const { m_polyline.paint( painter, clip ); }
+
+private:
+    qreal toY( float value ) const;
+
+    TimeSeries m_series;
+    Decimation m_decimation = Decimation::MinMax;
+    bool m_following = true;
+    double m_start = 0.0;
+    double m_length = 0.0;
+    bool m_styleChanged = true;
+
+    // 上次生成折线时的状态, 用来判断哪些列需要重绘
+    QSizeF m_size;
+    qreal m_devicePixelRatio = 0.0;
+    double m_viewStart = 0.0;
+    double m_samplesPerColumn = 0.0;
+    uint64_t m_seenBegin = 0;
+    uint64_t m_seenEnd = 0;
+    float m_low = 0.0f;
+    float m_high = 0.0f;
+
+    std::vector<TimeSeries::Column> m_columns;
+    std::vector<float> m_selected;
+    Polyline m_polyline{ {}, QColor( 0, 160, 255 ) };
+};
@@ -0,0 +1,233 @@
+// 构建时运行的主题令牌生成工具: themeCodegen <theme_tokens.json> <输出目录>
+// 每个分组生成一个 QObject, 每个令牌是一个带独立通知信号的强类型属性, 明暗两套值直接编译成字面量;
+// 另外生成 AppTheme 单例, dark 变化时各分组只对值不同的令牌发出通知
+// 令牌格式: { "type": "color" | "int" | "real" | "string", "light": ..., "dark": ... } 或明暗相同时 { "type": ..., "value": ... }
+// 颜色按 QColor::fromString 解析, 带 alpha 时为 #AARRGGBB
+#include <QColor>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QStringList>
+
+namespace {
+
+struct TokenType {
+    const char* json;
+    const char* cpp;
+};
+
+const TokenType kTypes[] = {
+    { "color", "QColor" },
+    { "int", "int" },
+    { "real", "qreal" },
+    { "string", "QString" },
+};
+
+// 令牌值对应的 C++ 表达式; 解析失败时返回空字符串
+QString literal( const QString& type, const QJsonValue& value ) {
+    if ( type == "color" ) {
+        const QColor color = QColor::fromString( value.toString() );
+        if ( !color.isValid() ) return QString();
+        return QString( "QColor( %1, %2, %3, %4 )" ).arg( color.red() ).arg( color.green() ).arg( color.blue() ).arg( color.alpha() );
+    }
+    if ( type == "int" && value.isDouble() ) return QString::number( value.toInt() );
+    if ( type == "real" && value.isDouble() ) return QString::number( value.toDouble(), 'g', 17 );
+    if ( type == "string" && value.isString() ) {
+        QString escaped = value.toString();
+        escaped.replace( "\\", "\\\\" ).replace( "\"", "\\\"" );
+        return QString( "QStringLiteral( \"%1\" )" ).arg( escaped );
+    }
+    return QString();
+}
+
+// 未知类型返回空字符串
+QString cppType( const QString& type ) {
+    for ( const TokenType& known : kTypes ) {
+        if ( type == QLatin1String( known.json ) ) return QLatin1String( known.cpp );
+    }
+    return QString();
+}
+
+// 内容没变时不改文件, 避免触发重新编译
+bool writeIfChanged( const QString& path, const QString& content ) {
+    const QByteArray bytes = content.toUtf8();
+    QFile file( path );
+    if ( file.open( QIODevice::ReadOnly ) && file.readAll() == bytes ) return true;
+    file.close();
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        qDebug() << "Failed to write" << path;
+        return false;
+    }
+    file.write( bytes );
+    return true;
+}
+
+} // namespace
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication app( argc, argv );
+    const QStringList arguments = app.arguments();
+    if ( arguments.size() != 3 ) {
+        qDebug() << "Usage: themeCodegen <theme_tokens.json> <output directory>";
+        return 1;
+    }
+
+    QFile input( arguments[1] );
+    if ( !input.open( QIODevice::ReadOnly ) ) {
+        qDebug() << "Failed to open" << arguments[1];
+        return 1;
+    }
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson( input.readAll(), &error );
+    if ( !document.isObject() ) {
+        qDebug() << "Invalid theme json:" << error.errorString();
+        return 1;
+    }
+
+    const QRegularExpression identifier( "^[A-Za-z_][A-Za-z0-9_]*$" );
+    const QJsonObject groups = document.object();
+    QString header;
+    QString source;
+    QString themeProperties;
+    QString themeAccessors;
+    QString themeMembers;
+    QString themeConstruct;
+    QString themeApply;
+
+    for ( auto group = groups.begin(); group != groups.end(); ++group ) {
+        const QString groupName = group.key();
+        if ( !identifier.match( groupName ).hasMatch() ) {
+            qDebug() << "Invalid group name" << groupName;
+            return 1;
+        }
+        const QString className = "Theme" + groupName;
+        QString properties;
+        QString accessors;
+        QString signalList;
+        QString members;
+        QString apply;
+        bool themed = false;
+
+        const QJsonObject tokens = group.value().toObject();
+        for ( auto token = tokens.begin(); token != tokens.end(); ++token ) {
+            const QString name = token.key();
+            const QJsonObject spec = token.value().toObject();
+            const QString type = spec["type"].toString();
+            const QString cpp = cppType( type );
+            if ( !identifier.match( name ).hasMatch() || cpp.isEmpty() ) {
+                qDebug() << "Invalid token" << groupName + "." + name << type;
+                return 1;
+            }
+            const bool shared = spec.contains( "value" );
+            const QString light = literal( type, shared ? spec["value"] : spec["light"] );
+            const QString dark = literal( type, shared ? spec["value"] : spec["dark"] );
+            if ( light.isEmpty() || dark.isEmpty() ) {
+                qDebug() << "Invalid value for token" << groupName + "." + name;
+                return 1;
+            }
+
+            properties += QString( "    Q_PROPERTY(%1 %2 READ %2 NOTIFY %2Changed FINAL)\n" ).arg( cpp, name );
+            accessors += QString( "    %1 %2() const { return m_%2; }\n" ).arg( cpp, name );
+            signalList += QString( "    void %1Changed();\n" ).arg( name );
+            members += QString( "    %1 m_%2;\n" ).arg( cpp, name );
+            // 明暗相同的令牌只在第一次 apply 时赋值
+            themed = themed || light != dark;
+            const QString value = light == dark ? light : QString( "dark ? %1 : %2" ).arg( dark, light );
+            apply += QString( "    {\n"
+                              "        const %1 value = %2;\n"
+                              "        if ( !m_initialized || value != m_%3 ) {\n"
+                              "            m_%3 = value;\n"
+                              "            emit %3Changed();\n"
+                              "        }\n"
+                              "    }\n" ).arg( cpp, value, name );
+        }
+
+        header += QString( "class %1 : public QObject {\n"
+                           "    Q_OBJECT\n"
+                           "    QML_ANONYMOUS\n"
+                           "%2\n"
+                           "public:\n"
+                           "    explicit %1( QObject* parent = nullptr ) : QObject( parent ) {}\n\n"
+                           "%3\n"
+                           "    // 切换明暗时只有值变化的令牌发出通知\n"
+                           "    void apply( bool dark );\n\n"
+                           "signals:\n"
+                           "%4\n"
+                           "private:\n"
+                           "    bool m_initialized = false;\n"
+                           "%5"
+                           "};\n\n" ).arg( className, properties, accessors, signalList, members );
+        if ( !themed ) apply.prepend( "    Q_UNUSED( dark )\n" );
+        source += QString( "void %1::apply( bool dark ) {\n"
+                           "%2"
+                           "    m_initialized = true;\n"
+                           "}\n\n" ).arg( className, apply );
+
+        themeProperties += QString( "    Q_PROPERTY(%1* %2 READ %2 CONSTANT FINAL)\n" ).arg( className, groupName );
+        themeAccessors += QString( "    %1* %2() const { return m_%2; }\n" ).arg( className, groupName );
+        themeMembers += QString( "    %1* m_%2;\n" ).arg( className, groupName );
+        themeConstruct += QString( "    , m_%1( new %2( this ) )\n" ).arg( groupName, className );
+        themeApply += QString( "    m_%1->apply( m_dark );\n" ).arg( groupName );
+    }
+
+    header = QString( "// 由 themeCodegen 从 %1 生成, 不要手改\n"
+                      "#pragma once\n\n"
+                      "#include <QColor>\n"
+                      "#include <QObject>\n"
+                      "#include <QString>\n"
+                      "#include <QtQml/qqmlregistration.h>\n\n"
+                      "%2"
+                      "// 应用侧主题: AppTheme.<分组>.<令牌>, 属性都是强类型, 绑定求值不经过 QVariantMap\n"
+                      "class AppTheme : public QObject {\n"
+                      "    Q_OBJECT\n"
+                      "    QML_ELEMENT\n"
+                      "    QML_SINGLETON\n"
+                      "    Q_PROPERTY(bool dark READ dark WRITE setDark NOTIFY darkChanged FINAL)\n"
+                      "%3\n"
+                      "public:\n"
+                      "    explicit AppTheme( QObject* parent = nullptr );\n\n"
+                      "    bool dark() const { return m_dark; }\n"
+                      "    void setDark( bool dark );\n\n"
+                      "%4\n"
+                      "signals:\n"
+                      "    void darkChanged();\n\n"
+                      "private:\n"
+                      "    void apply();\n\n"
+                      "    bool m_dark = false;\n"
+                      "%5"
+                      "};\n" ).arg( QFileInfo( arguments[1] ).fileName(), header, themeProperties, themeAccessors, themeMembers );
+
+    source = QString( "// 由 themeCodegen 从 %1 生成, 不要手改\n"
+                      "#include \"theme_tokens.hpp\"\n\n"
+                      "%2"
+                      "AppTheme::AppTheme( QObject* parent )\n"
+                      "    : QObject( parent )\n"
+                      "%3"
+                      "{\n"
+                      "    apply();\n"
+                      "}\n\n"
+                      "void AppTheme::setDark( bool dark ) {\n"
+                      "    if ( dark == m_dark ) return;\n"
+                      "    m_dark = dark;\n"
+                      "    apply();\n"
+                      "    emit darkChanged();\n"
+                      "}\n\n"
+                      "void AppTheme::apply() {\n"
+                      "%4"
+                      "}\n" ).arg( QFileInfo( arguments[1] ).fileName(), source, themeConstruct, themeApply );
+
+    const QDir output( arguments[2] );
+    if ( !QDir().mkpath( output.path() ) ) {
+        qDebug() << "Failed to create" << output.path();
+        return 1;
+    }
+    return writeIfChanged( output.filePath( "theme_tokens.hpp" ), header )
+                   && writeIfChanged( output.filePath( "theme_tokens.cpp" ), source )
+               ? 0
+               : 1;
+}